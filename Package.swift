@@ -54,5 +54,8 @@ let package = Package(
                 "Bifaci",
                 .product(name: "SwiftCBOR", package: "SwiftCBOR"),
             ]),
+        .testTarget(
+            name: "BifaciBenchmarks",
+            dependencies: ["Bifaci"]),
     ]
 )
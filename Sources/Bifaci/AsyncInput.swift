@@ -0,0 +1,221 @@
+//
+//  AsyncInput.swift
+//  Bifaci
+//
+//  AsyncSequence input for Op handlers registered with `register_async_op`.
+//
+//  The CBOR-mode reader loop pushes a request's frames straight into an
+//  AsyncInputDemux, which splits them per stream_id into AsyncStreams. The
+//  handler iterates AsyncInputPackage / AsyncInputStream with `for await`,
+//  so while it waits for the next chunk its task is suspended and no thread
+//  is parked. Checksum verification and CBOR decoding happen in the handler
+//  task as it iterates, not on the reader thread, through the same
+//  CborSequenceDecoder the blocking demux uses.
+
+import Foundation
+@preconcurrency import SwiftCBOR
+
+/// Where the CBOR-mode reader loop delivers an incoming request's frames
+protocol RequestFrameSink: AnyObject {
+    func push(_ frame: Frame)
+    func finish()
+}
+
+extension BlockingQueue: RequestFrameSink where T == Frame {}
+
+/// A single input stream for async handlers — yields decoded CBOR values
+/// from CHUNK frames as they arrive. Async counterpart of `InputStream`.
+public final class AsyncInputStream: AsyncSequence, @unchecked Sendable {
+    public typealias Element = Result<CBOR, StreamError>
+
+    public struct AsyncIterator: AsyncIteratorProtocol {
+        fileprivate var frames: AsyncStream<Frame>.Iterator
+        private var decoder = CborSequenceDecoder()
+        /// Items decoded from the last chunk, not yet returned
+        private var ready: [Result<CBOR, StreamError>] = []
+        private var readyIndex = 0
+        private var ended = false
+
+        fileprivate init(frames: AsyncStream<Frame>.Iterator) {
+            self.frames = frames
+        }
+
+        public mutating func next() async -> Result<CBOR, StreamError>? {
+            while readyIndex == ready.count {
+                guard !ended else { return nil }
+                ready = []
+                readyIndex = 0
+                guard let frame = await frames.next() else {
+                    ended = true
+                    if let failure = unfinishedItemFailure(decoder) {
+                        ready = [failure]
+                    }
+                    continue
+                }
+                switch frame.frameType {
+                case .chunk:
+                    guard let payload = frame.payload else { continue }
+                    ready = decodeChunkItems(payload, of: frame, with: &decoder)
+                case .err:
+                    let code = frame.errorCode ?? "UNKNOWN"
+                    let message = frame.errorMessage ?? "Unknown error"
+                    ready = [.failure(.remoteError(code: code, message: message))]
+                default:
+                    continue
+                }
+            }
+            defer { readyIndex += 1 }
+            return ready[readyIndex]
+        }
+    }
+
+    private let _mediaUrn: String
+    private let frames: AsyncStream<Frame>
+
+    init(mediaUrn: String, frames: AsyncStream<Frame>) {
+        self._mediaUrn = mediaUrn
+        self.frames = frames
+    }
+
+    /// Media URN of this stream (from STREAM_START).
+    public var mediaUrn: String {
+        _mediaUrn
+    }
+
+    public func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(frames: frames.makeAsyncIterator())
+    }
+
+    /// Collect all chunks into a single byte vector (scalar path).
+    public func collectBytes() async throws -> Data {
+        var result = Data()
+        for await itemResult in self {
+            appendChunkBytes(try itemResult.get(), to: &result)
+        }
+        return result
+    }
+
+    /// Collect all chunks as a raw RFC 8742 CBOR sequence (list path).
+    public func collectCborSequence() async throws -> Data {
+        var result = Data()
+        for await itemResult in self {
+            result.append(contentsOf: try itemResult.get().encode())
+        }
+        return result
+    }
+
+    /// Collect a single CBOR value (expects exactly one chunk).
+    public func collectValue() async throws -> CBOR {
+        var iterator = makeAsyncIterator()
+        guard let first = await iterator.next() else {
+            throw StreamError.closed
+        }
+        return try first.get()
+    }
+}
+
+/// The bundle of all input arg streams for one async request. Yields an
+/// AsyncInputStream as each STREAM_START arrives — before that stream's
+/// chunks — and ends after END. Async counterpart of `InputPackage`.
+public final class AsyncInputPackage: AsyncSequence, @unchecked Sendable {
+    public typealias Element = Result<AsyncInputStream, StreamError>
+
+    public struct AsyncIterator: AsyncIteratorProtocol {
+        fileprivate var streams: AsyncStream<AsyncInputStream>.Iterator
+
+        public mutating func next() async -> Result<AsyncInputStream, StreamError>? {
+            guard let stream = await streams.next() else { return nil }
+            return .success(stream)
+        }
+    }
+
+    private let streams: AsyncStream<AsyncInputStream>
+
+    init(streams: AsyncStream<AsyncInputStream>) {
+        self.streams = streams
+    }
+
+    public func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(streams: streams.makeAsyncIterator())
+    }
+
+    /// Get the next input stream. Returns nil when all streams delivered (after END).
+    public func nextStream() async -> Result<AsyncInputStream, StreamError>? {
+        var iterator = makeAsyncIterator()
+        return await iterator.next()
+    }
+
+    /// Collect all streams' bytes into a single Data.
+    public func collectAllBytes() async throws -> Data {
+        var all = Data()
+        for await streamResult in self {
+            all.append(try await streamResult.get().collectBytes())
+        }
+        return all
+    }
+
+    /// Collect each stream individually into an array of (mediaUrn, bytes) pairs.
+    public func collectStreams() async throws -> [(mediaUrn: String, bytes: Data)] {
+        var result: [(mediaUrn: String, bytes: Data)] = []
+        for await streamResult in self {
+            let stream = try streamResult.get()
+            result.append((mediaUrn: stream.mediaUrn, bytes: try await stream.collectBytes()))
+        }
+        return result
+    }
+}
+
+/// Splits one request's frames into the streams of an AsyncInputPackage.
+/// push/finish must come from a single thread (the reader loop).
+final class AsyncInputDemux: RequestFrameSink, @unchecked Sendable {
+    let package: AsyncInputPackage
+    private let streamsContinuation: AsyncStream<AsyncInputStream>.Continuation
+    /// Streams that have seen STREAM_START but not STREAM_END
+    private var open: [String: AsyncStream<Frame>.Continuation] = [:]
+
+    init() {
+        let (streams, continuation) = AsyncStream<AsyncInputStream>.makeStream()
+        self.package = AsyncInputPackage(streams: streams)
+        self.streamsContinuation = continuation
+    }
+
+    func push(_ frame: Frame) {
+        switch frame.frameType {
+        case .streamStart:
+            guard let streamId = frame.streamId else { return }
+            let (frames, continuation) = AsyncStream<Frame>.makeStream()
+            open[streamId] = continuation
+            streamsContinuation.yield(AsyncInputStream(mediaUrn: frame.mediaUrn ?? "media:", frames: frames))
+
+        case .chunk:
+            guard let streamId = frame.streamId else { return }
+            open[streamId]?.yield(frame)
+
+        case .streamEnd:
+            guard let streamId = frame.streamId else { return }
+            open.removeValue(forKey: streamId)?.finish()
+
+        case .err:
+            // Error frame - propagate to every open stream
+            for continuation in open.values {
+                continuation.yield(frame)
+            }
+            finish()
+
+        case .end:
+            finish()
+
+        default:
+            break
+        }
+    }
+
+    /// End the package and any stream left open
+    func finish() {
+        for continuation in open.values {
+            continuation.finish()
+        }
+        open.removeAll()
+        streamsContinuation.finish()
+    }
+}
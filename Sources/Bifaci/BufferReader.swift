@@ -8,18 +8,20 @@ public class BufferReader: @unchecked Sendable {
     private let bufferLock = NSLock()
     private var limits: Limits
 
-    /// Temporary file for large payloads (stream-to-disk)
-    private var tempFileHandle: FileHandle?
-    private var tempFileURL: URL?
+    /// Sparse temp file for large payloads (stream-to-disk)
+    private var mapped: MappedAssembly?
     private var expectedLength: UInt64?
+    /// Chunk bytes received so far (completion check)
     private var receivedLength: UInt64 = 0
+    /// End of the furthest chunk written into `mapped` (result size)
+    private var assembledLength: Int = 0
 
     public init(limits: Limits = Limits()) {
         self.limits = limits
     }
 
     deinit {
-        cleanupTempFile()
+        cleanupAssembly()
     }
 
     /// Update limits
@@ -47,14 +49,8 @@ public class BufferReader: @unchecked Sendable {
             return nil
         }
 
-        // Read big-endian length
-        let bytes = [UInt8](buffer.prefix(4))
-        let length = Int(UInt32(bytes[0]) << 24 | UInt32(bytes[1]) << 16 | UInt32(bytes[2]) << 8 | UInt32(bytes[3]))
-
-        // Validate length
-        if length > limits.maxFrame || length > MAX_FRAME_HARD_LIMIT {
-            throw FrameError.frameTooLarge(size: length, max: min(limits.maxFrame, MAX_FRAME_HARD_LIMIT))
-        }
+        // Read and validate big-endian length
+        let length = try decodeFrameLength(buffer.prefix(4), limits: limits)
 
         // Check if we have the full payload
         let totalNeeded = 4 + length
@@ -83,41 +79,41 @@ public class BufferReader: @unchecked Sendable {
         bufferLock.lock()
         defer { bufferLock.unlock() }
         buffer.removeAll()
-        cleanupTempFileInternal()
+        cleanupAssemblyInternal()
     }
 
     // MARK: - Chunk Reassembly
 
     /// Start assembling a chunked transfer
-    /// If the total length exceeds maxChunk, uses disk storage
+    /// If the total length exceeds maxChunk, chunks are written into a
+    /// sparse temp file instead of RAM
     public func startChunkedAssembly(totalLength: UInt64) throws {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
+        cleanupAssemblyInternal()
         expectedLength = totalLength
         receivedLength = 0
 
-        // For large payloads, use temp file to avoid RAM exhaustion
+        // For large payloads, use a mapped temp file to avoid RAM exhaustion
         if totalLength > UInt64(limits.maxChunk) {
-            let tempDir = FileManager.default.temporaryDirectory
-            let fileName = UUID().uuidString + ".cbor_chunk"
-            tempFileURL = tempDir.appendingPathComponent(fileName)
-            FileManager.default.createFile(atPath: tempFileURL!.path, contents: nil)
-            tempFileHandle = try FileHandle(forWritingTo: tempFileURL!)
+            guard totalLength <= UInt64(Int.max) else {
+                throw FrameError.protocolError("Chunked payload length \(totalLength) is not addressable")
+            }
+            mapped = try MappedAssembly(length: Int(totalLength))
         }
     }
 
     /// Add a chunk to the assembly
-    @available(macOS 10.15.4, iOS 13.4, *)
     public func addChunk(_ data: Data, offset: UInt64) throws {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
-        if let handle = tempFileHandle {
-            // Stream to disk
-            try handle.seek(toOffset: offset)
-            try handle.write(contentsOf: data)
+        if let mapped = mapped {
+            // Write straight into the temp file
+            try mapped.write(data, at: offset)
             receivedLength += UInt64(data.count)
+            assembledLength = max(assembledLength, Int(offset) + data.count)
         } else {
             // In-memory assembly
             // Ensure buffer is large enough
@@ -130,16 +126,18 @@ public class BufferReader: @unchecked Sendable {
         }
     }
 
-    /// Finalize chunked assembly and return the complete data
+    /// Finalize chunked assembly and return the complete data.
+    ///
+    /// Large (file-backed) payloads are returned without copying: the Data
+    /// reads a read-only mapping of the temp file and unmaps it when
+    /// released, so the payload is paged in on demand.
     public func finalizeChunkedAssembly() throws -> Data {
         bufferLock.lock()
         defer { bufferLock.unlock() }
 
-        if let url = tempFileURL, let handle = tempFileHandle {
-            // Read from temp file
-            try handle.close()
-            let data = try Data(contentsOf: url)
-            cleanupTempFileInternal()
+        if let mapped = mapped {
+            let data = try mapped.takeData(count: assembledLength)
+            cleanupAssemblyInternal()
             return data
         } else {
             // Return in-memory buffer
@@ -164,23 +162,89 @@ public class BufferReader: @unchecked Sendable {
 
     // MARK: - Private
 
-    private func cleanupTempFile() {
+    private func cleanupAssembly() {
         bufferLock.lock()
         defer { bufferLock.unlock() }
-        cleanupTempFileInternal()
+        cleanupAssemblyInternal()
     }
 
-    private func cleanupTempFileInternal() {
-        if let handle = tempFileHandle {
-            try? handle.close()
-            tempFileHandle = nil
-        }
-        if let url = tempFileURL {
-            try? FileManager.default.removeItem(at: url)
-            tempFileURL = nil
-        }
+    private func cleanupAssemblyInternal() {
+        // Closes the temp file; a Data handed out by finalize keeps its mapping
+        mapped = nil
         expectedLength = nil
         receivedLength = 0
+        assembledLength = 0
+    }
+}
+
+// MARK: - Mapped Assembly
+
+/// Sparse temp file for reassembling one large payload.
+///
+/// The file is unlinked as soon as it is opened, so it disappears with the
+/// descriptor and the final mapping and never outlives the process. Chunks
+/// are written with `pwrite` rather than copied into a shared mapping: the
+/// declared length comes from the peer, and a store into a mapped hole
+/// that the disk cannot back raises SIGBUS, whereas `pwrite` reports
+/// ENOSPC as an error. The file is only mapped, read-only, once assembly
+/// is finished.
+private final class MappedAssembly {
+    private let fd: Int32
+    private let capacity: Int
+
+    init(length: Int) throws {
+        let path = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString + ".cbor_chunk").path
+        let fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0o600)
+        guard fd >= 0 else {
+            throw FrameError.ioError("open(\(path)) failed: \(String(cString: strerror(errno)))")
+        }
+        // The descriptor keeps the file alive; nothing needs the name
+        unlink(path)
+
+        guard ftruncate(fd, off_t(length)) == 0 else {
+            let message = String(cString: strerror(errno))
+            close(fd)
+            throw FrameError.ioError("ftruncate(\(length)) failed: \(message)")
+        }
+        self.fd = fd
+        capacity = length
+    }
+
+    deinit {
+        close(fd)
+    }
+
+    func write(_ data: Data, at offset: UInt64) throws {
+        guard offset <= UInt64(capacity), data.count <= capacity - Int(offset) else {
+            throw FrameError.protocolError("Chunk at offset \(offset) (\(data.count) bytes) exceeds declared length \(capacity)")
+        }
+        try data.withUnsafeBytes { src in
+            guard let source = src.baseAddress else { return }
+            var written = 0
+            while written < src.count {
+                let n = pwrite(fd, source + written, src.count - written, off_t(Int(offset) + written))
+                if n < 0 {
+                    if errno == EINTR { continue }
+                    throw FrameError.ioError("pwrite(\(src.count) bytes at \(offset)) failed: \(String(cString: strerror(errno)))")
+                }
+                written += n
+            }
+        }
+    }
+
+    /// Map the first `count` bytes read-only into a Data that unmaps them
+    /// when released. Every written byte already has disk behind it and
+    /// unwritten holes read back as zeros, so reading cannot fault.
+    func takeData(count: Int) throws -> Data {
+        guard count > 0 else { return Data() }
+        guard let ptr = mmap(nil, count, PROT_READ, MAP_PRIVATE, fd, 0),
+              ptr != UnsafeMutableRawPointer(bitPattern: -1) else {
+            throw FrameError.ioError("mmap(\(count)) failed: \(String(cString: strerror(errno)))")
+        }
+        return Data(bytesNoCopy: ptr, count: count, deallocator: .custom { pointer, length in
+            _ = munmap(pointer, length)
+        })
     }
 }
 
@@ -0,0 +1,362 @@
+//
+//  CapDispatchIndex.swift
+//  Bifaci
+//
+//  Pre-parsed cap URN routing table.
+//
+//  Routing a REQ means finding the registered cap whose URN the request
+//  accepts. Doing that naively re-parses every registered cap string with
+//  CSCapUrn.fromString on every request. The index parses each registered
+//  cap once when the table is (re)built, buckets entries by their `op` tag,
+//  and memoizes recent resolutions per request URN string in an LRU until
+//  the next rebuild.
+//
+//  Shared by RelaySwitch (masters), PluginHost (plugins) and PluginRuntime
+//  (Op handlers).
+
+import Foundation
+import CapDAG
+
+/// Number of recent request → target resolutions kept per index.
+let CAP_DISPATCH_CACHE_CAPACITY: Int = 1024
+
+/// Compiled routing table mapping cap URNs to dispatch targets.
+///
+/// Build it from the registered `(capUrn, target)` pairs whenever the
+/// underlying table changes; look up with `closestMatch(for:preferredCap:)`
+/// (closest specificity, used by RelaySwitch and PluginRuntime) or
+/// `firstMatch(for:)` (exact string, then first accepting entry, used by
+/// PluginHost).
+///
+/// `closestMatches` / `firstMatches` return the winner followed by every
+/// other target registered with an equivalent cap (each accepts the other),
+/// for callers that spread load across interchangeable targets.
+///
+/// Matching semantics are identical to a linear scan with
+/// `request.accepts(registered)`; the `op` buckets only prune entries that
+/// `accepts` would reject anyway:
+/// - request `op=X`  → entries with `op=X` or `op=*`
+/// - request `op=*`  → entries that carry any `op`
+/// - request w/o op  → every entry
+///
+/// Not thread-safe. Callers keep it under the same lock as the state it indexes.
+struct CapDispatchIndex<Target> {
+
+    /// A registered cap, parsed once at build time.
+    struct Entry {
+        let capUrn: String
+        let urn: CSCapUrn
+        let specificity: Int
+        let target: Target
+    }
+
+    /// Entries in registration order (order breaks specificity ties).
+    private(set) var entries: [Entry] = []
+
+    /// Entry indices by exact `op` value.
+    private var byOp: [String: [Int]] = [:]
+    /// Entries registered with `op=*`.
+    private var wildcardOp: [Int] = []
+    /// Entries registered without an `op` tag.
+    private var withoutOp: [Int] = []
+
+    /// First entry index per exact registered cap string.
+    private var byString: [String: Int] = [:]
+
+    private enum Policy: Hashable {
+        case closest
+        case first
+    }
+
+    private struct CacheKey: Hashable {
+        let policy: Policy
+        let capUrn: String
+        let preferredCap: String?
+    }
+
+    /// Recent resolutions: request → winning entry index followed by the
+    /// indices of entries equivalent to it (empty = no handler).
+    private var cache: LRUCache<CacheKey, [Int]>
+
+    init(cacheCapacity: Int = CAP_DISPATCH_CACHE_CAPACITY) {
+        self.cache = LRUCache(capacity: cacheCapacity)
+    }
+
+    /// Number of registered entries.
+    var count: Int { entries.count }
+
+    // MARK: - Building
+
+    /// Replace the index contents. Unparseable cap strings are skipped, exactly
+    /// as the linear scan skipped them.
+    mutating func rebuild<S: Sequence>(_ registrations: S) where S.Element == (capUrn: String, target: Target) {
+        entries.removeAll(keepingCapacity: true)
+        byOp.removeAll(keepingCapacity: true)
+        wildcardOp.removeAll(keepingCapacity: true)
+        withoutOp.removeAll(keepingCapacity: true)
+        byString.removeAll(keepingCapacity: true)
+        cache.removeAll()
+
+        for (capUrn, target) in registrations {
+            guard let urn = try? CSCapUrn.fromString(capUrn) else { continue }
+            let idx = entries.count
+            entries.append(Entry(capUrn: capUrn, urn: urn, specificity: Int(urn.specificity()), target: target))
+            if byString[capUrn] == nil {
+                byString[capUrn] = idx
+            }
+
+            switch urn.getTag("op") {
+            case nil:
+                withoutOp.append(idx)
+            case "*"?:
+                wildcardOp.append(idx)
+            case let op?:
+                byOp[op, default: []].append(idx)
+            }
+        }
+    }
+
+    // MARK: - Lookup
+
+    /// Find the target whose registered cap best serves `capUrn`.
+    ///
+    /// Prefers the match whose specificity is CLOSEST to the request's
+    /// specificity (ties broken by registration order).
+    ///
+    /// - Parameters:
+    ///   - capUrn: The requested cap URN
+    ///   - preferredCap: Optional cap URN for exact routing. When provided, uses
+    ///                   comparable matching (broader) and prefers entries whose
+    ///                   registered cap is equivalent to this URN.
+    mutating func closestMatch(for capUrn: String, preferredCap: String? = nil) -> Target? {
+        return closestEntries(for: capUrn, preferredCap: preferredCap).first.map { entries[$0].target }
+    }
+
+    /// `closestMatch` followed by the other targets registered with a cap
+    /// equivalent to the winning one, in registration order.
+    mutating func closestMatches(for capUrn: String, preferredCap: String? = nil) -> [Target] {
+        return closestEntries(for: capUrn, preferredCap: preferredCap).map { entries[$0].target }
+    }
+
+    /// Registered cap URN of the `closestMatch` winner: the cap a request is
+    /// actually routed by, as opposed to the (peer-supplied) request string.
+    mutating func closestMatchedCap(for capUrn: String, preferredCap: String? = nil) -> String? {
+        return closestEntries(for: capUrn, preferredCap: preferredCap).first.map { entries[$0].capUrn }
+    }
+
+    private mutating func closestEntries(for capUrn: String, preferredCap: String?) -> [Int] {
+        let key = CacheKey(policy: .closest, capUrn: capUrn, preferredCap: preferredCap)
+        if let cached = cache.get(key) {
+            return cached
+        }
+
+        let resolved = resolveClosest(capUrn, preferredCap: preferredCap).map(equivalentEntries) ?? []
+        cache.set(key, resolved)
+        return resolved
+    }
+
+    /// Find the first target that serves `capUrn`.
+    ///
+    /// Exact string match first (no parsing), then the first entry in
+    /// registration order that the request accepts.
+    mutating func firstMatch(for capUrn: String) -> Target? {
+        if let idx = byString[capUrn] {
+            return entries[idx].target
+        }
+        return firstEntries(for: capUrn).first.map { entries[$0].target }
+    }
+
+    /// `firstMatch` followed by the other targets registered with a cap
+    /// equivalent to the winning one, in registration order.
+    mutating func firstMatches(for capUrn: String) -> [Target] {
+        return firstEntries(for: capUrn).map { entries[$0].target }
+    }
+
+    /// Registered cap URN of the `firstMatch` winner
+    mutating func firstMatchedCap(for capUrn: String) -> String? {
+        if let idx = byString[capUrn] {
+            return entries[idx].capUrn
+        }
+        return firstEntries(for: capUrn).first.map { entries[$0].capUrn }
+    }
+
+    private mutating func firstEntries(for capUrn: String) -> [Int] {
+        let key = CacheKey(policy: .first, capUrn: capUrn, preferredCap: nil)
+        if let cached = cache.get(key) {
+            return cached
+        }
+
+        var resolved: Int? = byString[capUrn]
+        if resolved == nil, let requestUrn = try? CSCapUrn.fromString(capUrn) {
+            // Request is pattern, registered cap is instance
+            resolved = candidates(for: requestUrn, comparable: false).first { requestUrn.accepts(entries[$0].urn) }
+        }
+        let group = resolved.map(equivalentEntries) ?? []
+        cache.set(key, group)
+        return group
+    }
+
+    /// `winner`, then every other entry whose cap is equivalent to it
+    /// (each accepts the other), in registration order.
+    private func equivalentEntries(_ winner: Int) -> [Int] {
+        let urn = entries[winner].urn
+        var group = [winner]
+        for idx in candidates(for: urn, comparable: false) where idx != winner {
+            let other = entries[idx].urn
+            if urn.accepts(other) && other.accepts(urn) {
+                group.append(idx)
+            }
+        }
+        return group
+    }
+
+    /// Uncached resolution. Returns the winning entry index.
+    private func resolveClosest(_ capUrn: String, preferredCap: String?) -> Int? {
+        guard let requestUrn = try? CSCapUrn.fromString(capUrn) else {
+            return nil
+        }
+        let requestSpecificity = Int(requestUrn.specificity())
+        let preferredUrn = preferredCap.flatMap { try? CSCapUrn.fromString($0) }
+        let comparable = preferredUrn != nil
+
+        var firstPreferred: Int? = nil
+        var best: (idx: Int, distance: Int)? = nil
+
+        for idx in candidates(for: requestUrn, comparable: comparable) {
+            let entry = entries[idx]
+
+            // Comparable: either side accepts the other (broader match set).
+            // Standard: request is pattern, registered cap is instance.
+            let isMatch = comparable
+                ? (requestUrn.accepts(entry.urn) || entry.urn.accepts(requestUrn))
+                : requestUrn.accepts(entry.urn)
+            guard isMatch else { continue }
+
+            if let pref = preferredUrn, firstPreferred == nil,
+               pref.accepts(entry.urn) && entry.urn.accepts(pref) {
+                firstPreferred = idx
+            }
+
+            let distance = abs(entry.specificity - requestSpecificity)
+            if best == nil || distance < best!.distance {
+                best = (idx, distance)
+                // Nothing later can beat an exact specificity match
+                if distance == 0 && preferredUrn == nil { break }
+            }
+        }
+
+        return firstPreferred ?? best?.idx
+    }
+
+    /// Entry indices that can possibly match, in registration order.
+    private func candidates(for requestUrn: CSCapUrn, comparable: Bool) -> [Int] {
+        guard let op = requestUrn.getTag("op") else {
+            // Unconstrained op: every entry is a candidate
+            return Array(entries.indices)
+        }
+
+        var result: [Int]
+        if op == "*" {
+            // Entries must carry some op for the request to accept them;
+            // comparable mode also lets op-less entries accept the request.
+            if comparable { return Array(entries.indices) }
+            result = wildcardOp
+            for bucket in byOp.values { result.append(contentsOf: bucket) }
+        } else {
+            result = (byOp[op] ?? []) + wildcardOp
+            if comparable { result.append(contentsOf: withoutOp) }
+        }
+        result.sort()
+        return result
+    }
+}
+
+// MARK: - LRU Cache
+
+/// Fixed-capacity least-recently-used cache.
+///
+/// Slots live in a flat array linked into a recency list by index, so hits
+/// and evictions never allocate once the cache is full. Not thread-safe.
+struct LRUCache<Key: Hashable, Value> {
+    private struct Slot {
+        var key: Key
+        var value: Value
+        var prev: Int
+        var next: Int
+    }
+
+    let capacity: Int
+    private var slots: [Slot] = []
+    private var map: [Key: Int] = [:]
+    /// Most recently used slot (-1 when empty)
+    private var head = -1
+    /// Least recently used slot (-1 when empty)
+    private var tail = -1
+
+    init(capacity: Int) {
+        precondition(capacity > 0, "LRUCache capacity must be positive")
+        self.capacity = capacity
+    }
+
+    var count: Int { map.count }
+
+    /// Look up a value and mark it most recently used.
+    mutating func get(_ key: Key) -> Value? {
+        guard let idx = map[key] else { return nil }
+        moveToFront(idx)
+        return slots[idx].value
+    }
+
+    /// Insert or update a value, evicting the least recently used entry when full.
+    mutating func set(_ key: Key, _ value: Value) {
+        if let idx = map[key] {
+            slots[idx].value = value
+            moveToFront(idx)
+            return
+        }
+
+        let idx: Int
+        if slots.count < capacity {
+            idx = slots.count
+            slots.append(Slot(key: key, value: value, prev: -1, next: -1))
+        } else {
+            idx = tail
+            unlink(idx)
+            map.removeValue(forKey: slots[idx].key)
+            slots[idx].key = key
+            slots[idx].value = value
+        }
+        map[key] = idx
+        pushFront(idx)
+    }
+
+    mutating func removeAll() {
+        slots.removeAll(keepingCapacity: true)
+        map.removeAll(keepingCapacity: true)
+        head = -1
+        tail = -1
+    }
+
+    private mutating func moveToFront(_ idx: Int) {
+        guard idx != head else { return }
+        unlink(idx)
+        pushFront(idx)
+    }
+
+    private mutating func unlink(_ idx: Int) {
+        let prev = slots[idx].prev
+        let next = slots[idx].next
+        if prev >= 0 { slots[prev].next = next } else { head = next }
+        if next >= 0 { slots[next].prev = prev } else { tail = prev }
+        slots[idx].prev = -1
+        slots[idx].next = -1
+    }
+
+    private mutating func pushFront(_ idx: Int) {
+        slots[idx].prev = -1
+        slots[idx].next = head
+        if head >= 0 { slots[head].prev = idx }
+        head = idx
+        if tail < 0 { tail = idx }
+    }
+}
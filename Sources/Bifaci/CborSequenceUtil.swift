@@ -2,7 +2,7 @@
 //  CborSequenceUtil.swift
 //  Bifaci
 //
-//  RFC 8742 CBOR Sequence split/assemble utilities.
+//  RFC 8742 CBOR Sequence split/assemble utilities and incremental decoder.
 //
 //  A CBOR sequence is a concatenation of independently-encoded CBOR data items
 //  with no array wrapper. Each item is a complete, self-delimiting CBOR value.
@@ -30,59 +30,212 @@ public enum CborSequenceError: Error, LocalizedError {
     }
 }
 
-/// Split an RFC 8742 CBOR sequence into individually-serialized CBOR items.
-///
-/// A CBOR sequence is a concatenation of independently-encoded CBOR data items.
-/// This function iterates through the sequence by decoding values one at a time
-/// from the byte stream, tracking exact byte consumption.
+/// Maximum container/tag nesting CborSequenceDecoder accepts in one item
+public let CBOR_SEQUENCE_MAX_DEPTH: Int = 256
+
+/// Incremental RFC 8742 CBOR sequence decoder.
 ///
-/// Returns each item as its independent CBOR-encoded `Data`.
+/// Bytes are fed in arbitrary pieces (e.g. CHUNK payloads, where one item may
+/// span several chunks and one chunk may hold several items). `nextItem()`
+/// returns each item's encoded bytes as soon as the item is complete; only the
+/// unfinished trailing item stays buffered, so memory is bounded by the
+/// largest item rather than the whole sequence.
 ///
-/// - Parameter data: The raw bytes of a CBOR sequence
-/// - Returns: Array of individually-encoded CBOR items
-/// - Throws: `CborSequenceError.emptySequence` if input is empty,
-///           `CborSequenceError.deserializationError` if any value is malformed
-public func splitCborSequence(_ data: Data) throws -> [Data] {
-    if data.isEmpty {
-        throw CborSequenceError.emptySequence
+/// Item boundaries are found by scanning CBOR headers, without decoding
+/// values. An item still incomplete after a feed is rescanned from its start
+/// on the next one.
+public struct CborSequenceDecoder {
+    private var buffer = Data()
+    /// Offset in `buffer` of the first byte not yet returned
+    private var start = 0
+    /// Bytes consumed before `buffer`'s first byte (for error offsets)
+    private var consumedBefore = 0
+
+    public init() {}
+
+    /// Bytes held for the incomplete trailing item
+    public var bufferedByteCount: Int {
+        buffer.count - start
     }
 
-    let bytes = [UInt8](data)
-    var items: [Data] = []
-    var offset = 0
+    /// Append the next piece of the sequence.
+    public mutating func feed(_ data: Data) {
+        if start == buffer.count {
+            // Nothing pending: adopt the new bytes without copying them
+            consumedBefore += buffer.count
+            buffer = data
+            start = 0
+            return
+        }
+        if start > 0 {
+            consumedBefore += start
+            buffer.removeSubrange(buffer.startIndex..<(buffer.startIndex + start))
+            start = 0
+        }
+        buffer.append(data)
+    }
 
-    while offset < bytes.count {
-        let remaining = Array(bytes[offset...])
-        let decoder = CBORDecoder(input: remaining)
+    /// Encoded bytes of the next complete item, or nil until more bytes arrive.
+    /// - Throws: `CborSequenceError.deserializationError` if the bytes are not well-formed CBOR
+    public mutating func nextItem() throws -> Data? {
+        guard start < buffer.count else { return nil }
+        let itemStart = start
+        let offsetBase = consumedBefore
+        let end: Int? = try buffer.withUnsafeBytes { raw in
+            var cursor = itemStart
+            let complete = try CborSequenceDecoder.scanItem(raw, &cursor, depth: 0, offsetBase: offsetBase)
+            return complete ? cursor : nil
+        }
+        guard let itemEnd = end else { return nil }
+        start = itemEnd
+        return buffer.subdata(in: (buffer.startIndex + itemStart)..<(buffer.startIndex + itemEnd))
+    }
 
-        let decoded: CBOR?
+    /// Next complete item, decoded.
+    public mutating func nextValue() throws -> CBOR? {
+        guard let item = try nextItem() else { return nil }
+        let value: CBOR?
         do {
-            decoded = try decoder.decodeItem()
+            value = try CBOR.decode([UInt8](item))
         } catch {
-            throw CborSequenceError.deserializationError(
-                "Failed to decode CBOR value at offset \(offset) (\(bytes.count - offset) bytes remaining): \(error)"
-            )
+            throw CborSequenceError.deserializationError("Failed to decode CBOR item: \(error)")
+        }
+        guard let decoded = value else {
+            throw CborSequenceError.deserializationError("Unexpected nil CBOR item")
         }
+        return decoded
+    }
 
-        guard let value = decoded else {
+    /// Check that the sequence ended on an item boundary.
+    /// - Throws: `CborSequenceError.deserializationError` if an incomplete item is buffered
+    public func finish() throws {
+        if bufferedByteCount > 0 {
             throw CborSequenceError.deserializationError(
-                "Unexpected nil CBOR item at offset \(offset)"
+                "Truncated CBOR value at offset \(consumedBefore + start) (\(bufferedByteCount) bytes remaining)"
             )
         }
+    }
 
-        // Re-encode the decoded value to get the canonical serialized form
-        let encoded = value.encode()
-        items.append(Data(encoded))
-        offset += encoded.count
+    /// Drop any buffered partial item (e.g. after a corrupt piece).
+    public mutating func reset() {
+        consumedBefore += buffer.count
+        buffer = Data()
+        start = 0
     }
 
-    if items.isEmpty {
-        throw CborSequenceError.emptySequence
+    /// Advance `i` past one CBOR item. Returns false if `b` ends before the item does.
+    private static func scanItem(_ b: UnsafeRawBufferPointer, _ i: inout Int, depth: Int, offsetBase: Int) throws -> Bool {
+        func malformed(_ what: String) -> CborSequenceError {
+            .deserializationError("Malformed CBOR at offset \(offsetBase + i): \(what)")
+        }
+        guard depth <= CBOR_SEQUENCE_MAX_DEPTH else {
+            throw malformed("nesting deeper than \(CBOR_SEQUENCE_MAX_DEPTH)")
+        }
+        guard i < b.count else { return false }
+
+        let initial = b[i]
+        let major = initial >> 5
+        let info = initial & 0x1f
+        i += 1
+
+        var argument: UInt64 = 0
+        switch info {
+        case 0...23:
+            argument = UInt64(info)
+        case 24...27:
+            let width = 1 << Int(info - 24)
+            guard b.count - i >= width else { return false }
+            for k in 0..<width {
+                argument = argument << 8 | UInt64(b[i + k])
+            }
+            i += width
+        case 31:
+            guard (2...5).contains(major) else {
+                throw malformed(major == 7 ? "unexpected break" : "indefinite length on major type \(major)")
+            }
+        default:
+            throw malformed("reserved additional info \(info)")
+        }
+        let indefinite = info == 31
+
+        switch major {
+        case 0, 1, 7:
+            return true
+
+        case 2, 3:
+            if indefinite {
+                // Definite-length chunks of the same major type, then break
+                while true {
+                    guard i < b.count else { return false }
+                    if b[i] == 0xff {
+                        i += 1
+                        return true
+                    }
+                    guard b[i] >> 5 == major, b[i] & 0x1f != 31 else {
+                        throw malformed("invalid chunk in indefinite-length string")
+                    }
+                    guard try scanItem(b, &i, depth: depth + 1, offsetBase: offsetBase) else { return false }
+                }
+            }
+            guard argument <= UInt64(b.count - i) else { return false }
+            i += Int(argument)
+            return true
+
+        case 4, 5:
+            if indefinite {
+                while true {
+                    guard i < b.count else { return false }
+                    if b[i] == 0xff {
+                        i += 1
+                        return true
+                    }
+                    guard try scanItem(b, &i, depth: depth + 1, offsetBase: offsetBase) else { return false }
+                }
+            }
+            let perEntry: UInt64 = major == 5 ? 2 : 1
+            // Every nested item takes at least one byte
+            guard argument <= UInt64(b.count - i) / perEntry else { return false }
+            for _ in 0..<(Int(argument) * Int(perEntry)) {
+                guard try scanItem(b, &i, depth: depth + 1, offsetBase: offsetBase) else { return false }
+            }
+            return true
+
+        default: // 6: tag, followed by one item
+            return try scanItem(b, &i, depth: depth + 1, offsetBase: offsetBase)
+        }
     }
+}
 
+/// Split an RFC 8742 CBOR sequence into individually-serialized CBOR items.
+///
+/// A CBOR sequence is a concatenation of independently-encoded CBOR data items.
+/// Item boundaries come from CborSequenceDecoder, so each item is returned
+/// exactly as encoded in `data` (no decode/re-encode round trip).
+///
+/// - Parameter data: The raw bytes of a CBOR sequence
+/// - Returns: Array of individually-encoded CBOR items
+/// - Throws: `CborSequenceError.emptySequence` if input is empty,
+///           `CborSequenceError.deserializationError` if any value is malformed
+public func splitCborSequence(_ data: Data) throws -> [Data] {
+    var items: [Data] = []
+    try forEachCborSequenceItem(data) { items.append($0) }
     return items
 }
 
+/// Visit each item of an RFC 8742 CBOR sequence in order without building
+/// the full item list. Same errors as `splitCborSequence`.
+public func forEachCborSequenceItem(_ data: Data, _ body: (Data) throws -> Void) throws {
+    if data.isEmpty {
+        throw CborSequenceError.emptySequence
+    }
+    var decoder = CborSequenceDecoder()
+    decoder.feed(data)
+    while let item = try decoder.nextItem() {
+        try body(item)
+    }
+    try decoder.finish()
+}
+
 /// Assemble individually-serialized CBOR items into an RFC 8742 CBOR sequence.
 ///
 /// Each input item must be a complete CBOR value. The result is their raw
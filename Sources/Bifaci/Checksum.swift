@@ -0,0 +1,158 @@
+//
+//  Checksum.swift
+//  Bifaci
+//
+//  CHUNK payload checksum algorithms.
+//
+//  FNV-1a is the protocol default and is always supported. Peers may
+//  advertise faster algorithms in HELLO (`checksum_algorithms`); a CHUNK
+//  that uses anything other than FNV-1a names its algorithm in the
+//  `checksumAlgorithm` frame key, so receivers always verify with the
+//  algorithm the sender actually used.
+
+import Foundation
+
+/// Algorithm used for `Frame.checksum`.
+public enum ChecksumAlgorithm: UInt8, Sendable, CaseIterable {
+    /// FNV-1a 64-bit. Protocol default, byte-serial.
+    case fnv1a = 0
+    /// xxHash64. Four independent 64-bit lanes over 32-byte stripes.
+    case xxh64 = 1
+
+    /// Name used in HELLO `checksum_algorithms`
+    public var name: String {
+        switch self {
+        case .fnv1a: return "fnv1a"
+        case .xxh64: return "xxh64"
+        }
+    }
+
+    public init?(name: String) {
+        guard let algorithm = ChecksumAlgorithm.allCases.first(where: { $0.name == name }) else {
+            return nil
+        }
+        self = algorithm
+    }
+
+    /// Checksum of `data` with this algorithm
+    public func compute(_ data: Data) -> UInt64 {
+        return data.withUnsafeBytes { bytes in
+            switch self {
+            case .fnv1a: return fnv1a64(bytes)
+            case .xxh64: return xxHash64(bytes)
+            }
+        }
+    }
+
+    /// Pick the algorithm for a connection: ours if the peer offers it, else FNV-1a.
+    ///
+    /// Each side starts from its own preference and the other side's offer.
+    /// Both always support FNV-1a, so they agree whenever at most one side
+    /// prefers a non-default algorithm or both prefer the same one.
+    public static func negotiate(preferred: ChecksumAlgorithm, offered: [ChecksumAlgorithm]) -> ChecksumAlgorithm {
+        return offered.contains(preferred) ? preferred : .fnv1a
+    }
+}
+
+// MARK: - FNV-1a
+
+private let FNV_OFFSET_BASIS: UInt64 = 0xcbf29ce484222325
+private let FNV_PRIME: UInt64 = 0x100000001b3
+
+/// FNV-1a 64. Reads the raw buffer directly; iterating `Data` byte by byte
+/// through its Sequence conformance is several times slower.
+func fnv1a64(_ bytes: UnsafeRawBufferPointer) -> UInt64 {
+    var hash = FNV_OFFSET_BASIS
+    for byte in bytes {
+        hash ^= UInt64(byte)
+        hash = hash &* FNV_PRIME  // wrapping multiply
+    }
+    return hash
+}
+
+// MARK: - xxHash64
+
+private let XXH_PRIME64_1: UInt64 = 0x9E3779B185EBCA87
+private let XXH_PRIME64_2: UInt64 = 0xC2B2AE3D27D4EB4F
+private let XXH_PRIME64_3: UInt64 = 0x165667B19E3779F9
+private let XXH_PRIME64_4: UInt64 = 0x85EBCA77C2B2AE63
+private let XXH_PRIME64_5: UInt64 = 0x27D4EB2F165667C5
+
+@inline(__always)
+private func rotl(_ x: UInt64, _ r: UInt64) -> UInt64 {
+    return (x << r) | (x >> (64 - r))
+}
+
+@inline(__always)
+private func xxhRound(_ acc: UInt64, _ input: UInt64) -> UInt64 {
+    return rotl(acc &+ input &* XXH_PRIME64_2, 31) &* XXH_PRIME64_1
+}
+
+@inline(__always)
+private func xxhMergeRound(_ acc: UInt64, _ val: UInt64) -> UInt64 {
+    return (acc ^ xxhRound(0, val)) &* XXH_PRIME64_1 &+ XXH_PRIME64_4
+}
+
+@inline(__always)
+private func read64(_ bytes: UnsafeRawBufferPointer, _ offset: Int) -> UInt64 {
+    return UInt64(littleEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt64.self))
+}
+
+@inline(__always)
+private func read32(_ bytes: UnsafeRawBufferPointer, _ offset: Int) -> UInt64 {
+    return UInt64(UInt32(littleEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt32.self)))
+}
+
+/// xxHash64 with seed 0 (reference XXH64 output)
+func xxHash64(_ bytes: UnsafeRawBufferPointer) -> UInt64 {
+    let length = bytes.count
+    var offset = 0
+    var hash: UInt64
+
+    if length >= 32 {
+        var v1 = XXH_PRIME64_1 &+ XXH_PRIME64_2
+        var v2 = XXH_PRIME64_2
+        var v3: UInt64 = 0
+        var v4 = 0 &- XXH_PRIME64_1
+        while offset + 32 <= length {
+            v1 = xxhRound(v1, read64(bytes, offset))
+            v2 = xxhRound(v2, read64(bytes, offset + 8))
+            v3 = xxhRound(v3, read64(bytes, offset + 16))
+            v4 = xxhRound(v4, read64(bytes, offset + 24))
+            offset += 32
+        }
+        hash = rotl(v1, 1) &+ rotl(v2, 7) &+ rotl(v3, 12) &+ rotl(v4, 18)
+        hash = xxhMergeRound(hash, v1)
+        hash = xxhMergeRound(hash, v2)
+        hash = xxhMergeRound(hash, v3)
+        hash = xxhMergeRound(hash, v4)
+    } else {
+        hash = XXH_PRIME64_5
+    }
+
+    hash = hash &+ UInt64(length)
+
+    while offset + 8 <= length {
+        hash ^= xxhRound(0, read64(bytes, offset))
+        hash = rotl(hash, 27) &* XXH_PRIME64_1 &+ XXH_PRIME64_4
+        offset += 8
+    }
+    if offset + 4 <= length {
+        hash ^= read32(bytes, offset) &* XXH_PRIME64_1
+        hash = rotl(hash, 23) &* XXH_PRIME64_2 &+ XXH_PRIME64_3
+        offset += 4
+    }
+    while offset < length {
+        hash ^= UInt64(bytes[offset]) &* XXH_PRIME64_5
+        hash = rotl(hash, 11) &* XXH_PRIME64_1
+        offset += 1
+    }
+
+    // Avalanche
+    hash ^= hash >> 33
+    hash = hash &* XXH_PRIME64_2
+    hash ^= hash >> 29
+    hash = hash &* XXH_PRIME64_3
+    hash ^= hash >> 32
+    return hash
+}
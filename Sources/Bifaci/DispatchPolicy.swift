@@ -0,0 +1,97 @@
+//
+//  DispatchPolicy.swift
+//  Bifaci
+//
+//  Choosing between interchangeable REQ targets.
+//
+//  When several masters (RelaySwitch) or plugin processes (PluginHost) are
+//  registered with equivalent caps, CapDispatchIndex hands back all of them
+//  and the owner's DispatchPolicy picks one, using the number of requests
+//  each already has in flight. Candidates always arrive in registration
+//  order, and every policy breaks ties towards the earlier one, so with no
+//  load anywhere the choice is the same target the plain first/closest match
+//  would have picked.
+
+import Foundation
+
+/// How a REQ is assigned when more than one target serves its cap equally well
+public enum DispatchPolicy: Sendable, Equatable {
+    /// Always the first registered target — no load balancing
+    case first
+    /// The target with the fewest requests in flight
+    case leastInFlight
+    /// The less loaded of two targets picked at random. Spreads load
+    /// almost as well as `leastInFlight` without every burst piling onto
+    /// whichever target looked idlest a moment ago.
+    case powerOfTwoChoices
+    /// Fewest requests in flight relative to each target's weight (see
+    /// `RelaySwitch.setMasterWeight`). A target with weight 0 only gets
+    /// requests when every candidate has weight 0.
+    case weighted
+}
+
+/// Default policy for RelaySwitch and PluginHost
+public let DEFAULT_DISPATCH_POLICY: DispatchPolicy = .leastInFlight
+
+/// One target the policy may choose, with its load at selection time
+struct DispatchCandidate {
+    let target: Int
+    let inFlight: Int
+    /// Relative capacity; only `.weighted` looks at it
+    let weight: Double
+
+    init(target: Int, inFlight: Int, weight: Double = 1.0) {
+        self.target = target
+        self.inFlight = inFlight
+        self.weight = weight
+    }
+}
+
+extension DispatchPolicy {
+
+    /// Pick a target from `candidates` (registration order, must not be empty).
+    func choose(_ candidates: [DispatchCandidate]) -> Int {
+        precondition(!candidates.isEmpty, "DispatchPolicy needs at least one candidate")
+        guard candidates.count > 1 else { return candidates[0].target }
+
+        switch self {
+        case .first:
+            return candidates[0].target
+
+        case .leastInFlight:
+            return Self.leastLoaded(candidates, by: { Double($0.inFlight) }).target
+
+        case .powerOfTwoChoices:
+            guard candidates.count > 2 else {
+                return Self.leastLoaded(candidates, by: { Double($0.inFlight) }).target
+            }
+            let a = Int.random(in: 0..<candidates.count)
+            var b = Int.random(in: 0..<(candidates.count - 1))
+            if b >= a { b += 1 }
+            let pair = [candidates[min(a, b)], candidates[max(a, b)]]
+            return Self.leastLoaded(pair, by: { Double($0.inFlight) }).target
+
+        case .weighted:
+            let eligible = candidates.filter { $0.weight > 0 }
+            guard !eligible.isEmpty else {
+                return Self.leastLoaded(candidates, by: { Double($0.inFlight) }).target
+            }
+            // +1 so an idle heavy target beats an idle light one
+            return Self.leastLoaded(eligible, by: { Double($0.inFlight + 1) / $0.weight }).target
+        }
+    }
+
+    /// First candidate with the lowest score
+    private static func leastLoaded(_ candidates: [DispatchCandidate], by score: (DispatchCandidate) -> Double) -> DispatchCandidate {
+        var best = candidates[0]
+        var bestScore = score(best)
+        for candidate in candidates.dropFirst() {
+            let candidateScore = score(candidate)
+            if candidateScore < bestScore {
+                best = candidate
+                bestScore = candidateScore
+            }
+        }
+        return best
+    }
+}
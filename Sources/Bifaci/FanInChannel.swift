@@ -0,0 +1,201 @@
+//
+//  FanInChannel.swift
+//  Bifaci
+//
+//  Bounded many-producer / single-consumer channel with one lane per producer.
+//
+//  RelaySwitch reader threads (one per master) each own a lane: a fixed-size
+//  ring guarded by that lane's own condition, so producers never contend
+//  with each other, and the consumer only touches one lane at a time. The
+//  consumer polls lanes round-robin, so a chatty master cannot starve the
+//  others. A full lane blocks its producer (backpressure onto that master's
+//  socket) until the consumer makes room or the channel is closed.
+
+import Foundation
+
+/// Default per-lane capacity (frames) of the RelaySwitch inbound channel
+public let RELAY_CHANNEL_CAPACITY: Int = 4096
+
+/// Point-in-time queue depth metrics for a FanInChannel
+public struct FanInChannelStats: Sendable {
+    /// Items queued right now, per lane (lane index = master index)
+    public let depthByLane: [Int]
+    /// Largest depth any single lane has reached
+    public let highWaterMark: Int
+    /// Total items accepted since creation
+    public let enqueued: UInt64
+    /// Times a producer had to wait for room in a full lane
+    public let producerWaits: UInt64
+
+    /// Items queued right now across all lanes
+    public var depth: Int { depthByLane.reduce(0, +) }
+}
+
+final class FanInChannel<Element>: @unchecked Sendable {
+
+    private final class Lane {
+        let condition = NSCondition()
+        var ring: [Element?]
+        var head = 0
+        var count = 0
+        var highWaterMark = 0
+        var enqueued: UInt64 = 0
+        var producerWaits: UInt64 = 0
+
+        init(capacity: Int) {
+            ring = [Element?](repeating: nil, count: capacity)
+        }
+    }
+
+    private let capacity: Int
+    /// Guards `lanes` growth and `closed`; never held while waiting
+    private let lanesLock = NSLock()
+    private var lanes: [Lane] = []
+    private var closed = false
+    /// One permit per queued item (plus wake-ups)
+    private let available = DispatchSemaphore(value: 0)
+    /// Next lane the consumer looks at (consumer-only)
+    private var cursor = 0
+    /// Process-wide depth across every channel reporting into it, if any
+    private let depthGauge: MetricGauge?
+
+    /// - Parameters:
+    ///   - capacity: Maximum queued items per lane
+    ///   - depthGauge: Gauge to keep at the number of queued items
+    init(capacity: Int = RELAY_CHANNEL_CAPACITY, depthGauge: MetricGauge? = nil) {
+        precondition(capacity > 0, "FanInChannel capacity must be positive")
+        self.capacity = capacity
+        self.depthGauge = depthGauge
+    }
+
+    deinit {
+        let queued = lanes.reduce(0) { $0 + $1.count }
+        if queued > 0 {
+            depthGauge?.add(-Int64(queued))
+        }
+    }
+
+    private func lane(_ index: Int) -> Lane {
+        lanesLock.lock()
+        defer { lanesLock.unlock() }
+        while lanes.count <= index {
+            lanes.append(Lane(capacity: capacity))
+        }
+        return lanes[index]
+    }
+
+    private var isClosed: Bool {
+        lanesLock.lock()
+        defer { lanesLock.unlock() }
+        return closed
+    }
+
+    /// Enqueue on `lane`, blocking while that lane is full.
+    /// Returns false (item dropped) if the channel was closed.
+    @discardableResult
+    func send(_ item: Element, lane index: Int) -> Bool {
+        let lane = lane(index)
+        lane.condition.lock()
+        if lane.count == capacity {
+            lane.producerWaits += 1
+            while lane.count == capacity && !isClosed {
+                lane.condition.wait()
+            }
+        }
+        if isClosed {
+            lane.condition.unlock()
+            return false
+        }
+        lane.ring[(lane.head + lane.count) % capacity] = item
+        lane.count += 1
+        lane.enqueued += 1
+        lane.highWaterMark = max(lane.highWaterMark, lane.count)
+        lane.condition.unlock()
+        depthGauge?.add(1)
+
+        available.signal()
+        return true
+    }
+
+    /// Dequeue the next item, visiting lanes round-robin.
+    /// Blocks until an item arrives or `deadline` passes (nil = wait forever).
+    /// Single consumer only.
+    func receive(deadline: DispatchTime? = nil) -> Element? {
+        while true {
+            if let deadline = deadline {
+                if available.wait(timeout: deadline) == .timedOut { return nil }
+            } else {
+                available.wait()
+            }
+            if let item = popNext() {
+                return item
+            }
+            // Wake-up without an item (wake()); keep waiting
+        }
+    }
+
+    /// Wake a blocked receive() without delivering an item
+    func wake() {
+        available.signal()
+    }
+
+    /// Stop accepting items and release producers blocked on full lanes.
+    /// Already-queued items stay receivable.
+    func close() {
+        lanesLock.lock()
+        closed = true
+        let snapshot = lanes
+        lanesLock.unlock()
+        for lane in snapshot {
+            lane.condition.lock()
+            lane.condition.broadcast()
+            lane.condition.unlock()
+        }
+    }
+
+    func stats() -> FanInChannelStats {
+        lanesLock.lock()
+        let snapshot = lanes
+        lanesLock.unlock()
+
+        var depths: [Int] = []
+        var highWater = 0
+        var enqueued: UInt64 = 0
+        var waits: UInt64 = 0
+        for lane in snapshot {
+            lane.condition.lock()
+            depths.append(lane.count)
+            highWater = max(highWater, lane.highWaterMark)
+            enqueued += lane.enqueued
+            waits += lane.producerWaits
+            lane.condition.unlock()
+        }
+        return FanInChannelStats(depthByLane: depths, highWaterMark: highWater, enqueued: enqueued, producerWaits: waits)
+    }
+
+    private func popNext() -> Element? {
+        lanesLock.lock()
+        let snapshot = lanes
+        lanesLock.unlock()
+        guard !snapshot.isEmpty else { return nil }
+
+        for step in 0..<snapshot.count {
+            let idx = (cursor + step) % snapshot.count
+            let lane = snapshot[idx]
+            lane.condition.lock()
+            if lane.count > 0 {
+                let item = lane.ring[lane.head]
+                lane.ring[lane.head] = nil
+                lane.head = (lane.head + 1) % capacity
+                lane.count -= 1
+                lane.condition.signal()
+                lane.condition.unlock()
+                depthGauge?.add(-1)
+                cursor = idx + 1
+                return item
+            }
+            lane.condition.unlock()
+        }
+        return nil
+    }
+}
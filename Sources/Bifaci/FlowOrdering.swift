@@ -25,7 +25,7 @@ public struct FlowKey: Hashable, Sendable {
 /// Used at output stages (writer threads) to ensure each flow's frames
 /// carry a contiguous, gap-free seq sequence starting at 0.
 ///
-/// Non-flow frames (Hello, Heartbeat, RelayNotify, RelayState) are skipped
+/// Non-flow frames (Hello, Heartbeat, RelayNotify, RelayState, Credit) are skipped
 /// and their seq stays at 0.
 /// Assigns monotonically increasing seq numbers per FlowKey (RID + optional XID).
 /// Keyed by FlowKey to match ReorderBuffer's key space exactly:
@@ -80,10 +80,22 @@ public final class ReorderBuffer: @unchecked Sendable {
     private let maxBufferPerFlow: Int
     private let lock = NSLock()
 
+    /// Frames held back waiting for a gap, across every reorder buffer in the process
+    private static let occupancy = MetricsRegistry.shared.gauge("reorder_buffer.buffered_frames")
+    /// Frames that arrived ahead of their flow's expected seq
+    private static let outOfOrder = MetricsRegistry.shared.counter("reorder_buffer.out_of_order_frames")
+
     public init(maxBufferPerFlow: Int) {
         self.maxBufferPerFlow = maxBufferPerFlow
     }
 
+    deinit {
+        let held = flows.values.reduce(0) { $0 + $1.buffer.count }
+        if held > 0 {
+            Self.occupancy.add(-Int64(held))
+        }
+    }
+
     /// Accept a frame into the reorder buffer.
     /// Returns an array of frames ready for delivery (in seq order).
     /// Non-flow frames bypass reordering and are returned immediately.
@@ -112,6 +124,9 @@ public final class ReorderBuffer: @unchecked Sendable {
                 ready.append(buffered)
                 state.expectedSeq += 1
             }
+            if ready.count > 1 {
+                Self.occupancy.add(-Int64(ready.count - 1))
+            }
 
             return ready
 
@@ -133,6 +148,8 @@ public final class ReorderBuffer: @unchecked Sendable {
             }
 
             state.buffer[frame.seq] = frame
+            Self.outOfOrder.increment()
+            Self.occupancy.add(1)
             return []
 
         } else {
@@ -147,6 +164,151 @@ public final class ReorderBuffer: @unchecked Sendable {
     public func cleanupFlow(_ key: FlowKey) {
         lock.lock()
         defer { lock.unlock() }
-        flows.removeValue(forKey: key)
+        if let state = flows.removeValue(forKey: key), !state.buffer.isEmpty {
+            Self.occupancy.add(-Int64(state.buffer.count))
+        }
+    }
+}
+
+// MARK: - Flow Credits
+
+/// Sender side of per-flow credit flow control.
+///
+/// Every flow starts with `window` CHUNK credits. Sending a CHUNK spends one;
+/// when none are left the sender blocks until the receiver returns credits
+/// with a CREDIT frame. Each flow has its own window, so a bulk transfer
+/// that has run out of credits never holds back other flows.
+public final class FlowCreditGate: @unchecked Sendable {
+    private let window: Int
+    private var credits: [FlowKey: Int] = [:]
+    private var closed = false
+    private let condition = NSCondition()
+    /// Tasks suspended in acquireAsync, woken to retry on grant/close
+    private var asyncWaiters: [FlowKey: [CheckedContinuation<Void, Never>]] = [:]
+
+    public init(window: Int) {
+        precondition(window > 0, "FlowCreditGate window must be positive")
+        self.window = window
+    }
+
+    /// Spend one credit for `key`, blocking while the flow has none.
+    /// Returns false if the gate was closed (peer gone); the caller may still send.
+    @discardableResult
+    public func acquire(_ key: FlowKey) -> Bool {
+        condition.lock()
+        defer { condition.unlock() }
+        while !closed && credits[key, default: window] == 0 {
+            condition.wait()
+        }
+        if closed { return false }
+        credits[key] = credits[key, default: window] - 1
+        return true
+    }
+
+    /// Spend one credit for `key`, suspending the calling task (not its
+    /// thread) while the flow has none. Same result as `acquire`.
+    @discardableResult
+    public func acquireAsync(_ key: FlowKey) async -> Bool {
+        while true {
+            if let acquired = tryAcquire(key) {
+                return acquired
+            }
+            await withCheckedContinuation { continuation in
+                park(key, continuation)
+            }
+        }
+    }
+
+    /// Spend a credit if one is available: true = spent, false = closed, nil = none left.
+    private func tryAcquire(_ key: FlowKey) -> Bool? {
+        condition.lock()
+        defer { condition.unlock() }
+        if closed { return false }
+        let available = credits[key, default: window]
+        guard available > 0 else { return nil }
+        credits[key] = available - 1
+        return true
+    }
+
+    /// Queue an async waiter, or wake it at once if credits arrived meanwhile.
+    private func park(_ key: FlowKey, _ continuation: CheckedContinuation<Void, Never>) {
+        condition.lock()
+        if closed || credits[key, default: window] > 0 {
+            condition.unlock()
+            continuation.resume()
+            return
+        }
+        asyncWaiters[key, default: []].append(continuation)
+        condition.unlock()
+    }
+
+    /// Return credits from a CREDIT frame. Grants for finished flows are dropped.
+    public func grant(_ key: FlowKey, _ count: Int) {
+        guard count > 0 else { return }
+        condition.lock()
+        guard let current = credits[key] else {
+            condition.unlock()
+            return
+        }
+        credits[key] = current + count
+        condition.broadcast()
+        let woken = asyncWaiters.removeValue(forKey: key) ?? []
+        condition.unlock()
+        woken.forEach { $0.resume() }
+    }
+
+    /// Forget a flow after its terminal frame (END/ERR).
+    public func remove(_ key: FlowKey) {
+        condition.lock()
+        defer { condition.unlock() }
+        credits.removeValue(forKey: key)
+    }
+
+    /// Release every blocked sender and stop throttling.
+    public func close() {
+        condition.lock()
+        closed = true
+        credits.removeAll()
+        condition.broadcast()
+        let woken = asyncWaiters.values.flatMap { $0 }
+        asyncWaiters.removeAll()
+        condition.unlock()
+        woken.forEach { $0.resume() }
+    }
+}
+
+/// Receiver side of per-flow credit flow control.
+///
+/// Counts CHUNK frames the receiver has finished with (delivered onward, not
+/// merely read) and returns them in batches of half a window, so the sender
+/// never drains its window completely on a steady stream.
+public final class FlowCreditReturner: @unchecked Sendable {
+    private let batch: Int
+    private var pending: [FlowKey: Int] = [:]
+    private let lock = NSLock()
+
+    public init(window: Int) {
+        precondition(window > 0, "FlowCreditReturner window must be positive")
+        self.batch = max(1, window / 2)
+    }
+
+    /// Record one consumed CHUNK. Returns the credits to send back, if a batch is due.
+    public func consumed(_ key: FlowKey) -> Int? {
+        lock.lock()
+        defer { lock.unlock() }
+        let count = pending[key, default: 0] + 1
+        if count >= batch {
+            pending[key] = 0
+            return count
+        }
+        pending[key] = count
+        return nil
+    }
+
+    /// Forget a flow after its terminal frame (END/ERR).
+    public func remove(_ key: FlowKey) {
+        lock.lock()
+        defer { lock.unlock() }
+        pending.removeValue(forKey: key)
     }
 }
@@ -17,6 +17,10 @@ public let DEFAULT_MAX_REORDER_BUFFER: Int = 64
 /// Hard limit for frame size (16 MB) - prevents memory exhaustion
 public let MAX_FRAME_HARD_LIMIT: Int = 16 * 1024 * 1024
 
+/// CHUNK credits per flow that PluginHost and PluginRuntime offer in HELLO.
+/// `Limits.flowWindow` itself defaults to 0 (no flow control).
+public let DEFAULT_FLOW_WINDOW: Int = 32
+
 /// Frame type discriminator
 public enum FrameType: UInt8, Sendable {
     /// Handshake frame for negotiating limits
@@ -42,6 +46,9 @@ public enum FrameType: UInt8, Sendable {
     case relayNotify = 10
     /// Relay host system resources + cap demands (master → slave). Carries opaque resource payload.
     case relayState = 11
+    /// Return CHUNK credits for one flow (receiver → sender). Hop-by-hop: only sent on
+    /// a link whose HELLOs negotiated a flow window, never forwarded.
+    case credit = 12
 }
 
 /// Message ID - either a 16-byte UUID or a simple integer
@@ -124,11 +131,23 @@ public struct Limits: Sendable {
     public var maxChunk: Int
     /// Maximum reorder buffer size per flow (frame count)
     public var maxReorderBuffer: Int
-
-    public init(maxFrame: Int = DEFAULT_MAX_FRAME, maxChunk: Int = DEFAULT_MAX_CHUNK, maxReorderBuffer: Int = DEFAULT_MAX_REORDER_BUFFER) {
+    /// Checksum algorithm for CHUNK frames we originate.
+    /// Before the handshake: our preference (advertised in HELLO). After: the negotiated algorithm.
+    public var checksum: ChecksumAlgorithm
+    /// CHUNK frames a sender may have outstanding per flow before it waits for CREDIT.
+    /// 0 = no flow control. Active only when both HELLOs offer a window.
+    public var flowWindow: Int
+    /// Bytes of shared memory ring for CHUNK payloads we send (see SharedMemoryTransport).
+    /// Before the handshake: the ring we're willing to offer/accept. After: our active ring, or 0.
+    public var sharedMemoryRing: Int
+
+    public init(maxFrame: Int = DEFAULT_MAX_FRAME, maxChunk: Int = DEFAULT_MAX_CHUNK, maxReorderBuffer: Int = DEFAULT_MAX_REORDER_BUFFER, checksum: ChecksumAlgorithm = .fnv1a, flowWindow: Int = 0, sharedMemoryRing: Int = 0) {
         self.maxFrame = maxFrame
         self.maxChunk = maxChunk
         self.maxReorderBuffer = maxReorderBuffer
+        self.checksum = checksum
+        self.flowWindow = flowWindow
+        self.sharedMemoryRing = sharedMemoryRing
     }
 
     /// Negotiate minimum of both limits
@@ -136,9 +155,17 @@ public struct Limits: Sendable {
         return Limits(
             maxFrame: min(self.maxFrame, other.maxFrame),
             maxChunk: min(self.maxChunk, other.maxChunk),
-            maxReorderBuffer: min(self.maxReorderBuffer, other.maxReorderBuffer)
+            maxReorderBuffer: min(self.maxReorderBuffer, other.maxReorderBuffer),
+            checksum: self.checksum == other.checksum ? self.checksum : .fnv1a,
+            flowWindow: Limits.negotiateFlowWindow(self.flowWindow, other.flowWindow),
+            sharedMemoryRing: self.sharedMemoryRing > 0 && other.sharedMemoryRing > 0 ? self.sharedMemoryRing : 0
         )
     }
+
+    /// Smaller of two offered windows, or 0 if either side doesn't do flow control
+    public static func negotiateFlowWindow(_ ours: Int, _ theirs: Int) -> Int {
+        return ours > 0 && theirs > 0 ? min(ours, theirs) : 0
+    }
 }
 
 /// A CBOR protocol frame
@@ -179,8 +206,10 @@ public struct Frame: @unchecked Sendable {
     public var chunkIndex: UInt64?
     /// Total chunk count (STREAM_END frames only, by source's reckoning)
     public var chunkCount: UInt64?
-    /// FNV-1a checksum of payload (CHUNK frames only)
+    /// Checksum of payload (CHUNK frames only), computed with `checksumAlgorithm`
     public var checksum: UInt64?
+    /// Algorithm that produced `checksum`. Only non-default values go on the wire.
+    public var checksumAlgorithm: ChecksumAlgorithm = .fnv1a
 
     public init(frameType: FrameType, id: MessageId) {
         self.frameType = frameType
@@ -198,6 +227,8 @@ public struct Frame: @unchecked Sendable {
             "max_reorder_buffer": .unsignedInt(UInt64(limits.maxReorderBuffer)),
             "version": .unsignedInt(UInt64(CBOR_PROTOCOL_VERSION))
         ]
+        frame.advertiseChecksum(limits.checksum)
+        frame.advertiseFlowWindow(limits.flowWindow)
         return frame
     }
 
@@ -213,9 +244,24 @@ public struct Frame: @unchecked Sendable {
             "version": .unsignedInt(UInt64(CBOR_PROTOCOL_VERSION)),
             "manifest": .byteString([UInt8](manifest))
         ]
+        frame.advertiseChecksum(limits.checksum)
+        frame.advertiseFlowWindow(limits.flowWindow)
         return frame
     }
 
+    /// Add `checksum_algorithms` to HELLO meta when preferring a non-default algorithm.
+    /// Default HELLOs stay byte-identical to peers that predate the key.
+    private mutating func advertiseChecksum(_ preferred: ChecksumAlgorithm) {
+        guard preferred != .fnv1a else { return }
+        meta?["checksum_algorithms"] = .array([.utf8String(preferred.name), .utf8String(ChecksumAlgorithm.fnv1a.name)])
+    }
+
+    /// Add `flow_window` to HELLO meta when offering flow control.
+    private mutating func advertiseFlowWindow(_ window: Int) {
+        guard window > 0 else { return }
+        meta?["flow_window"] = .unsignedInt(UInt64(window))
+    }
+
     /// Create a REQ frame for invoking a cap
     public static func req(id: MessageId, capUrn: String, payload: Data, contentType: String) -> Frame {
         var frame = Frame(frameType: .req, id: id)
@@ -323,6 +369,14 @@ public struct Frame: @unchecked Sendable {
         return Frame(frameType: .heartbeat, id: id)
     }
 
+    /// Create a CREDIT frame returning `credits` CHUNK credits to the sender of flow (id, routingId)
+    public static func credit(id: MessageId, routingId: MessageId?, credits: Int) -> Frame {
+        var frame = Frame(frameType: .credit, id: id)
+        frame.routingId = routingId
+        frame.meta = ["credits": .unsignedInt(UInt64(credits))]
+        return frame
+    }
+
     /// Create a STREAM_START frame to announce a new stream within a request.
     /// Used for multiplexed streaming - multiple streams can exist per request.
     ///
@@ -372,8 +426,21 @@ public struct Frame: @unchecked Sendable {
         return frame
     }
 
+    /// RELAY_STATE frame that also carries a metrics snapshot of the sending side in meta.
+    public static func relayState(resources: Data, metrics: MetricsSnapshot) -> Frame {
+        var frame = relayState(resources: resources)
+        frame.meta = ["metrics": metrics.cbor()]
+        return frame
+    }
+
     // MARK: - Accessors
 
+    /// Metrics snapshot attached to a RELAY_STATE frame, if any
+    public var relayStateMetrics: MetricsSnapshot? {
+        guard frameType == .relayState, let value = meta?["metrics"] else { return nil }
+        return MetricsSnapshot(cbor: value)
+    }
+
     /// Check if this is the final frame in a stream
     public var isEof: Bool {
         return eof ?? false
@@ -473,6 +540,35 @@ public struct Frame: @unchecked Sendable {
         return Int(n)
     }
 
+    /// Checksum algorithms offered in HELLO metadata, in the peer's preference order.
+    /// Peers that don't send the key only support FNV-1a. Unknown names are skipped.
+    public var helloChecksumAlgorithms: [ChecksumAlgorithm] {
+        guard frameType == .hello, let meta = meta, case .array(let names) = meta["checksum_algorithms"] else {
+            return [.fnv1a]
+        }
+        let offered = names.compactMap { name -> ChecksumAlgorithm? in
+            guard case .utf8String(let s) = name else { return nil }
+            return ChecksumAlgorithm(name: s)
+        }
+        return offered.contains(.fnv1a) ? offered : offered + [.fnv1a]
+    }
+
+    /// Flow window offered in HELLO metadata; 0 if the peer doesn't do flow control
+    public var helloFlowWindow: Int {
+        guard frameType == .hello, let meta = meta, case .unsignedInt(let n) = meta["flow_window"] else {
+            return 0
+        }
+        return Int(n)
+    }
+
+    /// Credits returned by a CREDIT frame
+    public var creditGrant: Int? {
+        guard frameType == .credit, let meta = meta, case .unsignedInt(let n) = meta["credits"] else {
+            return nil
+        }
+        return Int(n)
+    }
+
     /// Extract manifest from HELLO metadata (plugin side sends this)
     /// Returns nil if no manifest present (host HELLO) or not a HELLO frame.
     /// The manifest is JSON-encoded plugin metadata.
@@ -488,23 +584,33 @@ public struct Frame: @unchecked Sendable {
     /// Compute FNV-1a 64-bit checksum of bytes.
     /// This is a simple, fast hash function suitable for detecting transmission errors.
     public static func computeChecksum(_ data: Data) -> UInt64 {
-        let FNV_OFFSET_BASIS: UInt64 = 0xcbf29ce484222325
-        let FNV_PRIME: UInt64 = 0x100000001b3
+        return data.withUnsafeBytes { fnv1a64($0) }
+    }
 
-        var hash = FNV_OFFSET_BASIS
-        for byte in data {
-            hash ^= UInt64(byte)
-            hash = hash &* FNV_PRIME  // wrapping multiply
-        }
-        return hash
+    /// Compute a payload checksum with the given algorithm.
+    public static func computeChecksum(_ data: Data, algorithm: ChecksumAlgorithm) -> UInt64 {
+        return algorithm.compute(data)
+    }
+
+    /// Set `checksum` and `checksumAlgorithm` from the current payload.
+    public mutating func setChecksum(algorithm: ChecksumAlgorithm) {
+        checksum = algorithm.compute(payload ?? Data())
+        checksumAlgorithm = algorithm
+    }
+
+    /// True if `checksum` matches the payload under the frame's own algorithm.
+    /// False when the checksum is missing.
+    public func hasValidChecksum() -> Bool {
+        guard let expected = checksum else { return false }
+        return checksumAlgorithm.compute(payload ?? Data()) == expected
     }
 
     /// Returns true if this frame type participates in flow ordering (seq tracking).
-    /// Non-flow frames (Hello, Heartbeat, RelayNotify, RelayState) bypass seq assignment
+    /// Non-flow frames (Hello, Heartbeat, RelayNotify, RelayState, Credit) bypass seq assignment
     /// and reorder buffers entirely.
     public func isFlowFrame() -> Bool {
         switch frameType {
-        case .hello, .heartbeat, .relayNotify, .relayState:
+        case .hello, .heartbeat, .relayNotify, .relayState, .credit:
             return false
         default:
             return true
@@ -562,4 +668,6 @@ public enum FrameKey: UInt64 {
     case chunkIndex = 14
     case chunkCount = 15
     case checksum = 16
+    /// ChecksumAlgorithm raw value; omitted for FNV-1a
+    case checksumAlgorithm = 17
 }
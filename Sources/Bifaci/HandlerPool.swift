@@ -0,0 +1,278 @@
+//
+//  HandlerPool.swift
+//  Bifaci
+//
+//  Bounded worker pool for PluginRuntime request handlers.
+//
+//  Workers are long-lived threads started on demand up to `maxWorkers`, so
+//  a burst of small requests reuses a handful of threads instead of creating
+//  one per REQ. Jobs carry a group (the registered cap URN) with an optional
+//  concurrency limit; a job whose group is at its limit stays queued while
+//  workers run later jobs from other groups.
+//
+//  Handlers block (on input frames, on peer responses), so the pool must be
+//  sized for the number of handlers expected to be in flight at once. A
+//  handler that waits on a peer call may be waiting for a REQ the host routes
+//  back into this same plugin, so a job parked in `HandlerPool.blocking`
+//  stops counting against the pool and its group's limit: the callee gets a
+//  worker (started beyond maxWorkers if need be) instead of deadlocking.
+//
+//  Async handlers (`register_async_op`) don't use the workers: they run as
+//  tasks, and AsyncHandlerGate applies the same limits by suspending them.
+
+import Foundation
+
+/// Default number of handler worker threads in PluginRuntime
+public let DEFAULT_MAX_CONCURRENT_HANDLERS: Int = 64
+
+/// Point-in-time HandlerPool counters
+public struct HandlerPoolStats: Sendable {
+    /// Worker threads alive (above the pool limit only by up to `blocked`)
+    public let workers: Int
+    /// Jobs currently running
+    public let running: Int
+    /// Workers parked waiting for a job
+    public let idle: Int
+    /// Jobs waiting for a worker or for their group's limit
+    public let queued: Int
+    /// Running jobs parked on a peer response, not counted against the limits
+    public let blocked: Int
+}
+
+final class HandlerPool: @unchecked Sendable {
+
+    private struct Job {
+        let group: String
+        let limit: Int?
+        let work: () -> Void
+    }
+
+    private let maxWorkers: Int
+    private let name: String
+    private let condition = NSCondition()
+    private var jobs: [Job] = []
+    private var runningByGroup: [String: Int] = [:]
+    private var blockedByGroup: [String: Int] = [:]
+    private var workers = 0
+    private var idleWorkers = 0
+    private var running = 0
+    private var blocked = 0
+    private var closed = false
+
+    /// The pool and group of the job on the current worker thread, for `blocking`
+    private final class WorkerContext {
+        unowned let pool: HandlerPool
+        let group: String
+
+        init(pool: HandlerPool, group: String) {
+            self.pool = pool
+            self.group = group
+        }
+    }
+
+    private static let contextKey = "Bifaci.HandlerPool.context"
+
+    /// - Parameters:
+    ///   - maxWorkers: Maximum handler threads alive at once
+    ///   - name: Thread name prefix
+    init(maxWorkers: Int = DEFAULT_MAX_CONCURRENT_HANDLERS, name: String = "HandlerPool") {
+        precondition(maxWorkers > 0, "HandlerPool needs at least one worker")
+        self.maxWorkers = maxWorkers
+        self.name = name
+    }
+
+    /// Queue `work`. At most `limit` jobs of `group` run at once (nil = pool limit only).
+    func submit(group: String, limit: Int? = nil, _ work: @escaping () -> Void) {
+        condition.lock()
+        defer { condition.unlock() }
+        guard !closed else { return }
+
+        jobs.append(Job(group: group, limit: limit, work: work))
+        startWorkerIfNeeded()
+        condition.signal()
+    }
+
+    /// Run `body`, which waits on something another handler of this pool may
+    /// have to produce (a peer response). While it waits, the current job
+    /// counts neither against maxWorkers nor against its group's limit, so
+    /// queued jobs can start. When it returns the job resumes even if that
+    /// briefly puts its group over the limit. Called off a pool worker, this
+    /// is just `body()`.
+    static func blocking<T>(_ body: () throws -> T) rethrows -> T {
+        guard let context = Thread.current.threadDictionary[contextKey] as? WorkerContext else {
+            return try body()
+        }
+        let pool = context.pool
+        pool.condition.lock()
+        pool.blocked += 1
+        pool.blockedByGroup[context.group, default: 0] += 1
+        pool.startWorkerIfNeeded()
+        // Our group's slot just opened up for idle workers too
+        pool.condition.broadcast()
+        pool.condition.unlock()
+
+        defer {
+            pool.condition.lock()
+            pool.blocked -= 1
+            pool.blockedByGroup[context.group, default: 1] -= 1
+            if pool.blockedByGroup[context.group] == 0 {
+                pool.blockedByGroup.removeValue(forKey: context.group)
+            }
+            // Idle workers beyond the limit can retire now
+            pool.condition.broadcast()
+            pool.condition.unlock()
+        }
+        return try body()
+    }
+
+    /// Idle workers may already be claimed by earlier submits that haven't
+    /// woken yet, so start a worker whenever jobs outnumber them. Blocked
+    /// jobs hold a thread without using a worker slot. Must hold `condition`.
+    private func startWorkerIfNeeded() {
+        guard jobs.count > idleWorkers && workers - blocked < maxWorkers else { return }
+        workers += 1
+        let thread = Thread { [self] in workerLoop() }
+        thread.name = "\(name)[\(workers - 1)]"
+        thread.start()
+    }
+
+    /// Stop accepting jobs; workers exit once the queue drains.
+    func close() {
+        condition.lock()
+        closed = true
+        condition.broadcast()
+        condition.unlock()
+    }
+
+    func stats() -> HandlerPoolStats {
+        condition.lock()
+        defer { condition.unlock() }
+        return HandlerPoolStats(workers: workers, running: running, idle: idleWorkers, queued: jobs.count, blocked: blocked)
+    }
+
+    /// First queued job whose group has room. Must hold `condition`.
+    private func takeRunnableJob() -> Job? {
+        guard let idx = jobs.firstIndex(where: { job in
+            guard let limit = job.limit else { return true }
+            return runningByGroup[job.group, default: 0] - blockedByGroup[job.group, default: 0] < limit
+        }) else {
+            return nil
+        }
+        return jobs.remove(at: idx)
+    }
+
+    private func workerLoop() {
+        condition.lock()
+        while true {
+            if let job = takeRunnableJob() {
+                runningByGroup[job.group, default: 0] += 1
+                running += 1
+                condition.unlock()
+
+                Thread.current.threadDictionary[Self.contextKey] = WorkerContext(pool: self, group: job.group)
+                job.work()
+                Thread.current.threadDictionary.removeObject(forKey: Self.contextKey)
+
+                condition.lock()
+                running -= 1
+                runningByGroup[job.group, default: 1] -= 1
+                if runningByGroup[job.group] == 0 {
+                    runningByGroup.removeValue(forKey: job.group)
+                }
+                // A finished job may unblock a queued job of the same group
+                condition.broadcast()
+                continue
+            }
+            // Also retire the extra workers started while jobs were blocked
+            if (closed && jobs.isEmpty) || workers - blocked > maxWorkers {
+                workers -= 1
+                condition.unlock()
+                return
+            }
+            idleWorkers += 1
+            condition.wait()
+            idleWorkers -= 1
+        }
+    }
+}
+
+/// Admission control for async handlers, which run as tasks rather than on
+/// HandlerPool workers. Same limits as HandlerPool — `maxRunning` overall and
+/// an optional per-group cap — but a task over the limit suspends in
+/// `enter` instead of occupying a thread.
+final class AsyncHandlerGate: @unchecked Sendable {
+
+    private struct Waiter {
+        let group: String
+        let limit: Int?
+        let continuation: CheckedContinuation<Void, Never>
+    }
+
+    private let maxRunning: Int
+    private let lock = NSLock()
+    private var waiters: [Waiter] = []
+    private var runningByGroup: [String: Int] = [:]
+    private var running = 0
+
+    init(maxRunning: Int = DEFAULT_MAX_CONCURRENT_HANDLERS) {
+        precondition(maxRunning > 0, "AsyncHandlerGate needs room for at least one handler")
+        self.maxRunning = maxRunning
+    }
+
+    /// Wait until a handler of `group` may run. Pair with `leave(group:)`.
+    func enter(group: String, limit: Int? = nil) async {
+        await withCheckedContinuation { continuation in
+            admitOrQueue(Waiter(group: group, limit: limit, continuation: continuation))
+        }
+    }
+
+    /// A handler of `group` finished; admit whoever it was holding back.
+    func leave(group: String) {
+        lock.lock()
+        running -= 1
+        runningByGroup[group, default: 1] -= 1
+        if runningByGroup[group] == 0 {
+            runningByGroup.removeValue(forKey: group)
+        }
+        var admitted: [Waiter] = []
+        while let idx = waiters.firstIndex(where: canRun) {
+            let waiter = waiters.remove(at: idx)
+            start(waiter)
+            admitted.append(waiter)
+        }
+        lock.unlock()
+        admitted.forEach { $0.continuation.resume() }
+    }
+
+    /// `workers`, `idle` and `blocked` are always 0: async handlers hold no threads
+    func stats() -> HandlerPoolStats {
+        lock.lock()
+        defer { lock.unlock() }
+        return HandlerPoolStats(workers: 0, running: running, idle: 0, queued: waiters.count, blocked: 0)
+    }
+
+    private func admitOrQueue(_ waiter: Waiter) {
+        lock.lock()
+        guard canRun(waiter) else {
+            waiters.append(waiter)
+            lock.unlock()
+            return
+        }
+        start(waiter)
+        lock.unlock()
+        waiter.continuation.resume()
+    }
+
+    /// Must hold `lock`
+    private func canRun(_ waiter: Waiter) -> Bool {
+        guard running < maxRunning else { return false }
+        guard let limit = waiter.limit else { return true }
+        return runningByGroup[waiter.group, default: 0] < limit
+    }
+
+    /// Must hold `lock`
+    private func start(_ waiter: Waiter) {
+        running += 1
+        runningByGroup[waiter.group, default: 0] += 1
+    }
+}
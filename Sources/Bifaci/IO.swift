@@ -30,28 +30,136 @@ extension FrameError: LocalizedError {
 
 // MARK: - Frame Encoding
 
-/// Encode a frame to CBOR bytes
-public func encodeFrame(_ frame: Frame) throws -> Data {
-    var map: [CBOR: CBOR] = [:]
+// Frames are a single CBOR map with small unsigned integer keys (FrameKey).
+// The codec below reads and writes that map directly instead of going through
+// a SwiftCBOR `[CBOR: CBOR]` tree: header fields are emitted straight into the
+// output buffer, and the payload is appended once on encode and sliced out of
+// the input on decode. Only `meta` (arbitrary CBOR values) still goes through
+// SwiftCBOR. The wire format is unchanged; key order is not significant.
+
+private let CBOR_MAJOR_UNSIGNED: UInt8 = 0
+private let CBOR_MAJOR_NEGATIVE: UInt8 = 1
+private let CBOR_MAJOR_BYTES: UInt8 = 2
+private let CBOR_MAJOR_TEXT: UInt8 = 3
+private let CBOR_MAJOR_ARRAY: UInt8 = 4
+private let CBOR_MAJOR_MAP: UInt8 = 5
+private let CBOR_MAJOR_TAG: UInt8 = 6
+private let CBOR_MAJOR_SIMPLE: UInt8 = 7
+
+private let CBOR_INDEFINITE: UInt8 = 31
+private let CBOR_BREAK: UInt8 = 0xFF
+private let CBOR_FALSE: UInt8 = 0xF4
+private let CBOR_TRUE: UInt8 = 0xF5
+
+/// Append a CBOR head (major type + argument) using the shortest encoding
+private func appendHead(_ major: UInt8, _ value: UInt64, to out: inout Data) {
+    let m = major << 5
+    if value < 24 {
+        out.append(m | UInt8(value))
+    } else if value <= 0xFF {
+        out.append(m | 24)
+        out.append(UInt8(value))
+    } else if value <= 0xFFFF {
+        out.append(m | 25)
+        out.append(UInt8((value >> 8) & 0xFF))
+        out.append(UInt8(value & 0xFF))
+    } else if value <= 0xFFFF_FFFF {
+        out.append(m | 26)
+        for shift in stride(from: 24, through: 0, by: -8) {
+            out.append(UInt8((value >> UInt64(shift)) & 0xFF))
+        }
+    } else {
+        out.append(m | 27)
+        for shift in stride(from: 56, through: 0, by: -8) {
+            out.append(UInt8((value >> UInt64(shift)) & 0xFF))
+        }
+    }
+}
 
-    // Required fields
-    map[.unsignedInt(FrameKey.version.rawValue)] = .unsignedInt(UInt64(frame.version))
-    map[.unsignedInt(FrameKey.frameType.rawValue)] = .unsignedInt(UInt64(frame.frameType.rawValue))
+/// Encode `bytes` as a single CBOR byte string
+/// (same bytes as `CBOR.byteString([UInt8](bytes)).encode()`, one copy)
+func encodeCborByteString(_ bytes: Data) -> Data {
+    var out = Data()
+    out.reserveCapacity(9 + bytes.count)
+    appendHead(CBOR_MAJOR_BYTES, UInt64(bytes.count), to: &out)
+    out.append(bytes)
+    return out
+}
+
+private func appendKey(_ key: FrameKey, to out: inout Data) {
+    appendHead(CBOR_MAJOR_UNSIGNED, key.rawValue, to: &out)
+}
+
+private func appendUInt(_ key: FrameKey, _ value: UInt64, to out: inout Data) {
+    appendKey(key, to: &out)
+    appendHead(CBOR_MAJOR_UNSIGNED, value, to: &out)
+}
 
-    // Message ID
-    switch frame.id {
+private func appendText(_ key: FrameKey, _ value: String, to out: inout Data) {
+    appendKey(key, to: &out)
+    appendHead(CBOR_MAJOR_TEXT, UInt64(value.utf8.count), to: &out)
+    out.append(contentsOf: value.utf8)
+}
+
+private func appendBytes(_ key: FrameKey, _ value: Data, to out: inout Data) {
+    appendKey(key, to: &out)
+    appendHead(CBOR_MAJOR_BYTES, UInt64(value.count), to: &out)
+    out.append(value)
+}
+
+private func appendMessageId(_ key: FrameKey, _ id: MessageId, to out: inout Data) {
+    switch id {
     case .uuid(let data):
-        map[.unsignedInt(FrameKey.id.rawValue)] = .byteString([UInt8](data))
+        appendBytes(key, data, to: &out)
     case .uint(let n):
-        map[.unsignedInt(FrameKey.id.rawValue)] = .unsignedInt(n)
+        appendUInt(key, n, to: &out)
     }
+}
 
-    // Sequence number
-    map[.unsignedInt(FrameKey.seq.rawValue)] = .unsignedInt(frame.seq)
+/// Encode a frame to CBOR bytes
+public func encodeFrame(_ frame: Frame) throws -> Data {
+    var out = Data()
+    out.reserveCapacity(128 + (frame.payload?.count ?? 0))
+    encodeFrameHeader(frame, into: &out)
+    if let payload = frame.payload {
+        out.append(payload)
+    }
+    return out
+}
+
+/// Append every CBOR byte of `frame` except the payload bytes themselves.
+///
+/// The payload entry is emitted last, so the encoded frame is exactly
+/// header + payload and the payload can be written from its own buffer.
+func encodeFrameHeader(_ frame: Frame, into out: inout Data) {
+    // version, frame_type, id, seq are always present
+    var fieldCount: UInt64 = 4
+    if frame.contentType != nil { fieldCount += 1 }
+    if frame.meta != nil { fieldCount += 1 }
+    if frame.payload != nil { fieldCount += 1 }
+    if frame.len != nil { fieldCount += 1 }
+    if frame.offset != nil { fieldCount += 1 }
+    if frame.eof != nil { fieldCount += 1 }
+    if frame.cap != nil { fieldCount += 1 }
+    if frame.streamId != nil { fieldCount += 1 }
+    if frame.mediaUrn != nil { fieldCount += 1 }
+    if frame.routingId != nil { fieldCount += 1 }
+    if frame.chunkIndex != nil { fieldCount += 1 }
+    if frame.chunkCount != nil { fieldCount += 1 }
+    if frame.checksum != nil { fieldCount += 1 }
+    if frame.checksumAlgorithm != .fnv1a { fieldCount += 1 }
+
+    appendHead(CBOR_MAJOR_MAP, fieldCount, to: &out)
+
+    // Required fields
+    appendUInt(.version, UInt64(frame.version), to: &out)
+    appendUInt(.frameType, UInt64(frame.frameType.rawValue), to: &out)
+    appendMessageId(.id, frame.id, to: &out)
+    appendUInt(.seq, frame.seq, to: &out)
 
     // Optional fields
     if let ct = frame.contentType {
-        map[.unsignedInt(FrameKey.contentType.rawValue)] = .utf8String(ct)
+        appendText(.contentType, ct, to: &out)
     }
 
     if let meta = frame.meta {
@@ -59,191 +167,374 @@ public func encodeFrame(_ frame: Frame) throws -> Data {
         for (k, v) in meta {
             metaMap[.utf8String(k)] = v
         }
-        map[.unsignedInt(FrameKey.meta.rawValue)] = .map(metaMap)
-    }
-
-    if let payload = frame.payload {
-        map[.unsignedInt(FrameKey.payload.rawValue)] = .byteString([UInt8](payload))
+        appendKey(.meta, to: &out)
+        out.append(contentsOf: CBOR.map(metaMap).encode())
     }
 
     if let len = frame.len {
-        map[.unsignedInt(FrameKey.len.rawValue)] = .unsignedInt(len)
+        appendUInt(.len, len, to: &out)
     }
 
     if let offset = frame.offset {
-        map[.unsignedInt(FrameKey.offset.rawValue)] = .unsignedInt(offset)
+        appendUInt(.offset, offset, to: &out)
     }
 
     if let eof = frame.eof {
-        map[.unsignedInt(FrameKey.eof.rawValue)] = .boolean(eof)
+        appendKey(.eof, to: &out)
+        out.append(eof ? CBOR_TRUE : CBOR_FALSE)
     }
 
     if let cap = frame.cap {
-        map[.unsignedInt(FrameKey.cap.rawValue)] = .utf8String(cap)
+        appendText(.cap, cap, to: &out)
     }
 
     if let streamId = frame.streamId {
-        map[.unsignedInt(FrameKey.streamId.rawValue)] = .utf8String(streamId)
+        appendText(.streamId, streamId, to: &out)
     }
 
     if let mediaUrn = frame.mediaUrn {
-        map[.unsignedInt(FrameKey.mediaUrn.rawValue)] = .utf8String(mediaUrn)
+        appendText(.mediaUrn, mediaUrn, to: &out)
     }
 
     if let routingId = frame.routingId {
-        switch routingId {
-        case .uuid(let data):
-            map[.unsignedInt(FrameKey.routingId.rawValue)] = .byteString([UInt8](data))
-        case .uint(let n):
-            map[.unsignedInt(FrameKey.routingId.rawValue)] = .unsignedInt(n)
-        }
+        appendMessageId(.routingId, routingId, to: &out)
     }
 
     if let chunkIndex = frame.chunkIndex {
-        map[.unsignedInt(FrameKey.chunkIndex.rawValue)] = .unsignedInt(chunkIndex)
+        appendUInt(.chunkIndex, chunkIndex, to: &out)
     }
 
     if let chunkCount = frame.chunkCount {
-        map[.unsignedInt(FrameKey.chunkCount.rawValue)] = .unsignedInt(chunkCount)
+        appendUInt(.chunkCount, chunkCount, to: &out)
     }
 
     if let checksum = frame.checksum {
-        map[.unsignedInt(FrameKey.checksum.rawValue)] = .unsignedInt(checksum)
+        appendUInt(.checksum, checksum, to: &out)
     }
 
-    let cbor = CBOR.map(map)
-    return Data(cbor.encode())
+    if frame.checksumAlgorithm != .fnv1a {
+        appendUInt(.checksumAlgorithm, UInt64(frame.checksumAlgorithm.rawValue), to: &out)
+    }
+
+    // Payload last; only its byte string head is written here
+    if let payload = frame.payload {
+        appendKey(.payload, to: &out)
+        appendHead(CBOR_MAJOR_BYTES, UInt64(payload.count), to: &out)
+    }
 }
 
-/// Decode a frame from CBOR bytes
-public func decodeFrame(_ data: Data) throws -> Frame {
-    guard let cbor = try? CBOR.decode([UInt8](data)) else {
-        throw FrameError.decodeError("Failed to parse CBOR")
+// MARK: - Frame Decoding
+
+/// Forward-only reader over the CBOR bytes of one frame.
+/// Truncated or malformed input surfaces as `decodeError`.
+private struct FrameCursor {
+    let data: Data
+    var pos: Data.Index
+
+    init(_ data: Data) {
+        self.data = data
+        self.pos = data.startIndex
     }
 
-    guard case .map(let map) = cbor else {
-        throw FrameError.invalidFrame("Expected map")
+    static let malformed = FrameError.decodeError("Failed to parse CBOR")
+
+    mutating func readByte() throws -> UInt8 {
+        guard pos < data.endIndex else { throw FrameCursor.malformed }
+        let b = data[pos]
+        pos += 1
+        return b
+    }
+
+    mutating func peekByte() throws -> UInt8 {
+        guard pos < data.endIndex else { throw FrameCursor.malformed }
+        return data[pos]
     }
 
-    // Helper to get integer key value
-    func getUInt(_ key: FrameKey) -> UInt64? {
-        if case .unsignedInt(let n) = map[.unsignedInt(key.rawValue)] {
-            return n
+    /// Read the argument that follows an initial byte with the given additional info
+    mutating func readArgument(_ info: UInt8) throws -> UInt64 {
+        let width: Int
+        switch info {
+        case 0..<24: return UInt64(info)
+        case 24: width = 1
+        case 25: width = 2
+        case 26: width = 4
+        case 27: width = 8
+        default: throw FrameCursor.malformed
         }
-        return nil
+        guard data.endIndex - pos >= width else { throw FrameCursor.malformed }
+        var value: UInt64 = 0
+        for _ in 0..<width {
+            value = (value << 8) | UInt64(data[pos])
+            pos += 1
+        }
+        return value
     }
 
-    // Extract required fields
-    guard let versionRaw = getUInt(.version) else {
-        throw FrameError.invalidFrame("Missing version")
+    /// Read an initial byte and split it into (major, additional info)
+    mutating func readInitial() throws -> (major: UInt8, info: UInt8) {
+        let b = try readByte()
+        return (b >> 5, b & 0x1F)
     }
-    let version = UInt8(versionRaw)
 
-    guard let frameTypeRaw = getUInt(.frameType),
-          let frameType = FrameType(rawValue: UInt8(frameTypeRaw)) else {
-        throw FrameError.invalidFrame("Missing or invalid frame_type")
+    /// Take `count` bytes as a slice of the input (no copy)
+    mutating func take(_ count: UInt64) throws -> Data {
+        guard count <= UInt64(data.endIndex - pos) else { throw FrameCursor.malformed }
+        let end = pos + Int(count)
+        let slice = data[pos..<end]
+        pos = end
+        return slice
     }
 
-    // Extract ID
-    let id: MessageId
-    if let idValue = map[.unsignedInt(FrameKey.id.rawValue)] {
-        switch idValue {
-        case .byteString(let bytes):
-            if bytes.count == 16 {
-                id = .uuid(Data(bytes))
+    /// Read the body of a byte or text string whose initial byte was already consumed.
+    /// Definite strings are sliced; indefinite strings concatenate their chunks.
+    mutating func readStringBody(major: UInt8, info: UInt8) throws -> Data {
+        if info != CBOR_INDEFINITE {
+            return try take(readArgument(info))
+        }
+        var joined = Data()
+        while try peekByte() != CBOR_BREAK {
+            let (chunkMajor, chunkInfo) = try readInitial()
+            guard chunkMajor == major, chunkInfo != CBOR_INDEFINITE else {
+                throw FrameCursor.malformed
+            }
+            joined.append(try take(readArgument(chunkInfo)))
+        }
+        pos += 1
+        return joined
+    }
+
+    /// Skip one complete data item whose initial byte was already consumed
+    mutating func skipBody(major: UInt8, info: UInt8) throws {
+        switch major {
+        case CBOR_MAJOR_UNSIGNED, CBOR_MAJOR_NEGATIVE:
+            _ = try readArgument(info)
+        case CBOR_MAJOR_BYTES, CBOR_MAJOR_TEXT:
+            _ = try readStringBody(major: major, info: info)
+        case CBOR_MAJOR_ARRAY, CBOR_MAJOR_MAP:
+            let perEntry = major == CBOR_MAJOR_MAP ? 2 : 1
+            if info == CBOR_INDEFINITE {
+                while try peekByte() != CBOR_BREAK {
+                    for _ in 0..<perEntry { try skipItem() }
+                }
+                pos += 1
             } else {
-                id = .uint(0)
+                let count = try readArgument(info)
+                // Every item takes at least one byte; reject counts the input can't hold
+                guard count <= UInt64(data.endIndex - pos) else { throw FrameCursor.malformed }
+                for _ in 0..<(Int(count) * perEntry) { try skipItem() }
             }
-        case .unsignedInt(let n):
-            id = .uint(n)
+        case CBOR_MAJOR_TAG:
+            _ = try readArgument(info)
+            try skipItem()
         default:
-            id = .uint(0)
+            // Simple values and floats; a stray break is malformed
+            guard info != CBOR_INDEFINITE else { throw FrameCursor.malformed }
+            _ = try readArgument(info)
         }
-    } else {
-        throw FrameError.invalidFrame("Missing id")
     }
 
-    var frame = Frame(frameType: frameType, id: id)
-    frame.version = version
-    frame.seq = getUInt(.seq) ?? 0
-
-    // Optional fields
-    if case .utf8String(let s) = map[.unsignedInt(FrameKey.contentType.rawValue)] {
-        frame.contentType = s
+    mutating func skipItem() throws {
+        let (major, info) = try readInitial()
+        try skipBody(major: major, info: info)
     }
+}
 
-    if case .map(let metaMap) = map[.unsignedInt(FrameKey.meta.rawValue)] {
-        var meta: [String: CBOR] = [:]
-        for (k, v) in metaMap {
-            if case .utf8String(let key) = k {
-                meta[key] = v
-            }
-        }
-        frame.meta = meta
-    }
+/// Decoded value of one frame map entry, limited to the shapes frames use
+private enum FrameValue {
+    case uint(UInt64)
+    case negative(UInt64)
+    case bytes(Data)
+    case text(Data)
+    case bool(Bool)
+    case meta(Data)
+    case other
+}
 
-    if case .byteString(let bytes) = map[.unsignedInt(FrameKey.payload.rawValue)] {
-        frame.payload = Data(bytes)
+private func readFrameValue(_ cursor: inout FrameCursor, key: UInt64) throws -> FrameValue {
+    let itemStart = cursor.pos
+    let (major, info) = try cursor.readInitial()
+    switch major {
+    case CBOR_MAJOR_UNSIGNED:
+        return .uint(try cursor.readArgument(info))
+    case CBOR_MAJOR_NEGATIVE:
+        return .negative(try cursor.readArgument(info))
+    case CBOR_MAJOR_BYTES:
+        return .bytes(try cursor.readStringBody(major: major, info: info))
+    case CBOR_MAJOR_TEXT:
+        return .text(try cursor.readStringBody(major: major, info: info))
+    case CBOR_MAJOR_MAP where key == FrameKey.meta.rawValue:
+        try cursor.skipBody(major: major, info: info)
+        return .meta(cursor.data[itemStart..<cursor.pos])
+    case CBOR_MAJOR_SIMPLE where info == (CBOR_FALSE & 0x1F) || info == (CBOR_TRUE & 0x1F):
+        return .bool(info == (CBOR_TRUE & 0x1F))
+    default:
+        try cursor.skipBody(major: major, info: info)
+        return .other
     }
+}
 
-    if let len = getUInt(.len) {
-        frame.len = len
-    }
+/// Decode a frame from CBOR bytes
+///
+/// `payload` is a slice of `data` (shares its storage, indices need not start at 0).
+public func decodeFrame(_ data: Data) throws -> Frame {
+    var cursor = FrameCursor(data)
 
-    if let offset = getUInt(.offset) {
-        frame.offset = offset
+    let (major, info) = try cursor.readInitial()
+    guard major == CBOR_MAJOR_MAP else {
+        // Still has to be well-formed CBOR to count as "not a map"
+        try cursor.skipBody(major: major, info: info)
+        throw FrameError.invalidFrame("Expected map")
     }
+    var remaining: UInt64? = nil
+    if info != CBOR_INDEFINITE {
+        remaining = try cursor.readArgument(info)
+    }
+
+    var versionRaw: UInt64?
+    var frameTypeRaw: UInt64?
+    var idValue: FrameValue?
+    var seq: UInt64?
+    var contentType: String?
+    var metaBytes: Data?
+    var payload: Data?
+    var len: UInt64?
+    var offset: UInt64?
+    var eof: Bool?
+    var cap: String?
+    var streamId: String?
+    var mediaUrn: String?
+    var routingIdValue: FrameValue?
+    var chunkIndex: UInt64?
+    var chunkCount: UInt64?
+    var checksum: UInt64?
+    var checksumAlgorithmRaw: UInt64?
+
+    var entriesRead: UInt64 = 0
+    while true {
+        if let remaining = remaining {
+            if entriesRead == remaining { break }
+        } else if try cursor.peekByte() == CBOR_BREAK {
+            cursor.pos += 1
+            break
+        }
+        entriesRead += 1
+
+        // Non-integer keys are not part of the frame schema; skip the entry
+        let (keyMajor, keyInfo) = try cursor.readInitial()
+        guard keyMajor == CBOR_MAJOR_UNSIGNED else {
+            try cursor.skipBody(major: keyMajor, info: keyInfo)
+            try cursor.skipItem()
+            continue
+        }
+        let key = try cursor.readArgument(keyInfo)
+        guard let frameKey = FrameKey(rawValue: key) else {
+            try cursor.skipItem()
+            continue
+        }
 
-    if case .boolean(let b) = map[.unsignedInt(FrameKey.eof.rawValue)] {
-        frame.eof = b
+        let value = try readFrameValue(&cursor, key: key)
+        // Fields with an unexpected value type are ignored, as before
+        switch (frameKey, value) {
+        case (.version, .uint(let n)): versionRaw = n
+        case (.frameType, .uint(let n)): frameTypeRaw = n
+        case (.id, _): idValue = value
+        case (.seq, .uint(let n)): seq = n
+        case (.contentType, .text(let s)): contentType = String(decoding: s, as: UTF8.self)
+        case (.meta, .meta(let bytes)): metaBytes = bytes
+        case (.payload, .bytes(let bytes)): payload = bytes
+        case (.len, .uint(let n)): len = n
+        case (.offset, .uint(let n)): offset = n
+        case (.eof, .bool(let b)): eof = b
+        case (.cap, .text(let s)): cap = String(decoding: s, as: UTF8.self)
+        case (.streamId, .text(let s)): streamId = String(decoding: s, as: UTF8.self)
+        case (.mediaUrn, .text(let s)): mediaUrn = String(decoding: s, as: UTF8.self)
+        case (.routingId, _): routingIdValue = value
+        case (.chunkIndex, .uint(let n)): chunkIndex = n
+        case (.chunkCount, .uint(let n)): chunkCount = n
+        case (.checksum, .uint(let n)): checksum = n
+        case (.checksum, .negative(let n)):
+            // Rust encodes checksum as i64, which becomes negativeInt for values > i64::MAX
+            // negativeInt(n) represents -(n+1), i.e. the two's complement bit pattern ~n
+            checksum = ~n
+        case (.checksumAlgorithm, .uint(let n)): checksumAlgorithmRaw = n
+        default:
+            break
+        }
     }
 
-    if case .utf8String(let s) = map[.unsignedInt(FrameKey.cap.rawValue)] {
-        frame.cap = s
+    // Extract required fields
+    guard let versionRaw = versionRaw else {
+        throw FrameError.invalidFrame("Missing version")
+    }
+    guard let version = UInt8(exactly: versionRaw) else {
+        throw FrameError.invalidFrame("Invalid version")
     }
 
-    if case .utf8String(let s) = map[.unsignedInt(FrameKey.streamId.rawValue)] {
-        frame.streamId = s
+    guard let frameTypeRaw = frameTypeRaw,
+          let frameTypeByte = UInt8(exactly: frameTypeRaw),
+          let frameType = FrameType(rawValue: frameTypeByte) else {
+        throw FrameError.invalidFrame("Missing or invalid frame_type")
     }
 
-    if case .utf8String(let s) = map[.unsignedInt(FrameKey.mediaUrn.rawValue)] {
-        frame.mediaUrn = s
+    // Extract ID
+    let id: MessageId
+    switch idValue {
+    case .bytes(let bytes)?:
+        id = bytes.count == 16 ? .uuid(Data(bytes)) : .uint(0)
+    case .uint(let n)?:
+        id = .uint(n)
+    case nil:
+        throw FrameError.invalidFrame("Missing id")
+    default:
+        id = .uint(0)
     }
 
-    // Extract routingId
-    if let routingIdValue = map[.unsignedInt(FrameKey.routingId.rawValue)] {
-        switch routingIdValue {
-        case .byteString(let bytes):
-            if bytes.count == 16 {
-                frame.routingId = .uuid(Data(bytes))
+    var frame = Frame(frameType: frameType, id: id)
+    frame.version = version
+    frame.seq = seq ?? 0
+
+    // Optional fields
+    frame.contentType = contentType
+
+    if let metaBytes = metaBytes {
+        guard case .map(let metaMap)? = try? CBOR.decode([UInt8](metaBytes)) else {
+            throw FrameCursor.malformed
+        }
+        var meta: [String: CBOR] = [:]
+        for (k, v) in metaMap {
+            if case .utf8String(let key) = k {
+                meta[key] = v
             }
-        case .unsignedInt(let n):
-            frame.routingId = .uint(n)
-        default:
-            break
         }
+        frame.meta = meta
     }
 
-    if let chunkIndex = getUInt(.chunkIndex) {
-        frame.chunkIndex = chunkIndex
-    }
-
-    if let chunkCount = getUInt(.chunkCount) {
-        frame.chunkCount = chunkCount
-    }
+    frame.payload = payload
+    frame.len = len
+    frame.offset = offset
+    frame.eof = eof
+    frame.cap = cap
+    frame.streamId = streamId
+    frame.mediaUrn = mediaUrn
 
-    // Checksum can be encoded as signed or unsigned (Rust uses signed i64 which may become negativeInt for large values)
-    if let value = map[.unsignedInt(FrameKey.checksum.rawValue)] {
-        switch value {
-        case .unsignedInt(let n):
-            frame.checksum = n
-        case .negativeInt(let n):
-            // Rust encodes checksum as i64, which becomes negativeInt for values > i64::MAX
-            // Convert back using two's complement: negativeInt(n) represents -(n+1)
-            frame.checksum = UInt64(bitPattern: Int64(-1 - Int64(n)))
-        default:
-            break
+    // Extract routingId
+    switch routingIdValue {
+    case .bytes(let bytes)? where bytes.count == 16:
+        frame.routingId = .uuid(Data(bytes))
+    case .uint(let n)?:
+        frame.routingId = .uint(n)
+    default:
+        break
+    }
+
+    frame.chunkIndex = chunkIndex
+    frame.chunkCount = chunkCount
+    frame.checksum = checksum
+    if let raw = checksumAlgorithmRaw {
+        guard let byte = UInt8(exactly: raw), let algorithm = ChecksumAlgorithm(rawValue: byte) else {
+            throw FrameError.protocolError("Unknown checksum algorithm \(raw)")
         }
+        frame.checksumAlgorithm = algorithm
     }
 
     // Protocol v2 validation: CHUNK frames MUST have chunkIndex and checksum
@@ -268,52 +559,114 @@ public func decodeFrame(_ data: Data) throws -> Frame {
 
 // MARK: - Length-Prefixed I/O
 
-/// Write a length-prefixed CBOR frame with buffering
-/// Matches Rust's BufWriter behavior: accumulates in 8KB buffer, flushes when full
-@available(macOS 10.15.4, iOS 13.4, *)
-public func writeFrame(_ frame: Frame, to handle: FileHandle, limits: Limits, buffer: inout Data) throws {
-    let data = try encodeFrame(frame)
-
-    if data.count > limits.maxFrame {
-        throw FrameError.frameTooLarge(size: data.count, max: limits.maxFrame)
-    }
+/// Payloads at least this large are handed to writev(2) from their own
+/// buffer instead of being copied behind the frame header
+public let FRAME_WRITEV_MIN_PAYLOAD: Int = 16 * 1024
+
+/// Append the length prefix and CBOR header of `frame` to `buffer`.
+///
+/// Small payloads are appended too and nil is returned. Payloads of at
+/// least FRAME_WRITEV_MIN_PAYLOAD bytes are NOT appended; they are returned
+/// so the caller writes them right after `buffer`.
+func appendFrame(_ frame: Frame, limits: Limits, to buffer: inout Data) throws -> Data? {
+    let start = buffer.count
+    buffer.append(contentsOf: [0, 0, 0, 0])  // length prefix, patched below
+    encodeFrameHeader(frame, into: &buffer)
+
+    let payloadCount = frame.payload?.count ?? 0
+    let frameSize = buffer.count - start - 4 + payloadCount
+
+    if frameSize > limits.maxFrame || frameSize > MAX_FRAME_HARD_LIMIT {
+        buffer.removeSubrange(start..<buffer.count)
+        throw FrameError.frameTooLarge(size: frameSize, max: frameSize > limits.maxFrame ? limits.maxFrame : MAX_FRAME_HARD_LIMIT)
+    }
+
+    let length = UInt32(frameSize)
+    let prefixIndex = buffer.startIndex + start
+    buffer[prefixIndex] = UInt8((length >> 24) & 0xFF)
+    buffer[prefixIndex + 1] = UInt8((length >> 16) & 0xFF)
+    buffer[prefixIndex + 2] = UInt8((length >> 8) & 0xFF)
+    buffer[prefixIndex + 3] = UInt8(length & 0xFF)
+
+    guard let payload = frame.payload, !payload.isEmpty else { return nil }
+    if payload.count >= FRAME_WRITEV_MIN_PAYLOAD {
+        return payload
+    }
+    buffer.append(payload)
+    return nil
+}
 
-    if data.count > MAX_FRAME_HARD_LIMIT {
-        throw FrameError.frameTooLarge(size: data.count, max: MAX_FRAME_HARD_LIMIT)
+/// Write all of `head` followed by all of `tail` (if any) to `fd`.
+/// Uses a single writev(2) when there is a tail, retrying on partial writes and EINTR.
+func writeFully(_ fd: Int32, _ head: Data, _ tail: Data? = nil) throws {
+    try head.withUnsafeBytes { headBytes in
+        try (tail ?? Data()).withUnsafeBytes { tailBytes in
+            var iov = [
+                iovec(iov_base: UnsafeMutableRawPointer(mutating: headBytes.baseAddress), iov_len: headBytes.count),
+                iovec(iov_base: UnsafeMutableRawPointer(mutating: tailBytes.baseAddress), iov_len: tailBytes.count),
+            ]
+            var first = 0
+            while first < iov.count {
+                if iov[first].iov_len == 0 {
+                    first += 1
+                    continue
+                }
+                let result = iov.withUnsafeMutableBufferPointer { ptr in
+                    Darwin.writev(fd, ptr.baseAddress!.advanced(by: first), Int32(ptr.count - first))
+                }
+                if result < 0 {
+                    if errno == EINTR { continue }
+                    throw FrameError.ioError("write failed: \(String(cString: strerror(errno)))")
+                }
+                // Advance past what was written
+                var written = result
+                while written > 0 && first < iov.count {
+                    let n = min(written, iov[first].iov_len)
+                    iov[first].iov_base = iov[first].iov_base.map { $0.advanced(by: n) }
+                    iov[first].iov_len -= n
+                    written -= n
+                    if iov[first].iov_len == 0 { first += 1 }
+                }
+            }
+        }
     }
+}
 
-    let length = UInt32(data.count)
-    var lengthBytes = Data(count: 4)
-    lengthBytes[0] = UInt8((length >> 24) & 0xFF)
-    lengthBytes[1] = UInt8((length >> 16) & 0xFF)
-    lengthBytes[2] = UInt8((length >> 8) & 0xFF)
-    lengthBytes[3] = UInt8(length & 0xFF)
-
-    // Accumulate length + data in buffer
-    buffer.append(lengthBytes)
-    buffer.append(data)
+/// Write a length-prefixed CBOR frame and flush it.
+///
+/// `buffer` is scratch space reused across calls (kept allocated, left empty).
+/// Large payloads go out with the header in one writev(2) without being copied.
+@available(macOS 10.15.4, iOS 13.4, *)
+public func writeFrame(_ frame: Frame, to handle: FileHandle, limits: Limits, buffer: inout Data) throws {
+    let largePayload = try appendFrame(frame, limits: limits, to: &buffer)
 
     // Use POSIX write() directly to bypass FileHandle buffering
     // FileHandle.write() may internally buffer data, causing frames to not reach
     // the pipe reader immediately. POSIX write() is unbuffered and writes directly
     // to the file descriptor, ensuring data reaches the reader without delay.
-    let fd = handle.fileDescriptor
-    try buffer.withUnsafeBytes { rawBuffer in
-        guard let baseAddress = rawBuffer.baseAddress else { return }
-        var totalWritten = 0
-        while totalWritten < buffer.count {
-            let result = Darwin.write(fd, baseAddress.advanced(by: totalWritten), buffer.count - totalWritten)
-            if result < 0 {
-                throw FrameError.ioError("write failed: \(String(cString: strerror(errno)))")
-            }
-            totalWritten += result
-        }
+    defer { buffer.removeAll(keepingCapacity: true) }
+    try writeFully(handle.fileDescriptor, buffer, largePayload)
+}
+
+/// Decode and validate a 4-byte big-endian frame length prefix
+func decodeFrameLength<C: Collection>(_ prefix: C, limits: Limits) throws -> Int where C.Element == UInt8 {
+    var length: UInt32 = 0
+    for byte in prefix.prefix(4) {
+        length = (length << 8) | UInt32(byte)
+    }
+    let size = Int(length)
+
+    if size > limits.maxFrame || size > MAX_FRAME_HARD_LIMIT {
+        throw FrameError.frameTooLarge(size: size, max: min(limits.maxFrame, MAX_FRAME_HARD_LIMIT))
     }
-    buffer.removeAll(keepingCapacity: true)
+    return size
 }
 
 /// Read a length-prefixed CBOR frame
 /// Returns nil on clean EOF
+///
+/// Unbuffered: two reads per frame, never consumes bytes past the frame.
+/// Prefer FrameReader, which reads ahead.
 public func readFrame(from handle: FileHandle, limits: Limits) throws -> Frame? {
     // Read 4-byte length prefix
     let lengthData = handle.readData(ofLength: 4)
@@ -326,13 +679,7 @@ public func readFrame(from handle: FileHandle, limits: Limits) throws -> Frame?
         throw FrameError.unexpectedEof
     }
 
-    let bytes = [UInt8](lengthData)
-    let length = Int(UInt32(bytes[0]) << 24 | UInt32(bytes[1]) << 16 | UInt32(bytes[2]) << 8 | UInt32(bytes[3]))
-
-    // Validate length
-    if length > limits.maxFrame || length > MAX_FRAME_HARD_LIMIT {
-        throw FrameError.frameTooLarge(size: length, max: min(limits.maxFrame, MAX_FRAME_HARD_LIMIT))
-    }
+    let length = try decodeFrameLength(lengthData, limits: limits)
 
     // Read payload
     let payloadData = handle.readData(ofLength: length)
@@ -345,15 +692,38 @@ public func readFrame(from handle: FileHandle, limits: Limits) throws -> Frame?
 
 // MARK: - Frame Reader/Writer Classes
 
+/// Default read-ahead buffer size for FrameReader (one syscall typically
+/// yields several small frames or a full max-size chunk)
+public let FRAME_READ_BUFFER_SIZE: Int = 256 * 1024
+
 /// CBOR frame reader with incremental decoding
+///
+/// By default reads ahead from the raw file descriptor into a reusable
+/// buffer and extracts as many frames as it holds before issuing the next
+/// `read(2)`. Bytes past the returned frame stay in the buffer, so only this
+/// reader may consume the handle. Pass `bufferSize: 0` to read exactly one
+/// frame at a time via `readFrame(from:limits:)` when the handle is shared.
 public class FrameReader: @unchecked Sendable {
     private let handle: FileHandle
     private var limits: Limits
     private let lock = NSLock()
 
-    public init(handle: FileHandle, limits: Limits = Limits()) {
+    /// Serializes read() callers; separate from `lock` so setLimits never
+    /// waits behind a blocking read
+    private let readLock = NSLock()
+    private let bufferSize: Int
+    private var buffer: [UInt8] = []
+    /// Unconsumed bytes are buffer[readStart..<readEnd]
+    private var readStart = 0
+    private var readEnd = 0
+    private var reachedEof = false
+    /// Peer's ring when the handshake negotiated shared memory payloads. Guarded by `lock`.
+    private var sharedRing: SharedMemoryRing?
+
+    public init(handle: FileHandle, limits: Limits = Limits(), bufferSize: Int = FRAME_READ_BUFFER_SIZE) {
         self.handle = handle
         self.limits = limits
+        self.bufferSize = bufferSize
     }
 
     /// Update limits (after handshake)
@@ -370,26 +740,149 @@ public class FrameReader: @unchecked Sendable {
         return limits
     }
 
+    /// Take CHUNK payloads that arrive by offset from the peer's ring (see SharedMemoryTransport)
+    func attachSharedMemoryRing(_ ring: SharedMemoryRing) {
+        lock.lock()
+        defer { lock.unlock() }
+        sharedRing = ring
+    }
+
     /// Read the next frame (blocking)
     public func read() throws -> Frame? {
         lock.lock()
         let currentLimits = limits
+        let ring = sharedRing
         lock.unlock()
-        return try readFrame(from: handle, limits: currentLimits)
+
+        var frame: Frame?
+        if bufferSize <= 0 {
+            frame = try readFrame(from: handle, limits: currentLimits)
+            try frame?.restorePayload(from: ring)
+            return frame
+        }
+
+        readLock.lock()
+        defer { readLock.unlock() }
+        frame = try readBuffered(limits: currentLimits)
+        // Still under readLock: ring payloads must be taken in wire order
+        try frame?.restorePayload(from: ring)
+        return frame
+    }
+
+    /// Extract the next frame from the read-ahead buffer, refilling only when
+    /// it holds less than one complete frame. Caller holds readLock.
+    private func readBuffered(limits: Limits) throws -> Frame? {
+        // Length prefix
+        while readEnd - readStart < 4 {
+            if try !fill(atLeast: 4) {
+                if readEnd == readStart { return nil }  // Clean EOF
+                throw FrameError.unexpectedEof
+            }
+        }
+        let length = try decodeFrameLength(buffer[readStart..<(readStart + 4)], limits: limits)
+
+        // Body
+        let total = 4 + length
+        while readEnd - readStart < total {
+            if try !fill(atLeast: total) {
+                throw FrameError.unexpectedEof
+            }
+        }
+
+        let bodyStart = readStart + 4
+        let body = buffer.withUnsafeBufferPointer { ptr in
+            Data(UnsafeBufferPointer(rebasing: ptr[bodyStart..<(readStart + total)]))
+        }
+        readStart += total
+        if readStart == readEnd {
+            readStart = 0
+            readEnd = 0
+        }
+
+        return try decodeFrame(body)
+    }
+
+    /// Issue one read(2) into the buffer, making room for a frame of `needed`
+    /// bytes first. Returns false on EOF.
+    private func fill(atLeast needed: Int) throws -> Bool {
+        if reachedEof { return false }
+
+        if buffer.count < max(bufferSize, needed) {
+            // Grow once to fit the largest frame seen; never shrinks
+            if readStart > 0 { compact() }
+            buffer.append(contentsOf: repeatElement(0, count: max(bufferSize, needed) - buffer.count))
+        } else if buffer.count - readStart < needed || readEnd == buffer.count {
+            compact()
+        }
+
+        let fd = handle.fileDescriptor
+        while true {
+            let result = buffer.withUnsafeMutableBufferPointer { ptr in
+                Darwin.read(fd, ptr.baseAddress!.advanced(by: readEnd), ptr.count - readEnd)
+            }
+            if result > 0 {
+                readEnd += result
+                return true
+            }
+            if result == 0 {
+                reachedEof = true
+                return false
+            }
+            if errno == EINTR { continue }
+            throw FrameError.ioError("read failed: \(String(cString: strerror(errno)))")
+        }
+    }
+
+    /// Move unconsumed bytes to the front of the buffer
+    private func compact() {
+        let pending = readEnd - readStart
+        if pending > 0 && readStart > 0 {
+            buffer.withUnsafeMutableBufferPointer { ptr in
+                let base = ptr.baseAddress!
+                _ = memmove(base, base.advanced(by: readStart), pending)
+            }
+        }
+        readStart = 0
+        readEnd = pending
     }
 }
 
+/// Default byte threshold for FrameWriter coalescing
+public let FRAME_COALESCE_BYTES: Int = 64 * 1024
+
+/// Default upper bound on how long a coalesced frame may sit in the buffer
+public let FRAME_COALESCE_DELAY: TimeInterval = 0.002
+
 /// CBOR frame writer
+///
+/// By default every write() is flushed immediately. With `coalesceBytes > 0`
+/// CHUNK / STREAM_START / STREAM_END frames accumulate in the buffer until it
+/// holds `coalesceBytes`, until `coalesceDelay` elapses, or until any other
+/// frame type (END, ERR, HEARTBEAT, REQ, ...) is written, which flushes the
+/// batch together with that frame. Large payloads are never copied into the
+/// buffer; they are written with the pending bytes in one writev(2).
 @available(macOS 10.15.4, iOS 13.4, *)
 public class FrameWriter: @unchecked Sendable {
     public let handle: FileHandle
     private var limits: Limits
     private let lock = NSLock()
-    private var buffer: Data = Data()  // 8KB buffer matching Rust's BufWriter
-
-    public init(handle: FileHandle, limits: Limits = Limits()) {
+    private var buffer: Data = Data()
+
+    private let coalesceBytes: Int
+    private let coalesceDelay: TimeInterval
+    /// Incremented on every flush; a delayed flush only fires for its own batch
+    private var flushGeneration: UInt64 = 0
+    private var flushScheduled = false
+    /// Error from a delayed flush, reported by the next write() or flush()
+    private var deferredError: Error?
+    /// Our ring when the handshake negotiated shared memory payloads
+    private var sharedRing: SharedMemoryRing?
+
+    public init(handle: FileHandle, limits: Limits = Limits(), coalesceBytes: Int = 0, coalesceDelay: TimeInterval = FRAME_COALESCE_DELAY) {
         self.handle = handle
         self.limits = limits
+        self.coalesceBytes = coalesceBytes
+        self.coalesceDelay = coalesceDelay
     }
 
     /// Destructor: flush any remaining buffered data before object is destroyed
@@ -398,16 +891,7 @@ public class FrameWriter: @unchecked Sendable {
         defer { lock.unlock() }
         if !buffer.isEmpty {
             // Use POSIX write() directly to ensure data reaches pipe
-            let fd = handle.fileDescriptor
-            buffer.withUnsafeBytes { rawBuffer in
-                guard let baseAddress = rawBuffer.baseAddress else { return }
-                var totalWritten = 0
-                while totalWritten < buffer.count {
-                    let result = Darwin.write(fd, baseAddress.advanced(by: totalWritten), buffer.count - totalWritten)
-                    if result <= 0 { break }
-                    totalWritten += result
-                }
-            }
+            try? writeFully(handle.fileDescriptor, buffer)
         }
     }
 
@@ -425,32 +909,100 @@ public class FrameWriter: @unchecked Sendable {
         return limits
     }
 
-    /// Write a frame (buffered)
+    /// Write a frame (buffered when coalescing is enabled)
     public func write(_ frame: Frame) throws {
         lock.lock()
         defer { lock.unlock() }
-        try writeFrame(frame, to: handle, limits: limits, buffer: &buffer)
+        try writeLocked(frame)
+    }
+
+    /// Send large CHUNK payloads through `ring` from now on (see SharedMemoryTransport)
+    func attachSharedMemoryRing(_ ring: SharedMemoryRing) {
+        lock.lock()
+        defer { lock.unlock() }
+        sharedRing = ring
     }
 
     /// Flush buffered data
     public func flush() throws {
         lock.lock()
         defer { lock.unlock() }
-        if !buffer.isEmpty {
-            // Use POSIX write() directly to ensure data reaches pipe
-            let fd = handle.fileDescriptor
-            try buffer.withUnsafeBytes { rawBuffer in
-                guard let baseAddress = rawBuffer.baseAddress else { return }
-                var totalWritten = 0
-                while totalWritten < buffer.count {
-                    let result = Darwin.write(fd, baseAddress.advanced(by: totalWritten), buffer.count - totalWritten)
-                    if result < 0 {
-                        throw FrameError.ioError("write failed: \(String(cString: strerror(errno)))")
-                    }
-                    totalWritten += result
+        try throwDeferredError()
+        try flushLocked()
+    }
+
+    /// Frames that may wait in the buffer. Everything else is latency-sensitive
+    /// (END/ERR/HEARTBEAT terminate or probe, REQ/HELLO/relay frames wait for a reply).
+    private static func isCoalescable(_ type: FrameType) -> Bool {
+        switch type {
+        case .chunk, .streamStart, .streamEnd: return true
+        default: return false
+        }
+    }
+
+    /// Caller holds lock.
+    private func writeLocked(_ frame: Frame) throws {
+        try throwDeferredError()
+
+        // A forwarded CHUNK may carry a checksum this peer never agreed to
+        // (negotiated on another hop). Re-stamp it with one the peer can verify.
+        var frame = frame
+        if frame.frameType == .chunk && frame.checksum != nil
+            && frame.checksumAlgorithm != .fnv1a && frame.checksumAlgorithm != limits.checksum {
+            frame.setChecksum(algorithm: limits.checksum)
+        }
+        if let ring = sharedRing {
+            frame.stagePayload(in: ring)
+        }
+
+        let largePayload = try appendFrame(frame, limits: limits, to: &buffer)
+
+        if largePayload != nil || coalesceBytes <= 0 || buffer.count >= coalesceBytes
+            || !Self.isCoalescable(frame.frameType) {
+            try flushLocked(tail: largePayload)
+        } else {
+            scheduleDelayedFlushLocked()
+        }
+    }
+
+    /// Caller holds lock.
+    private func flushLocked(tail: Data? = nil) throws {
+        guard !buffer.isEmpty || tail != nil else { return }
+        flushGeneration &+= 1
+        defer { buffer.removeAll(keepingCapacity: true) }
+        // Use POSIX write() directly to ensure data reaches pipe
+        try writeFully(handle.fileDescriptor, buffer, tail)
+    }
+
+    /// Caller holds lock.
+    private func throwDeferredError() throws {
+        if let error = deferredError {
+            deferredError = nil
+            throw error
+        }
+    }
+
+    /// Make sure the batch now in the buffer goes out within coalesceDelay
+    /// even if no further frame arrives. Caller holds lock.
+    private func scheduleDelayedFlushLocked() {
+        guard !flushScheduled else { return }
+        flushScheduled = true
+        let generation = flushGeneration
+        DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + coalesceDelay) { [weak self] in
+            guard let self = self else { return }
+            self.lock.lock()
+            defer { self.lock.unlock() }
+            self.flushScheduled = false
+            if self.flushGeneration == generation {
+                do {
+                    try self.flushLocked()
+                } catch {
+                    self.deferredError = error
                 }
+            } else if !self.buffer.isEmpty {
+                // Batch already went out; a newer one is pending
+                self.scheduleDelayedFlushLocked()
             }
-            buffer.removeAll(keepingCapacity: true)
         }
     }
 
@@ -470,13 +1022,14 @@ public class FrameWriter: @unchecked Sendable {
         if data.isEmpty {
             // Empty payload - single chunk with eof
             let emptyData = Data()
-            let checksum = Frame.computeChecksum(emptyData)
+            let checksum = Frame.computeChecksum(emptyData, algorithm: limits.checksum)
             var frame = Frame.chunk(reqId: id, streamId: streamId, seq: 0, payload: emptyData, chunkIndex: 0, checksum: checksum)
+            frame.checksumAlgorithm = limits.checksum
             frame.contentType = contentType
             frame.len = 0
             frame.offset = 0
             frame.eof = true
-            try writeFrame(frame, to: handle, limits: limits, buffer: &buffer)
+            try writeLocked(frame)
             return
         }
 
@@ -487,11 +1040,15 @@ public class FrameWriter: @unchecked Sendable {
             let chunkSize = min(maxChunk, data.count - offset)
             let isLast = offset + chunkSize >= data.count
 
-            let chunkData = data.subdata(in: offset..<(offset + chunkSize))
-            let checksum = Frame.computeChecksum(chunkData)
+            // Slice, not subdata: shares the source storage, and appendFrame
+            // hands large slices straight to writev
+            let chunkStart = data.startIndex + offset
+            let chunkData = data[chunkStart..<(chunkStart + chunkSize)]
+            let checksum = Frame.computeChecksum(chunkData, algorithm: limits.checksum)
 
             // seq=0 for all chunks - SeqAssigner handles seq assignment at output stage
             var frame = Frame.chunk(reqId: id, streamId: streamId, seq: 0, payload: chunkData, chunkIndex: chunkIndex, checksum: checksum)
+            frame.checksumAlgorithm = limits.checksum
             frame.offset = UInt64(offset)
 
             // Set content_type and total len on first chunk (chunk_index-based, not seq-based)
@@ -504,12 +1061,31 @@ public class FrameWriter: @unchecked Sendable {
                 frame.eof = true
             }
 
-            try writeFrame(frame, to: handle, limits: limits, buffer: &buffer)
+            try writeLocked(frame)
 
             chunkIndex += 1
             offset += chunkSize
         }
     }
+
+    /// Write a file as multiple chunks without reading it into memory.
+    ///
+    /// The file is memory-mapped and each chunk is a slice of the mapping,
+    /// so pages go from the page cache to the descriptor without a user-space copy.
+    /// - Parameters:
+    ///   - id: Request ID
+    ///   - streamId: Stream ID for multiplexing
+    ///   - contentType: Content type
+    ///   - fileURL: File to chunk
+    public func writeChunked(id: MessageId, streamId: String, contentType: String, fileURL: URL) throws {
+        let mapped: Data
+        do {
+            mapped = try Data(contentsOf: fileURL, options: .alwaysMapped)
+        } catch {
+            throw FrameError.ioError("cannot map \(fileURL.path): \(error.localizedDescription)")
+        }
+        try writeChunked(id: id, streamId: streamId, contentType: contentType, data: mapped)
+    }
 }
 
 // MARK: - Handshake
@@ -528,8 +1104,19 @@ public struct HandshakeResult: Sendable {
 public func performHandshakeWithManifest(reader: FrameReader, writer: FrameWriter) throws -> HandshakeResult {
     // Send our HELLO with our current limits
     let ourLimits = writer.getLimits()
-    let ourHello = Frame.hello(limits: ourLimits)
-    try writer.write(ourHello)
+    var ourHello = Frame.hello(limits: ourLimits)
+    let offeredRing = offerSharedMemoryRing(in: &ourHello, capacity: ourLimits.sharedMemoryRing)
+    do {
+        try writer.write(ourHello)
+    } catch {
+        offeredRing?.unlinkFile()
+        throw error
+    }
+    // A failed handshake must not leave the offered ring file behind
+    var ringSettled = false
+    defer {
+        if !ringSettled { offeredRing?.unlinkFile() }
+    }
 
     // Read their HELLO (should include manifest)
     guard let theirFrame = try reader.read() else {
@@ -557,11 +1144,15 @@ public func performHandshakeWithManifest(reader: FrameReader, writer: FrameWrite
     }
 
     // Negotiate minimum of both sides
-    let limits = Limits(
+    var limits = Limits(
         maxFrame: min(ourLimits.maxFrame, theirMaxFrame),
         maxChunk: min(ourLimits.maxChunk, theirMaxChunk),
-        maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer)
+        maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer),
+        checksum: ChecksumAlgorithm.negotiate(preferred: ourLimits.checksum, offered: theirFrame.helloChecksumAlgorithms),
+        flowWindow: Limits.negotiateFlowWindow(ourLimits.flowWindow, theirFrame.helloFlowWindow)
     )
+    ringSettled = true
+    limits.sharedMemoryRing = completeSharedMemoryOffer(offeredRing, theirHello: theirFrame, reader: reader, writer: writer)
 
     // Update both reader and writer with negotiated limits
     reader.setLimits(limits)
@@ -600,14 +1191,17 @@ public func acceptHandshakeWithManifest(reader: FrameReader, writer: FrameWriter
 
     // Negotiate minimum of both sides
     let ourLimits = writer.getLimits()
-    let limits = Limits(
+    var limits = Limits(
         maxFrame: min(ourLimits.maxFrame, theirMaxFrame),
         maxChunk: min(ourLimits.maxChunk, theirMaxChunk),
-        maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer)
+        maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer),
+        checksum: ChecksumAlgorithm.negotiate(preferred: ourLimits.checksum, offered: theirFrame.helloChecksumAlgorithms),
+        flowWindow: Limits.negotiateFlowWindow(ourLimits.flowWindow, theirFrame.helloFlowWindow)
     )
 
     // Send our HELLO with manifest and negotiated limits
-    let ourHello = Frame.helloWithManifest(limits: ourLimits, manifest: manifest)
+    var ourHello = Frame.helloWithManifest(limits: ourLimits, manifest: manifest)
+    limits.sharedMemoryRing = acceptSharedMemoryOffer(theirHello: theirFrame, capacity: ourLimits.sharedMemoryRing, ourHello: &ourHello, reader: reader, writer: writer)
     try writer.write(ourHello)
 
     // Update both reader and writer with negotiated limits
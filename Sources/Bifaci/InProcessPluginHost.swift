@@ -60,12 +60,15 @@ public final class ResponseWriter: @unchecked Sendable {
     private let routingId: MessageId?
     private let sendFrame: @Sendable (Frame) -> Void
     private let maxChunkSize: Int
+    /// Trace from the REQ, returned on the END/ERR
+    private let trace: TraceContext?
 
-    init(requestId: MessageId, routingId: MessageId?, sendFrame: @escaping @Sendable (Frame) -> Void, maxChunk: Int) {
+    init(requestId: MessageId, routingId: MessageId?, sendFrame: @escaping @Sendable (Frame) -> Void, maxChunk: Int, trace: TraceContext? = nil) {
         self.requestId = requestId
         self.routingId = routingId
         self.sendFrame = sendFrame
         self.maxChunkSize = maxChunk
+        self.trace = trace
     }
 
     /// Send a frame, stamping it with the request_id and routing_id.
@@ -74,6 +77,10 @@ public final class ResponseWriter: @unchecked Sendable {
         stamped.id = requestId
         stamped.routingId = routingId
         stamped.seq = 0 // SeqAssigner handles this
+        if var trace = trace, frame.frameType == .end || frame.frameType == .err {
+            trace.record(TraceSpan(hop: TraceHop.plugin, event: "handler_end"))
+            stamped.traceContext = trace
+        }
         sendFrame(stamped)
     }
 
@@ -385,11 +392,14 @@ public final class InProcessPluginHost {
                 active[rid] = inputContinuation
 
                 // Spawn handler task
+                var trace = frame.traceContext
+                trace?.record(TraceSpan(hop: TraceHop.plugin, event: "req_received"))
                 let output = ResponseWriter(
                     requestId: rid,
                     routingId: xid,
                     sendFrame: { writeContinuation.yield($0) },
-                    maxChunk: Limits().maxChunk
+                    maxChunk: Limits().maxChunk,
+                    trace: trace
                 )
 
                 Task.detached {
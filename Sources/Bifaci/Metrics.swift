@@ -0,0 +1,437 @@
+//
+//  Metrics.swift
+//  Bifaci
+//
+//  Process-wide counters, gauges and histograms for the frame hot paths.
+//
+//  Components look their metrics up once (by name and optional label, e.g.
+//  the cap URN) and keep the handle; an update is then a few instructions
+//  under the metric's own lock, never the registry's, so two hot paths only
+//  contend when they touch the very same metric. Handles stay valid across
+//  `reset()`. Histograms use power-of-two buckets, so recording is constant
+//  time and memory per histogram is fixed.
+//
+//  `MetricsRegistry.shared.snapshot()` exports everything on demand; the
+//  snapshot encodes to JSON for logs and to CBOR for RelayState meta (see
+//  `RelayMaster.sendState(socketWriter:resources:metrics:)`).
+
+import Foundation
+@preconcurrency import SwiftCBOR
+
+/// Number of histogram buckets: one for zero, then one per power of two
+public let METRICS_HISTOGRAM_BUCKETS: Int = 65
+
+// MARK: - Keys
+
+/// Name plus optional label identifying one metric, e.g. `plugin_host.request_latency_us{cap:...}`
+public struct MetricKey: Hashable, Sendable, CustomStringConvertible {
+    public let name: String
+    public let label: String?
+
+    public init(_ name: String, label: String? = nil) {
+        self.name = name
+        self.label = label
+    }
+
+    public var description: String {
+        guard let label = label else { return name }
+        return "\(name){\(label)}"
+    }
+
+    /// Inverse of `description`
+    init(parsing text: String) {
+        if text.hasSuffix("}"), let open = text.firstIndex(of: "{") {
+            name = String(text[..<open])
+            label = String(text[text.index(after: open)..<text.index(before: text.endIndex)])
+        } else {
+            name = text
+            label = nil
+        }
+    }
+}
+
+// MARK: - Metrics
+
+/// Monotonic event counter
+public final class MetricCounter: @unchecked Sendable {
+    private let lock = NSLock()
+    private var count: UInt64 = 0
+
+    public func increment(by amount: UInt64 = 1) {
+        lock.lock()
+        count &+= amount
+        lock.unlock()
+    }
+
+    public var value: UInt64 {
+        lock.lock()
+        defer { lock.unlock() }
+        return count
+    }
+
+    fileprivate func reset() {
+        lock.lock()
+        count = 0
+        lock.unlock()
+    }
+}
+
+/// Level that goes up and down (queue depth, requests in flight), with its high-water mark
+public final class MetricGauge: @unchecked Sendable {
+    private let lock = NSLock()
+    private var current: Int64 = 0
+    private var highWater: Int64 = 0
+
+    public func add(_ delta: Int64) {
+        lock.lock()
+        current += delta
+        if current > highWater { highWater = current }
+        lock.unlock()
+    }
+
+    public func set(_ value: Int64) {
+        lock.lock()
+        current = value
+        if current > highWater { highWater = current }
+        lock.unlock()
+    }
+
+    public var value: Int64 {
+        lock.lock()
+        defer { lock.unlock() }
+        return current
+    }
+
+    fileprivate func snapshot() -> GaugeSnapshot {
+        lock.lock()
+        defer { lock.unlock() }
+        return GaugeSnapshot(value: current, highWaterMark: highWater)
+    }
+
+    fileprivate func reset() {
+        lock.lock()
+        highWater = current
+        lock.unlock()
+    }
+}
+
+/// Distribution of non-negative samples (latencies in µs, sizes in bytes)
+public final class MetricHistogram: @unchecked Sendable {
+    private let lock = NSLock()
+    private var buckets = [UInt64](repeating: 0, count: METRICS_HISTOGRAM_BUCKETS)
+    private var count: UInt64 = 0
+    private var sum: UInt64 = 0
+    private var minValue: UInt64 = .max
+    private var maxValue: UInt64 = 0
+
+    public func record(_ value: UInt64) {
+        let bucket = UInt64.bitWidth - value.leadingZeroBitCount
+        lock.lock()
+        buckets[bucket] &+= 1
+        count &+= 1
+        sum &+= value
+        if value < minValue { minValue = value }
+        if value > maxValue { maxValue = value }
+        lock.unlock()
+    }
+
+    /// Record the microseconds elapsed since `start` (a `metricsClock()` reading)
+    public func recordElapsed(since start: UInt64) {
+        let now = metricsClock()
+        record(now > start ? (now - start) / 1_000 : 0)
+    }
+
+    fileprivate func snapshot() -> HistogramSnapshot {
+        lock.lock()
+        defer { lock.unlock() }
+        return HistogramSnapshot(count: count, sum: sum, min: count == 0 ? 0 : minValue, max: maxValue, buckets: buckets)
+    }
+
+    fileprivate func reset() {
+        lock.lock()
+        buckets = [UInt64](repeating: 0, count: METRICS_HISTOGRAM_BUCKETS)
+        count = 0
+        sum = 0
+        minValue = .max
+        maxValue = 0
+        lock.unlock()
+    }
+}
+
+/// Monotonic nanoseconds for latency measurements
+@inline(__always)
+public func metricsClock() -> UInt64 {
+    return DispatchTime.now().uptimeNanoseconds
+}
+
+// MARK: - Snapshots
+
+/// Gauge reading
+public struct GaugeSnapshot: Sendable, Equatable {
+    public let value: Int64
+    /// Highest value since creation or the last `reset()`
+    public let highWaterMark: Int64
+}
+
+/// Histogram reading
+public struct HistogramSnapshot: Sendable, Equatable {
+    public let count: UInt64
+    public let sum: UInt64
+    public let min: UInt64
+    public let max: UInt64
+    /// Bucket 0 counts zeros; bucket i counts samples in [2^(i-1), 2^i)
+    public let buckets: [UInt64]
+
+    public var mean: Double {
+        count == 0 ? 0 : Double(sum) / Double(count)
+    }
+
+    /// Upper bound of the bucket holding the `p`-th percentile (0...1), capped at `max`
+    public func percentile(_ p: Double) -> UInt64 {
+        guard count > 0 else { return 0 }
+        let rank = UInt64((Double(count) * Swift.min(Swift.max(p, 0), 1)).rounded(.up))
+        var seen: UInt64 = 0
+        for (bucket, n) in buckets.enumerated() where n > 0 {
+            seen += n
+            if seen >= Swift.max(rank, 1) {
+                let upper = bucket == 0 ? 0 : (bucket >= 64 ? UInt64.max : (UInt64(1) << UInt64(bucket)) - 1)
+                return Swift.min(upper, max)
+            }
+        }
+        return max
+    }
+}
+
+/// Every metric in a registry at one point in time
+public struct MetricsSnapshot: Sendable {
+    public let counters: [MetricKey: UInt64]
+    public let gauges: [MetricKey: GaugeSnapshot]
+    public let histograms: [MetricKey: HistogramSnapshot]
+
+    public func counter(_ name: String, label: String? = nil) -> UInt64 {
+        counters[MetricKey(name, label: label)] ?? 0
+    }
+
+    public func gauge(_ name: String, label: String? = nil) -> GaugeSnapshot? {
+        gauges[MetricKey(name, label: label)]
+    }
+
+    public func histogram(_ name: String, label: String? = nil) -> HistogramSnapshot? {
+        histograms[MetricKey(name, label: label)]
+    }
+
+    /// JSON object: counters as numbers, gauges as {value, high_water_mark},
+    /// histograms as {count, sum, min, max, mean, p50, p99}.
+    public func jsonData() -> Data {
+        var counterObj: [String: Any] = [:]
+        for (key, value) in counters { counterObj[key.description] = value }
+        var gaugeObj: [String: Any] = [:]
+        for (key, g) in gauges { gaugeObj[key.description] = ["value": g.value, "high_water_mark": g.highWaterMark] }
+        var histogramObj: [String: Any] = [:]
+        for (key, h) in histograms {
+            histogramObj[key.description] = [
+                "count": h.count, "sum": h.sum, "min": h.min, "max": h.max,
+                "mean": h.mean, "p50": h.percentile(0.5), "p99": h.percentile(0.99),
+            ]
+        }
+        let root: [String: Any] = ["counters": counterObj, "gauges": gaugeObj, "histograms": histogramObj]
+        return (try? JSONSerialization.data(withJSONObject: root, options: [.sortedKeys])) ?? Data("{}".utf8)
+    }
+
+    /// CBOR map carried in RelayState meta
+    public func cbor() -> CBOR {
+        var counterMap: [CBOR: CBOR] = [:]
+        for (key, value) in counters { counterMap[.utf8String(key.description)] = .unsignedInt(value) }
+        var gaugeMap: [CBOR: CBOR] = [:]
+        for (key, g) in gauges {
+            gaugeMap[.utf8String(key.description)] = .array([Self.encodeSigned(g.value), Self.encodeSigned(g.highWaterMark)])
+        }
+        var histogramMap: [CBOR: CBOR] = [:]
+        for (key, h) in histograms {
+            histogramMap[.utf8String(key.description)] = .map([
+                .utf8String("count"): .unsignedInt(h.count),
+                .utf8String("sum"): .unsignedInt(h.sum),
+                .utf8String("min"): .unsignedInt(h.min),
+                .utf8String("max"): .unsignedInt(h.max),
+                .utf8String("buckets"): .array(h.buckets.map { .unsignedInt($0) }),
+            ])
+        }
+        return .map([
+            .utf8String("counters"): .map(counterMap),
+            .utf8String("gauges"): .map(gaugeMap),
+            .utf8String("histograms"): .map(histogramMap),
+        ])
+    }
+
+    /// Decode `cbor()` output. Returns nil if the shape doesn't match.
+    public init?(cbor: CBOR) {
+        guard case .map(let root) = cbor,
+              case .map(let counterMap)? = root[.utf8String("counters")],
+              case .map(let gaugeMap)? = root[.utf8String("gauges")],
+              case .map(let histogramMap)? = root[.utf8String("histograms")] else {
+            return nil
+        }
+        var counters: [MetricKey: UInt64] = [:]
+        for (k, v) in counterMap {
+            guard case .utf8String(let name) = k, case .unsignedInt(let value) = v else { return nil }
+            counters[MetricKey(parsing: name)] = value
+        }
+        var gauges: [MetricKey: GaugeSnapshot] = [:]
+        for (k, v) in gaugeMap {
+            guard case .utf8String(let name) = k, case .array(let pair) = v, pair.count == 2,
+                  let value = Self.decodeSigned(pair[0]), let high = Self.decodeSigned(pair[1]) else { return nil }
+            gauges[MetricKey(parsing: name)] = GaugeSnapshot(value: value, highWaterMark: high)
+        }
+        var histograms: [MetricKey: HistogramSnapshot] = [:]
+        for (k, v) in histogramMap {
+            guard case .utf8String(let name) = k, case .map(let fields) = v,
+                  case .unsignedInt(let count)? = fields[.utf8String("count")],
+                  case .unsignedInt(let sum)? = fields[.utf8String("sum")],
+                  case .unsignedInt(let min)? = fields[.utf8String("min")],
+                  case .unsignedInt(let max)? = fields[.utf8String("max")],
+                  case .array(let bucketItems)? = fields[.utf8String("buckets")] else { return nil }
+            var buckets: [UInt64] = []
+            for item in bucketItems {
+                guard case .unsignedInt(let n) = item else { return nil }
+                buckets.append(n)
+            }
+            histograms[MetricKey(parsing: name)] = HistogramSnapshot(count: count, sum: sum, min: min, max: max, buckets: buckets)
+        }
+        self.init(counters: counters, gauges: gauges, histograms: histograms)
+    }
+
+    init(counters: [MetricKey: UInt64], gauges: [MetricKey: GaugeSnapshot], histograms: [MetricKey: HistogramSnapshot]) {
+        self.counters = counters
+        self.gauges = gauges
+        self.histograms = histograms
+    }
+
+    private static func encodeSigned(_ value: Int64) -> CBOR {
+        value >= 0 ? .unsignedInt(UInt64(value)) : .negativeInt(UInt64(-(value + 1)))
+    }
+
+    private static func decodeSigned(_ cbor: CBOR) -> Int64? {
+        switch cbor {
+        case .unsignedInt(let v): return Int64(exactly: v)
+        case .negativeInt(let n): return Int64(exactly: n).map { -1 - $0 }
+        default: return nil
+        }
+    }
+}
+
+// MARK: - Registry
+
+/// Owner of all metrics in a process. Lookups take the registry lock;
+/// updates through a returned handle don't.
+public final class MetricsRegistry: @unchecked Sendable {
+    /// Registry the Bifaci runtime components report into
+    public static let shared = MetricsRegistry()
+
+    private let lock = NSLock()
+    private var counters: [MetricKey: MetricCounter] = [:]
+    private var gauges: [MetricKey: MetricGauge] = [:]
+    private var histograms: [MetricKey: MetricHistogram] = [:]
+
+    public init() {}
+
+    /// Counter for `name`/`label`, created on first use
+    public func counter(_ name: String, label: String? = nil) -> MetricCounter {
+        let key = MetricKey(name, label: label)
+        lock.lock()
+        defer { lock.unlock() }
+        if let existing = counters[key] { return existing }
+        let created = MetricCounter()
+        counters[key] = created
+        return created
+    }
+
+    /// Gauge for `name`/`label`, created on first use
+    public func gauge(_ name: String, label: String? = nil) -> MetricGauge {
+        let key = MetricKey(name, label: label)
+        lock.lock()
+        defer { lock.unlock() }
+        if let existing = gauges[key] { return existing }
+        let created = MetricGauge()
+        gauges[key] = created
+        return created
+    }
+
+    /// Histogram for `name`/`label`, created on first use
+    public func histogram(_ name: String, label: String? = nil) -> MetricHistogram {
+        let key = MetricKey(name, label: label)
+        lock.lock()
+        defer { lock.unlock() }
+        if let existing = histograms[key] { return existing }
+        let created = MetricHistogram()
+        histograms[key] = created
+        return created
+    }
+
+    /// Read every metric. Each metric is read atomically; the set as a whole is not.
+    public func snapshot() -> MetricsSnapshot {
+        lock.lock()
+        let counterRefs = counters
+        let gaugeRefs = gauges
+        let histogramRefs = histograms
+        lock.unlock()
+        return MetricsSnapshot(
+            counters: counterRefs.mapValues { $0.value },
+            gauges: gaugeRefs.mapValues { $0.snapshot() },
+            histograms: histogramRefs.mapValues { $0.snapshot() }
+        )
+    }
+
+    /// Zero counters and histograms and restart gauge high-water marks.
+    /// Gauge levels are kept: they describe live state, not history.
+    public func reset() {
+        lock.lock()
+        let counterRefs = Array(counters.values)
+        let gaugeRefs = Array(gauges.values)
+        let histogramRefs = Array(histograms.values)
+        lock.unlock()
+        counterRefs.forEach { $0.reset() }
+        gaugeRefs.forEach { $0.reset() }
+        histogramRefs.forEach { $0.reset() }
+    }
+}
+
+// MARK: - Per-cap request metrics
+
+/// Handles for the per-cap request metrics of one component
+/// (`<prefix>.request_latency_us`, `<prefix>.request_errors` and, when
+/// asked for, `<prefix>.response_bytes_per_sec`), labeled by a registered cap.
+/// Resolved when a request is routed and carried with it, so finishing a
+/// request never touches the registry.
+struct CapRequestMetrics {
+    let latency: MetricHistogram
+    let errors: MetricCounter
+    let throughput: MetricHistogram?
+
+    /// Caches handles per registered cap, so the label set is bounded by what
+    /// was registered rather than by what peers ask for. Not thread-safe: keep
+    /// it under the lock that guards the component's routing table.
+    struct Cache {
+        private let prefix: String
+        private let recordsThroughput: Bool
+        private var byCap: [String: CapRequestMetrics] = [:]
+
+        init(prefix: String, recordsThroughput: Bool = false) {
+            self.prefix = prefix
+            self.recordsThroughput = recordsThroughput
+        }
+
+        mutating func metrics(for registeredCap: String) -> CapRequestMetrics {
+            if let cached = byCap[registeredCap] { return cached }
+            let registry = MetricsRegistry.shared
+            let resolved = CapRequestMetrics(
+                latency: registry.histogram("\(prefix).request_latency_us", label: registeredCap),
+                errors: registry.counter("\(prefix).request_errors", label: registeredCap),
+                throughput: recordsThroughput
+                    ? registry.histogram("\(prefix).response_bytes_per_sec", label: registeredCap)
+                    : nil
+            )
+            byCap[registeredCap] = resolved
+            return resolved
+        }
+    }
+}
@@ -12,6 +12,9 @@
 //  - Heartbeat health monitoring per plugin
 //  - Plugin death detection and ERR propagation
 //  - Aggregate capability advertisement
+//  - Pre-warmed instances: several processes per binary path, spawned ahead
+//    of the first REQ
+//  - Load-aware dispatch across plugins registered with equivalent caps
 //
 //  Architecture:
 //
@@ -171,6 +174,25 @@ private struct RxidKey: Hashable {
     let rid: MessageId
 }
 
+/// Metrics bookkeeping for a relay request a plugin is handling
+private struct RequestTiming {
+    /// Per-cap metrics of the registered cap the REQ was routed to
+    let metrics: CapRequestMetrics
+    let pluginIdx: Int
+    /// `metricsClock()` when the REQ was written to the plugin
+    let startedAt: UInt64
+    /// CHUNK payload bytes the plugin has sent back so far
+    var responseBytes: UInt64 = 0
+}
+
+/// Manifest from a plugin binary's last successful HELLO, with its parsed caps.
+/// A respawn that presents the same manifest bytes reuses `caps` instead of
+/// re-validating it.
+private struct CachedManifest {
+    let manifest: Data
+    let caps: [String]
+}
+
 /// Interval between heartbeat probes (seconds).
 private let HEARTBEAT_INTERVAL: TimeInterval = 30.0
 
@@ -192,6 +214,15 @@ enum ShutdownReason {
 
 private class ManagedPlugin {
     let path: String
+    /// 0 for the registered plugin; 1... for extra pre-warmed processes of the same binary.
+    let instance: Int
+    /// Held for the whole spawn so a pre-warm and an on-demand spawn of the
+    /// same instance never both launch a process.
+    let spawnLock = NSLock()
+    /// Set while a background warm-up spawn is queued or running.
+    var warming: Bool
+    /// Relay requests dispatched to this process that haven't sent END/ERR yet.
+    var inFlight: Int
     var pid: pid_t?
     var stdinHandle: FileHandle?
     var stdoutHandle: FileHandle?
@@ -219,9 +250,14 @@ private class ManagedPlugin {
     var memoryFootprintMb: UInt64
     /// Resident set size in MB (self-reported via heartbeat response meta).
     var memoryRssMb: UInt64
+    /// Returns CHUNK credits to the plugin. nil when the HELLOs negotiated no flow window.
+    var creditReturner: FlowCreditReturner?
 
-    init(path: String, knownCaps: [String]) {
+    init(path: String, knownCaps: [String], instance: Int = 0) {
         self.path = path
+        self.instance = instance
+        self.warming = false
+        self.inFlight = 0
         self.manifest = Data()
         self.limits = Limits()
         self.caps = []
@@ -303,7 +339,15 @@ public final class PluginHost: @unchecked Sendable {
     private var plugins: [ManagedPlugin] = []
 
     /// Routing: cap_urn -> plugin index.
-    private var capTable: [(String, Int)] = []
+    /// Any mutation marks `capIndex` stale; it is recompiled on the next lookup.
+    private var capTable: [(String, Int)] = [] {
+        didSet { capIndexStale = true }
+    }
+
+    /// Compiled form of `capTable` (pre-parsed URNs + recent resolutions).
+    /// Protected by stateLock.
+    private var capIndex = CapDispatchIndex<Int>()
+    private var capIndexStale = false
 
     /// List 1: OUTGOING_RIDS — tracks peer requests sent BY plugins (RID → plugin_idx).
     /// Used for death cleanup (ERR all pending peer requests when plugin dies).
@@ -317,6 +361,10 @@ public final class PluginHost: @unchecked Sendable {
     /// appears in both outgoing and incoming maps.
     private var incomingRxids: [RxidKey: Int] = [:]
 
+    /// Relay requests awaiting the plugin's END/ERR, for latency and throughput
+    /// metrics. Unlike incomingRxids this is cleaned up on the terminal frame.
+    private var requestTimings: [RxidKey: RequestTiming] = [:]
+
     /// Aggregate capabilities (serialized JSON manifest of all plugin caps).
     private var _capabilities: Data = Data()
 
@@ -340,13 +388,42 @@ public final class PluginHost: @unchecked Sendable {
     /// Whether the host is closed.
     private var closed = false
 
+    /// Processes to keep warm per binary path (see `setPrewarm`). Protected by stateLock.
+    private var prewarmInstances: [String: Int] = [:]
+
+    /// Last HELLO manifest per binary path. Protected by stateLock.
+    private var manifestCache: [String: CachedManifest] = [:]
+
+    /// Chooses among running plugins serving a cap equally well. Protected by stateLock.
+    private var dispatchPolicy: DispatchPolicy = DEFAULT_DISPATCH_POLICY
+
+    /// Per-cap metrics, keyed by registered cap. Protected by stateLock.
+    private var capMetrics = CapRequestMetrics.Cache(prefix: "plugin_host", recordsThroughput: true)
+
+    /// Chunk checksum offered in every plugin HELLO. Plugins that also offer
+    /// it get it; everyone else stays on FNV-1a.
+    private let checksumPreference: ChecksumAlgorithm
+
+    // Process-wide metrics (MetricsRegistry.shared); per-cap ones are resolved
+    // once per registered cap (`capMetrics`) and carried in the RequestTiming
+    private static let requestsInFlight = MetricsRegistry.shared.gauge("plugin_host.requests_in_flight")
+    private static let bytesToPlugins = MetricsRegistry.shared.counter("plugin_host.bytes_to_plugins")
+    private static let bytesFromPlugins = MetricsRegistry.shared.counter("plugin_host.bytes_from_plugins")
+    private static let noHandler = MetricsRegistry.shared.counter("plugin_host.no_handler")
+
     // MARK: - Initialization
 
     /// Create a new plugin host runtime.
     ///
     /// After creation, register plugins with `registerPlugin()` or
     /// attach pre-connected plugins with `attachPlugin()`, then call `run()`.
-    public init() {}
+    ///
+    /// - Parameter checksum: Chunk checksum algorithm to prefer in plugin
+    ///   handshakes. FNV-1a unless given; `.xxh64` is used with every plugin
+    ///   whose HELLO offers it too.
+    public init(checksum: ChecksumAlgorithm = .fnv1a) {
+        self.checksumPreference = checksum
+    }
 
     // MARK: - Plugin Management
 
@@ -358,7 +435,10 @@ public final class PluginHost: @unchecked Sendable {
     /// - Parameters:
     ///   - path: Path to plugin binary
     ///   - knownCaps: Cap URNs this plugin is expected to handle
-    public func registerPlugin(path: String, knownCaps: [String]) {
+    ///   - manifest: The binary's manifest if the caller already has it (e.g. from
+    ///     discovery). When the spawned plugin's HELLO carries the same bytes, the
+    ///     host skips parsing and validating it again.
+    public func registerPlugin(path: String, knownCaps: [String], manifest: Data? = nil) {
         stateLock.lock()
         let plugin = ManagedPlugin(path: path, knownCaps: knownCaps)
         let idx = plugins.count
@@ -366,10 +446,95 @@ public final class PluginHost: @unchecked Sendable {
         for cap in knownCaps {
             capTable.append((cap, idx))
         }
+        if let manifest = manifest, let caps = try? Self.extractCaps(from: manifest) {
+            manifestCache[path] = CachedManifest(manifest: manifest, caps: caps)
+        }
         rebuildCapabilities()
         stateLock.unlock()
     }
 
+    /// Keep `instances` processes of the plugin binary at `path` warm.
+    ///
+    /// `run()` spawns them in the background as soon as it starts, so the first
+    /// REQ for one of their caps doesn't wait for posix_spawn and the HELLO
+    /// handshake. With more than one instance, REQs go to the running instance
+    /// with the fewest requests in flight, and a cold instance is warmed up in
+    /// the background once every warm one is busy (see `setDispatchPolicy`). Call `prewarmPlugins()` to
+    /// top the pool up again later, e.g. when the app goes idle.
+    ///
+    /// - Parameters:
+    ///   - path: Binary path previously passed to `registerPlugin` or `syncRegistrations`
+    ///   - instances: Processes to keep available; 0 turns pre-warming off
+    public func setPrewarm(path: String, instances: Int) {
+        stateLock.lock()
+        defer { stateLock.unlock() }
+        if instances > 0 {
+            prewarmInstances[path] = instances
+            ensureInstancesLocked(path: path, count: instances)
+        } else {
+            prewarmInstances.removeValue(forKey: path)
+        }
+    }
+
+    /// Set how REQs are spread across plugins registered with equivalent caps,
+    /// including pre-warm instances of one binary.
+    ///
+    /// `.weighted` has no per-plugin weights here and behaves like `.leastInFlight`.
+    /// With `.first`, REQs always go to the first registered plugin, exactly
+    /// as if there were no other candidates.
+    public func setDispatchPolicy(_ policy: DispatchPolicy) {
+        stateLock.lock()
+        dispatchPolicy = policy
+        stateLock.unlock()
+    }
+
+    /// Spawn every configured pre-warm instance that isn't running yet.
+    ///
+    /// Blocks until each spawn has finished or failed. Safe to call while
+    /// `run()` is active — an instance being spawned on demand at the same
+    /// time is only launched once.
+    ///
+    /// - Returns: Number of processes started
+    @discardableResult
+    public func prewarmPlugins() -> Int {
+        stateLock.lock()
+        var targets: [Int] = []
+        for (path, count) in prewarmInstances where !closed {
+            ensureInstancesLocked(path: path, count: count)
+            for (idx, plugin) in plugins.enumerated()
+            where plugin.path == path && plugin.instance < count && !plugin.running && !plugin.helloFailed {
+                targets.append(idx)
+            }
+        }
+        stateLock.unlock()
+
+        var started = 0
+        for idx in targets {
+            do {
+                try spawnPlugin(at: idx)
+                started += 1
+            } catch {
+                fputs("[PluginHost] Pre-warm of plugin \(idx) failed: \(error.localizedDescription)\n", stderr)
+            }
+        }
+        return started
+    }
+
+    /// Add spare instances of the plugin at `path` until there are `count`.
+    /// No-op for paths that aren't registered. Must hold stateLock.
+    private func ensureInstancesLocked(path: String, count: Int) {
+        let existing = plugins.filter { $0.path == path }
+        guard let primary = existing.first(where: { $0.instance == 0 }), !primary.helloFailed else { return }
+        for instance in existing.count..<max(existing.count, count) {
+            let spare = ManagedPlugin(path: path, knownCaps: primary.knownCaps, instance: instance)
+            let idx = plugins.count
+            plugins.append(spare)
+            for cap in spare.knownCaps {
+                capTable.append((cap, idx))
+            }
+        }
+    }
+
     /// Reconcile the host's plugin state with the current on-disk truth.
     ///
     /// After a rescan, the XPC service calls this instead of accumulating
@@ -428,6 +593,7 @@ public final class PluginHost: @unchecked Sendable {
                 plugin.helloFailed = true  // Prevent on-demand spawn
                 plugin.knownCaps = []      // Remove from capTable rebuild
                 plugin.caps = []
+                manifestCache.removeValue(forKey: plugin.path)
             }
         }
 
@@ -461,8 +627,8 @@ public final class PluginHost: @unchecked Sendable {
         let reader = FrameReader(handle: stdoutHandle)
         let writer = FrameWriter(handle: stdinHandle)
 
-        // Perform HELLO handshake
-        let ourLimits = Limits()
+        // Perform HELLO handshake (offering per-flow CHUNK credits)
+        let ourLimits = Limits(checksum: checksumPreference, flowWindow: DEFAULT_FLOW_WINDOW)
         let ourHello = Frame.hello(limits: ourLimits)
         try writer.write(ourHello)
 
@@ -490,7 +656,9 @@ public final class PluginHost: @unchecked Sendable {
         let negotiatedLimits = Limits(
             maxFrame: min(ourLimits.maxFrame, theirMaxFrame),
             maxChunk: min(ourLimits.maxChunk, theirMaxChunk),
-            maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer)
+            maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer),
+            checksum: ChecksumAlgorithm.negotiate(preferred: ourLimits.checksum, offered: theirHello.helloChecksumAlgorithms),
+            flowWindow: Limits.negotiateFlowWindow(ourLimits.flowWindow, theirHello.helloFlowWindow)
         )
         writer.setLimits(negotiatedLimits)
         reader.setLimits(negotiatedLimits)
@@ -506,6 +674,7 @@ public final class PluginHost: @unchecked Sendable {
         plugin.stdinHandle = stdinHandle
         plugin.stdoutHandle = stdoutHandle
         plugin.writer = writer
+        plugin.creditReturner = negotiatedLimits.flowWindow > 0 ? FlowCreditReturner(window: negotiatedLimits.flowWindow) : nil
 
         stateLock.lock()
         let idx = plugins.count
@@ -542,22 +711,74 @@ public final class PluginHost: @unchecked Sendable {
     }
 
     /// Internal: find plugin for cap (must hold stateLock).
+    ///
+    /// Exact string match first, then the first registered cap (in capTable
+    /// order) that the request accepts. Both run against `capIndex`, which is
+    /// recompiled only after capTable changes.
     private func findPluginForCapLocked(_ capUrn: String) -> Int? {
-        // Exact string match first (fast path)
-        for (registeredCap, idx) in capTable {
-            if registeredCap == capUrn { return idx }
+        if capIndexStale {
+            capIndex.rebuild(capTable.map { (capUrn: $0.0, target: $0.1) })
+            capIndexStale = false
+        }
+        return capIndex.firstMatch(for: capUrn)
+    }
+
+    /// Choose which of the plugins registered with equivalent caps gets the
+    /// next REQ. `candidates` comes from `capIndex.firstMatches` and starts
+    /// with `matched`, the plain first match.
+    ///
+    /// Running candidates are weighed by `dispatchPolicy`; if none is running,
+    /// the first one is spawned on demand. When the chosen plugin is already
+    /// busy, `warm` names a cold candidate to spawn in the background so the
+    /// following REQ has somewhere idle to go. Must hold stateLock.
+    private func pickPluginLocked(_ candidates: [Int], matched: Int) -> (target: Int, warm: Int?) {
+        guard dispatchPolicy != .first else { return (matched, nil) }
+        var live: [Int] = []
+        for idx in candidates where !plugins[idx].helloFailed && !live.contains(idx) {
+            live.append(idx)
         }
+        guard live.count > 1 else { return (live.first ?? matched, nil) }
+
+        let running = live.filter { plugins[$0].running }
+        guard !running.isEmpty else { return (live[0], nil) }
+        let best = dispatchPolicy.choose(running.map { DispatchCandidate(target: $0, inFlight: plugins[$0].inFlight) })
 
-        // URN-level semantic matching (slow path)
-        guard let requestUrn = try? CSCapUrn.fromString(capUrn) else { return nil }
-        for (registeredCap, idx) in capTable {
-            if let registeredUrn = try? CSCapUrn.fromString(registeredCap) {
-                // Request is pattern, registered cap is instance
-                if requestUrn.accepts(registeredUrn) { return idx }
+        guard plugins[best].inFlight > 0,
+              let cold = live.first(where: { !plugins[$0].running && !plugins[$0].warming && !plugins[$0].path.isEmpty }) else {
+            return (best, nil)
+        }
+        plugins[cold].warming = true
+        return (best, cold)
+    }
+
+    /// Spawn the instance at `idx` on its own thread (it was marked `warming`).
+    private func warmUpInBackground(_ idx: Int) {
+        let thread = Thread { [weak self] in
+            guard let self = self else { return }
+            do {
+                try self.spawnPlugin(at: idx)
+            } catch {
+                fputs("[PluginHost] Warm-up of plugin \(idx) failed: \(error.localizedDescription)\n", stderr)
             }
+            self.stateLock.lock()
+            self.plugins[idx].warming = false
+            self.stateLock.unlock()
         }
+        thread.name = "PluginHost.warmup[\(idx)]"
+        thread.start()
+    }
 
-        return nil
+    /// Point capTable's entries for `idx` at `caps`. When they already match —
+    /// the usual case when a plugin respawns with the manifest it had before —
+    /// capTable is left alone, so the compiled capIndex stays valid.
+    /// Must hold stateLock.
+    private func replaceCapTableEntriesLocked(_ idx: Int, caps: [String]) {
+        let current = capTable.compactMap { $0.1 == idx ? $0.0 : nil }
+        guard current != caps else { return }
+        capTable.removeAll { $0.1 == idx }
+        for cap in caps {
+            capTable.append((cap, idx))
+        }
     }
 
     // MARK: - Main Run Loop
@@ -606,6 +827,18 @@ public final class PluginHost: @unchecked Sendable {
         relayThread.name = "PluginHost.relay"
         relayThread.start()
 
+        // Warm up configured plugins off the event loop so relay frames keep flowing
+        stateLock.lock()
+        let hasPrewarm = !prewarmInstances.isEmpty
+        stateLock.unlock()
+        if hasPrewarm {
+            let prewarmThread = Thread { [weak self] in
+                self?.prewarmPlugins()
+            }
+            prewarmThread.name = "PluginHost.prewarm"
+            prewarmThread.start()
+        }
+
         // Main loop: wait for events from any source (relay or plugins)
         while true {
             eventSemaphore.wait()
@@ -662,16 +895,24 @@ public final class PluginHost: @unchecked Sendable {
             }
 
             stateLock.lock()
-            guard let pluginIdx = findPluginForCapLocked(capUrn) else {
+            guard let matchedIdx = findPluginForCapLocked(capUrn) else {
                 stateLock.unlock()
+                Self.noHandler.increment()
                 var err = Frame.err(id: frame.id, code: "NO_HANDLER", message: "No plugin handles cap: \(capUrn)")
                 err.routingId = xid
                 sendToRelay(err)
                 return
             }
+            let (pluginIdx, warmIdx) = pickPluginLocked(capIndex.firstMatches(for: capUrn), matched: matchedIdx)
+            // Labeled by the registered cap, never the relay-supplied request string
+            let metrics = capMetrics.metrics(for: capIndex.firstMatchedCap(for: capUrn) ?? capUrn)
             let needsSpawn = !plugins[pluginIdx].running && !plugins[pluginIdx].helloFailed
             stateLock.unlock()
 
+            if let warmIdx = warmIdx {
+                warmUpInBackground(warmIdx)
+            }
+
             // Spawn on demand if registered but not running
             if needsSpawn {
                 do {
@@ -689,10 +930,15 @@ public final class PluginHost: @unchecked Sendable {
             stateLock.lock()
             incomingRxids[key] = pluginIdx
             let plugin = plugins[pluginIdx]
+            plugin.inFlight += 1
+            requestTimings[key] = RequestTiming(metrics: metrics, pluginIdx: pluginIdx, startedAt: metricsClock())
             stateLock.unlock()
+            Self.requestsInFlight.add(1)
 
             os_log(.debug, log: Self.log, "[handleRelayFrame] REQ dispatched to plugin %d cap=%{public}@ xid=%{public}@ rid=%{public}@", pluginIdx, String(describing: frame.cap), String(describing: xid), String(describing: frame.id))
-            if !plugin.writeFrame(frame) {
+            var dispatched = frame
+            dispatched.recordTraceSpan(hop: TraceHop.pluginHost, event: "dispatch")
+            if !plugin.writeFrame(dispatched) {
                 // Plugin is dead — send ERR with XID and clean up
                 let deathMsg = plugin.lastDeathMessage ?? "Plugin exited while processing request"
                 var err = Frame.err(id: frame.id, code: "PLUGIN_DIED", message: deathMsg)
@@ -700,7 +946,13 @@ public final class PluginHost: @unchecked Sendable {
                 sendToRelay(err)
                 stateLock.lock()
                 incomingRxids.removeValue(forKey: key)
+                plugin.inFlight = max(0, plugin.inFlight - 1)
+                let timing = requestTimings.removeValue(forKey: key)
                 stateLock.unlock()
+                if timing != nil {
+                    Self.requestsInFlight.add(-1)
+                    metrics.errors.increment()
+                }
             }
 
         case .streamStart, .chunk, .streamEnd, .end, .err:
@@ -727,6 +979,9 @@ public final class PluginHost: @unchecked Sendable {
             }
             let plugin = plugins[resolvedIdx]
             stateLock.unlock()
+            if frame.frameType == .chunk, let payload = frame.payload {
+                Self.bytesToPlugins.increment(by: UInt64(payload.count))
+            }
 
             // If the plugin is dead, send ERR to engine with XID and clean up
             if !plugin.writeFrame(frame) {
@@ -762,7 +1017,7 @@ public final class PluginHost: @unchecked Sendable {
             }
             // If not a peer response LOG, ignore silently (e.g., stale routing)
 
-        case .hello, .heartbeat:
+        case .hello, .heartbeat, .credit:
             // These should never arrive from the engine through the relay
             fputs("[PluginHost] Protocol error: \(frame.frameType) from relay\n", stderr)
 
@@ -818,6 +1073,10 @@ public final class PluginHost: @unchecked Sendable {
             // Plugins must never send relay frames
             fputs("[PluginHost] Protocol error: relay frame \(frame.frameType) from plugin \(pluginIdx)\n", stderr)
 
+        case .credit:
+            // Only the host grants credits (plugin → host CHUNKs); never forward
+            fputs("[PluginHost] Protocol error: CREDIT from plugin \(pluginIdx)\n", stderr)
+
         case .req:
             // Plugin peer invoke — record in OUTGOING_RIDS and track max-seen seq.
             // Plugins MUST NOT send XID (that's a relay-level concept).
@@ -833,16 +1092,76 @@ public final class PluginHost: @unchecked Sendable {
             // Track max-seen seq for flow, clean up on terminal.
             if frame.isFlowFrame() {
                 let flowKey = FlowKey.fromFrame(frame)
+                let chunkBytes = frame.frameType == .chunk ? UInt64(frame.payload?.count ?? 0) : 0
+                var finished: RequestTiming?
                 stateLock.lock()
                 let isTerminal = frame.frameType == .end || frame.frameType == .err
                 if isTerminal {
                     outgoingMaxSeq.removeValue(forKey: flowKey)
+                    // Responses to relay requests carry the XID; peer requests never do
+                    if let xid = frame.routingId {
+                        let plugin = plugins[pluginIdx]
+                        plugin.inFlight = max(0, plugin.inFlight - 1)
+                        finished = requestTimings.removeValue(forKey: RxidKey(xid: xid, rid: frame.id))
+                    }
                 } else {
                     outgoingMaxSeq[flowKey] = frame.seq
+                    if chunkBytes > 0, let xid = frame.routingId {
+                        requestTimings[RxidKey(xid: xid, rid: frame.id)]?.responseBytes += chunkBytes
+                    }
                 }
                 stateLock.unlock()
+                if chunkBytes > 0 {
+                    Self.bytesFromPlugins.increment(by: chunkBytes)
+                }
+                if let timing = finished {
+                    recordFinished(timing, failed: frame.frameType == .err)
+                }
             }
-            sendToRelay(frame)
+            var forwarded = frame
+            if frame.carriesTrace {
+                forwarded.recordTraceSpan(hop: TraceHop.pluginHost, event: "response")
+            }
+            sendToRelay(forwarded)
+            returnCredits(pluginIdx: pluginIdx, after: frame)
+        }
+    }
+
+    /// Record latency and response throughput for a relay request that ended.
+    private func recordFinished(_ timing: RequestTiming, failed: Bool) {
+        Self.requestsInFlight.add(-1)
+        let elapsedNanos = max(metricsClock() &- timing.startedAt, 1)
+        timing.metrics.latency.record(elapsedNanos / 1_000)
+        if timing.responseBytes > 0, let throughput = timing.metrics.throughput {
+            let bytesPerSecond = Double(timing.responseBytes) * 1e9 / Double(elapsedNanos)
+            throughput.record(UInt64(bytesPerSecond))
+        }
+        if failed {
+            timing.metrics.errors.increment()
+        }
+    }
+
+    /// Give a flow-controlled plugin its CHUNK credits back once a batch of
+    /// them has been written to the relay. Crediting only after the relay
+    /// write means a slow relay throttles the plugin instead of frames piling
+    /// up in the event queue.
+    private func returnCredits(pluginIdx: Int, after frame: Frame) {
+        stateLock.lock()
+        let plugin = plugins[pluginIdx]
+        let returner = plugin.creditReturner
+        stateLock.unlock()
+        guard let returner = returner else { return }
+
+        let flowKey = FlowKey.fromFrame(frame)
+        switch frame.frameType {
+        case .chunk:
+            if let credits = returner.consumed(flowKey) {
+                plugin.writeFrame(Frame.credit(id: frame.id, routingId: frame.routingId, credits: credits))
+            }
+        case .end, .err:
+            returner.remove(flowKey)
+        default:
+            break
         }
     }
 
@@ -863,6 +1182,7 @@ public final class PluginHost: @unchecked Sendable {
         let plugin = plugins[pluginIdx]
         plugin.running = false
         plugin.writer = nil
+        plugin.inFlight = 0
         let reason = plugin.shutdownReason
         plugin.shutdownReason = nil  // Reset for potential respawn
 
@@ -955,6 +1275,10 @@ public final class PluginHost: @unchecked Sendable {
         for entry in failedIncoming {
             incomingRxids.removeValue(forKey: entry.key)
         }
+        let abandoned = requestTimings.filter { $0.value.pluginIdx == pluginIdx }
+        for key in abandoned.keys {
+            requestTimings.removeValue(forKey: key)
+        }
 
         // Determine error code and message based on shutdown reason.
         // Both unexpected deaths and OOM kills send ERR frames for pending work.
@@ -986,15 +1310,19 @@ public final class PluginHost: @unchecked Sendable {
         }
 
         // Rebuild capTable for on-demand respawn routing.
-        capTable.removeAll { $0.1 == pluginIdx }
-        if !plugin.helloFailed {
-            for cap in plugin.knownCaps {
-                capTable.append((cap, pluginIdx))
-            }
-        }
+        replaceCapTableEntriesLocked(pluginIdx, caps: plugin.helloFailed ? [] : plugin.knownCaps)
         rebuildCapabilities()
         stateLock.unlock()
 
+        if !abandoned.isEmpty {
+            Self.requestsInFlight.add(-Int64(abandoned.count))
+            if errInfo != nil {
+                for timing in abandoned.values {
+                    timing.metrics.errors.increment()
+                }
+            }
+        }
+
         // Send ERR frames for all pending work (unexpected death and OOM kill).
         if let info = errInfo {
             for entry in failedOutgoing {
@@ -1096,6 +1424,7 @@ public final class PluginHost: @unchecked Sendable {
     ///
     /// Includes caps from ALL registered plugins that haven't permanently failed HELLO.
     /// Running plugins use their actual manifest caps; non-running plugins use knownCaps.
+    /// Spare pre-warm instances are skipped — they serve the same caps as instance 0.
     /// This ensures the relay always advertises all caps that CAN be handled, regardless
     /// of whether the plugin process is currently alive (on-demand spawn handles restarts).
     ///
@@ -1105,17 +1434,11 @@ public final class PluginHost: @unchecked Sendable {
         // CAP_IDENTITY is always present — structural, not plugin-dependent
         var capUrns: [String] = [CSCapIdentity]
 
-        for plugin in plugins where !plugin.helloFailed {
+        for plugin in plugins where !plugin.helloFailed && plugin.instance == 0 {
             if plugin.running {
-                // Running: use actual caps from manifest (verified via HELLO handshake)
-                if !plugin.manifest.isEmpty,
-                   let json = try? JSONSerialization.jsonObject(with: plugin.manifest) as? [String: Any],
-                   let caps = json["caps"] as? [[String: Any]] {
-                    for cap in caps {
-                        if let urn = cap["urn"] as? String, urn != CSCapIdentity {
-                            capUrns.append(urn)
-                        }
-                    }
+                // Running: use actual caps from manifest (parsed once at HELLO handshake)
+                for urn in plugin.caps where urn != CSCapIdentity {
+                    capUrns.append(urn)
                 }
             } else {
                 // Not running: use knownCaps (from discovery, available for on-demand spawn)
@@ -1253,21 +1576,32 @@ public final class PluginHost: @unchecked Sendable {
     ///
     /// Performs posix_spawn + HELLO handshake + starts reader thread.
     /// Does NOT hold stateLock during blocking operations (handshake).
+    /// Concurrent calls for the same instance (pre-warm vs. on demand) are
+    /// serialized; the later one finds the plugin running and returns.
     ///
     /// - Parameter idx: Plugin index in the plugins array
     /// - Throws: PluginHostError if spawn or handshake fails
     private func spawnPlugin(at idx: Int) throws {
+        stateLock.lock()
+        let spawnLock = plugins[idx].spawnLock
+        stateLock.unlock()
+        spawnLock.lock()
+        defer { spawnLock.unlock() }
+
         // Read plugin info without holding lock during blocking ops
         stateLock.lock()
         let path = plugins[idx].path
         let alreadyRunning = plugins[idx].running
         let alreadyFailed = plugins[idx].helloFailed
+        let hostClosed = closed
+        let cached = manifestCache[path]
         stateLock.unlock()
 
         guard !path.isEmpty else {
             throw PluginHostError.handshakeFailed("No binary path for plugin \(idx)")
         }
         guard !alreadyRunning else { return }
+        guard !hostClosed else { throw PluginHostError.closed }
         guard !alreadyFailed else {
             throw PluginHostError.handshakeFailed("Plugin previously failed HELLO — permanently removed")
         }
@@ -1316,9 +1650,10 @@ public final class PluginHost: @unchecked Sendable {
         let stdoutHandle = outputPipe.fileHandleForReading
         let stderrHandle = errorPipe.fileHandleForReading
 
-        // HELLO handshake (blocking — stateLock NOT held)
+        // HELLO handshake (blocking — stateLock NOT held), offering per-flow CHUNK
+        // credits and, since the child is local by construction, a shared memory ring
         let reader = FrameReader(handle: stdoutHandle)
-        let writer = FrameWriter(handle: stdinHandle)
+        let writer = FrameWriter(handle: stdinHandle, limits: Limits(checksum: checksumPreference, flowWindow: DEFAULT_FLOW_WINDOW, sharedMemoryRing: DEFAULT_SHARED_MEMORY_RING))
 
         let handshakeResult: HandshakeResult
         do {
@@ -1331,16 +1666,27 @@ public final class PluginHost: @unchecked Sendable {
             stdoutHandle.closeFile()
             stderrHandle.closeFile()
 
+            // Every instance runs the same binary, so they all go
             stateLock.lock()
-            plugins[idx].helloFailed = true
-            capTable.removeAll { $0.1 == idx }
+            for plugin in plugins where plugin.path == path {
+                plugin.helloFailed = true
+            }
+            capTable.removeAll { plugins[$0.1].path == path }
+            manifestCache.removeValue(forKey: path)
             rebuildCapabilities()
             stateLock.unlock()
 
             throw PluginHostError.handshakeFailed("HELLO failed for \(path): \(error.localizedDescription)")
         }
 
-        let caps = try Self.extractCaps(from: handshakeResult.manifest ?? Data())
+        // A respawn normally presents the manifest we already validated
+        let manifest = handshakeResult.manifest ?? Data()
+        let caps: [String]
+        if let cached = cached, cached.manifest == manifest {
+            caps = cached.caps
+        } else {
+            caps = try Self.extractCaps(from: manifest)
+        }
 
         // Update plugin state under lock
         stateLock.lock()
@@ -1350,16 +1696,15 @@ public final class PluginHost: @unchecked Sendable {
         plugin.stdoutHandle = stdoutHandle
         plugin.stderrHandle = stderrHandle
         plugin.writer = writer
-        plugin.manifest = handshakeResult.manifest ?? Data()
+        plugin.manifest = manifest
         plugin.limits = handshakeResult.limits
+        plugin.creditReturner = handshakeResult.limits.flowWindow > 0 ? FlowCreditReturner(window: handshakeResult.limits.flowWindow) : nil
         plugin.caps = caps
         plugin.running = true
+        manifestCache[path] = CachedManifest(manifest: manifest, caps: caps)
 
         // Update capTable with actual caps from manifest
-        capTable.removeAll { $0.1 == idx }
-        for cap in caps {
-            capTable.append((cap, idx))
-        }
+        replaceCapTableEntriesLocked(idx, caps: caps)
         rebuildCapabilities()
         stateLock.unlock()
 
@@ -88,6 +88,34 @@ public enum StreamError: Error {
 /// Internal to the runtime — handlers never see this.
 protocol FrameSender: Sendable {
     func send(_ frame: Frame) throws
+    /// Like send, but waits for flow credits by suspending the task instead
+    /// of parking the thread
+    func sendAsync(_ frame: Frame) async throws
+    /// Checksum algorithm negotiated with the receiving peer
+    var checksumAlgorithm: ChecksumAlgorithm { get }
+}
+
+extension FrameSender {
+    var checksumAlgorithm: ChecksumAlgorithm { .fnv1a }
+
+    /// Senders that never wait for credits just send
+    func sendAsync(_ frame: Frame) async throws {
+        try send(frame)
+    }
+}
+
+/// Append one chunk's bytes for collectBytes: inner bytes of byteString/utf8String,
+/// the CBOR encoding of anything else.
+func appendChunkBytes(_ item: CBOR, to result: inout Data) {
+    switch item {
+    case .byteString(let bytes):
+        result.append(contentsOf: bytes)
+    case .utf8String(let str):
+        result.append(contentsOf: str.utf8)
+    default:
+        // For non-byte types, CBOR-encode them
+        result.append(contentsOf: item.encode())
+    }
 }
 
 /// A single input stream — yields decoded CBOR values from CHUNK frames.
@@ -112,17 +140,7 @@ public final class InputStream: Sequence, @unchecked Sendable {
     public func collectBytes() throws -> Data {
         var result = Data()
         for itemResult in self {
-            let item = try itemResult.get()
-            switch item {
-            case .byteString(let bytes):
-                result.append(contentsOf: bytes)
-            case .utf8String(let str):
-                result.append(str.data(using: .utf8) ?? Data())
-            default:
-                // For non-byte types, CBOR-encode them
-                let encoded = Data(item.encode())
-                result.append(encoded)
-            }
+            appendChunkBytes(try itemResult.get(), to: &result)
         }
         return result
     }
@@ -344,35 +362,50 @@ public final class OutputStream: @unchecked Sendable {
         _mediaUrn
     }
 
-    private func ensureStarted() throws {
+    /// Claim the STREAM_START slot. Returns the frame to send if this call won it.
+    private func takeStartFrame() -> Frame? {
         streamStartedLock.lock()
         let alreadyStarted = _streamStarted
-        if !alreadyStarted {
-            _streamStarted = true
-        }
+        _streamStarted = true
         streamStartedLock.unlock()
 
-        if !alreadyStarted {
-            var startFrame = Frame.streamStart(
-                reqId: requestId,
-                streamId: streamId,
-                mediaUrn: _mediaUrn
-            )
-            startFrame.routingId = routingId
+        guard !alreadyStarted else { return nil }
+        var startFrame = Frame.streamStart(
+            reqId: requestId,
+            streamId: streamId,
+            mediaUrn: _mediaUrn
+        )
+        startFrame.routingId = routingId
+        return startFrame
+    }
+
+    private func ensureStarted() throws {
+        if let startFrame = takeStartFrame() {
             try sender.send(startFrame)
         }
     }
 
+    private func ensureStartedAsync() async throws {
+        if let startFrame = takeStartFrame() {
+            try await sender.sendAsync(startFrame)
+        }
+    }
+
     private func sendChunk(_ value: CBOR) throws {
-        let cborPayload = Data(value.encode())
+        try sendChunkPayload(Data(value.encode()))
+    }
 
+    /// Build the next CHUNK frame. `cborPayload` may be a slice of a larger
+    /// buffer; it is written out without another copy.
+    private func chunkFrame(_ cborPayload: Data) -> Frame {
         chunkStateLock.lock()
         let currentChunkIndex = _chunkIndex
         _chunkIndex += 1
         _chunkCount += 1
         chunkStateLock.unlock()
 
-        let checksum = Frame.computeChecksum(cborPayload)
+        let algorithm = sender.checksumAlgorithm
+        let checksum = Frame.computeChecksum(cborPayload, algorithm: algorithm)
         var frame = Frame.chunk(
             reqId: requestId,
             streamId: streamId,
@@ -381,22 +414,41 @@ public final class OutputStream: @unchecked Sendable {
             chunkIndex: currentChunkIndex,
             checksum: checksum
         )
+        frame.checksumAlgorithm = algorithm
         frame.routingId = routingId
-        try sender.send(frame)
+        return frame
+    }
+
+    /// Send already-encoded bytes as one CHUNK.
+    private func sendChunkPayload(_ cborPayload: Data) throws {
+        try sender.send(chunkFrame(cborPayload))
+    }
+
+    private func sendChunkPayloadAsync(_ cborPayload: Data) async throws {
+        try await sender.sendAsync(chunkFrame(cborPayload))
     }
 
     /// Write raw bytes. Splits into maxChunk pieces, each wrapped as CBOR byteString.
     /// Auto-sends STREAM_START before first chunk.
     public func write(_ data: Data) throws {
         try ensureStarted()
-        if data.isEmpty {
-            return
+        var offset = 0
+        while offset < data.count {
+            let chunkSize = min(data.count - offset, maxChunk)
+            // Same bytes as CBOR.byteString(...).encode(), without the [UInt8] round trip
+            try sendChunkPayload(encodeCborByteString(data[(data.startIndex + offset)..<(data.startIndex + offset + chunkSize)]))
+            offset += chunkSize
         }
+    }
+
+    /// Async `write`: while the flow is out of credits the calling task
+    /// suspends instead of blocking its thread.
+    public func writeAsync(_ data: Data) async throws {
+        try await ensureStartedAsync()
         var offset = 0
         while offset < data.count {
             let chunkSize = min(data.count - offset, maxChunk)
-            let chunkBytes = data.subdata(in: offset..<(offset + chunkSize))
-            try sendChunk(.byteString([UInt8](chunkBytes)))
+            try await sendChunkPayloadAsync(encodeCborByteString(data[(data.startIndex + offset)..<(data.startIndex + offset + chunkSize)]))
             offset += chunkSize
         }
     }
@@ -418,25 +470,21 @@ public final class OutputStream: @unchecked Sendable {
         var offset = 0
         while offset < cborBytes.count {
             let chunkSize = min(cborBytes.count - offset, maxChunk)
-            let chunkPayload = cborBytes.subdata(in: offset..<(offset + chunkSize))
-
-            chunkStateLock.lock()
-            let currentChunkIndex = _chunkIndex
-            _chunkIndex += 1
-            _chunkCount += 1
-            chunkStateLock.unlock()
-
-            let checksum = Frame.computeChecksum(chunkPayload)
-            var frame = Frame.chunk(
-                reqId: requestId,
-                streamId: streamId,
-                seq: 0,
-                payload: chunkPayload,
-                chunkIndex: currentChunkIndex,
-                checksum: checksum
-            )
-            frame.routingId = routingId
-            try sender.send(frame)
+            // Slices share cborBytes' storage - no per-chunk copy
+            try sendChunkPayload(cborBytes[offset..<(offset + chunkSize)])
+            offset += chunkSize
+        }
+    }
+
+    /// Async `emitListItem`, suspending while the flow is out of credits.
+    public func emitListItemAsync(_ value: CBOR) async throws {
+        try await ensureStartedAsync()
+        let cborBytes = Data(value.encode())
+
+        var offset = 0
+        while offset < cborBytes.count {
+            let chunkSize = min(cborBytes.count - offset, maxChunk)
+            try await sendChunkPayloadAsync(cborBytes[offset..<(offset + chunkSize)])
             offset += chunkSize
         }
     }
@@ -444,52 +492,18 @@ public final class OutputStream: @unchecked Sendable {
     /// Emit a CBOR value. Handles byteString/utf8String/array/map chunking.
     public func emitCbor(_ value: CBOR) throws {
         try ensureStarted()
-        switch value {
-        case .byteString(let bytes):
-            var offset = 0
-            while offset < bytes.count {
-                let chunkSize = min(bytes.count - offset, maxChunk)
-                let chunkBytes = Array(bytes[offset..<(offset + chunkSize)])
-                try sendChunk(.byteString(chunkBytes))
-                offset += chunkSize
-            }
-
-        case .utf8String(let text):
-            let textBytes = Data(text.utf8)
-            var offset = 0
-            while offset < textBytes.count {
-                var chunkSize = min(textBytes.count - offset, maxChunk)
-                // Ensure we don't split UTF-8 mid-character
-                while chunkSize > 0 {
-                    let chunkData = textBytes.subdata(in: offset..<(offset + chunkSize))
-                    if String(data: chunkData, encoding: .utf8) != nil {
-                        break
-                    }
-                    chunkSize -= 1
-                }
-                if chunkSize == 0 {
-                    throw PluginRuntimeError.handlerError("Cannot split text on character boundary")
-                }
-                let chunkData = textBytes.subdata(in: offset..<(offset + chunkSize))
-                let chunkText = String(data: chunkData, encoding: .utf8)!
-                try sendChunk(.utf8String(chunkText))
-                offset += chunkSize
-            }
-
-        case .array(let elements):
-            for element in elements {
-                try sendChunk(element)
-            }
-
-        case .map(let entries):
-            for (key, val) in entries {
-                let entry = CBOR.array([key, val])
-                try sendChunk(entry)
-            }
+        var pieces = CborChunkPieces(value, maxChunk: maxChunk)
+        while let piece = try pieces.next() {
+            try sendChunk(piece)
+        }
+    }
 
-        default:
-            // Other types (int, float, bool, null): send as single chunk
-            try sendChunk(value)
+    /// Async `emitCbor`, suspending while the flow is out of credits.
+    public func emitCborAsync(_ value: CBOR) async throws {
+        try await ensureStartedAsync()
+        var pieces = CborChunkPieces(value, maxChunk: maxChunk)
+        while let piece = try pieces.next() {
+            try await sendChunkPayloadAsync(Data(piece.encode()))
         }
     }
 
@@ -545,22 +559,18 @@ public final class OutputStream: @unchecked Sendable {
         ProgressSender(sender: sender, requestId: requestId, routingId: routingId)
     }
 
-    /// Close the output stream (sends STREAM_END). Idempotent.
-    /// If stream was never started, sends STREAM_START first.
-    public func close() throws {
+    /// Claim the close. Returns false if the stream was already closed.
+    private func markClosed() -> Bool {
         closedLock.lock()
-        let alreadyClosed = _closed
-        if !alreadyClosed {
-            _closed = true
-        }
-        closedLock.unlock()
-
-        if alreadyClosed {
-            return
+        defer { closedLock.unlock() }
+        if _closed {
+            return false
         }
+        _closed = true
+        return true
+    }
 
-        try ensureStarted()
-
+    private func streamEndFrame() -> Frame {
         chunkStateLock.lock()
         let finalChunkCount = _chunkCount
         chunkStateLock.unlock()
@@ -571,7 +581,88 @@ public final class OutputStream: @unchecked Sendable {
             chunkCount: finalChunkCount
         )
         frame.routingId = routingId
-        try sender.send(frame)
+        return frame
+    }
+
+    /// Close the output stream (sends STREAM_END). Idempotent.
+    /// If stream was never started, sends STREAM_START first.
+    public func close() throws {
+        guard markClosed() else { return }
+        try ensureStarted()
+        try sender.send(streamEndFrame())
+    }
+
+    /// Async `close`. Idempotent, and shares the closed flag with `close()`.
+    public func closeAsync() async throws {
+        guard markClosed() else { return }
+        try await ensureStartedAsync()
+        try await sender.sendAsync(streamEndFrame())
+    }
+}
+
+/// Splits a CBOR value into the values `emitCbor` sends one per CHUNK:
+/// byte and text strings at maxChunk boundaries (text only on character
+/// boundaries), arrays per element, maps per [key, value] entry, anything
+/// else whole.
+private struct CborChunkPieces {
+    private enum Source {
+        case bytes([UInt8])
+        case text(Data)
+        case items([CBOR])
+    }
+
+    private let source: Source
+    private let maxChunk: Int
+    private var offset = 0
+
+    init(_ value: CBOR, maxChunk: Int) {
+        self.maxChunk = maxChunk
+        switch value {
+        case .byteString(let bytes):
+            source = .bytes(bytes)
+        case .utf8String(let text):
+            source = .text(Data(text.utf8))
+        case .array(let elements):
+            source = .items(elements)
+        case .map(let entries):
+            source = .items(entries.map { CBOR.array([$0.key, $0.value]) })
+        default:
+            // Other types (int, float, bool, null): send as single chunk
+            source = .items([value])
+        }
+    }
+
+    mutating func next() throws -> CBOR? {
+        switch source {
+        case .bytes(let bytes):
+            guard offset < bytes.count else { return nil }
+            let chunkSize = min(bytes.count - offset, maxChunk)
+            defer { offset += chunkSize }
+            return .byteString(Array(bytes[offset..<(offset + chunkSize)]))
+
+        case .text(let textBytes):
+            guard offset < textBytes.count else { return nil }
+            var chunkSize = min(textBytes.count - offset, maxChunk)
+            // Ensure we don't split UTF-8 mid-character
+            while chunkSize > 0 {
+                let chunkData = textBytes.subdata(in: offset..<(offset + chunkSize))
+                if String(data: chunkData, encoding: .utf8) != nil {
+                    break
+                }
+                chunkSize -= 1
+            }
+            if chunkSize == 0 {
+                throw PluginRuntimeError.handlerError("Cannot split text on character boundary")
+            }
+            let chunkData = textBytes.subdata(in: offset..<(offset + chunkSize))
+            offset += chunkSize
+            return .utf8String(String(data: chunkData, encoding: .utf8)!)
+
+        case .items(let items):
+            guard offset < items.count else { return nil }
+            defer { offset += 1 }
+            return items[offset]
+        }
     }
 }
 
@@ -668,6 +759,113 @@ public final class PeerCall: @unchecked Sendable {
     }
 }
 
+/// Handle for a peer invocation made by an async Op. Async counterpart of
+/// `PeerCall`: write args with the OutputStream async methods
+/// (`writeAsync`, `emitCborAsync`, `closeAsync`), then `await finish()`.
+public final class AsyncPeerCall: @unchecked Sendable {
+    private let sender: any FrameSender
+    private let requestId: MessageId
+    private let maxChunk: Int
+    private var responses: AsyncStream<Frame>?
+    private let lock = NSLock()
+
+    init(sender: any FrameSender, requestId: MessageId, maxChunk: Int, responses: AsyncStream<Frame>) {
+        self.sender = sender
+        self.requestId = requestId
+        self.maxChunk = maxChunk
+        self.responses = responses
+    }
+
+    /// Create a new arg OutputStream for this peer call.
+    /// Each arg is an independent stream (own stream_id, no routing_id).
+    public func arg(mediaUrn: String) -> OutputStream {
+        OutputStream(
+            sender: sender,
+            streamId: UUID().uuidString,
+            mediaUrn: mediaUrn,
+            requestId: requestId,
+            routingId: nil, // No routing_id for peer requests
+            maxChunk: maxChunk
+        )
+    }
+
+    /// Finish sending args (sends END) and get the peer response.
+    public func finish() async throws -> AsyncPeerResponse {
+        fputs("[PeerCall] finishAsync: sending END for peer_rid=\(requestId)\n", stderr)
+        try await sender.sendAsync(Frame.end(id: requestId, finalPayload: nil))
+
+        lock.lock()
+        guard let stream = responses else {
+            lock.unlock()
+            throw PluginRuntimeError.peerRequestError("PeerCall already finished")
+        }
+        responses = nil
+        lock.unlock()
+        return AsyncPeerResponse(frames: stream)
+    }
+}
+
+/// Response from an async peer call — data items and LOG frames in arrival
+/// order. Async counterpart of `PeerResponse`: the task is suspended, not
+/// blocked, while it waits for the next frame.
+public final class AsyncPeerResponse: AsyncSequence, @unchecked Sendable {
+    public typealias Element = PeerResponseItem
+
+    public struct AsyncIterator: AsyncIteratorProtocol {
+        fileprivate var frames: AsyncStream<Frame>.Iterator
+        private var ended = false
+
+        fileprivate init(frames: AsyncStream<Frame>.Iterator) {
+            self.frames = frames
+        }
+
+        public mutating func next() async -> PeerResponseItem? {
+            while !ended, let frame = await frames.next() {
+                switch peerResponseStep(for: frame) {
+                case .skip:
+                    continue
+                case .item(let item):
+                    return item
+                case .end:
+                    ended = true
+                }
+            }
+            return nil
+        }
+    }
+
+    private let frames: AsyncStream<Frame>
+
+    init(frames: AsyncStream<Frame>) {
+        self.frames = frames
+    }
+
+    public func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(frames: frames.makeAsyncIterator())
+    }
+
+    /// Collect all data chunks into a single byte vector, discarding LOG frames.
+    public func collectBytes() async throws -> Data {
+        var result = Data()
+        for await item in self {
+            if case .data(let dataResult) = item {
+                appendChunkBytes(try dataResult.get(), to: &result)
+            }
+        }
+        return result
+    }
+
+    /// Collect a single CBOR data value (expects exactly one data chunk), discarding LOG frames.
+    public func collectValue() async throws -> CBOR {
+        for await item in self {
+            if case .data(let dataResult) = item {
+                return try dataResult.get()
+            }
+        }
+        throw StreamError.closed
+    }
+}
+
 /// Wrapper to transfer non-Sendable types across concurrency boundaries.
 /// Use with extreme caution — ensures external synchronization.
 private final class UnsafeTransfer<T>: @unchecked Sendable {
@@ -751,51 +949,71 @@ public final class BlockingQueue<T>: @unchecked Sendable {
 /// one at a time as they arrive. Returns immediately — LOG frames are delivered
 /// in real-time, not buffered until data starts. This is critical for keeping
 /// the engine's activity timer alive during long peer calls (e.g., model downloads).
-internal func demuxSingleStream(responseRx: AnyIterator<Frame>, maxChunk: Int) -> PeerResponse {
-    let iterator = AnyIterator<PeerResponseItem> {
-        while let frame = responseRx.next() {
-            switch frame.frameType {
-            case .streamStart:
-                // Structural frame — skip, yield next item
-                continue
+/// What one peer response frame contributes to the response
+internal enum PeerResponseStep {
+    /// Structural frame, nothing to yield
+    case skip
+    case item(PeerResponseItem)
+    /// Terminal frame — the response is done
+    case end
+}
 
-            case .chunk:
-                guard let payload = frame.payload else {
-                    return .data(.failure(.protocolError("CHUNK frame missing payload")))
-                }
+/// Map a peer response frame to its PeerResponseItem. Shared by the blocking
+/// and async peer responses.
+internal func peerResponseStep(for frame: Frame) -> PeerResponseStep {
+    switch frame.frameType {
+    case .streamStart:
+        return .skip
 
-                // Verify checksum (MANDATORY in protocol v2)
-                guard let expectedChecksum = frame.checksum else {
-                    return .data(.failure(.protocolError("CHUNK frame missing required checksum field")))
-                }
-                let actualChecksum = Frame.computeChecksum(payload)
-                if actualChecksum != expectedChecksum {
-                    return .data(.failure(.protocolError("Checksum mismatch: expected=\(expectedChecksum), actual=\(actualChecksum) (payload \(payload.count) bytes)")))
-                }
+    case .chunk:
+        guard let payload = frame.payload else {
+            return .item(.data(.failure(.protocolError("CHUNK frame missing payload"))))
+        }
 
-                do {
-                    guard let value = try CBOR.decode([UInt8](payload)) else {
-                        return .data(.failure(.decode("Failed to decode CBOR chunk - decode returned nil")))
-                    }
-                    return .data(.success(value))
-                } catch {
-                    return .data(.failure(.decode("Failed to decode CBOR chunk: \(error)")))
-                }
+        // Verify checksum (MANDATORY in protocol v2)
+        guard let expectedChecksum = frame.checksum else {
+            return .item(.data(.failure(.protocolError("CHUNK frame missing required checksum field"))))
+        }
+        let actualChecksum = Frame.computeChecksum(payload, algorithm: frame.checksumAlgorithm)
+        if actualChecksum != expectedChecksum {
+            return .item(.data(.failure(.protocolError("Checksum mismatch: expected=\(expectedChecksum), actual=\(actualChecksum) (payload \(payload.count) bytes)"))))
+        }
 
-            case .log:
-                return .log(frame)
+        do {
+            guard let value = try CBOR.decode([UInt8](payload)) else {
+                return .item(.data(.failure(.decode("Failed to decode CBOR chunk - decode returned nil"))))
+            }
+            return .item(.data(.success(value)))
+        } catch {
+            return .item(.data(.failure(.decode("Failed to decode CBOR chunk: \(error)"))))
+        }
 
-            case .streamEnd, .end:
-                // Terminal — stream is done
-                return nil
+    case .log:
+        return .item(.log(frame))
 
-            case .err:
-                let code = frame.errorCode ?? "UNKNOWN"
-                let message = frame.errorMessage ?? "Unknown error"
-                return .data(.failure(.remoteError(code: code, message: message)))
+    case .streamEnd, .end:
+        return .end
+
+    case .err:
+        let code = frame.errorCode ?? "UNKNOWN"
+        let message = frame.errorMessage ?? "Unknown error"
+        return .item(.data(.failure(.remoteError(code: code, message: message))))
 
-            default:
-                return .data(.failure(.protocolError("Unexpected frame type in response: \(frame.frameType)")))
+    default:
+        return .item(.data(.failure(.protocolError("Unexpected frame type in response: \(frame.frameType)"))))
+    }
+}
+
+internal func demuxSingleStream(responseRx: AnyIterator<Frame>, maxChunk: Int) -> PeerResponse {
+    let iterator = AnyIterator<PeerResponseItem> {
+        while let frame = responseRx.next() {
+            switch peerResponseStep(for: frame) {
+            case .skip:
+                continue
+            case .item(let item):
+                return item
+            case .end:
+                return nil
             }
         }
         return nil
@@ -804,71 +1022,144 @@ internal func demuxSingleStream(responseRx: AnyIterator<Frame>, maxChunk: Int) -
     return PeerResponse(items: iterator)
 }
 
+/// Verify a CHUNK's checksum and feed its payload to the stream's sequence
+/// decoder. Returns every item the payload completes — none while an item
+/// spanning several chunks (emitListItem) is still incomplete.
+internal func decodeChunkItems(_ payload: Data, of frame: Frame, with decoder: inout CborSequenceDecoder) -> [Result<CBOR, StreamError>] {
+    // Verify checksum (MANDATORY in protocol v2)
+    guard let expectedChecksum = frame.checksum else {
+        decoder.reset()
+        return [.failure(.protocolError("CHUNK frame missing required checksum field"))]
+    }
+    let actualChecksum = Frame.computeChecksum(payload, algorithm: frame.checksumAlgorithm)
+    if actualChecksum != expectedChecksum {
+        decoder.reset()
+        return [.failure(.protocolError("Checksum mismatch: expected=\(expectedChecksum), actual=\(actualChecksum)"))]
+    }
+
+    decoder.feed(payload)
+    var items: [Result<CBOR, StreamError>] = []
+    do {
+        while let value = try decoder.nextValue() {
+            items.append(.success(value))
+        }
+    } catch {
+        decoder.reset()
+        items.append(.failure(.decode("Failed to decode CBOR chunk: \(error)")))
+    }
+    return items
+}
+
+/// Failure for a stream that ended inside a CBOR item, if it did.
+internal func unfinishedItemFailure(_ decoder: CborSequenceDecoder) -> Result<CBOR, StreamError>? {
+    guard decoder.bufferedByteCount > 0 else { return nil }
+    return .failure(.decode("Stream ended inside a CBOR item (\(decoder.bufferedByteCount) bytes buffered)"))
+}
+
 /// Demux multiple input streams from frame iterator into InputPackage.
 /// Groups frames by stream_id, yields InputStream for each stream.
 /// Used for incoming requests (plugin receiving from host).
+///
+/// Frames are pulled lazily: the package yields a stream once its
+/// STREAM_START has been read, and a stream yields each item as soon as the
+/// chunks carrying it have arrived. Items of streams other than the one
+/// being read are buffered until read.
 internal func demuxMultiStream(frameIterator: AnyIterator<Frame>) -> InputPackage {
-    // Track per-stream state
-    class StreamState {
-        var mediaUrn: String = "media:"
-        var chunks: [Result<CBOR, StreamError>] = []
+    let demux = LazyInputDemux(frames: frameIterator)
+    return InputPackage(rx: AnyIterator { demux.nextStream() })
+}
+
+/// Pull-driven demux behind demuxMultiStream. All reads go through one
+/// lock, so the package and its streams may be consumed from any thread.
+private final class LazyInputDemux: @unchecked Sendable {
+    private final class StreamState {
+        var items: [Result<CBOR, StreamError>] = []
+        var head = 0
+        var decoder = CborSequenceDecoder()
         var ended = false
+
+        func append(_ item: Result<CBOR, StreamError>) {
+            items.append(item)
+        }
+
+        func popFirst() -> Result<CBOR, StreamError>? {
+            guard head < items.count else { return nil }
+            let item = items[head]
+            head += 1
+            // Drop the consumed prefix once it dominates the buffer
+            if head > 64 && head * 2 > items.count {
+                items.removeFirst(head)
+                head = 0
+            }
+            return item
+        }
+
+        var isDrained: Bool { head == items.count }
+    }
+
+    private let frames: AnyIterator<Frame>
+    private let lock = NSLock()
+    private var streams: [String: StreamState] = [:]
+    /// Streams started but not yet handed out, in STREAM_START order
+    private var unclaimed: [(streamId: String, mediaUrn: String)] = []
+    private var inputDone = false
+
+    init(frames: AnyIterator<Frame>) {
+        self.frames = frames
     }
 
-    var streams: [String: StreamState] = [:]
-    var streamOrder: [String] = [] // Track order of STREAM_START arrivals
+    func nextStream() -> Result<InputStream, StreamError>? {
+        lock.lock()
+        defer { lock.unlock() }
+        while unclaimed.isEmpty && !inputDone {
+            pump()
+        }
+        guard !unclaimed.isEmpty else { return nil }
+        let (streamId, mediaUrn) = unclaimed.removeFirst()
+        let items = AnyIterator<Result<CBOR, StreamError>> { [self] in
+            nextItem(streamId)
+        }
+        return .success(InputStream(mediaUrn: mediaUrn, rx: items))
+    }
+
+    private func nextItem(_ streamId: String) -> Result<CBOR, StreamError>? {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let state = streams[streamId] else { return nil }
+        while state.isDrained && !state.ended && !inputDone {
+            pump()
+        }
+        return state.popFirst()
+    }
 
-    // Drain all frames and organize by stream_id
-    for frame in frameIterator {
+    /// Read one frame and route it. Must hold `lock`.
+    private func pump() {
+        guard let frame = frames.next() else {
+            endInput()
+            return
+        }
         switch frame.frameType {
         case .streamStart:
-            guard let streamId = frame.streamId else {
-                continue
-            }
-            let state = StreamState()
-            if let urn = frame.mediaUrn {
-                state.mediaUrn = urn
-            }
-            streams[streamId] = state
-            streamOrder.append(streamId)
+            guard let streamId = frame.streamId else { return }
+            streams[streamId] = StreamState()
+            unclaimed.append((streamId: streamId, mediaUrn: frame.mediaUrn ?? "media:"))
 
         case .chunk:
             guard let streamId = frame.streamId,
-                  let state = streams[streamId],
+                  let state = streams[streamId], !state.ended,
                   let payload = frame.payload else {
-                continue
+                return
             }
-
-            // Verify checksum (MANDATORY in protocol v2)
-            guard let expectedChecksum = frame.checksum else {
-                state.chunks.append(.failure(.protocolError("CHUNK frame missing required checksum field")))
-                continue
-            }
-            let actualChecksum = Frame.computeChecksum(payload)
-            if actualChecksum != expectedChecksum {
-                state.chunks.append(.failure(.protocolError("Checksum mismatch: expected=\(expectedChecksum), actual=\(actualChecksum)")))
-                continue
-            }
-
-            do {
-                guard let value = try CBOR.decode([UInt8](payload)) else {
-                    state.chunks.append(.failure(.decode("Failed to decode CBOR chunk - decode returned nil")))
-                    continue
-                }
-                state.chunks.append(.success(value))
-            } catch {
-                state.chunks.append(.failure(.decode("Failed to decode CBOR chunk: \(error)")))
+            for item in decodeChunkItems(payload, of: frame, with: &state.decoder) {
+                state.append(item)
             }
 
         case .streamEnd:
-            guard let streamId = frame.streamId,
-                  let state = streams[streamId] else {
-                continue
-            }
-            state.ended = true
+            guard let streamId = frame.streamId, let state = streams[streamId] else { return }
+            end(state)
 
         case .end:
-            break
+            endInput()
 
         case .err:
             // Error frame - propagate to all streams
@@ -876,45 +1167,26 @@ internal func demuxMultiStream(frameIterator: AnyIterator<Frame>) -> InputPackag
             let message = frame.errorMessage ?? "Unknown error"
             let error = StreamError.remoteError(code: code, message: message)
             for state in streams.values {
-                state.chunks.append(.failure(error))
+                state.append(.failure(error))
             }
-            break
 
         default:
             break
         }
     }
 
-    // Build InputStream for each stream in arrival order
-    var inputStreams: [Result<InputStream, StreamError>] = []
-    for streamId in streamOrder {
-        guard let state = streams[streamId] else {
-            continue
-        }
-
-        var chunkIndex = 0
-        let chunksCopy = state.chunks
-        let iterator = AnyIterator<Result<CBOR, StreamError>> {
-            guard chunkIndex < chunksCopy.count else { return nil }
-            let item = chunksCopy[chunkIndex]
-            chunkIndex += 1
-            return item
+    private func end(_ state: StreamState) {
+        guard !state.ended else { return }
+        if let failure = unfinishedItemFailure(state.decoder) {
+            state.append(failure)
         }
-
-        let inputStream = InputStream(mediaUrn: state.mediaUrn, rx: iterator)
-        inputStreams.append(.success(inputStream))
+        state.ended = true
     }
 
-    // Create InputPackage iterator
-    var streamIndex = 0
-    let streamsIterator = AnyIterator<Result<InputStream, StreamError>> {
-        guard streamIndex < inputStreams.count else { return nil }
-        let item = inputStreams[streamIndex]
-        streamIndex += 1
-        return item
+    private func endInput() {
+        inputDone = true
+        streams.values.forEach(end)
     }
-
-    return InputPackage(rx: streamsIterator)
 }
 
 // MARK: - Stream Chunk Type - REMOVED
@@ -971,10 +1243,30 @@ public protocol PeerInvoker: Sendable {
     /// Returns a `PeerResponse` — use `collectBytes()` / `collectValue()` to
     /// discard LOG frames, or `recv()` to process them alongside data.
     func callWithBytes(capUrn: String, args: [(mediaUrn: String, data: Data)]) throws -> PeerResponse
+
+    /// Start a peer call from an async Op (`register_async_op`). Waiting for
+    /// the response suspends the task instead of blocking a thread.
+    func callAsync(capUrn: String) async throws -> AsyncPeerCall
 }
 
 // Default implementation of callWithBytes
 extension PeerInvoker {
+    /// Invokers without an async path can't serve async Ops
+    public func callAsync(capUrn: String) async throws -> AsyncPeerCall {
+        throw PluginRuntimeError.peerRequestError("Async peer invocation not supported by \(type(of: self))")
+    }
+
+    /// Async `callWithBytes`: write each arg's bytes, finish, return the response.
+    public func callWithBytesAsync(capUrn: String, args: [(mediaUrn: String, data: Data)]) async throws -> AsyncPeerResponse {
+        let call = try await self.callAsync(capUrn: capUrn)
+        for (mediaUrn, data) in args {
+            let arg = call.arg(mediaUrn: mediaUrn)
+            try await arg.writeAsync(data)
+            try await arg.closeAsync()
+        }
+        return try await call.finish()
+    }
+
     public func callWithBytes(capUrn: String, args: [(mediaUrn: String, data: Data)]) throws -> PeerResponse {
         let call = try self.call(capUrn: capUrn)
         for (mediaUrn, data) in args {
@@ -994,6 +1286,10 @@ public struct NoPeerInvoker: PeerInvoker {
     public func call(capUrn: String) throws -> PeerCall {
         throw PluginRuntimeError.peerRequestError("Peer invocation not supported in this context")
     }
+
+    public func callAsync(capUrn: String) async throws -> AsyncPeerCall {
+        throw PluginRuntimeError.peerRequestError("Peer invocation not supported in this context")
+    }
 }
 
 // MARK: - CliFrameSender
@@ -1219,6 +1515,7 @@ func extractEffectivePayload(payload: Data, contentType: String?, capUrn: String
 public final class CborRequest: @unchecked Sendable {
     private let _inputLock = NSLock()
     private var _inputPackage: InputPackage?
+    private var _asyncInputPackage: AsyncInputPackage?
     private let _output: OutputStream
     private let _peer: any PeerInvoker
 
@@ -1228,17 +1525,42 @@ public final class CborRequest: @unchecked Sendable {
         _peer = peer
     }
 
+    /// Request for a handler registered with `register_async_op`.
+    public init(asyncInput: AsyncInputPackage, output: OutputStream, peer: any PeerInvoker) {
+        _asyncInputPackage = asyncInput
+        _output = output
+        _peer = peer
+    }
+
     /// Take the input package. Can only be called once — second call throws.
     public func takeInput() throws -> InputPackage {
         _inputLock.lock()
         defer { _inputLock.unlock() }
         guard let pkg = _inputPackage else {
+            if _asyncInputPackage != nil {
+                throw PluginRuntimeError.protocolError("Handler was registered async - use takeAsyncInput()")
+            }
             throw PluginRuntimeError.protocolError("Input already consumed")
         }
         _inputPackage = nil
         return pkg
     }
 
+    /// Take the async input package (handlers registered with `register_async_op`).
+    /// Can only be called once — second call throws.
+    public func takeAsyncInput() throws -> AsyncInputPackage {
+        _inputLock.lock()
+        defer { _inputLock.unlock() }
+        guard let pkg = _asyncInputPackage else {
+            if _inputPackage != nil {
+                throw PluginRuntimeError.protocolError("Handler was registered blocking - use takeInput()")
+            }
+            throw PluginRuntimeError.protocolError("Input already consumed")
+        }
+        _asyncInputPackage = nil
+        return pkg
+    }
+
     public func output() -> OutputStream { _output }
     public func peer() -> any PeerInvoker { _peer }
 }
@@ -1298,13 +1620,36 @@ func dispatchOp(op: AnyOp<Void>, input: InputPackage, output: OutputStream, peer
     let wet = WetContext()
     wet.insertRef(req, for: WET_KEY_REQUEST)
 
+    try waitForTask {
+        _ = try await op.perform(dry: dry, wet: wet)
+    }
+    // Auto-close output stream on success
+    try? output.close()
+}
+
+/// Dispatch an AnyOp<Void> whose CborRequest carries an AsyncInputPackage.
+/// Runs in the caller's task — no thread is parked while the Op awaits input
+/// or output credits. Closes the output stream on success.
+func dispatchOpAsync(op: AnyOp<Void>, input: AsyncInputPackage, output: OutputStream, peer: any PeerInvoker) async throws {
+    let req = CborRequest(asyncInput: input, output: output, peer: peer)
+    let dry = DryContext()
+    let wet = WetContext()
+    wet.insertRef(req, for: WET_KEY_REQUEST)
+
+    _ = try await op.perform(dry: dry, wet: wet)
+    // Auto-close output stream on success
+    try? await output.closeAsync()
+}
+
+/// Run `body` in a Task and block the calling (non-cooperative) thread until it finishes.
+private func waitForTask(_ body: @escaping @Sendable () async throws -> Void) throws {
     // Use a class wrapper so Task can capture it as @Sendable (Swift 6 requirement)
     final class ErrorHolder: @unchecked Sendable { var error: Error? = nil }
     let holder = ErrorHolder()
     let sema = DispatchSemaphore(value: 0)
     Task { [holder, sema] in
         do {
-            _ = try await op.perform(dry: dry, wet: wet)
+            try await body()
         } catch {
             holder.error = error
         }
@@ -1315,8 +1660,6 @@ func dispatchOp(op: AnyOp<Void>, input: InputPackage, output: OutputStream, peer
     if let err = holder.error {
         throw err
     }
-    // Auto-close output stream on success
-    try? output.close()
 }
 
 // MARK: - Internal: Pending Peer Request
@@ -1341,14 +1684,52 @@ private final class ChannelFrameSender: FrameSender, @unchecked Sendable {
     private let writer: FrameWriter
     private let writerLock: NSLock
     private let seqAssigner: SeqAssigner
+    /// Per-flow CHUNK credits; nil when the host negotiated no flow window
+    private let credits: FlowCreditGate?
 
-    init(writer: FrameWriter, writerLock: NSLock, seqAssigner: SeqAssigner) {
+    init(writer: FrameWriter, writerLock: NSLock, seqAssigner: SeqAssigner, credits: FlowCreditGate? = nil) {
         self.writer = writer
         self.writerLock = writerLock
         self.seqAssigner = seqAssigner
+        self.credits = credits
+    }
+
+    var checksumAlgorithm: ChecksumAlgorithm {
+        return writer.getLimits().checksum
     }
 
     func send(_ frame: Frame) throws {
+        // Wait for a credit before taking the writer lock, so a throttled
+        // flow never blocks frames of other flows
+        if frame.frameType == .chunk {
+            credits?.acquire(FlowKey.fromFrame(frame))
+        }
+        try write(frame)
+    }
+
+    func sendAsync(_ frame: Frame) async throws {
+        if frame.frameType == .chunk, let credits = credits {
+            await credits.acquireAsync(FlowKey.fromFrame(frame))
+        }
+        // The writer lock and a full pipe can block; wait for them on
+        // asyncWriteQueue so the task's cooperative thread stays free
+        try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+            Self.asyncWriteQueue.async {
+                do {
+                    try self.write(frame)
+                    continuation.resume()
+                } catch {
+                    continuation.resume(throwing: error)
+                }
+            }
+        }
+    }
+
+    /// Where async handlers' frames are written. Serial: writes go through
+    /// the writer lock one at a time anyway, and a task's frames stay in order.
+    private static let asyncWriteQueue = DispatchQueue(label: "Bifaci.ChannelFrameSender.asyncWrite")
+
+    private func write(_ frame: Frame) throws {
         writerLock.lock()
         defer { writerLock.unlock() }
         var mutableFrame = frame
@@ -1356,6 +1737,7 @@ private final class ChannelFrameSender: FrameSender, @unchecked Sendable {
         try writer.write(mutableFrame)
         if mutableFrame.frameType == .end || mutableFrame.frameType == .err {
             seqAssigner.remove(FlowKey.fromFrame(mutableFrame))
+            credits?.remove(FlowKey.fromFrame(mutableFrame))
         }
     }
 }
@@ -1368,17 +1750,21 @@ final class PeerInvokerImpl: PeerInvoker, @unchecked Sendable {
     private let pendingRequests: NSMutableDictionary // [MessageId: PendingPeerRequest]
     private let pendingRequestsLock: NSLock
     private let maxChunk: Int
+    private let credits: FlowCreditGate?
 
-    init(writer: FrameWriter, writerLock: NSLock, seqAssigner: SeqAssigner, pendingRequests: NSMutableDictionary, pendingRequestsLock: NSLock, maxChunk: Int) {
+    init(writer: FrameWriter, writerLock: NSLock, seqAssigner: SeqAssigner, pendingRequests: NSMutableDictionary, pendingRequestsLock: NSLock, maxChunk: Int, credits: FlowCreditGate? = nil) {
         self.writer = writer
         self.writerLock = writerLock
         self.seqAssigner = seqAssigner
         self.pendingRequests = pendingRequests
         self.pendingRequestsLock = pendingRequestsLock
         self.maxChunk = maxChunk
+        self.credits = credits
     }
 
-    func call(capUrn: String) throws -> PeerCall {
+    /// Register a response channel for a new peer request id. The reader
+    /// loop yields the response frames into the returned stream.
+    private func registerPeerRequest(capUrn: String) -> (requestId: MessageId, stream: AsyncStream<Frame>, continuation: AsyncStream<Frame>.Continuation) {
         // Generate a new message ID for this request
         let requestId = MessageId.newUUID()
         fputs("[PluginRuntime] PEER_CALL: cap='\(capUrn)' peer_rid=\(requestId)\n", stderr)
@@ -1396,6 +1782,30 @@ final class PeerInvokerImpl: PeerInvoker, @unchecked Sendable {
         pendingRequestsLock.lock()
         pendingRequests[requestId] = pending
         pendingRequestsLock.unlock()
+        return (requestId, stream, continuation)
+    }
+
+    func callAsync(capUrn: String) async throws -> AsyncPeerCall {
+        let (requestId, stream, continuation) = registerPeerRequest(capUrn: capUrn)
+
+        // Shares seqAssigner and credits; its sendAsync writes off the cooperative pool
+        let sender = ChannelFrameSender(writer: writer, writerLock: writerLock, seqAssigner: seqAssigner, credits: credits)
+        do {
+            try await sender.sendAsync(Frame.req(id: requestId, capUrn: capUrn, payload: Data(), contentType: "application/cbor"))
+        } catch {
+            pendingRequestsLock.lock()
+            pendingRequests.removeObject(forKey: requestId)
+            pendingRequestsLock.unlock()
+            continuation.finish()
+            throw PluginRuntimeError.peerRequestError("Failed to send peer REQ: \(error)")
+        }
+
+        // The response stream is consumed directly by the task — no bridge thread
+        return AsyncPeerCall(sender: sender, requestId: requestId, maxChunk: maxChunk, responses: stream)
+    }
+
+    func call(capUrn: String) throws -> PeerCall {
+        let (requestId, stream, continuation) = registerPeerRequest(capUrn: capUrn)
 
         // Send REQ with empty payload — apply seq assignment
         writerLock.lock()
@@ -1436,7 +1846,11 @@ final class PeerInvokerImpl: PeerInvoker, @unchecked Sendable {
             }
 
             func next() -> Frame? {
-                semaphore.wait()
+                // The response may need another handler of this plugin to run,
+                // so a handler that has to wait gives up its pool slot meanwhile
+                if semaphore.wait(timeout: .now()) == .timedOut {
+                    HandlerPool.blocking { semaphore.wait() }
+                }
                 lock.lock()
                 defer { lock.unlock() }
 
@@ -1464,8 +1878,8 @@ final class PeerInvokerImpl: PeerInvoker, @unchecked Sendable {
             queue.next()
         }
 
-        // Create ChannelFrameSender for arg streams (shares seqAssigner)
-        let sender = ChannelFrameSender(writer: writer, writerLock: writerLock, seqAssigner: seqAssigner)
+        // Create ChannelFrameSender for arg streams (shares seqAssigner and credits)
+        let sender = ChannelFrameSender(writer: writer, writerLock: writerLock, seqAssigner: seqAssigner, credits: credits)
 
         // Return PeerCall with response iterator
         return PeerCall(
@@ -1631,7 +2045,8 @@ public struct Manifest: Codable, Sendable {
 /// - Bidirectional peer invocation (plugin can call host caps)
 ///
 /// **Multiplexed execution**: Multiple requests can be processed concurrently.
-/// Each request handler runs in its own thread, allowing the runtime to:
+/// Handlers run on a bounded worker pool (`maxConcurrentHandlers`, plus optional
+/// per-cap limits), off the frame-reading thread, allowing the runtime to:
 /// - Respond to heartbeats while handlers are running
 /// - Accept new requests while previous ones are still processing
 /// - Route response frames to handlers that invoked peer caps
@@ -1644,8 +2059,24 @@ public final class PluginRuntime: @unchecked Sendable {
     // MARK: - Properties
 
     private var handlers: [String: OpFactory] = [:]
+    /// Cap URNs in first-registration order (ties in findHandler resolve to the earliest).
+    private var handlerOrder: [String] = []
+    /// Compiled handler lookup over `handlers` (resolves to the registered cap URN),
+    /// recompiled lazily after registration. Protected by handlersLock.
+    private var handlerIndex = CapDispatchIndex<String>()
+    private var handlerIndexStale = false
+    /// Per-registered-cap handler concurrency limits. Protected by handlersLock.
+    private var handlerConcurrencyLimits: [String: Int] = [:]
+    /// Registered caps whose Ops take AsyncInputPackage input. Protected by handlersLock.
+    private var asyncHandlers: Set<String> = []
     private let handlersLock = NSLock()
 
+    /// Maximum handlers running at once in CBOR mode. Further REQs queue
+    /// (their input frames are buffered) until a worker frees up. Async
+    /// handlers run as tasks under a separate budget of the same size.
+    /// Set before `run()`.
+    public var maxConcurrentHandlers: Int = DEFAULT_MAX_CONCURRENT_HANDLERS
+
     private var limits = Limits()
 
     /// Plugin manifest JSON data - sent in HELLO response.
@@ -1729,8 +2160,51 @@ public final class PluginRuntime: @unchecked Sendable {
     /// Register an Op factory for a cap URN.
     /// The factory creates a fresh AnyOp<Void> per invocation.
     public func register_op(capUrn: String, factory: @escaping OpFactory) {
+        register(capUrn: capUrn, factory: factory, isAsync: false)
+    }
+
+    /// Register an Op factory whose Ops read input with `CborRequest.takeAsyncInput()`.
+    ///
+    /// In CBOR mode these run as tasks on the Swift cooperative pool instead of
+    /// on handler threads: the reader loop feeds their AsyncInputPackage
+    /// directly, and `OutputStream`'s async writes suspend rather than block
+    /// while the flow is out of credits (the write itself happens off the
+    /// pool). Peer calls go through `peer().callAsync` / `callWithBytesAsync`,
+    /// which suspend until the response arrives. The blocking `call` and the
+    /// non-async OutputStream methods must not be used from these Ops.
+    public func register_async_op(capUrn: String, factory: @escaping OpFactory) {
+        register(capUrn: capUrn, factory: factory, isAsync: true)
+    }
+
+    /// Convenience: register_async_op with a no-arg Op factory closure.
+    public func register_async_op_type<T: Op>(capUrn: String, make: @escaping @Sendable () -> T) where T.Output == Void {
+        register_async_op(capUrn: capUrn, factory: { AnyOp(make()) })
+    }
+
+    private func register(capUrn: String, factory: @escaping OpFactory, isAsync: Bool) {
+        handlersLock.lock()
+        if handlers.updateValue(factory, forKey: capUrn) == nil {
+            handlerOrder.append(capUrn)
+        }
+        if isAsync {
+            asyncHandlers.insert(capUrn)
+        } else {
+            asyncHandlers.remove(capUrn)
+        }
+        handlerIndexStale = true
+        handlersLock.unlock()
+    }
+
+    /// Limit how many requests for a registered cap run at once (CBOR mode).
+    /// Requests beyond the limit wait in the handler queue; other caps keep running.
+    ///
+    /// - Parameters:
+    ///   - limit: Maximum concurrent handlers for this cap, or nil to remove the limit
+    ///   - capUrn: The cap URN exactly as registered
+    public func setConcurrencyLimit(_ limit: Int?, forCap capUrn: String) {
+        precondition(limit.map { $0 > 0 } ?? true, "Concurrency limit must be positive")
         handlersLock.lock()
-        handlers[capUrn] = factory
+        handlerConcurrencyLimits[capUrn] = limit
         handlersLock.unlock()
     }
 
@@ -1748,40 +2222,25 @@ public final class PluginRuntime: @unchecked Sendable {
     /// meaning the registered cap must be able to satisfy what the request asks for.
     ///
     /// Returns the factory with the closest specificity to the request (not necessarily the most specific).
+    /// Registered caps are parsed once (on the first lookup after registration);
+    /// repeated request URNs resolve from the index's LRU without parsing.
     func findHandler(capUrn: String) -> OpFactory? {
+        return findRegisteredHandler(capUrn: capUrn)?.factory
+    }
+
+    /// Like findHandler, plus the registered cap URN, its concurrency limit and
+    /// whether it was registered async.
+    private func findRegisteredHandler(capUrn: String) -> (capUrn: String, factory: OpFactory, limit: Int?, isAsync: Bool)? {
         handlersLock.lock()
         defer { handlersLock.unlock() }
-
-        // Parse request URN
-        guard let requestUrn = try? CSCapUrn.fromString(capUrn) else {
-            return nil
+        if handlerIndexStale {
+            handlerIndex.rebuild(handlerOrder.map { (capUrn: $0, target: $0) })
+            handlerIndexStale = false
         }
-
-        let requestSpecificity = requestUrn.specificity()
-        var best: (factory: OpFactory, distance: Int)? = nil
-
-        // Find all matching handlers, prefer closest specificity
-        for (registeredCapStr, factory) in handlers {
-            guard let registeredUrn = try? CSCapUrn.fromString(registeredCapStr) else {
-                continue
-            }
-
-            // Request is pattern, registered cap is instance
-            if requestUrn.accepts(registeredUrn) {
-                let specificity = registeredUrn.specificity()
-                let distance = abs(Int(specificity) - Int(requestSpecificity))
-
-                if let currentBest = best {
-                    if distance < currentBest.distance {
-                        best = (factory, distance)
-                    }
-                } else {
-                    best = (factory, distance)
-                }
-            }
+        guard let registered = handlerIndex.closestMatch(for: capUrn), let factory = handlers[registered] else {
+            return nil
         }
-
-        return best?.factory
+        return (capUrn: registered, factory: factory, limit: handlerConcurrencyLimits[registered], isAsync: asyncHandlers.contains(registered))
     }
 
     // MARK: - Main Run Loop
@@ -1898,7 +2357,7 @@ public final class PluginRuntime: @unchecked Sendable {
         }
 
         // Find Op factory
-        guard let factory = findHandler(capUrn: cap.urn) else {
+        guard let handler = findRegisteredHandler(capUrn: cap.urn) else {
             throw PluginRuntimeError.noHandler("No handler registered for cap '\(cap.urn)'")
         }
 
@@ -2016,9 +2475,6 @@ public final class PluginRuntime: @unchecked Sendable {
             return frame
         }
 
-        // Demux frames into InputPackage
-        let inputPackage = demuxMultiStream(frameIterator: frameIterator)
-
         // Create CLI-mode OutputStream (writes to stdout)
         let cliSender = CliFrameSender()
         let outputStream = OutputStream(
@@ -2034,8 +2490,21 @@ public final class PluginRuntime: @unchecked Sendable {
         let peer = NoPeerInvoker()
 
         // Invoke Op handler — dispatchOp closes output stream on success
-        let op = factory()
-        try dispatchOp(op: op, input: inputPackage, output: outputStream, peer: peer)
+        let op = handler.factory()
+        if handler.isAsync {
+            // Every frame is already here; feed them through the async demux and wait
+            let demux = AsyncInputDemux()
+            allFrames.forEach(demux.push)
+            demux.finish()
+            let inputPackage = demux.package
+            try waitForTask {
+                try await dispatchOpAsync(op: op, input: inputPackage, output: outputStream, peer: peer)
+            }
+        } else {
+            // Demux frames into InputPackage
+            let inputPackage = demuxMultiStream(frameIterator: frameIterator)
+            try dispatchOp(op: op, input: inputPackage, output: outputStream, peer: peer)
+        }
     }
 
     /// Find a cap by its command name (the CLI subcommand).
@@ -2501,6 +2970,28 @@ public final class PluginRuntime: @unchecked Sendable {
 
     // MARK: - CBOR Mode
 
+    /// Handlers running right now, sync and async (replaces the per-handler stderr trace)
+    private static let activeHandlers = MetricsRegistry.shared.gauge("plugin_runtime.handlers_active")
+
+    /// Count a handler as running; returns the start time for `handlerFinished`.
+    private static func handlerStarted() -> UInt64 {
+        activeHandlers.add(1)
+        return metricsClock()
+    }
+
+    private static func handlerFinished(cap: String, startedAt: UInt64) {
+        activeHandlers.add(-1)
+        MetricsRegistry.shared.histogram("plugin_runtime.handler_latency_us", label: cap).recordElapsed(since: startedAt)
+    }
+
+    /// Copy a REQ's trace onto its END/ERR, adding the handler's start and end spans.
+    private static func attachTrace(_ trace: TraceContext?, handlerStartedAt: UInt64, to frame: inout Frame) {
+        guard var trace = trace else { return }
+        trace.record(TraceSpan(hop: TraceHop.plugin, event: "handler_start", timestampMicros: handlerStartedAt))
+        trace.record(TraceSpan(hop: TraceHop.plugin, event: "handler_end"))
+        frame.traceContext = trace
+    }
+
     /// Run in CBOR mode - binary protocol over stdin/stdout.
     private func runCborMode() throws {
         let stdinHandle = FileHandle.standardInput
@@ -2519,16 +3010,20 @@ public final class PluginRuntime: @unchecked Sendable {
         let stdoutHandle = FileHandle(fileDescriptor: safeFd, closeOnDealloc: true)
 
         let frameReader = FrameReader(handle: stdinHandle, limits: limits)
-        let frameWriter = FrameWriter(handle: stdoutHandle, limits: limits)
+        // Coalesce CHUNK bursts from emitters; END/ERR/heartbeats still flush immediately
+        let frameWriter = FrameWriter(handle: stdoutHandle, limits: limits, coalesceBytes: FRAME_COALESCE_BYTES)
         let writerLock = NSLock()
         let seqAssigner = SeqAssigner()
 
         // Perform handshake
         try performHandshake(reader: frameReader, writer: frameWriter)
 
+        // Per-flow CHUNK credits, returned by the host in CREDIT frames
+        let flowCredits = limits.flowWindow > 0 ? FlowCreditGate(window: limits.flowWindow) : nil
+
         // Shared output sender — all outbound frames go through this.
-        // Applies SeqAssigner and cleans up flow tracking on terminal frames.
-        let outputSender = ChannelFrameSender(writer: frameWriter, writerLock: writerLock, seqAssigner: seqAssigner)
+        // Applies SeqAssigner, waits for CHUNK credits, and cleans up flow tracking on terminal frames.
+        let outputSender = ChannelFrameSender(writer: frameWriter, writerLock: writerLock, seqAssigner: seqAssigner, credits: flowCredits)
 
         // Track pending peer requests (plugin invoking host caps)
         // Maps request ID to AsyncStream.Continuation for forwarding response frames
@@ -2541,14 +3036,20 @@ public final class PluginRuntime: @unchecked Sendable {
         let pendingHeartbeatsLock = NSLock()
 
         // Track pending incoming requests (host invoking plugin caps)
-        // Maps request ID to (capUrn, continuation) - forwards request frames to handler
+        // Maps request ID to (capUrn, frames) - the main loop pushes request frames
+        // straight into the handler's BlockingQueue or AsyncInputDemux
         struct PendingIncomingRequest {
             let capUrn: String
-            let continuation: AsyncStream<Frame>.Continuation
+            let frames: any RequestFrameSink
         }
         var pendingIncoming: [MessageId: PendingIncomingRequest] = [:]
         let pendingIncomingLock = NSLock()
 
+        // Bounded handler workers (replaces a thread per REQ)
+        let handlerPool = HandlerPool(maxWorkers: maxConcurrentHandlers, name: "PluginRuntime.handler")
+        defer { handlerPool.close() }
+        let asyncHandlerGate = AsyncHandlerGate(maxRunning: maxConcurrentHandlers)
+
         // Main loop - stays responsive for heartbeats
         while true {
 
@@ -2590,7 +3091,7 @@ public final class PluginRuntime: @unchecked Sendable {
                 }
 
                 // Find Op factory (using pattern matching to support wildcards)
-                guard let factory = findHandler(capUrn: capUrn) else {
+                guard let handler = findRegisteredHandler(capUrn: capUrn) else {
                     var err = Frame.err(id: frame.id, code: "NO_HANDLER", message: "No handler registered for cap: \(capUrn)")
                     err.routingId = routingIdForErrors
                     try? outputSender.send(err)
@@ -2608,34 +3109,91 @@ public final class PluginRuntime: @unchecked Sendable {
                     continue
                 }
 
-                // Create AsyncStream for forwarding frames to handler
-                let (stream, continuation) = AsyncStream<Frame>.makeStream()
+                // Where the main loop forwards this request's frames. Frames that
+                // arrive before the handler starts wait here.
+                let asyncInput: AsyncInputDemux? = handler.isAsync ? AsyncInputDemux() : nil
+                let blockingInput: BlockingQueue<Frame>? = handler.isAsync ? nil : BlockingQueue<Frame>()
+                let frameSink: any RequestFrameSink
+                if let asyncInput = asyncInput {
+                    frameSink = asyncInput
+                } else {
+                    frameSink = blockingInput!
+                }
 
                 // Register pending request
                 pendingIncomingLock.lock()
                 pendingIncoming[frame.id] = PendingIncomingRequest(
                     capUrn: capUrn,
-                    continuation: continuation
+                    frames: frameSink
                 )
                 pendingIncomingLock.unlock()
 
-                // Spawn handler thread immediately (matches Rust: spawn on REQ, stream frames)
                 let requestId = frame.id
                 let routingId = frame.routingId  // Capture routing_id to include in responses
-                let outputMediaUrn = cap.getOutSpec()
+                let factory = handler.factory
+                // A traced REQ's context goes back on the END/ERR (see attachTrace)
+                var receivedTrace = frame.traceContext
+                receivedTrace?.record(TraceSpan(hop: TraceHop.plugin, event: "req_received"))
+                let requestTrace = receivedTrace
+
+                // Create OutputStream for response (uses shared outputSender for seq assignment)
+                let outputStream = OutputStream(
+                    sender: outputSender,
+                    streamId: UUID().uuidString,
+                    mediaUrn: cap.getOutSpec(),
+                    requestId: requestId,
+                    routingId: routingId,
+                    maxChunk: limits.maxChunk
+                )
 
-                Thread.detachNewThread {
-                    fputs("[PluginRuntime] handler started: cap='\(capUrn)' rid=\(requestId)\n", stderr)
-                    // Create blocking queue for frame delivery
-                    let framesQueue = BlockingQueue<Frame>()
+                // Create PeerInvoker (shares seqAssigner)
+                let peer = PeerInvokerImpl(
+                    writer: frameWriter,
+                    writerLock: writerLock,
+                    seqAssigner: seqAssigner,
+                    pendingRequests: pendingPeerRequests,
+                    pendingRequestsLock: pendingPeerRequestsLock,
+                    maxChunk: limits.maxChunk,
+                    credits: flowCredits
+                )
 
-                    // Spawn async task to feed frames into queue
+                if let asyncInput = asyncInput {
+                    // Async handler: a task on the cooperative pool, fed by this loop
+                    let inputPackage = asyncInput.package
+                    let group = handler.capUrn
+                    let limit = handler.limit
                     Task {
-                        for await frame in stream {
-                            framesQueue.enqueue(frame)
+                        await asyncHandlerGate.enter(group: group, limit: limit)
+                        let started = Self.handlerStarted()
+                        defer { Self.handlerFinished(cap: group, startedAt: started) }
+                        let traceStart = requestTrace == nil ? 0 : traceClock()
+                        do {
+                            try await dispatchOpAsync(op: factory(), input: inputPackage, output: outputStream, peer: peer)
+
+                            var endFrame = Frame.end(id: requestId, finalPayload: nil)
+                            endFrame.routingId = routingId
+                            Self.attachTrace(requestTrace, handlerStartedAt: traceStart, to: &endFrame)
+                            try? await outputSender.sendAsync(endFrame)
+                        } catch {
+                            fputs("[PluginRuntime] handler FAILED: cap='\(capUrn)' rid=\(requestId) error=\(error)\n", stderr)
+                            MetricsRegistry.shared.counter("plugin_runtime.handler_errors", label: group).increment()
+                            var errFrame = Frame.err(id: requestId, code: "HANDLER_ERROR", message: "\(error)")
+                            errFrame.routingId = routingId
+                            Self.attachTrace(requestTrace, handlerStartedAt: traceStart, to: &errFrame)
+                            try? await outputSender.sendAsync(errFrame)
                         }
-                        framesQueue.finish() // Signal no more frames
+                        asyncHandlerGate.leave(group: group)
                     }
+                    continue
+                }
+
+                // Hand the request to the worker pool (matches Rust: start on REQ, stream frames)
+                let framesQueue = blockingInput!
+                let registeredCap = handler.capUrn
+                handlerPool.submit(group: registeredCap, limit: handler.limit) {
+                    let started = Self.handlerStarted()
+                    defer { Self.handlerFinished(cap: registeredCap, startedAt: started) }
+                    let traceStart = requestTrace == nil ? 0 : traceClock()
 
                     // Create iterator that reads from blocking queue
                     let frameIterator = AnyIterator<Frame> {
@@ -2645,42 +3203,23 @@ public final class PluginRuntime: @unchecked Sendable {
                     // Demux frames into InputPackage
                     let inputPackage = demuxMultiStream(frameIterator: frameIterator)
 
-                    // Create OutputStream for response (uses shared outputSender for seq assignment)
-                    let responseStreamId = UUID().uuidString
-                    let outputStream = OutputStream(
-                        sender: outputSender,
-                        streamId: responseStreamId,
-                        mediaUrn: outputMediaUrn,
-                        requestId: requestId,
-                        routingId: routingId,
-                        maxChunk: self.limits.maxChunk
-                    )
-
-                    // Create PeerInvoker (shares seqAssigner)
-                    let peer = PeerInvokerImpl(
-                        writer: frameWriter,
-                        writerLock: writerLock,
-                        seqAssigner: seqAssigner,
-                        pendingRequests: pendingPeerRequests,
-                        pendingRequestsLock: pendingPeerRequestsLock,
-                        maxChunk: self.limits.maxChunk
-                    )
-
                     do {
                         // Invoke Op handler — dispatchOp closes output stream on success
                         let op = factory()
                         try dispatchOp(op: op, input: inputPackage, output: outputStream, peer: peer)
 
-                        fputs("[PluginRuntime] handler completed OK: cap='\(capUrn)' rid=\(requestId)\n", stderr)
                         // Send END frame with routing_id (via outputSender for seq assignment)
                         var endFrame = Frame.end(id: requestId, finalPayload: nil)
                         endFrame.routingId = routingId
+                        Self.attachTrace(requestTrace, handlerStartedAt: traceStart, to: &endFrame)
                         try? outputSender.send(endFrame)
 
                     } catch {
                         fputs("[PluginRuntime] handler FAILED: cap='\(capUrn)' rid=\(requestId) error=\(error)\n", stderr)
+                        MetricsRegistry.shared.counter("plugin_runtime.handler_errors", label: registeredCap).increment()
                         var errFrame = Frame.err(id: requestId, code: "HANDLER_ERROR", message: "\(error)")
                         errFrame.routingId = routingId
+                        Self.attachTrace(requestTrace, handlerStartedAt: traceStart, to: &errFrame)
                         try? outputSender.send(errFrame)
                     }
                 }
@@ -2722,7 +3261,7 @@ public final class PluginRuntime: @unchecked Sendable {
                 // Check if this is a chunk for an incoming request
                 pendingIncomingLock.lock()
                 if let pendingReq = pendingIncoming[frame.id] {
-                    pendingReq.continuation.yield(frame)
+                    pendingReq.frames.push(frame)
                     pendingIncomingLock.unlock()
                     continue
                 }
@@ -2742,8 +3281,8 @@ public final class PluginRuntime: @unchecked Sendable {
                 pendingIncomingLock.lock()
                 if let pendingReq = pendingIncoming.removeValue(forKey: frame.id) {
                     fputs("[PluginRuntime] END routed to active_request rid=\(frame.id)\n", stderr)
-                    pendingReq.continuation.yield(frame)
-                    pendingReq.continuation.finish()
+                    pendingReq.frames.push(frame)
+                    pendingReq.frames.finish()
                     pendingIncomingLock.unlock()
                     continue
                 }
@@ -2787,7 +3326,7 @@ public final class PluginRuntime: @unchecked Sendable {
                 // Check if this is for an incoming request
                 pendingIncomingLock.lock()
                 if let pendingReq = pendingIncoming[frame.id] {
-                    pendingReq.continuation.yield(frame)
+                    pendingReq.frames.push(frame)
                     pendingIncomingLock.unlock()
                     continue
                 }
@@ -2806,7 +3345,7 @@ public final class PluginRuntime: @unchecked Sendable {
                 // Check if this is for an incoming request
                 pendingIncomingLock.lock()
                 if let pendingReq = pendingIncoming[frame.id] {
-                    pendingReq.continuation.yield(frame)
+                    pendingReq.frames.push(frame)
                     pendingIncomingLock.unlock()
                     continue
                 }
@@ -2819,6 +3358,10 @@ public final class PluginRuntime: @unchecked Sendable {
                 }
                 pendingPeerRequestsLock.unlock()
 
+            case .credit:
+                // Host finished with some of our CHUNKs for this flow
+                flowCredits?.grant(FlowKey.fromFrame(frame), frame.creditGrant ?? 0)
+
             case .relayNotify, .relayState:
                 // Relay frame types should NEVER reach the plugin runtime — they are
                 // intercepted by the relay layer. If one arrives here, it's a
@@ -2827,7 +3370,15 @@ public final class PluginRuntime: @unchecked Sendable {
             }
         }
 
-        // Handlers run asynchronously via Task - they complete on their own
+        // Host is gone: nobody will return credits, release throttled handlers
+        flowCredits?.close()
+
+        // Push out any CHUNKs still waiting in the coalescing buffer
+        writerLock.lock()
+        try? frameWriter.flush()
+        writerLock.unlock()
+
+        // Handlers already handed to the pool finish on their own; close() (deferred) lets queued ones drain
     }
 
     // MARK: - Handshake
@@ -2859,19 +3410,26 @@ public final class PluginRuntime: @unchecked Sendable {
             throw PluginRuntimeError.handshakeFailed("Protocol violation: HELLO missing max_reorder_buffer (required in protocol v2)")
         }
 
-        // Negotiate minimum of both sides
-        let ourLimits = Limits()
-        let negotiatedLimits = Limits(
+        // Negotiate minimum of both sides. The runtime verifies every algorithm,
+        // so it takes xxHash64 whenever the host offers it, honours CREDIT
+        // whenever the host offers a flow window, and takes a shared memory
+        // ring whenever the host offers one.
+        let ourLimits = Limits(checksum: .xxh64, flowWindow: DEFAULT_FLOW_WINDOW, sharedMemoryRing: DEFAULT_SHARED_MEMORY_RING)
+        var negotiatedLimits = Limits(
             maxFrame: min(ourLimits.maxFrame, theirMaxFrame),
             maxChunk: min(ourLimits.maxChunk, theirMaxChunk),
-            maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer)
+            maxReorderBuffer: min(ourLimits.maxReorderBuffer, theirMaxReorderBuffer),
+            checksum: ChecksumAlgorithm.negotiate(preferred: ourLimits.checksum, offered: theirFrame.helloChecksumAlgorithms),
+            flowWindow: Limits.negotiateFlowWindow(ourLimits.flowWindow, theirFrame.helloFlowWindow)
         )
 
-        self.limits = negotiatedLimits
-
         // Send our HELLO with negotiated limits AND manifest
         // The manifest is REQUIRED - this is the ONLY way to communicate plugin capabilities
-        let ourHello = Frame.helloWithManifest(limits: negotiatedLimits, manifest: manifestData)
+        var ourHello = Frame.helloWithManifest(limits: negotiatedLimits, manifest: manifestData)
+        negotiatedLimits.sharedMemoryRing = acceptSharedMemoryOffer(
+            theirHello: theirFrame, capacity: ourLimits.sharedMemoryRing, ourHello: &ourHello, reader: reader, writer: writer)
+        self.limits = negotiatedLimits
+
         do {
             try writer.write(ourHello)
         } catch {
@@ -36,6 +36,8 @@ public final class RelaySlave: @unchecked Sendable {
     /// Latest RelayState payload from master (thread-safe)
     private let resourceStateLock = NSLock()
     private var _resourceState: Data = Data()
+    /// Latest metrics snapshot the master attached to RelayState (guarded by resourceStateLock)
+    private var _metricsState: MetricsSnapshot?
 
     /// Create a relay slave with local I/O streams (to/from PluginHostRuntime).
     ///
@@ -54,6 +56,13 @@ public final class RelaySlave: @unchecked Sendable {
         return _resourceState
     }
 
+    /// Get the latest metrics snapshot the master attached to RelayState, if any.
+    public var metricsState: MetricsSnapshot? {
+        resourceStateLock.lock()
+        defer { resourceStateLock.unlock() }
+        return _metricsState
+    }
+
     /// Run the relay. Blocks until one side closes or an error occurs.
     ///
     /// Uses two concurrent threads for true bidirectional forwarding:
@@ -111,11 +120,15 @@ public final class RelaySlave: @unchecked Sendable {
 
                     // Intercept RelayState frames
                     if frame.frameType == .relayState {
+                        let metrics = frame.relayStateMetrics
+                        resourceStateLock.lock()
                         if let payload = frame.payload {
-                            resourceStateLock.lock()
                             _resourceState = payload
-                            resourceStateLock.unlock()
                         }
+                        if let metrics = metrics {
+                            _metricsState = metrics
+                        }
+                        resourceStateLock.unlock()
                         continue
                     }
 
@@ -126,12 +139,15 @@ public final class RelaySlave: @unchecked Sendable {
 
                     // Pass through reorder buffer
                     let readyFrames = try reorderBuffer.accept(frame)
-                    for readyFrame in readyFrames {
+                    for var readyFrame in readyFrames {
                         // Cleanup flow state after terminal frames
                         if readyFrame.frameType == .end || readyFrame.frameType == .err {
                             let key = FlowKey.fromFrame(readyFrame)
                             reorderBuffer.cleanupFlow(key)
                         }
+                        if readyFrame.carriesTrace {
+                            readyFrame.recordTraceSpan(hop: TraceHop.relaySlave, event: readyFrame.frameType == .req ? "req_in" : "response_in")
+                        }
                         if readyFrame.frameType != .log {
                             os_log(.debug, log: RelaySlave.log, "[t1 socket→local] %{public}@ id=%{public}@ xid=%{public}@", String(describing: readyFrame.frameType), String(describing: readyFrame.id), String(describing: readyFrame.routingId))
                         }
@@ -174,12 +190,15 @@ public final class RelaySlave: @unchecked Sendable {
 
                     // Pass through reorder buffer to validate seq
                     let readyFrames = try reorderBuffer.accept(frame)
-                    for readyFrame in readyFrames {
+                    for var readyFrame in readyFrames {
                         // Cleanup flow state after terminal frames
                         if readyFrame.frameType == .end || readyFrame.frameType == .err {
                             let key = FlowKey.fromFrame(readyFrame)
                             reorderBuffer.cleanupFlow(key)
                         }
+                        if readyFrame.carriesTrace {
+                            readyFrame.recordTraceSpan(hop: TraceHop.relaySlave, event: readyFrame.frameType == .req ? "req_out" : "response_out")
+                        }
                         if readyFrame.frameType != .log {
                             os_log(.debug, log: RelaySlave.log, "[t2 local→socket] %{public}@ id=%{public}@ xid=%{public}@", String(describing: readyFrame.frameType), String(describing: readyFrame.id), String(describing: readyFrame.routingId))
                         }
@@ -289,6 +308,24 @@ public final class RelayMaster: @unchecked Sendable {
         try socketWriter.write(frame)
     }
 
+    /// Send a RelayState frame carrying this process's metrics alongside the resources.
+    ///
+    /// The slave keeps the latest snapshot in `RelaySlave.metricsState`, so switch-side
+    /// latency, queue depth and load are visible to the host runtime.
+    ///
+    /// - Parameters:
+    ///   - socketWriter: Writer connected to the slave relay socket
+    ///   - resources: Opaque resource payload (CBOR or JSON encoded by the host)
+    ///   - metrics: Snapshot to attach, usually `MetricsRegistry.shared.snapshot()`
+    public static func sendState(
+        socketWriter: FrameWriter,
+        resources: Data,
+        metrics: MetricsSnapshot
+    ) throws {
+        let frame = Frame.relayState(resources: resources, metrics: metrics)
+        try socketWriter.write(frame)
+    }
+
     /// Read the next non-relay frame from the socket.
     ///
     /// RelayNotify frames are intercepted: manifest and limits are updated.
@@ -340,17 +377,19 @@ public final class RelayMaster: @unchecked Sendable {
             }
 
             // Process all ready frames
-            for readyFrame in readyFrames {
+            var stamped = readyFrames
+            for i in stamped.indices {
                 // Cleanup flow state after terminal frames
-                if readyFrame.frameType == .end || readyFrame.frameType == .err {
-                    let key = FlowKey.fromFrame(readyFrame)
+                if stamped[i].frameType == .end || stamped[i].frameType == .err {
+                    let key = FlowKey.fromFrame(stamped[i])
                     reorderBuffer.cleanupFlow(key)
+                    stamped[i].recordTraceSpan(hop: TraceHop.relayMaster, event: "response_in")
                 }
             }
 
             stateLock.lock()
             // Add all ready frames to queue
-            readyQueue.append(contentsOf: readyFrames)
+            readyQueue.append(contentsOf: stamped)
             // Return first frame
             let result = readyQueue.removeFirst()
             stateLock.unlock()
@@ -95,11 +95,43 @@ private struct RoutingEntry {
     let sourceMasterIdx: Int?
     /// Destination master index (where request is being handled)
     let destinationMasterIdx: Int
+    /// Per-cap metrics of the registered cap the REQ was routed to
+    let metrics: CapRequestMetrics
+    /// `metricsClock()` when the REQ was routed
+    let startedAt: UInt64
 }
 
 /// Sentinel value for engine-initiated requests (used in origin tracking)
 private let ENGINE_SOURCE = Int.max
 
+/// Number of routing table shards in a RelaySwitch
+public let RELAY_ROUTING_SHARDS: Int = 16
+
+/// One slice of the switch's routing state, selected by RID hash.
+///
+/// Everything keyed by a request lives in the shard of its RID, so a flow's
+/// routing entry, origin and RID → XID mapping are always read and updated
+/// together under one shard lock. Lock order: switch `lock` before any shard lock.
+private final class RoutingShard {
+    let lock = NSLock()
+    /// Routing: (xid, rid) → source/destination masters
+    var requestRouting: [RoutingKey: RoutingEntry] = [:]
+    /// Peer-initiated request keys for cleanup tracking
+    var peerRequests: Set<RoutingKey> = Set()
+    /// Origin tracking: (xid, rid) → upstream master index (nil = external caller)
+    var originMap: [RoutingKey: Int?] = [:]
+    /// RID → XID mapping (continuation frames without XID need the lookup)
+    var ridToXid: [MessageId: MessageId] = [:]
+
+    /// Drop all state for a finished flow. Must hold `lock`.
+    func removeFlow(_ key: RoutingKey) {
+        requestRouting.removeValue(forKey: key)
+        originMap.removeValue(forKey: key)
+        peerRequests.remove(key)
+        ridToXid.removeValue(forKey: key.rid)
+    }
+}
+
 // MARK: - Identity Nonce
 
 /// Generate identity verification nonce — CBOR-encoded "bifaci" text.
@@ -116,12 +148,23 @@ private final class MasterConnection: @unchecked Sendable {
     let socketWriter: FrameWriter
     /// SeqAssigner for outbound frames to this master (output stage)
     let seqAssigner: SeqAssigner
+    /// Serializes seq assignment + socket write so seq order is wire order.
+    /// Held only by writers to this master, never together with the switch lock.
+    private let writeLock = NSLock()
     /// ReorderBuffer for inbound frames from this master
     let reorderBuffer: ReorderBuffer
     var manifest: Data
     var limits: Limits
     var caps: [String]
     var healthy: Bool
+    /// Relative capacity for `DispatchPolicy.weighted`. Guarded by the switch lock.
+    var weight: Double = 1.0
+    /// Requests routed here whose terminal response hasn't come back yet.
+    /// Own lock: bumped under the switch lock, dropped from response paths that only hold a shard lock.
+    private let loadLock = NSLock()
+    private var _inFlight = 0
+    /// Requests in flight across every master of every switch in the process
+    private static let inFlightGauge = MetricsRegistry.shared.gauge("relay_switch.requests_in_flight")
 
     init(socketWriter: FrameWriter, seqAssigner: SeqAssigner, manifest: Data, limits: Limits, caps: [String], healthy: Bool) {
         self.socketWriter = socketWriter
@@ -132,6 +175,48 @@ private final class MasterConnection: @unchecked Sendable {
         self.healthy = healthy
         self.reorderBuffer = ReorderBuffer(maxBufferPerFlow: limits.maxReorderBuffer)
     }
+
+    var inFlight: Int {
+        loadLock.lock()
+        defer { loadLock.unlock() }
+        return _inFlight
+    }
+
+    func requestStarted() {
+        loadLock.lock()
+        _inFlight += 1
+        loadLock.unlock()
+        Self.inFlightGauge.add(1)
+    }
+
+    func requestFinished() {
+        loadLock.lock()
+        let finished = _inFlight > 0
+        _inFlight = max(0, _inFlight - 1)
+        loadLock.unlock()
+        if finished { Self.inFlightGauge.add(-1) }
+    }
+
+    func resetLoad() {
+        loadLock.lock()
+        let dropped = _inFlight
+        _inFlight = 0
+        loadLock.unlock()
+        if dropped > 0 { Self.inFlightGauge.add(-Int64(dropped)) }
+    }
+
+    /// Write a frame, assigning seq via this master's SeqAssigner.
+    /// Cleans up seq tracking on terminal frames (END/ERR).
+    /// Blocks only callers writing to this master.
+    func write(_ frame: inout Frame) throws {
+        writeLock.lock()
+        defer { writeLock.unlock() }
+        seqAssigner.assign(&frame)
+        try socketWriter.write(frame)
+        if frame.frameType == .end || frame.frameType == .err {
+            seqAssigner.remove(FlowKey.fromFrame(frame))
+        }
+    }
 }
 
 // MARK: - Relay Switch
@@ -143,28 +228,39 @@ private final class MasterConnection: @unchecked Sendable {
 @available(macOS 10.15.4, iOS 13.4, *)
 public final class RelaySwitch: @unchecked Sendable {
     private var masters: [MasterConnection] = []
-    private var capTable: [(capUrn: String, masterIdx: Int)] = []
+    /// Compiled cap → master routing table (rebuilt by rebuildCapTable)
+    private var capIndex = CapDispatchIndex<Int>()
 
-    /// Routing: (xid, rid) → source/destination masters
-    private var requestRouting: [RoutingKey: RoutingEntry] = [:]
-    /// Peer-initiated request keys for cleanup tracking
-    private var peerRequests: Set<RoutingKey> = Set()
-    /// Origin tracking: (xid, rid) → upstream master index (nil = external caller)
-    private var originMap: [RoutingKey: Int?] = [:]
-    /// RID → XID mapping for engine-initiated requests (continuation frames need XID lookup)
-    private var ridToXid: [MessageId: MessageId] = [:]
+    /// Per-request routing state, sharded by RID hash (see RoutingShard)
+    private let routingShards: [RoutingShard] = (0..<RELAY_ROUTING_SHARDS).map { _ in RoutingShard() }
     /// XID counter for assigning unique routing IDs
     private var xidCounter: UInt64 = 0
 
     private var aggregateCapabilities: Data = Data()
     private var negotiatedLimits: Limits = Limits()
+    /// Guards masters, capIndex, xidCounter, aggregates and isShutdown.
+    /// Never held across a socket write.
     private let lock = NSLock()
-    private var frameChannel: [(masterIdx: Int, frame: Frame?, error: Error?)] = []
-    private let frameSemaphore = DispatchSemaphore(value: 0)
+    /// Reader threads → engine thread. One lane per master, bounded.
+    private let frameChannel: FanInChannel<(masterIdx: Int, frame: Frame?, error: Error?)>
 
     /// Shutdown flag - when true, reader threads should exit
     private var isShutdown = false
 
+    /// Chooses among masters serving a cap equally well. Guarded by `lock`.
+    private var dispatchPolicy: DispatchPolicy = DEFAULT_DISPATCH_POLICY
+
+    /// Per-cap metrics, keyed by registered cap. Guarded by `lock`.
+    private var capMetrics = CapRequestMetrics.Cache(prefix: "relay_switch")
+
+    // Process-wide metrics (MetricsRegistry.shared); per-cap ones are resolved
+    // once per registered cap (`capMetrics`) and carried in the RoutingEntry
+    private static let requestsRouted = MetricsRegistry.shared.counter("relay_switch.requests_routed")
+    private static let noHandler = MetricsRegistry.shared.counter("relay_switch.no_handler")
+    private static let bytesToMasters = MetricsRegistry.shared.counter("relay_switch.bytes_to_masters")
+    private static let bytesToEngine = MetricsRegistry.shared.counter("relay_switch.bytes_to_engine")
+    private static let queueDepth = MetricsRegistry.shared.gauge("relay_switch.queue_depth")
+
     /// Create a RelaySwitch from socket pairs.
     ///
     /// Two-phase construction:
@@ -174,9 +270,12 @@ public final class RelaySwitch: @unchecked Sendable {
     /// Identity verification sends CAP_IDENTITY request with nonce, expects echo response.
     /// Updated RelayNotify frames during verification are captured (hosts send full caps after plugin startup).
     ///
-    /// - Parameter sockets: Array of socket pairs (one per master). Can be empty — use add_master later.
+    /// - Parameters:
+    ///   - sockets: Array of socket pairs (one per master). Can be empty — use add_master later.
+    ///   - channelCapacity: Frames buffered per master before its reader thread stops reading
     /// - Throws: RelaySwitchError if construction or identity verification fails
-    public init(sockets: [SocketPair]) throws {
+    public init(sockets: [SocketPair], channelCapacity: Int = RELAY_CHANNEL_CAPACITY) throws {
+        self.frameChannel = FanInChannel(capacity: channelCapacity, depthGauge: Self.queueDepth)
         // Allow empty sockets — creates empty switch. Use addMaster() to add masters later.
         // Matches Rust TEST432: Empty masters list creates empty switch, add_master works.
         if sockets.isEmpty {
@@ -330,8 +429,40 @@ public final class RelaySwitch: @unchecked Sendable {
         isShutdown = true
         lock.unlock()
 
-        // Signal semaphore to wake any waiting readers
-        frameSemaphore.signal()
+        // Release reader threads blocked on a full channel lane, wake the engine
+        frameChannel.close()
+        frameChannel.wake()
+    }
+
+    /// Set how REQs are spread across masters registered with equivalent caps.
+    public func setDispatchPolicy(_ policy: DispatchPolicy) {
+        lock.lock()
+        dispatchPolicy = policy
+        lock.unlock()
+    }
+
+    /// Set a master's relative capacity for `DispatchPolicy.weighted` (default 1).
+    ///
+    /// The engine derives this from the resources it reports to that master's
+    /// host in RelayState, e.g. free memory or cores; 0 drains the master of new
+    /// requests while others can take them.
+    public func setMasterWeight(_ masterIdx: Int, weight: Double) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard masters.indices.contains(masterIdx) else { return }
+        masters[masterIdx].weight = max(0, weight)
+    }
+
+    /// Requests routed to each master that haven't finished, by master index.
+    public func masterLoad() -> [Int] {
+        lock.lock()
+        defer { lock.unlock() }
+        return masters.map { $0.inFlight }
+    }
+
+    /// Inbound frame queue depth (per master) and backpressure counters.
+    public func channelStats() -> FanInChannelStats {
+        return frameChannel.stats()
     }
 
     /// deinit sets shutdown flag
@@ -412,24 +543,109 @@ public final class RelaySwitch: @unchecked Sendable {
         }
     }
 
+    /// Blocks while this master's lane is full (backpressure onto its socket).
     private func enqueueFrame(masterIdx: Int, frame: Frame?, error: Error?) {
+        frameChannel.send((masterIdx: masterIdx, frame: frame, error: error), lane: masterIdx)
+    }
+
+    // MARK: - Routing State
+
+    private func shard(for rid: MessageId) -> RoutingShard {
+        let hash = UInt(bitPattern: rid.hashValue)
+        return routingShards[Int(hash % UInt(routingShards.count))]
+    }
+
+    /// Connection for a master index. Callers write to it after releasing `lock`.
+    private func master(_ masterIdx: Int) -> MasterConnection {
         lock.lock()
-        frameChannel.append((masterIdx: masterIdx, frame: frame, error: error))
-        lock.unlock()
-        frameSemaphore.signal()
+        defer { lock.unlock() }
+        return masters[masterIdx]
     }
 
-    // MARK: - Frame Output
+    /// Route a new REQ: pick the destination, assign an XID if needed and
+    /// record the flow. Returns the connection to write to (outside any lock).
+    ///
+    /// The shard is updated while `lock` is still held so handleMasterDeath,
+    /// which scans shards under `lock`, never misses a flow routed to a master
+    /// that is dying concurrently.
+    private func routeRequest(_ frame: inout Frame, preferredCap: String?, sourceIdx: Int?) throws -> MasterConnection {
+        lock.lock()
+        defer { lock.unlock() }
 
-    /// Write a frame to a master, assigning seq via the per-master SeqAssigner.
-    /// Cleans up seq tracking on terminal frames (END/ERR).
-    private func writeToMasterIdx(_ masterIdx: Int, _ frame: inout Frame) throws {
-        let master = masters[masterIdx]
-        master.seqAssigner.assign(&frame)
-        try master.socketWriter.write(frame)
-        if frame.frameType == .end || frame.frameType == .err {
-            master.seqAssigner.remove(FlowKey.fromFrame(frame))
+        guard let cap = frame.cap,
+              let registeredCap = capIndex.closestMatchedCap(for: cap, preferredCap: preferredCap),
+              let destIdx = findMasterForCap(cap, preferredCap: preferredCap) else {
+            Self.noHandler.increment()
+            throw RelaySwitchError.noHandler(frame.cap ?? "nil")
+        }
+        // Labeled by the registered cap, never the peer-supplied request string
+        let metrics = capMetrics.metrics(for: registeredCap)
+
+        // Assign XID if absent (engine frames arrive without XID; peer REQs never carry one)
+        let xid: MessageId
+        if let existingXid = frame.routingId {
+            xid = existingXid
+        } else {
+            xidCounter += 1
+            xid = .uint(xidCounter)
+            frame.routingId = xid
+        }
+
+        let rid = frame.id
+        let key = RoutingKey(xid: xid, rid: rid)
+        if let sourceIdx = sourceIdx {
+            fputs("[RelaySwitch] PEER_REQ: master \(sourceIdx) → master \(destIdx) cap='\(cap)' rid=\(rid) xid=\(xid)\n", stderr)
         }
+
+        let shard = self.shard(for: rid)
+        shard.lock.lock()
+        // Record origin (nil = external caller via sendToMaster)
+        shard.originMap[key] = sourceIdx
+        // Register routing
+        shard.requestRouting[key] = RoutingEntry(
+            sourceMasterIdx: sourceIdx,
+            destinationMasterIdx: destIdx,
+            metrics: metrics,
+            startedAt: metricsClock()
+        )
+        // Record RID → XID mapping for continuation frames
+        shard.ridToXid[rid] = xid
+        if sourceIdx != nil {
+            // Mark as peer request (for cleanup tracking)
+            shard.peerRequests.insert(key)
+        }
+        shard.lock.unlock()
+
+        let destination = masters[destIdx]
+        destination.requestStarted()
+        Self.requestsRouted.increment()
+        frame.recordTraceSpan(hop: TraceHop.relaySwitch, event: "route")
+        return destination
+    }
+
+    /// Resolve a request continuation (no XID, or XID the engine already knows)
+    /// to its destination, filling in the XID from the RID → XID map if absent.
+    private func routeContinuation(_ frame: inout Frame) throws -> Int {
+        let rid = frame.id
+        let shard = self.shard(for: rid)
+        shard.lock.lock()
+        defer { shard.lock.unlock() }
+
+        let xid: MessageId
+        if let existingXid = frame.routingId {
+            xid = existingXid
+        } else {
+            guard let lookedUpXid = shard.ridToXid[rid] else {
+                throw RelaySwitchError.unknownRequest(rid.toString())
+            }
+            xid = lookedUpXid
+            frame.routingId = xid
+        }
+
+        guard let entry = shard.requestRouting[RoutingKey(xid: xid, rid: rid)] else {
+            throw RelaySwitchError.unknownRequest(rid.toString())
+        }
+        return entry.destinationMasterIdx
     }
 
     // MARK: - Dynamic Master Management
@@ -600,68 +816,22 @@ public final class RelaySwitch: @unchecked Sendable {
     ///                   whose registered cap is equivalent to this URN.
     ///                   When nil, uses standard accepts + closest-specificity routing.
     public func sendToMaster(_ frame: Frame, preferredCap: String? = nil) throws {
-        lock.lock()
-        defer { lock.unlock() }
-
         var mutableFrame = frame
 
         switch frame.frameType {
         case .req:
-            guard let cap = frame.cap, let destIdx = findMasterForCap(cap, preferredCap: preferredCap) else {
-                throw RelaySwitchError.noHandler(frame.cap ?? "nil")
-            }
-
-            // Assign XID if absent (engine frames arrive without XID)
-            let xid: MessageId
-            if let existingXid = frame.routingId {
-                xid = existingXid
-            } else {
-                xidCounter += 1
-                xid = .uint(xidCounter)
-                mutableFrame.routingId = xid
-            }
-
-            let rid = frame.id
-            let key = RoutingKey(xid: xid, rid: rid)
-
-            // Record origin (nil = external caller via sendToMaster)
-            originMap[key] = nil as Int?
-
-            // Register routing
-            requestRouting[key] = RoutingEntry(
-                sourceMasterIdx: nil,
-                destinationMasterIdx: destIdx
-            )
-
-            // Record RID → XID mapping for continuation frames from engine
-            ridToXid[rid] = xid
-
+            let destination = try routeRequest(&mutableFrame, preferredCap: preferredCap, sourceIdx: nil)
             // Forward to destination with XID
-            try writeToMasterIdx(destIdx, &mutableFrame)
+            try destination.write(&mutableFrame)
 
         case .streamStart, .chunk, .streamEnd, .end, .err:
             // Continuation frames from engine: look up XID from RID if missing
-            let xid: MessageId
-            if let existingXid = frame.routingId {
-                xid = existingXid
-            } else {
-                guard let lookedUpXid = ridToXid[frame.id] else {
-                    throw RelaySwitchError.unknownRequest(frame.id.toString())
-                }
-                xid = lookedUpXid
-                mutableFrame.routingId = xid
+            let destIdx = try routeContinuation(&mutableFrame)
+            if let payload = mutableFrame.payload, frame.frameType == .chunk {
+                Self.bytesToMasters.increment(by: UInt64(payload.count))
             }
-
-            let key = RoutingKey(xid: xid, rid: frame.id)
-
-            guard let entry = requestRouting[key] else {
-                throw RelaySwitchError.unknownRequest(frame.id.toString())
-            }
-
-            let destIdx = entry.destinationMasterIdx
-
             // Forward to destination
-            try writeToMasterIdx(destIdx, &mutableFrame)
+            try master(destIdx).write(&mutableFrame)
 
         default:
             throw RelaySwitchError.protocolError("Unexpected frame type from engine: \(frame.frameType)")
@@ -674,15 +844,7 @@ public final class RelaySwitch: @unchecked Sendable {
     /// Peer requests (plugin → plugin) are handled internally and not returned.
     public func readFromMasters() throws -> Frame? {
         while true {
-            frameSemaphore.wait()
-
-            lock.lock()
-            guard !frameChannel.isEmpty else {
-                lock.unlock()
-                continue
-            }
-            let masterFrame = frameChannel.removeFirst()
-            lock.unlock()
+            guard let masterFrame = frameChannel.receive() else { continue }
 
             if let error = masterFrame.error {
                 fputs("[RelaySwitch] Error reading from master \(masterFrame.masterIdx): \(error)\n", stderr)
@@ -715,16 +877,9 @@ public final class RelaySwitch: @unchecked Sendable {
             let remaining = deadline.timeIntervalSinceNow
             if remaining <= 0 { return nil }
 
-            let result = frameSemaphore.wait(timeout: DispatchTime.now() + remaining)
-            if result == .timedOut { return nil }
-
-            lock.lock()
-            guard !frameChannel.isEmpty else {
-                lock.unlock()
-                continue
+            guard let masterFrame = frameChannel.receive(deadline: DispatchTime.now() + remaining) else {
+                return nil  // Timed out
             }
-            let masterFrame = frameChannel.removeFirst()
-            lock.unlock()
 
             if let error = masterFrame.error {
                 fputs("[RelaySwitch] Error reading from master \(masterFrame.masterIdx): \(error)\n", stderr)
@@ -760,55 +915,17 @@ public final class RelaySwitch: @unchecked Sendable {
     ///                   When provided, uses comparable matching (broader) and prefers
     ///                   masters whose registered cap is equivalent to this URN.
     ///                   When nil, uses standard accepts + closest-specificity routing.
+    ///
+    /// Resolution runs against the pre-parsed `capIndex`; repeated request URNs
+    /// are answered from its cache without parsing. When several masters are
+    /// registered with caps equivalent to the winner, `dispatchPolicy` picks
+    /// one by load. Must hold `lock`.
     private func findMasterForCap(_ capUrn: String, preferredCap: String? = nil) -> Int? {
-        guard let requestUrn = try? CSCapUrn.fromString(capUrn) else {
-            return nil
-        }
-
-        let requestSpecificity = Int(requestUrn.specificity())
-
-        // Parse preferred cap URN if provided
-        let preferredUrn = preferredCap.flatMap { try? CSCapUrn.fromString($0) }
-
-        // Collect ALL matching masters with their specificity scores
-        // When preferredCap is set, use comparable (broader); otherwise accepts (standard)
-        var matches: [(masterIdx: Int, specificity: Int, isPreferred: Bool)] = []
-
-        for (registeredCap, masterIdx) in capTable {
-            guard let registeredUrn = try? CSCapUrn.fromString(registeredCap) else {
-                continue
-            }
-
-            // Determine if this is a match
-            let isMatch: Bool
-            if preferredUrn != nil {
-                // Comparable: either side accepts the other (broader match set)
-                isMatch = (requestUrn.accepts(registeredUrn) || registeredUrn.accepts(requestUrn))
-            } else {
-                // Standard: request is pattern, registered cap is instance
-                isMatch = requestUrn.accepts(registeredUrn)
-            }
-
-            if isMatch {
-                let specificity = Int(registeredUrn.specificity())
-                // Check if this registered cap is equivalent to the preferred cap
-                let isPreferred = preferredUrn.map { pref in
-                    pref.accepts(registeredUrn) && registeredUrn.accepts(pref)
-                } ?? false
-                matches.append((masterIdx: masterIdx, specificity: specificity, isPreferred: isPreferred))
-            }
-        }
-
-        if matches.isEmpty { return nil }
-
-        // If any match is preferred, pick the first preferred match
-        if let preferred = matches.first(where: { $0.isPreferred }) {
-            return preferred.masterIdx
-        }
-
-        // Fall back to closest-specificity (ties broken by first match)
-        let minDistance = matches.map { abs($0.specificity - requestSpecificity) }.min()!
-        return matches.first { abs($0.specificity - requestSpecificity) == minDistance }?.masterIdx
+        let candidates = capIndex.closestMatches(for: capUrn, preferredCap: preferredCap)
+        guard candidates.count > 1 else { return candidates.first }
+        return dispatchPolicy.choose(candidates.map { idx in
+            DispatchCandidate(target: idx, inFlight: masters[idx].inFlight, weight: masters[idx].weight)
+        })
     }
 
     /// Handle a frame arriving from a master (plugin → engine direction).
@@ -816,74 +933,62 @@ public final class RelaySwitch: @unchecked Sendable {
     /// Returns Some(frame) if the frame should be forwarded to the engine.
     /// Returns nil if the frame was handled internally (peer request or request continuation).
     private func handleMasterFrame(sourceIdx: Int, frame: Frame) throws -> Frame? {
-        lock.lock()
-        defer { lock.unlock() }
-
         var mutableFrame = frame
 
         switch frame.frameType {
         case .req:
             // Peer request: plugin → plugin via switch (no preference)
-            guard let cap = frame.cap, let destIdx = findMasterForCap(cap, preferredCap: nil) else {
-                throw RelaySwitchError.noHandler(frame.cap ?? "nil")
-            }
-
             // REQs from plugins should NOT have XID (per protocol spec)
             if frame.routingId != nil {
                 throw RelaySwitchError.protocolError("REQ from plugin should not have XID")
             }
 
-            // Assign fresh XID
-            xidCounter += 1
-            let xid = MessageId.uint(xidCounter)
-            mutableFrame.routingId = xid
-
-            let rid = frame.id
-            let key = RoutingKey(xid: xid, rid: rid)
-
-            // Record RID → XID mapping for continuation frames
-            ridToXid[rid] = xid
-
-            // Record origin (where this request came from)
-            fputs("[RelaySwitch] PEER_REQ: master \(sourceIdx) → master \(destIdx) cap='\(cap)' rid=\(rid) xid=\(xid)\n", stderr)
-            originMap[key] = sourceIdx
-
-            // Register routing
-            requestRouting[key] = RoutingEntry(
-                sourceMasterIdx: sourceIdx,
-                destinationMasterIdx: destIdx
-            )
-
-            // Mark as peer request (for cleanup tracking)
-            peerRequests.insert(key)
+            // Assigns a fresh XID and records the origin
+            let destination = try routeRequest(&mutableFrame, preferredCap: nil, sourceIdx: sourceIdx)
 
             // Forward to destination with XID
-            try writeToMasterIdx(destIdx, &mutableFrame)
+            try destination.write(&mutableFrame)
 
             // Do NOT return to engine (internal routing)
             return nil
 
         case .streamStart, .chunk, .streamEnd, .end, .err, .log:
             // Branch based on XID presence to distinguish request vs response direction
-            if frame.routingId != nil {
+            if let xid = frame.routingId {
                 // ========================================
                 // HAS XID = RESPONSE CONTINUATION
                 // ========================================
                 // Frame already has XID, so it's a response flowing back to origin
-                let xid = frame.routingId!
                 let rid = frame.id
                 let key = RoutingKey(xid: xid, rid: rid)
+                let isTerminal = frame.frameType == .end || frame.frameType == .err
 
-                guard requestRouting[key] != nil else {
+                let shard = self.shard(for: rid)
+                shard.lock.lock()
+                guard let entry = shard.requestRouting[key] else {
+                    shard.lock.unlock()
                     throw RelaySwitchError.unknownRequest(rid.toString())
                 }
 
                 // Get origin (where request came from)
-                guard let originIdx = originMap[key] else {
+                guard let originIdx = shard.originMap[key] else {
+                    shard.lock.unlock()
                     throw RelaySwitchError.protocolError("No origin recorded for request \(rid.toString())")
                 }
 
-                let isTerminal = frame.frameType == .end || frame.frameType == .err
+                // The terminal frame ends the flow; later frames for it are unknown
+                if isTerminal {
+                    shard.removeFlow(key)
+                }
+                shard.lock.unlock()
+                if isTerminal {
+                    mutableFrame.recordTraceSpan(hop: TraceHop.relaySwitch, event: "response")
+                    master(entry.destinationMasterIdx).requestFinished()
+                    entry.metrics.latency.recordElapsed(since: entry.startedAt)
+                    if frame.frameType == .err {
+                        entry.metrics.errors.increment()
+                    }
+                }
 
                 // Route back to origin
                 if let masterIdx = originIdx {
@@ -891,52 +996,29 @@ public final class RelaySwitch: @unchecked Sendable {
                     if isTerminal {
                         fputs("[RelaySwitch] PEER_RESP: routing \(frame.frameType) back to master \(masterIdx) xid=\(xid) rid=\(rid)\n", stderr)
                     }
-                    try writeToMasterIdx(masterIdx, &mutableFrame)
+                    try master(masterIdx).write(&mutableFrame)
                     if isTerminal {
                         fputs("[RelaySwitch] PEER_RESP: write to master \(masterIdx) completed\n", stderr)
-                        requestRouting.removeValue(forKey: key)
-                        originMap.removeValue(forKey: key)
-                        peerRequests.remove(key)
-                        ridToXid.removeValue(forKey: rid)
                     }
-
                     return nil
                 } else {
                     // External caller (via sendToMaster) — strip XID and return to engine
                     mutableFrame.routingId = nil
-
-                    if isTerminal {
-                        requestRouting.removeValue(forKey: key)
-                        originMap.removeValue(forKey: key)
-                        peerRequests.remove(key)
-                        ridToXid.removeValue(forKey: rid)
+                    if let payload = mutableFrame.payload, frame.frameType == .chunk {
+                        Self.bytesToEngine.increment(by: UInt64(payload.count))
                     }
-
                     return mutableFrame
                 }
             } else {
                 // ========================================
                 // NO XID = REQUEST CONTINUATION
                 // ========================================
-                // Frame has no XID, so it's a request continuation flowing to destination
-                let rid = frame.id
-
-                // Look up XID from RID → XID mapping (added by the REQ)
-                guard let xid = ridToXid[rid] else {
-                    throw RelaySwitchError.unknownRequest(rid.toString())
-                }
-
-                let key = RoutingKey(xid: xid, rid: rid)
-
-                guard let entry = requestRouting[key] else {
-                    throw RelaySwitchError.unknownRequest(rid.toString())
-                }
-
-                // Add XID to frame for forwarding
-                mutableFrame.routingId = xid
+                // Frame has no XID, so it's a request continuation flowing to destination.
+                // The XID comes from the RID → XID mapping added by the REQ.
+                let destIdx = try routeContinuation(&mutableFrame)
 
                 // Forward to destination master (keep XID)
-                try writeToMasterIdx(entry.destinationMasterIdx, &mutableFrame)
+                try master(destIdx).write(&mutableFrame)
                 return nil
             }
 
@@ -945,12 +1027,14 @@ public final class RelaySwitch: @unchecked Sendable {
             if let manifest = frame.relayNotifyManifest,
                let newLimits = frame.relayNotifyLimits {
                 let newCaps = try Self.parseCapabilitiesFromManifest(manifest)
+                lock.lock()
                 masters[sourceIdx].caps = newCaps
                 masters[sourceIdx].manifest = manifest
                 masters[sourceIdx].limits = newLimits
                 rebuildCapTable()
                 rebuildCapabilities()
                 rebuildLimits()
+                lock.unlock()
             }
             // Pass through to engine (for visibility)
             return frame
@@ -962,55 +1046,60 @@ public final class RelaySwitch: @unchecked Sendable {
 
     private func handleMasterDeath(_ masterIdx: Int) throws {
         lock.lock()
-        defer { lock.unlock() }
 
         guard masters[masterIdx].healthy else {
+            lock.unlock()
             return
         }
 
         fputs("[RelaySwitch] Master \(masterIdx) died\n", stderr)
         masters[masterIdx].healthy = false
+        masters[masterIdx].resetLoad()
+
+        // Find all pending requests to this master, drop their routing, and
+        // collect ERRs for peer origins that are still alive
+        var pendingErrors: [(destination: MasterConnection, frame: Frame)] = []
+        for shard in routingShards {
+            shard.lock.lock()
+            let deadKeys = shard.requestRouting.filter { $0.value.destinationMasterIdx == masterIdx }
+            for (key, entry) in deadKeys {
+                if let sourceIdx = entry.sourceMasterIdx, masters[sourceIdx].healthy {
+                    var errFrame = Frame.err(id: key.rid, code: "MASTER_DIED", message: "Relay master connection closed")
+                    errFrame.routingId = key.xid
+                    pendingErrors.append((destination: masters[sourceIdx], frame: errFrame))
+                }
 
-        // Find all pending requests to this master and ERR them
-        var deadKeys: [(key: RoutingKey, sourceMasterIdx: Int?)] = []
-        for (key, entry) in requestRouting {
-            if entry.destinationMasterIdx == masterIdx {
-                deadKeys.append((key: key, sourceMasterIdx: entry.sourceMasterIdx))
-            }
-        }
-
-        for (key, sourceMasterIdx) in deadKeys {
-            // Create ERR frame
-            var errFrame = Frame.err(id: key.rid, code: "MASTER_DIED", message: "Relay master connection closed")
-            errFrame.routingId = key.xid
-
-            if let masterIdx = sourceMasterIdx, masters[masterIdx].healthy {
-                // Send ERR back to source master
-                try? writeToMasterIdx(masterIdx, &errFrame)
+                // Cleanup routing
+                shard.requestRouting.removeValue(forKey: key)
+                shard.originMap.removeValue(forKey: key)
+                shard.peerRequests.remove(key)
             }
-
-            // Cleanup routing
-            requestRouting.removeValue(forKey: key)
-            originMap.removeValue(forKey: key)
-            peerRequests.remove(key)
+            shard.lock.unlock()
         }
 
         rebuildCapTable()
         rebuildCapabilities()
         rebuildLimits()
+        lock.unlock()
+
+        // Send ERRs back to source masters outside the lock
+        for var pending in pendingErrors {
+            try? pending.destination.write(&pending.frame)
+        }
     }
 
     // MARK: - Capability Management
 
+    /// Rebuild the compiled routing index from healthy masters' caps.
+    /// Parses every cap once here so the per-REQ path never does.
     private func rebuildCapTable() {
-        capTable.removeAll()
-        for (idx, master) in masters.enumerated() {
-            if master.healthy {
-                for cap in master.caps {
-                    capTable.append((capUrn: cap, masterIdx: idx))
-                }
+        var registrations: [(capUrn: String, target: Int)] = []
+        for (idx, master) in masters.enumerated() where master.healthy {
+            for cap in master.caps {
+                registrations.append((capUrn: cap, target: idx))
             }
         }
+        capIndex.rebuild(registrations)
     }
 
     private func rebuildCapabilities() {
@@ -0,0 +1,361 @@
+//
+//  SharedMemoryTransport.swift
+//  Bifaci
+//
+//  Optional same-machine payload transport for CHUNK frames.
+//
+//  Each direction of a link can carry its CHUNK payloads in a ring buffer
+//  shared between the two processes instead of in the pipe. The sender
+//  copies the payload into the ring and writes the CHUNK with the payload
+//  replaced by its ring offset and length (`shm_off` / `shm_len` in meta);
+//  the receiving FrameReader copies it back out and restores the frame, so
+//  everything above FrameReader/FrameWriter sees ordinary CHUNKs. A payload
+//  crosses one memcpy on each side instead of a trip through the kernel's
+//  pipe buffer in 64 KB pieces.
+//
+//  Negotiation (HELLO meta):
+//  - The host creates its ring and offers it (`shm_ring_path`, `shm_ring_size`).
+//  - A plugin that maps the host's ring answers with an offer of its own;
+//    that answer is also its acceptance. No answer → both directions stay inline.
+//  - The receiver unlinks the ring file once mapped; the mapping outlives it.
+//  - The receiver also flags the ring as mapped in its header; the sender
+//    keeps every CHUNK inline until it sees the flag, so a host that can't
+//    map the plugin's ring just settles for inline frames.
+//
+//  Payloads are consumed in the order they were written (one pipe per
+//  direction), so the ring only tracks how far the receiver has read. The
+//  cursor lives in the shared header behind a process-shared mutex, which
+//  also orders the receiver's copy-out before the sender reuses the space.
+//  When the ring is full, or a payload is small, the CHUNK simply goes inline.
+//
+//  The ring file's blocks are reserved when it is created: a store into a
+//  sparse mapping that the disk can't back raises SIGBUS in whichever
+//  process touches it, so a ring that can't be fully backed is never offered.
+//
+//  Hop-by-hop like CREDIT: frames forwarded to another link carry their
+//  payload inline again.
+
+import Foundation
+
+/// Ring bytes PluginHost offers to the plugins it spawns
+public let DEFAULT_SHARED_MEMORY_RING: Int = 16 * 1024 * 1024
+
+/// CHUNK payloads smaller than this stay inline — the pipe is cheaper than the bookkeeping
+public let SHARED_MEMORY_MIN_PAYLOAD: Int = 16 * 1024
+
+private let SHM_RING_PATH_KEY = "shm_ring_path"
+private let SHM_RING_SIZE_KEY = "shm_ring_size"
+private let SHM_OFFSET_KEY = "shm_off"
+private let SHM_LENGTH_KEY = "shm_len"
+
+/// One direction's payload ring, mapped into both processes.
+///
+/// The sending side calls `put` (under its FrameWriter's lock); the receiving
+/// side calls `take` (under its FrameReader's read lock).
+final class SharedMemoryRing: @unchecked Sendable {
+    /// Header: process-shared mutex, then the receiver's consumed cursor and mapped flag
+    private static let consumedOffset = 128
+    private static let attachedOffset = 136
+    private static let headerSize = 256
+
+    let path: String
+    let capacity: Int
+    private let base: UnsafeMutableRawPointer
+    private let mappedLength: Int
+    private let mutex: UnsafeMutablePointer<pthread_mutex_t>
+    private let consumed: UnsafeMutablePointer<UInt64>
+    private let attached: UnsafeMutablePointer<UInt64>
+    private let bytes: UnsafeMutableRawPointer
+    /// Sender: logical offset of the next payload
+    private var head: UInt64 = 0
+    /// Receiver: everything before this has been taken
+    private var taken: UInt64 = 0
+    /// Sender: the receiver has mapped the ring (sticky once seen)
+    private var peerAttached = false
+
+    private init(path: String, capacity: Int, base: UnsafeMutableRawPointer, mappedLength: Int) {
+        self.path = path
+        self.capacity = capacity
+        self.base = base
+        self.mappedLength = mappedLength
+        self.mutex = base.bindMemory(to: pthread_mutex_t.self, capacity: 1)
+        self.consumed = (base + Self.consumedOffset).bindMemory(to: UInt64.self, capacity: 1)
+        self.attached = (base + Self.attachedOffset).bindMemory(to: UInt64.self, capacity: 1)
+        self.bytes = base + Self.headerSize
+    }
+
+    deinit {
+        _ = munmap(base, mappedLength)
+    }
+
+    /// Create a ring to send through. The file stays on disk until the
+    /// receiver maps it or `unlinkFile()` is called. Throws if the file's
+    /// disk space can't be reserved or its mutex can't be set up.
+    static func create(capacity: Int) throws -> SharedMemoryRing {
+        precondition(MemoryLayout<pthread_mutex_t>.size <= consumedOffset, "pthread_mutex_t outgrew the ring header")
+        guard capacity > 0 else {
+            throw FrameError.protocolError("Shared memory ring needs a positive capacity")
+        }
+        var template = Array((NSTemporaryDirectory() as NSString).appendingPathComponent("bifaci-shm-XXXXXX").utf8CString)
+        let fd = mkstemp(&template)
+        guard fd >= 0 else {
+            throw FrameError.ioError("mkstemp failed: \(String(cString: strerror(errno)))")
+        }
+        defer { close(fd) }
+        let path = template.withUnsafeBufferPointer { String(cString: $0.baseAddress!) }
+
+        let length = headerSize + capacity
+        do {
+            try reserveBlocks(fd: fd, length: length)
+        } catch {
+            _ = unlink(path)
+            throw error
+        }
+        guard let base = mmap(nil, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), base != MAP_FAILED else {
+            let reason = String(cString: strerror(errno))
+            _ = unlink(path)
+            throw FrameError.ioError("Failed to map shared memory ring: \(reason)")
+        }
+
+        let ring = SharedMemoryRing(path: path, capacity: capacity, base: base, mappedLength: length)
+        var attr = pthread_mutexattr_t()
+        var status = pthread_mutexattr_init(&attr)
+        if status == 0 {
+            status = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED)
+            if status == 0 {
+                status = pthread_mutex_init(ring.mutex, &attr)
+            }
+            pthread_mutexattr_destroy(&attr)
+        }
+        guard status == 0 else {
+            ring.unlinkFile()
+            throw FrameError.ioError("Failed to set up shared memory ring mutex: \(String(cString: strerror(status)))")
+        }
+        ring.consumed.pointee = 0
+        ring.attached.pointee = 0
+        return ring
+    }
+
+    /// Size the ring file to `length` with every block allocated, so stores
+    /// into the mapping never fault. Preallocates where the file system
+    /// supports it and writes zeros otherwise; ENOSPC surfaces here.
+    private static func reserveBlocks(fd: Int32, length: Int) throws {
+        var store = fstore_t(fst_flags: UInt32(F_ALLOCATEALL), fst_posmode: F_PEOFPOSMODE,
+                             fst_offset: 0, fst_length: off_t(length), fst_bytesalloc: 0)
+        if fcntl(fd, F_PREALLOCATE, &store) == 0 {
+            guard ftruncate(fd, off_t(length)) == 0 else {
+                throw FrameError.ioError("Failed to size shared memory ring: \(String(cString: strerror(errno)))")
+            }
+            return
+        }
+
+        let zeros = [UInt8](repeating: 0, count: 64 * 1024)
+        var written = 0
+        while written < length {
+            let n = zeros.withUnsafeBytes { pwrite(fd, $0.baseAddress!, min($0.count, length - written), off_t(written)) }
+            if n < 0 {
+                if errno == EINTR { continue }
+                throw FrameError.ioError("Failed to reserve shared memory ring: \(String(cString: strerror(errno)))")
+            }
+            written += n
+        }
+    }
+
+    /// Map a ring the peer offered, then unlink its file.
+    static func open(path: String, capacity: Int) throws -> SharedMemoryRing {
+        guard capacity > 0 else {
+            throw FrameError.protocolError("Shared memory ring needs a positive capacity")
+        }
+        let fd = Darwin.open(path, O_RDWR)
+        guard fd >= 0 else {
+            throw FrameError.ioError("Failed to open shared memory ring \(path): \(String(cString: strerror(errno)))")
+        }
+        defer { close(fd) }
+
+        let length = headerSize + capacity
+        var info = stat()
+        guard fstat(fd, &info) == 0, Int(info.st_size) >= length else {
+            throw FrameError.protocolError("Shared memory ring \(path) is smaller than advertised")
+        }
+        guard let base = mmap(nil, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), base != MAP_FAILED else {
+            throw FrameError.ioError("Failed to map shared memory ring \(path): \(String(cString: strerror(errno)))")
+        }
+        _ = unlink(path)
+        let ring = SharedMemoryRing(path: path, capacity: capacity, base: base, mappedLength: length)
+        // The sender starts staging payloads once it sees this
+        pthread_mutex_lock(ring.mutex)
+        ring.attached.pointee = 1
+        pthread_mutex_unlock(ring.mutex)
+        return ring
+    }
+
+    /// Remove the ring's file (sender, when the peer never took the offer).
+    func unlinkFile() {
+        _ = unlink(path)
+    }
+
+    /// Copy `payload` into the ring. Returns its logical offset, or nil when
+    /// it doesn't fit right now or the receiver hasn't mapped the ring (the
+    /// caller sends it inline instead).
+    func put(_ payload: Data) -> UInt64? {
+        let length = payload.count
+        guard length > 0, length <= capacity, peerAttached || loadPeerAttached() else { return nil }
+        let ringSize = UInt64(capacity)
+
+        // Payloads never straddle the end; the skipped tail counts as used
+        var start = head
+        let position = Int(start % ringSize)
+        if position + length > capacity {
+            start += ringSize - UInt64(position)
+        }
+        guard start + UInt64(length) - loadConsumed() <= ringSize else { return nil }
+
+        payload.withUnsafeBytes { src in
+            (bytes + Int(start % ringSize)).copyMemory(from: src.baseAddress!, byteCount: length)
+        }
+        head = start + UInt64(length)
+        return start
+    }
+
+    /// Copy the payload at `offset` out of the ring and release its space.
+    func take(offset: UInt64, length: Int) throws -> Data {
+        let position = Int(offset % UInt64(capacity))
+        guard offset >= taken, length > 0, position + length <= capacity else {
+            throw FrameError.protocolError("Shared memory payload out of range (offset \(offset), length \(length))")
+        }
+        let payload = Data(bytes: bytes + position, count: length)
+        taken = offset + UInt64(length)
+        storeConsumed(taken)
+        return payload
+    }
+
+    private func loadPeerAttached() -> Bool {
+        pthread_mutex_lock(mutex)
+        peerAttached = attached.pointee != 0
+        pthread_mutex_unlock(mutex)
+        return peerAttached
+    }
+
+    private func loadConsumed() -> UInt64 {
+        pthread_mutex_lock(mutex)
+        defer { pthread_mutex_unlock(mutex) }
+        return consumed.pointee
+    }
+
+    private func storeConsumed(_ value: UInt64) {
+        pthread_mutex_lock(mutex)
+        consumed.pointee = value
+        pthread_mutex_unlock(mutex)
+    }
+}
+
+// MARK: - Frame Fields
+
+extension Frame {
+
+    /// Shared memory ring offered in HELLO metadata, if any
+    public var helloSharedMemoryRing: (path: String, size: Int)? {
+        guard frameType == .hello, let meta = meta,
+              case .utf8String(let path) = meta[SHM_RING_PATH_KEY],
+              case .unsignedInt(let size) = meta[SHM_RING_SIZE_KEY] else {
+            return nil
+        }
+        return (path: path, size: Int(size))
+    }
+
+    /// Add a shared memory ring offer to HELLO metadata.
+    mutating func advertiseSharedMemoryRing(_ ring: SharedMemoryRing) {
+        meta?[SHM_RING_PATH_KEY] = .utf8String(ring.path)
+        meta?[SHM_RING_SIZE_KEY] = .unsignedInt(UInt64(ring.capacity))
+    }
+
+    /// Move a large CHUNK payload into `ring`, leaving its offset in meta.
+    /// Leaves the frame alone when the payload is small or the ring is full.
+    mutating func stagePayload(in ring: SharedMemoryRing) {
+        guard frameType == .chunk, let payload = payload, payload.count >= SHARED_MEMORY_MIN_PAYLOAD,
+              let offset = ring.put(payload) else {
+            return
+        }
+        self.payload = nil
+        var fields = meta ?? [:]
+        fields[SHM_OFFSET_KEY] = .unsignedInt(offset)
+        fields[SHM_LENGTH_KEY] = .unsignedInt(UInt64(payload.count))
+        meta = fields
+    }
+
+    /// Put back a payload `stagePayload` moved into the peer's ring.
+    /// Throws if the frame references a ring this link never negotiated.
+    mutating func restorePayload(from ring: SharedMemoryRing?) throws {
+        guard frameType == .chunk, var fields = meta,
+              case .unsignedInt(let offset) = fields[SHM_OFFSET_KEY],
+              case .unsignedInt(let length) = fields[SHM_LENGTH_KEY] else {
+            return
+        }
+        guard let ring = ring else {
+            throw FrameError.protocolError("CHUNK payload in shared memory, but no ring was negotiated")
+        }
+        payload = try ring.take(offset: offset, length: Int(length))
+        fields.removeValue(forKey: SHM_OFFSET_KEY)
+        fields.removeValue(forKey: SHM_LENGTH_KEY)
+        meta = fields.isEmpty ? nil : fields
+    }
+}
+
+// MARK: - Handshake
+
+/// Host side, before sending HELLO: create the outbound ring and offer it.
+/// Returns nil (and offers nothing) when `capacity` is 0 or the ring can't be created.
+func offerSharedMemoryRing(in hello: inout Frame, capacity: Int) -> SharedMemoryRing? {
+    guard capacity > 0 else { return nil }
+    do {
+        let ring = try SharedMemoryRing.create(capacity: capacity)
+        hello.advertiseSharedMemoryRing(ring)
+        return ring
+    } catch {
+        fputs("[Bifaci] Shared memory transport unavailable: \(error.localizedDescription)\n", stderr)
+        return nil
+    }
+}
+
+/// Host side, after reading the plugin's HELLO: if the plugin answered the
+/// offer, map its ring and switch both directions over. A ring that can't
+/// be mapped leaves both directions inline: the plugin has already attached
+/// its rings, but never stages into one the host hasn't flagged as mapped.
+/// - Returns: Capacity of our outbound ring when active, else 0
+func completeSharedMemoryOffer(_ offered: SharedMemoryRing?, theirHello: Frame, reader: FrameReader, writer: FrameWriter) -> Int {
+    guard let ours = offered else { return 0 }
+    guard let theirs = theirHello.helloSharedMemoryRing else {
+        ours.unlinkFile()
+        return 0
+    }
+    let inbound: SharedMemoryRing
+    do {
+        inbound = try SharedMemoryRing.open(path: theirs.path, capacity: theirs.size)
+    } catch {
+        ours.unlinkFile()
+        fputs("[Bifaci] Shared memory transport unavailable, peer ring can't be mapped: \(error.localizedDescription)\n", stderr)
+        return 0
+    }
+    reader.attachSharedMemoryRing(inbound)
+    writer.attachSharedMemoryRing(ours)
+    return ours.capacity
+}
+
+/// Plugin side, after reading the host's HELLO and before answering: map the
+/// host's ring and offer our own in `ourHello`. Any failure leaves both
+/// directions inline — not answering the offer is how the plugin declines.
+/// - Returns: Capacity of our outbound ring when active, else 0
+func acceptSharedMemoryOffer(theirHello: Frame, capacity: Int, ourHello: inout Frame, reader: FrameReader, writer: FrameWriter) -> Int {
+    guard capacity > 0, let theirs = theirHello.helloSharedMemoryRing else { return 0 }
+    do {
+        let inbound = try SharedMemoryRing.open(path: theirs.path, capacity: theirs.size)
+        let ours = try SharedMemoryRing.create(capacity: capacity)
+        ourHello.advertiseSharedMemoryRing(ours)
+        reader.attachSharedMemoryRing(inbound)
+        writer.attachSharedMemoryRing(ours)
+        return ours.capacity
+    } catch {
+        fputs("[Bifaci] Declining shared memory transport: \(error.localizedDescription)\n", stderr)
+        return 0
+    }
+}
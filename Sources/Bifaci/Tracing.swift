@@ -0,0 +1,168 @@
+//
+//  Tracing.swift
+//  Bifaci
+//
+//  Optional per-request trace context carried in frame meta.
+//
+//  The engine opts a request in by calling `startTrace()` on its REQ. Every
+//  hop the REQ passes (RelaySwitch, RelaySlave, PluginHost, the plugin)
+//  appends a timestamped span to the REQ's trace; the plugin copies the
+//  trace it received onto its END/ERR, adds its handler spans, and each hop
+//  on the way back appends again. The terminal frame that reaches the engine
+//  therefore holds the whole journey, and `TraceContext.segments` turns it
+//  into a latency breakdown. Frames without a trace are left untouched, so
+//  untraced requests pay one dictionary lookup per hop.
+//
+//  Timestamps are wall-clock microseconds: hops live in different processes,
+//  and possibly on different machines behind a relay socket, so only a
+//  clock they all share can be compared.
+
+import Foundation
+@preconcurrency import SwiftCBOR
+
+/// Frame meta key holding the trace context
+public let TRACE_META_KEY = "trace"
+
+/// Most spans a trace keeps; further spans are dropped so a looping peer call can't grow a frame without bound
+public let MAX_TRACE_SPANS: Int = 64
+
+/// Hop names used by the Bifaci components
+public enum TraceHop {
+    public static let engine = "engine"
+    public static let relaySwitch = "relay_switch"
+    public static let relaySlave = "relay_slave"
+    public static let relayMaster = "relay_master"
+    public static let pluginHost = "plugin_host"
+    public static let plugin = "plugin"
+}
+
+/// One timestamped event at one hop
+public struct TraceSpan: Sendable, Equatable {
+    public let hop: String
+    public let event: String
+    /// Microseconds since the Unix epoch
+    public let timestampMicros: UInt64
+
+    public init(hop: String, event: String, timestampMicros: UInt64 = traceClock()) {
+        self.hop = hop
+        self.event = event
+        self.timestampMicros = timestampMicros
+    }
+}
+
+/// Time between two consecutive spans of a trace
+public struct TraceSegment: Sendable, Equatable {
+    public let from: TraceSpan
+    public let to: TraceSpan
+
+    /// Elapsed microseconds (negative if the two hosts' clocks disagree)
+    public var micros: Int64 {
+        Int64(bitPattern: to.timestampMicros &- from.timestampMicros)
+    }
+
+    /// "hop.event → hop.event"
+    public var label: String {
+        "\(from.hop).\(from.event) → \(to.hop).\(to.event)"
+    }
+}
+
+/// Trace id plus the spans recorded so far, in the order they were recorded
+public struct TraceContext: Sendable, Equatable {
+    public let traceId: String
+    public private(set) var spans: [TraceSpan]
+
+    public init(traceId: String = UUID().uuidString, spans: [TraceSpan] = []) {
+        self.traceId = traceId
+        self.spans = spans
+    }
+
+    public mutating func record(_ span: TraceSpan) {
+        guard spans.count < MAX_TRACE_SPANS else { return }
+        spans.append(span)
+    }
+
+    /// Consecutive span pairs: where the request spent its time, hop by hop
+    public var segments: [TraceSegment] {
+        guard spans.count > 1 else { return [] }
+        return (1..<spans.count).map { TraceSegment(from: spans[$0 - 1], to: spans[$0]) }
+    }
+
+    /// Microseconds from the first span to the last
+    public var totalMicros: Int64 {
+        guard let first = spans.first, let last = spans.last else { return 0 }
+        return Int64(bitPattern: last.timestampMicros &- first.timestampMicros)
+    }
+
+    func cbor() -> CBOR {
+        .map([
+            .utf8String("id"): .utf8String(traceId),
+            .utf8String("spans"): .array(spans.map {
+                .array([.utf8String($0.hop), .utf8String($0.event), .unsignedInt($0.timestampMicros)])
+            }),
+        ])
+    }
+
+    init?(cbor: CBOR) {
+        guard case .map(let fields) = cbor,
+              case .utf8String(let id)? = fields[.utf8String("id")],
+              case .array(let items)? = fields[.utf8String("spans")] else {
+            return nil
+        }
+        var spans: [TraceSpan] = []
+        for item in items {
+            guard case .array(let parts) = item, parts.count == 3,
+                  case .utf8String(let hop) = parts[0],
+                  case .utf8String(let event) = parts[1],
+                  case .unsignedInt(let ts) = parts[2] else {
+                return nil
+            }
+            spans.append(TraceSpan(hop: hop, event: event, timestampMicros: ts))
+        }
+        self.init(traceId: id, spans: spans)
+    }
+}
+
+/// Wall-clock microseconds since the Unix epoch
+public func traceClock() -> UInt64 {
+    var tv = timeval()
+    gettimeofday(&tv, nil)
+    return UInt64(tv.tv_sec) * 1_000_000 + UInt64(tv.tv_usec)
+}
+
+extension Frame {
+
+    /// Trace context carried in meta, if this request is traced
+    public var traceContext: TraceContext? {
+        get {
+            guard let value = meta?[TRACE_META_KEY] else { return nil }
+            return TraceContext(cbor: value)
+        }
+        set {
+            if let context = newValue {
+                var fields = meta ?? [:]
+                fields[TRACE_META_KEY] = context.cbor()
+                meta = fields
+            } else if meta != nil {
+                meta?.removeValue(forKey: TRACE_META_KEY)
+                if meta?.isEmpty == true { meta = nil }
+            }
+        }
+    }
+
+    /// Opt this REQ into tracing, recording the engine's send as the first span.
+    public mutating func startTrace(traceId: String = UUID().uuidString) {
+        traceContext = TraceContext(traceId: traceId, spans: [TraceSpan(hop: TraceHop.engine, event: "send")])
+    }
+
+    /// Append a span if this frame is traced; otherwise do nothing.
+    public mutating func recordTraceSpan(hop: String, event: String) {
+        guard meta?[TRACE_META_KEY] != nil, var context = traceContext else { return }
+        context.record(TraceSpan(hop: hop, event: event))
+        traceContext = context
+    }
+
+    /// True for frames that carry a trace hop-to-hop: REQs and terminal responses
+    var carriesTrace: Bool {
+        frameType == .req || frameType == .end || frameType == .err
+    }
+}
@@ -256,7 +256,15 @@
 }
 
 - (BOOL)acceptsRequest:(NSString *)requestUrn {
-    return [self findBestCapSet:requestUrn error:nil] != nil;
+    // Existence only: stop at the first registry that accepts, no ranking
+    @synchronized (self) {
+        for (CSCapBlockEntry *entry in self.registries) {
+            if ([entry.registry acceptsRequest:requestUrn]) {
+                return YES;
+            }
+        }
+    }
+    return NO;
 }
 
 - (CSCapGraph *)graph {
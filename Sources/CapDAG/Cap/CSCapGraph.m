@@ -60,11 +60,86 @@
 // CSCapGraph
 // ============================================================================
 
+/// Best achievable (score, length) from a node; length 0 means unreachable
+typedef struct {
+    NSInteger score;
+    NSInteger length;
+} CSCapGraphPathBound;
+
+/// A search-tree node: the path ending at `node`, via `edge` from `parent` (-1 at the root)
+typedef struct {
+    uint32_t node;
+    uint32_t edge;
+    int32_t parent;
+    NSInteger length;
+    NSInteger score;
+    CSCapGraphPathBound bound;
+} CSCapGraphPartialPath;
+
+/// Higher score first, then fewer steps
+static BOOL CSCapGraphBoundBetter(CSCapGraphPathBound a, CSCapGraphPathBound b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.length < b.length;
+}
+
+static BOOL CSCapGraphBoundEqual(CSCapGraphPathBound a, CSCapGraphPathBound b) {
+    return a.score == b.score && a.length == b.length;
+}
+
+static BOOL CSCapGraphPartialPrecedes(const CSCapGraphPartialPath *paths, uint32_t a, uint32_t b) {
+    if (!CSCapGraphBoundEqual(paths[a].bound, paths[b].bound)) {
+        return CSCapGraphBoundBetter(paths[a].bound, paths[b].bound);
+    }
+    return a < b;
+}
+
+static void CSCapGraphHeapPush(NSMutableData *heapData, const CSCapGraphPartialPath *paths, uint32_t value) {
+    [heapData appendBytes:&value length:sizeof(value)];
+    uint32_t *heap = heapData.mutableBytes;
+    NSUInteger i = heapData.length / sizeof(uint32_t) - 1;
+    while (i > 0) {
+        NSUInteger parent = (i - 1) / 2;
+        if (!CSCapGraphPartialPrecedes(paths, heap[i], heap[parent])) break;
+        uint32_t tmp = heap[i]; heap[i] = heap[parent]; heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static uint32_t CSCapGraphHeapPop(NSMutableData *heapData, const CSCapGraphPartialPath *paths) {
+    uint32_t *heap = heapData.mutableBytes;
+    NSUInteger count = heapData.length / sizeof(uint32_t);
+    uint32_t top = heap[0];
+    heap[0] = heap[count - 1];
+    count -= 1;
+    heapData.length = count * sizeof(uint32_t);
+    heap = heapData.mutableBytes;
+    NSUInteger i = 0;
+    while (YES) {
+        NSUInteger left = 2 * i + 1, right = left + 1, best = i;
+        if (left < count && CSCapGraphPartialPrecedes(paths, heap[left], heap[best])) best = left;
+        if (right < count && CSCapGraphPartialPrecedes(paths, heap[right], heap[best])) best = right;
+        if (best == i) break;
+        uint32_t tmp = heap[i]; heap[i] = heap[best]; heap[best] = tmp;
+        i = best;
+    }
+    return top;
+}
+
+
 @interface CSCapGraph ()
 @property (nonatomic, strong) NSMutableArray<CSCapGraphEdge *> *edges;
 @property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *outgoing;
 @property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *incoming;
 @property (nonatomic, strong) NSMutableSet<NSString *> *nodes;
+/// spec -> getOutgoing: result
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSArray<CSCapGraphEdge *> *> *outgoingMatchCache;
+/// spec -> every spec reachable from it (its transitive-closure row)
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSSet<NSString *> *> *reachableCache;
+/// Integer view of `outgoing` for path searches; nil until first needed
+@property (nonatomic, strong, nullable) NSDictionary<NSString *, NSNumber *> *searchNodeIds;
+@property (nonatomic, strong, nullable) NSData *searchEdgeTargets;
+@property (nonatomic, strong, nullable) NSData *searchOutOffsets;
+@property (nonatomic, strong, nullable) NSData *searchOutEdges;
 @end
 
 @implementation CSCapGraph
@@ -80,6 +155,8 @@
         _outgoing = [[NSMutableDictionary alloc] init];
         _incoming = [[NSMutableDictionary alloc] init];
         _nodes = [[NSMutableSet alloc] init];
+        _outgoingMatchCache = [[NSMutableDictionary alloc] init];
+        _reachableCache = [[NSMutableDictionary alloc] init];
     }
     return self;
 }
@@ -113,6 +190,8 @@
         self.incoming[toSpec] = [[NSMutableArray alloc] init];
     }
     [self.incoming[toSpec] addObject:@(edgeIndex)];
+
+    [self invalidateCaches];
 }
 
 - (NSSet<NSString *> *)getNodes {
@@ -124,6 +203,11 @@
 }
 
 - (NSArray<CSCapGraphEdge *> *)getOutgoing:(NSString *)spec {
+    NSArray<CSCapGraphEdge *> *cached = self.outgoingMatchCache[spec];
+    if (cached) {
+        return cached;
+    }
+
     // Use TaggedUrn matching: find all edges where the provided spec
     // satisfies the edge's input requirement (fromSpec)
     NSMutableArray<CSCapGraphEdge *> *result = [[NSMutableArray alloc] init];
@@ -158,7 +242,9 @@
         return NSOrderedSame;
     }];
 
-    return [result copy];
+    NSArray<CSCapGraphEdge *> *matches = [result copy];
+    self.outgoingMatchCache[spec] = matches;
+    return matches;
 }
 
 - (NSArray<CSCapGraphEdge *> *)getIncoming:(NSString *)spec {
@@ -211,27 +297,44 @@
         return NO;
     }
 
+    return [[self reachableSpecsFrom:fromSpec] containsObject:toSpec];
+}
+
+/// Every spec reachable from `fromSpec` through getOutgoing: edges, computed
+/// once per spec. A BFS that meets a spec whose row is known merges that row
+/// instead of walking past it.
+- (NSSet<NSString *> *)reachableSpecsFrom:(NSString *)fromSpec {
+    NSSet<NSString *> *cached = self.reachableCache[fromSpec];
+    if (cached) {
+        return cached;
+    }
+
+    NSMutableSet<NSString *> *reached = [[NSMutableSet alloc] init];
     NSMutableSet<NSString *> *visited = [[NSMutableSet alloc] init];
     NSMutableArray<NSString *> *queue = [[NSMutableArray alloc] init];
     [queue addObject:fromSpec];
     [visited addObject:fromSpec];
 
-    while (queue.count > 0) {
-        NSString *current = queue.firstObject;
-        [queue removeObjectAtIndex:0];
-
+    for (NSUInteger head = 0; head < queue.count; head++) {
+        NSString *current = queue[head];
         for (CSCapGraphEdge *edge in [self getOutgoing:current]) {
-            if ([edge.toSpec isEqualToString:toSpec]) {
-                return YES;
-            }
-            if (![visited containsObject:edge.toSpec]) {
-                [visited addObject:edge.toSpec];
+            [reached addObject:edge.toSpec];
+            if ([visited containsObject:edge.toSpec]) continue;
+            [visited addObject:edge.toSpec];
+
+            NSSet<NSString *> *known = self.reachableCache[edge.toSpec];
+            if (known) {
+                [reached unionSet:known];
+                [visited unionSet:known];
+            } else {
                 [queue addObject:edge.toSpec];
             }
         }
     }
 
-    return NO;
+    NSSet<NSString *> *row = [reached copy];
+    self.reachableCache[fromSpec] = row;
+    return row;
 }
 
 - (NSArray<CSCapGraphEdge *> * _Nullable)findPath:(NSString *)fromSpec toSpec:(NSString *)toSpec {
@@ -373,27 +476,204 @@
 - (NSArray<CSCapGraphEdge *> * _Nullable)findBestPath:(NSString *)fromSpec
                                                toSpec:(NSString *)toSpec
                                              maxDepth:(NSInteger)maxDepth {
-    NSArray<NSArray<CSCapGraphEdge *> *> *allPaths = [self findAllPaths:fromSpec toSpec:toSpec maxDepth:maxDepth];
+    return [self findBestPaths:fromSpec toSpec:toSpec maxDepth:maxDepth limit:1].firstObject;
+}
 
-    if (allPaths.count == 0) {
-        return nil;
+- (NSArray<NSArray<CSCapGraphEdge *> *> *)findBestPaths:(NSString *)fromSpec
+                                                 toSpec:(NSString *)toSpec
+                                               maxDepth:(NSInteger)maxDepth
+                                                  limit:(NSUInteger)limit {
+    if (limit == 0 || ![self.nodes containsObject:fromSpec] || ![self.nodes containsObject:toSpec]) {
+        return @[];
+    }
+
+    [self prepareSearchIndex];
+    NSUInteger nodeCount = self.searchNodeIds.count;
+    const uint32_t *targets = self.searchEdgeTargets.bytes;
+    const uint32_t *offsets = self.searchOutOffsets.bytes;
+    const uint32_t *outEdges = self.searchOutEdges.bytes;
+    uint32_t source = [self.searchNodeIds[fromSpec] unsignedIntValue];
+    uint32_t target = [self.searchNodeIds[toSpec] unsignedIntValue];
+
+    // A simple path (the source may recur once) has at most nodeCount edges;
+    // negative maxDepth means unbounded
+    NSInteger depth = (maxDepth < 0 || (NSUInteger)maxDepth > nodeCount) ? (NSInteger)nodeCount : maxDepth;
+    if (depth == 0) {
+        return @[];
+    }
+
+    // bounds[d * nodeCount + v]: best (score, length) from v to the target in
+    // at most d edges, ignoring the no-revisit rule. An upper bound on any
+    // real path, so the search below pops complete paths best-first.
+    NSMutableData *boundsData = [NSMutableData dataWithLength:(depth + 1) * nodeCount * sizeof(CSCapGraphPathBound)];
+    CSCapGraphPathBound *bounds = boundsData.mutableBytes;
+    for (NSInteger d = 1; d <= depth; d++) {
+        CSCapGraphPathBound *row = bounds + d * nodeCount;
+        const CSCapGraphPathBound *previous = bounds + (d - 1) * nodeCount;
+        for (NSUInteger v = 0; v < nodeCount; v++) {
+            CSCapGraphPathBound best = { 0, 0 };
+            for (uint32_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                uint32_t edge = outEdges[i];
+                uint32_t next = targets[edge];
+                NSInteger specificity = self.edges[edge].specificity;
+                CSCapGraphPathBound candidate;
+                if (next == target) {
+                    candidate = (CSCapGraphPathBound){ specificity, 1 };
+                } else if (previous[next].length > 0) {
+                    candidate = (CSCapGraphPathBound){ specificity + previous[next].score, previous[next].length + 1 };
+                } else {
+                    continue;
+                }
+                if (best.length == 0 || CSCapGraphBoundBetter(candidate, best)) {
+                    best = candidate;
+                }
+            }
+            row[v] = best;
+        }
+    }
+
+    CSCapGraphPathBound rootBound = bounds[depth * nodeCount + source];
+    if (rootBound.length == 0) {
+        return @[];
+    }
+
+    NSMutableData *pathData = [NSMutableData data];
+    NSMutableData *heapData = [NSMutableData data];
+    CSCapGraphPartialPath root = { .node = source, .edge = UINT32_MAX, .parent = -1, .length = 0, .score = 0, .bound = rootBound };
+    [pathData appendBytes:&root length:sizeof(root)];
+    CSCapGraphHeapPush(heapData, pathData.bytes, 0);
+
+    // Complete paths pop in (score desc, length asc) order. After `limit` of
+    // them, keep draining ties so edge-order tie-breaking stays exact.
+    NSMutableArray<NSNumber *> *complete = [NSMutableArray array];
+    CSCapGraphPathBound boundary = { 0, 0 };
+    while (heapData.length > 0) {
+        uint32_t index = CSCapGraphHeapPop(heapData, pathData.bytes);
+        CSCapGraphPartialPath path = ((const CSCapGraphPartialPath *)pathData.bytes)[index];
+        if (complete.count >= limit && CSCapGraphBoundBetter(boundary, path.bound)) {
+            break;
+        }
+
+        if (path.parent >= 0 && path.node == target) {
+            [complete addObject:@(index)];
+            if (complete.count == limit) {
+                boundary = path.bound;
+            }
+            continue;
+        }
+
+        NSInteger remaining = depth - path.length;
+        for (uint32_t i = offsets[path.node]; i < offsets[path.node + 1]; i++) {
+            uint32_t edge = outEdges[i];
+            uint32_t next = targets[edge];
+            NSInteger score = path.score + self.edges[edge].specificity;
+            CSCapGraphPartialPath child = { .node = next, .edge = edge, .parent = (int32_t)index, .length = path.length + 1, .score = score };
+
+            if (next == target) {
+                child.bound = (CSCapGraphPathBound){ score, child.length };
+            } else {
+                if (remaining < 2) continue;
+                CSCapGraphPathBound rest = bounds[(remaining - 1) * nodeCount + next];
+                if (rest.length == 0) continue;
+
+                // Intermediate specs are not revisited (the root is not marked)
+                BOOL onPath = NO;
+                const CSCapGraphPartialPath *paths = pathData.bytes;
+                for (int32_t p = (int32_t)index; p >= 0 && paths[p].parent >= 0; p = paths[p].parent) {
+                    if (paths[p].node == next) {
+                        onPath = YES;
+                        break;
+                    }
+                }
+                if (onPath) continue;
+                child.bound = (CSCapGraphPathBound){ score + rest.score, child.length + rest.length };
+            }
+
+            [pathData appendBytes:&child length:sizeof(child)];
+            CSCapGraphHeapPush(heapData, pathData.bytes, (uint32_t)(pathData.length / sizeof(CSCapGraphPartialPath) - 1));
+        }
     }
 
-    NSArray<CSCapGraphEdge *> *bestPath = nil;
-    NSInteger bestScore = -1;
+    // Edge indices per path, root first
+    const CSCapGraphPartialPath *paths = pathData.bytes;
+    NSMutableArray<NSArray<NSNumber *> *> *edgeLists = [NSMutableArray arrayWithCapacity:complete.count];
+    for (NSNumber *index in complete) {
+        NSMutableArray<NSNumber *> *edgeList = [NSMutableArray array];
+        for (int32_t p = index.intValue; paths[p].parent >= 0; p = paths[p].parent) {
+            [edgeList insertObject:@(paths[p].edge) atIndex:0];
+        }
+        [edgeLists addObject:edgeList];
+    }
 
-    for (NSArray<CSCapGraphEdge *> *path in allPaths) {
-        NSInteger score = 0;
-        for (CSCapGraphEdge *edge in path) {
-            score += edge.specificity;
+    // Equal score and length: the path a depth-first walk in edge order meets first
+    [edgeLists sortUsingComparator:^NSComparisonResult(NSArray<NSNumber *> *a, NSArray<NSNumber *> *b) {
+        NSInteger scoreA = 0, scoreB = 0;
+        for (NSNumber *edge in a) scoreA += self.edges[edge.unsignedIntegerValue].specificity;
+        for (NSNumber *edge in b) scoreB += self.edges[edge.unsignedIntegerValue].specificity;
+        if (scoreA != scoreB) return scoreA > scoreB ? NSOrderedAscending : NSOrderedDescending;
+        if (a.count != b.count) return a.count < b.count ? NSOrderedAscending : NSOrderedDescending;
+        for (NSUInteger i = 0; i < a.count; i++) {
+            NSComparisonResult order = [a[i] compare:b[i]];
+            if (order != NSOrderedSame) return order;
         }
-        if (score > bestScore) {
-            bestScore = score;
-            bestPath = path;
+        return NSOrderedSame;
+    }];
+
+    NSMutableArray<NSArray<CSCapGraphEdge *> *> *result = [NSMutableArray arrayWithCapacity:MIN(limit, edgeLists.count)];
+    for (NSArray<NSNumber *> *edgeList in edgeLists) {
+        if (result.count == limit) break;
+        NSMutableArray<CSCapGraphEdge *> *pathEdges = [NSMutableArray arrayWithCapacity:edgeList.count];
+        for (NSNumber *edge in edgeList) {
+            [pathEdges addObject:self.edges[edge.unsignedIntegerValue]];
         }
+        [result addObject:[pathEdges copy]];
+    }
+    return [result copy];
+}
+
+/// Integer IDs and exact-match adjacency (the `outgoing` index) for path searches
+- (void)prepareSearchIndex {
+    if (self.searchNodeIds) {
+        return;
     }
 
-    return bestPath;
+    NSMutableDictionary<NSString *, NSNumber *> *nodeIds = [NSMutableDictionary dictionaryWithCapacity:self.nodes.count];
+    NSArray<NSString *> *nodes = [[self.nodes allObjects] sortedArrayUsingSelector:@selector(compare:)];
+    for (NSUInteger n = 0; n < nodes.count; n++) {
+        nodeIds[nodes[n]] = @(n);
+    }
+
+    NSMutableData *edgeTargets = [NSMutableData dataWithLength:self.edges.count * sizeof(uint32_t)];
+    uint32_t *targets = edgeTargets.mutableBytes;
+    for (NSUInteger e = 0; e < self.edges.count; e++) {
+        targets[e] = [nodeIds[self.edges[e].toSpec] unsignedIntValue];
+    }
+
+    NSMutableData *outOffsets = [NSMutableData dataWithLength:(nodes.count + 1) * sizeof(uint32_t)];
+    NSMutableData *outEdges = [NSMutableData dataWithCapacity:self.edges.count * sizeof(uint32_t)];
+    for (NSUInteger n = 0; n < nodes.count; n++) {
+        ((uint32_t *)outOffsets.mutableBytes)[n] = (uint32_t)(outEdges.length / sizeof(uint32_t));
+        for (NSNumber *edgeIdx in self.outgoing[nodes[n]]) {
+            uint32_t value = edgeIdx.unsignedIntValue;
+            [outEdges appendBytes:&value length:sizeof(value)];
+        }
+    }
+    ((uint32_t *)outOffsets.mutableBytes)[nodes.count] = (uint32_t)(outEdges.length / sizeof(uint32_t));
+
+    self.searchEdgeTargets = edgeTargets;
+    self.searchOutOffsets = outOffsets;
+    self.searchOutEdges = outEdges;
+    self.searchNodeIds = nodeIds;
+}
+
+/// Drop every structure derived from the edges
+- (void)invalidateCaches {
+    self.searchNodeIds = nil;
+    self.searchEdgeTargets = nil;
+    self.searchOutOffsets = nil;
+    self.searchOutEdges = nil;
+    [self.outgoingMatchCache removeAllObjects];
+    [self.reachableCache removeAllObjects];
 }
 
 - (NSArray<NSString *> *)getInputSpecs {
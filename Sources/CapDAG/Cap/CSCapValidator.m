@@ -21,6 +21,16 @@ NSString * const CSValidationErrorActualValueKey = @"CSValidationErrorActualValu
 NSString * const CSValidationErrorActualTypeKey = @"CSValidationErrorActualTypeKey";
 NSString * const CSValidationErrorExpectedTypeKey = @"CSValidationErrorExpectedTypeKey";
 
+/// Shared so each media spec's schema is compiled once, not per validation
+static CSJSONSchemaValidator *CSSharedSchemaValidator(void) {
+    static CSJSONSchemaValidator *validator;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        validator = [CSJSONSchemaValidator validator];
+    });
+    return validator;
+}
+
 @implementation CSValidationError
 
 @synthesize validationType = _validationType;
@@ -356,7 +366,7 @@ NSString * const CSValidationErrorExpectedTypeKey = @"CSValidationErrorExpectedT
 
     // Schema validation
     if (mediaSpec && mediaSpec.schema) {
-        CSJSONSchemaValidator *schemaValidator = [CSJSONSchemaValidator validator];
+        CSJSONSchemaValidator *schemaValidator = CSSharedSchemaValidator();
         NSError *schemaError = nil;
 
         if (![schemaValidator validateArgument:argDef withValue:value mediaSpecs:cap.mediaSpecs error:&schemaError]) {
@@ -657,7 +667,7 @@ NSString * const CSValidationErrorExpectedTypeKey = @"CSValidationErrorExpectedT
 
     // Schema validation
     if (mediaSpec && mediaSpec.schema) {
-        CSJSONSchemaValidator *schemaValidator = [CSJSONSchemaValidator validator];
+        CSJSONSchemaValidator *schemaValidator = CSSharedSchemaValidator();
         NSError *schemaError = nil;
 
         if (![schemaValidator validateOutput:outputDef withValue:output mediaSpecs:cap.mediaSpecs error:&schemaError]) {
@@ -189,14 +189,322 @@ NSString * const CSSchemaValidationErrorValidationErrorsKey = @"CSSchemaValidati
 
 @end
 
+#pragma mark - Compiled Schemas
+
+/// Media spec definitions whose compiled schema is kept; a full cache is
+/// emptied before the next insert
+static const NSUInteger CSCompiledSchemaCacheLimit = 1024;
+
+typedef NS_ENUM(NSInteger, CSCompiledSchemaType) {
+    /// No "type" keyword: nothing is checked (matches the uncompiled walk)
+    CSCompiledSchemaTypeNone,
+    /// A type name this validator does not check
+    CSCompiledSchemaTypeOther,
+    CSCompiledSchemaTypeString,
+    CSCompiledSchemaTypeInteger,
+    CSCompiledSchemaTypeNumber,
+    CSCompiledSchemaTypeBoolean,
+    CSCompiledSchemaTypeArray,
+    CSCompiledSchemaTypeObject
+};
+
+static CSCompiledSchemaType CSCompiledSchemaTypeFromName(NSString *name) {
+    if ([name isEqualToString:@"string"]) return CSCompiledSchemaTypeString;
+    if ([name isEqualToString:@"integer"]) return CSCompiledSchemaTypeInteger;
+    if ([name isEqualToString:@"number"]) return CSCompiledSchemaTypeNumber;
+    if ([name isEqualToString:@"boolean"]) return CSCompiledSchemaTypeBoolean;
+    if ([name isEqualToString:@"array"]) return CSCompiledSchemaTypeArray;
+    if ([name isEqualToString:@"object"]) return CSCompiledSchemaTypeObject;
+    return CSCompiledSchemaTypeOther;
+}
+
+/// One schema object with its keywords read into typed fields
+@interface CSCompiledSchema : NSObject
+/// Set for a $ref: validation continues at the target. Weak because
+/// recursive schemas form cycles; the owning document keeps local targets
+/// alive and the root document's externalDocuments keeps external ones.
+@property (nonatomic, weak, nullable) CSCompiledSchema *refTarget;
+@property (nonatomic, assign) CSCompiledSchemaType type;
+@property (nonatomic, copy, nullable) NSArray<NSString *> *required;
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, CSCompiledSchema *> *properties;
+@property (nonatomic, strong, nullable) CSCompiledSchema *items;
+@property (nonatomic, strong, nullable) NSNumber *minItems;
+@property (nonatomic, strong, nullable) NSNumber *maxItems;
+@property (nonatomic, strong, nullable) NSNumber *minLength;
+@property (nonatomic, strong, nullable) NSNumber *maxLength;
+@property (nonatomic, copy, nullable) NSString *pattern;
+@property (nonatomic, strong, nullable) NSRegularExpression *regex;
+/// Why `pattern` failed to compile; reported when a string is validated
+@property (nonatomic, copy, nullable) NSString *patternError;
+@property (nonatomic, strong, nullable) NSNumber *minimum;
+@property (nonatomic, strong, nullable) NSNumber *maximum;
+@property (nonatomic, strong, nullable) NSNumber *multipleOf;
+@end
+
+@implementation CSCompiledSchema
+@end
+
+/// A compiled schema document: the root plus every local $ref target in it
+@interface CSCompiledSchemaDocument : NSObject
+@property (nonatomic, strong) CSCompiledSchema *root;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, CSCompiledSchema *> *refTargets;
+/// Every external $ref document this one can reach (set on media spec schemas)
+@property (nonatomic, copy, nullable) NSSet<CSCompiledSchemaDocument *> *externalDocuments;
+@end
+
+@implementation CSCompiledSchemaDocument
+@end
+
+/// A cached external $ref document and every external document it can reach
+@interface CSCompiledSchemaRef : NSObject
+@property (nonatomic, strong) CSCompiledSchemaDocument *document;
+@property (nonatomic, copy) NSSet<CSCompiledSchemaDocument *> *reachable;
+@end
+
+@implementation CSCompiledSchemaRef
+@end
+
+/// State for compiling one media spec schema, built without holding cacheLock
+@interface CSSchemaCompilation : NSObject
+@property (nonatomic, strong, nullable) id<CSSchemaResolver> resolver;
+/// The validator's resolverGeneration when the compilation started
+@property (nonatomic, assign) NSUInteger generation;
+/// External ref -> document, compiled here or taken from the cache
+@property (nonatomic, strong) NSMutableDictionary<NSString *, CSCompiledSchemaDocument *> *documents;
+/// Refs compiled here, published to the cache once compilation succeeds
+@property (nonatomic, strong) NSMutableArray<NSString *> *compiledRefs;
+/// Every external document reached so far
+@property (nonatomic, strong) NSMutableSet<CSCompiledSchemaDocument *> *externals;
+@end
+
+@implementation CSSchemaCompilation
+@end
+
+/// Resolve a local JSON pointer ("#", "#/definitions/item") within `root`
+static id _Nullable CSSchemaPointerTarget(NSDictionary *root, NSString *ref) {
+    if ([ref isEqualToString:@"#"]) {
+        return root;
+    }
+    if (![ref hasPrefix:@"#/"]) {
+        return nil;
+    }
+    id current = root;
+    for (NSString *rawToken in [[ref substringFromIndex:2] componentsSeparatedByString:@"/"]) {
+        NSString *token = [[[rawToken stringByRemovingPercentEncoding] ?: rawToken
+                            stringByReplacingOccurrencesOfString:@"~1" withString:@"/"]
+                           stringByReplacingOccurrencesOfString:@"~0" withString:@"~"];
+        if ([current isKindOfClass:[NSDictionary class]]) {
+            current = current[token];
+        } else if ([current isKindOfClass:[NSArray class]]) {
+            NSInteger index = token.integerValue;
+            current = index >= 0 && (NSUInteger)index < [current count] ? current[index] : nil;
+        } else {
+            return nil;
+        }
+    }
+    return current;
+}
+
+/// Whether following $ref links from `start` arrives at `node`. Terminates
+/// because compilation fails on the first link that would close a loop.
+static BOOL CSSchemaRefChainReaches(CSCompiledSchema * _Nullable start, CSCompiledSchema *node) {
+    for (CSCompiledSchema *current = start; current; current = current.refTarget) {
+        if (current == node) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static BOOL CSSchemaNumberIsInteger(NSNumber *number) {
+    return strcmp([number objCType], @encode(int)) == 0 ||
+           strcmp([number objCType], @encode(long)) == 0 ||
+           strcmp([number objCType], @encode(long long)) == 0 ||
+           strcmp([number objCType], @encode(unsigned int)) == 0 ||
+           strcmp([number objCType], @encode(unsigned long)) == 0 ||
+           strcmp([number objCType], @encode(unsigned long long)) == 0;
+}
+
+static BOOL CSSchemaNumberIsBoolean(NSNumber *number) {
+    return strcmp([number objCType], @encode(BOOL)) == 0 ||
+           strcmp([number objCType], @encode(char)) == 0;
+}
+
+/// Validate `value` against a compiled schema. With `errors` nil this stops
+/// at the first violation; otherwise every top-level violation is recorded.
+/// Nested properties and items report one summary line each, as before.
+static BOOL CSCompiledSchemaValidate(CSCompiledSchema *schema, id value, NSMutableArray<NSString *> * _Nullable errors) {
+    while (schema.refTarget) {
+        schema = schema.refTarget;
+    }
+    BOOL valid = YES;
+
+    switch (schema.type) {
+        case CSCompiledSchemaTypeString:
+            if (![value isKindOfClass:[NSString class]]) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected string but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeInteger:
+            if (![value isKindOfClass:[NSNumber class]] || !CSSchemaNumberIsInteger(value)) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected integer but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeNumber:
+            if (![value isKindOfClass:[NSNumber class]]) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected number but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeBoolean:
+            if (![value isKindOfClass:[NSNumber class]] || !CSSchemaNumberIsBoolean(value)) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected boolean but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeArray:
+            if (![value isKindOfClass:[NSArray class]]) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected array but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeObject:
+            if (![value isKindOfClass:[NSDictionary class]]) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Expected object but got %@", [value class]]];
+                valid = NO;
+            }
+            break;
+        case CSCompiledSchemaTypeNone:
+        case CSCompiledSchemaTypeOther:
+            break;
+    }
+
+    if (schema.type == CSCompiledSchemaTypeObject && [value isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *object = value;
+        for (NSString *requiredProp in schema.required) {
+            if (!object[requiredProp]) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Missing required property '%@'", requiredProp]];
+                valid = NO;
+            }
+        }
+        if (schema.properties) {
+            for (NSString *propName in object) {
+                CSCompiledSchema *propSchema = schema.properties[propName];
+                if (propSchema && !CSCompiledSchemaValidate(propSchema, object[propName], nil)) {
+                    if (!errors) return NO;
+                    [errors addObject:[NSString stringWithFormat:@"Property '%@' validation failed", propName]];
+                    valid = NO;
+                }
+            }
+        }
+    }
+
+    if (schema.type == CSCompiledSchemaTypeArray && [value isKindOfClass:[NSArray class]]) {
+        NSArray *array = value;
+        if (schema.minItems && array.count < schema.minItems.unsignedIntegerValue) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"Array must have at least %@ items but has %lu",
+                             schema.minItems, (unsigned long)array.count]];
+            valid = NO;
+        }
+        if (schema.maxItems && array.count > schema.maxItems.unsignedIntegerValue) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"Array must have at most %@ items but has %lu",
+                             schema.maxItems, (unsigned long)array.count]];
+            valid = NO;
+        }
+        if (schema.items) {
+            for (NSUInteger i = 0; i < array.count; i++) {
+                if (!CSCompiledSchemaValidate(schema.items, array[i], nil)) {
+                    if (!errors) return NO;
+                    [errors addObject:[NSString stringWithFormat:@"Array item %lu validation failed", (unsigned long)i]];
+                    valid = NO;
+                }
+            }
+        }
+    }
+
+    if (schema.type == CSCompiledSchemaTypeString && [value isKindOfClass:[NSString class]]) {
+        NSString *string = value;
+        if (schema.minLength && string.length < schema.minLength.unsignedIntegerValue) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"String must be at least %@ characters but is %lu",
+                             schema.minLength, (unsigned long)string.length]];
+            valid = NO;
+        }
+        if (schema.maxLength && string.length > schema.maxLength.unsignedIntegerValue) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"String must be at most %@ characters but is %lu",
+                             schema.maxLength, (unsigned long)string.length]];
+            valid = NO;
+        }
+        if (schema.regex) {
+            NSRange match = [schema.regex rangeOfFirstMatchInString:string options:0 range:NSMakeRange(0, string.length)];
+            if (match.location == NSNotFound) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"String does not match pattern '%@'", schema.pattern]];
+                valid = NO;
+            }
+        } else if (schema.patternError) {
+            if (!errors) return NO;
+            [errors addObject:schema.patternError];
+            valid = NO;
+        }
+    }
+
+    if ((schema.type == CSCompiledSchemaTypeNumber || schema.type == CSCompiledSchemaTypeInteger) &&
+        [value isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = value;
+        if (schema.minimum && [number compare:schema.minimum] == NSOrderedAscending) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"Number must be >= %@ but is %@", schema.minimum, number]];
+            valid = NO;
+        }
+        if (schema.maximum && [number compare:schema.maximum] == NSOrderedDescending) {
+            if (!errors) return NO;
+            [errors addObject:[NSString stringWithFormat:@"Number must be <= %@ but is %@", schema.maximum, number]];
+            valid = NO;
+        }
+        if (schema.multipleOf) {
+            double quotient = number.doubleValue / schema.multipleOf.doubleValue;
+            if (fmod(quotient, 1.0) != 0.0) {
+                if (!errors) return NO;
+                [errors addObject:[NSString stringWithFormat:@"Number must be a multiple of %@", schema.multipleOf]];
+                valid = NO;
+            }
+        }
+    }
+
+    return valid;
+}
+
 #pragma mark - CSJSONSchemaValidator Implementation
 
 @interface CSJSONSchemaValidator ()
-@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary *> *schemaCache;
+/// Guards the resolver and the caches below. Never held while compiling or
+/// calling the resolver, which may be slow or call back into this validator.
+@property (nonatomic, strong) NSLock *cacheLock;
+/// Bumped by setResolver:; compilations against an older resolver are not cached
+@property (nonatomic, assign) NSUInteger resolverGeneration;
+/// Media spec definition (by identity) -> compiled schema document, or NSNull if it has no schema
+@property (nonatomic, strong) NSMapTable<NSDictionary *, id> *compiledSpecs;
+/// External schema ref -> compiled document, resolved once through the resolver
+@property (nonatomic, strong) NSMutableDictionary<NSString *, CSCompiledSchemaRef *> *compiledRefs;
 @end
 
 @implementation CSJSONSchemaValidator
 
+@synthesize resolver = _resolver;
+
 + (instancetype)validator {
     return [[self alloc] init];
 }
@@ -210,45 +518,68 @@ NSString * const CSSchemaValidationErrorValidationErrorsKey = @"CSSchemaValidati
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _schemaCache = [NSMutableDictionary dictionary];
+        _cacheLock = [[NSLock alloc] init];
+        _compiledSpecs = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                   valueOptions:NSPointerFunctionsStrongMemory
+                                                       capacity:0];
+        _compiledRefs = [NSMutableDictionary dictionary];
     }
     return self;
 }
 
+- (nullable id<CSSchemaResolver>)resolver {
+    [self.cacheLock lock];
+    id<CSSchemaResolver> resolver = _resolver;
+    [self.cacheLock unlock];
+    return resolver;
+}
+
+- (void)setResolver:(nullable id<CSSchemaResolver>)resolver {
+    // Compiled $refs came from the old resolver
+    [self.cacheLock lock];
+    _resolver = resolver;
+    self.resolverGeneration += 1;
+    [self.compiledSpecs removeAllObjects];
+    [self.compiledRefs removeAllObjects];
+    [self.cacheLock unlock];
+}
+
 - (BOOL)validateArgument:(CSCapArg *)argument
                withValue:(id)value
               mediaSpecs:(NSArray<NSDictionary *> *)mediaSpecs
                    error:(NSError **)error {
-    // Resolve the mediaUrn to get the schema
-    NSDictionary *schema = [self resolveArgumentSchema:argument mediaSpecs:mediaSpecs error:error];
+    // Resolve the mediaUrn to its compiled schema
+    NSError *resolveError = nil;
+    CSCompiledSchemaDocument *schema = [self compiledSchemaForMediaUrn:argument.mediaUrn mediaSpecs:mediaSpecs error:&resolveError];
     if (!schema) {
-        // If there's an error, it's already set
-        // If no schema, validation passes (no schema means no validation needed)
-        return error == nil || *error == nil;
+        // A resolution failure is reported; no schema means no validation needed
+        if (resolveError && error) {
+            *error = resolveError;
+            return NO;
+        }
+        return YES;
     }
 
-    return [self validateValue:value
-                 againstSchema:schema
-                       context:[NSString stringWithFormat:@"argument '%@'", argument.mediaUrn]
-                         error:error];
+    return [self validateValue:value againstSchema:schema argumentName:argument.mediaUrn error:error];
 }
 
 - (BOOL)validateOutput:(CSCapOutput *)output
              withValue:(id)value
             mediaSpecs:(NSArray<NSDictionary *> *)mediaSpecs
                  error:(NSError **)error {
-    // Resolve the mediaUrn to get the schema
-    NSDictionary *schema = [self resolveOutputSchema:output mediaSpecs:mediaSpecs error:error];
+    // Resolve the mediaUrn to its compiled schema
+    NSError *resolveError = nil;
+    CSCompiledSchemaDocument *schema = [self compiledSchemaForMediaUrn:output.mediaUrn mediaSpecs:mediaSpecs error:&resolveError];
     if (!schema) {
-        // If there's an error, it's already set
-        // If no schema, validation passes
-        return error == nil || *error == nil;
+        // A resolution failure is reported; no schema means no validation needed
+        if (resolveError && error) {
+            *error = resolveError;
+            return NO;
+        }
+        return YES;
     }
 
-    return [self validateValue:value
-                 againstSchema:schema
-                       context:@"output"
-                         error:error];
+    return [self validateValue:value againstSchema:schema argumentName:nil error:error];
 }
 
 - (BOOL)validateArguments:(CSCap *)cap
@@ -327,275 +658,279 @@ NSString * const CSSchemaValidationErrorValidationErrorsKey = @"CSSchemaValidati
 
 #pragma mark - Private Methods
 
-- (nullable NSDictionary *)resolveArgumentSchema:(CSCapArg *)argument
-                                      mediaSpecs:(NSArray<NSDictionary *> *)mediaSpecs
-                                           error:(NSError **)error {
-    // Get the media URN from the argument
-    NSString *specId = argument.mediaUrn;
-    if (!specId) {
+/// The compiled schema of `mediaUrn`'s spec, compiled on first use. Returns
+/// nil with no error when the spec has no schema.
+- (nullable CSCompiledSchemaDocument *)compiledSchemaForMediaUrn:(nullable NSString *)mediaUrn
+                                                      mediaSpecs:(NSArray<NSDictionary *> *)mediaSpecs
+                                                           error:(NSError **)error {
+    if (!mediaUrn) {
         // No mediaUrn, no schema validation needed
         return nil;
     }
 
-    // Resolve the spec ID to a MediaSpec
-    NSError *resolveError = nil;
-    CSMediaSpec *mediaSpec = CSResolveMediaUrn(specId, mediaSpecs, &resolveError);
-    if (!mediaSpec) {
-        // FAIL HARD on unresolvable spec ID
-        if (error && resolveError) {
-            *error = resolveError;
+    // The definition CSResolveMediaUrn would pick; compiled results are keyed by it
+    NSDictionary *definition = nil;
+    for (NSDictionary *def in mediaSpecs) {
+        NSString *urn = def[@"urn"];
+        if (urn && [urn isEqualToString:mediaUrn]) {
+            definition = def;
+            break;
         }
-        return nil;
     }
 
-    // Return the schema from the resolved MediaSpec
-    return mediaSpec.schema;
-}
-
-- (nullable NSDictionary *)resolveOutputSchema:(CSCapOutput *)output
-                                    mediaSpecs:(NSArray<NSDictionary *> *)mediaSpecs
-                                         error:(NSError **)error {
-    // Get the media URN from the output
-    NSString *specId = output.mediaUrn;
-    if (!specId) {
-        // No mediaUrn, no schema validation needed
-        return nil;
+    [self.cacheLock lock];
+    id cached = definition ? [self.compiledSpecs objectForKey:definition] : nil;
+    id<CSSchemaResolver> resolver = _resolver;
+    NSUInteger generation = self.resolverGeneration;
+    [self.cacheLock unlock];
+    if (cached) {
+        return cached == [NSNull null] ? nil : cached;
     }
+    CSSchemaCompilation *compilation = [[CSSchemaCompilation alloc] init];
+    compilation.resolver = resolver;
+    compilation.generation = generation;
+    compilation.documents = [NSMutableDictionary dictionary];
+    compilation.compiledRefs = [NSMutableArray array];
+    compilation.externals = [NSMutableSet set];
 
-    // Resolve the spec ID to a MediaSpec
+    // Resolve the spec ID to a MediaSpec - FAIL HARD on unresolvable spec ID
     NSError *resolveError = nil;
-    CSMediaSpec *mediaSpec = CSResolveMediaUrn(specId, mediaSpecs, &resolveError);
+    CSMediaSpec *mediaSpec = CSResolveMediaUrn(mediaUrn, mediaSpecs, &resolveError);
     if (!mediaSpec) {
-        // FAIL HARD on unresolvable spec ID
-        if (error && resolveError) {
-            *error = resolveError;
-        }
+        if (error) *error = resolveError;
         return nil;
     }
 
-    // Return the schema from the resolved MediaSpec
-    return mediaSpec.schema;
-}
-
-- (BOOL)validateValue:(id)value
-        againstSchema:(NSDictionary *)schema
-              context:(NSString *)context
-                error:(NSError **)error {
-    // Basic JSON Schema Draft-7 validation implementation
-    // This is a simplified implementation - for production use, consider a full JSON Schema library
-
-    NSMutableArray<NSString *> *errors = [NSMutableArray array];
-
-    // Validate type
-    NSString *expectedType = schema[@"type"];
-    if (expectedType) {
-        if (![self validateValueType:value expectedType:expectedType errors:errors]) {
-            // Type validation failed, add to errors array
+    CSCompiledSchemaDocument *document = nil;
+    if (mediaSpec.schema) {
+        document = [self compileDocument:mediaSpec.schema compilation:compilation error:error];
+        if (!document) {
+            return nil;
         }
     }
 
-    // Validate properties for objects
-    if ([expectedType isEqualToString:@"object"] && [value isKindOfClass:[NSDictionary class]]) {
-        [self validateObjectProperties:(NSDictionary *)value schema:schema errors:errors];
+    // Publish unless the resolver changed meanwhile; a concurrent
+    // compilation of the same spec that got there first wins
+    [self.cacheLock lock];
+    if (compilation.generation == self.resolverGeneration) {
+        NSSet<CSCompiledSchemaDocument *> *reachable = [compilation.externals copy];
+        for (NSString *ref in compilation.compiledRefs) {
+            if (!self.compiledRefs[ref]) {
+                CSCompiledSchemaRef *entry = [[CSCompiledSchemaRef alloc] init];
+                entry.document = compilation.documents[ref];
+                entry.reachable = reachable;
+                self.compiledRefs[ref] = entry;
+            }
+        }
+        if (definition) {
+            id existing = [self.compiledSpecs objectForKey:definition];
+            if (existing) {
+                document = existing == [NSNull null] ? nil : existing;
+            } else {
+                if (self.compiledSpecs.count >= CSCompiledSchemaCacheLimit) {
+                    [self.compiledSpecs removeAllObjects];
+                }
+                [self.compiledSpecs setObject:document ?: [NSNull null] forKey:definition];
+            }
+        }
     }
+    [self.cacheLock unlock];
+    return document;
+}
 
-    // Validate items for arrays
-    if ([expectedType isEqualToString:@"array"] && [value isKindOfClass:[NSArray class]]) {
-        [self validateArrayItems:(NSArray *)value schema:schema errors:errors];
+/// Compile a media spec's schema document, keeping every external document it reaches.
+- (nullable CSCompiledSchemaDocument *)compileDocument:(NSDictionary *)schema
+                                           compilation:(CSSchemaCompilation *)compilation
+                                                 error:(NSError **)error {
+    CSCompiledSchemaDocument *document = [[CSCompiledSchemaDocument alloc] init];
+    document.root = [[CSCompiledSchema alloc] init];
+    document.refTargets = [NSMutableDictionary dictionary];
+    if (![self fillSchema:document.root fromDictionary:schema document:document rootSchema:schema compilation:compilation error:error]) {
+        return nil;
     }
+    document.externalDocuments = compilation.externals;
+    return document;
+}
 
-    // Validate string constraints
-    if ([expectedType isEqualToString:@"string"] && [value isKindOfClass:[NSString class]]) {
-        [self validateStringConstraints:(NSString *)value schema:schema errors:errors];
+/// The compiled document for an external $ref, resolved and compiled once.
+- (nullable CSCompiledSchemaDocument *)compiledDocumentForRef:(NSString *)ref
+                                                  compilation:(CSSchemaCompilation *)compilation
+                                                        error:(NSError **)error {
+    CSCompiledSchemaDocument *known = compilation.documents[ref];
+    if (known) {
+        return known;
     }
 
-    // Validate number constraints
-    if (([expectedType isEqualToString:@"number"] || [expectedType isEqualToString:@"integer"]) &&
-        [value isKindOfClass:[NSNumber class]]) {
-        [self validateNumberConstraints:(NSNumber *)value schema:schema errors:errors];
+    [self.cacheLock lock];
+    CSCompiledSchemaRef *cached = compilation.generation == self.resolverGeneration ? self.compiledRefs[ref] : nil;
+    [self.cacheLock unlock];
+    if (cached) {
+        compilation.documents[ref] = cached.document;
+        [compilation.externals unionSet:cached.reachable];
+        return cached.document;
     }
 
-    // Check for validation errors
-    if (errors.count > 0) {
+    NSError *resolveError = nil;
+    NSDictionary *schema = [compilation.resolver resolveSchema:ref error:&resolveError];
+    if (!schema) {
         if (error) {
-            if ([context hasPrefix:@"argument"]) {
-                NSString *argumentName = [context stringByReplacingOccurrencesOfString:@"argument '" withString:@""];
-                argumentName = [argumentName stringByReplacingOccurrencesOfString:@"'" withString:@""];
-                *error = [CSSchemaValidationError mediaValidationError:argumentName
-                                                         validationErrors:errors
-                                                                    value:value];
-            } else {
-                *error = [CSSchemaValidationError outputValidationError:errors value:value];
-            }
+            *error = resolveError ?: [CSSchemaValidationError schemaRefNotResolvedError:ref context:@"resolver returned no schema"];
         }
-        return NO;
+        return nil;
     }
 
-    return YES;
+    // Registered before compiling so schemas that refer back to it terminate
+    CSCompiledSchemaDocument *document = [[CSCompiledSchemaDocument alloc] init];
+    document.root = [[CSCompiledSchema alloc] init];
+    document.refTargets = [NSMutableDictionary dictionary];
+    compilation.documents[ref] = document;
+    [compilation.compiledRefs addObject:ref];
+    [compilation.externals addObject:document];
+    if (![self fillSchema:document.root fromDictionary:schema document:document rootSchema:schema compilation:compilation error:error]) {
+        return nil;
+    }
+    return document;
 }
 
-- (BOOL)validateValueType:(id)value expectedType:(NSString *)expectedType errors:(NSMutableArray<NSString *> *)errors {
-    if ([expectedType isEqualToString:@"string"]) {
-        if (![value isKindOfClass:[NSString class]]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected string but got %@", [value class]]];
-            return NO;
-        }
-    } else if ([expectedType isEqualToString:@"integer"]) {
-        if (![value isKindOfClass:[NSNumber class]] || ![self isInteger:(NSNumber *)value]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected integer but got %@", [value class]]];
-            return NO;
-        }
-    } else if ([expectedType isEqualToString:@"number"]) {
-        if (![value isKindOfClass:[NSNumber class]]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected number but got %@", [value class]]];
-            return NO;
-        }
-    } else if ([expectedType isEqualToString:@"boolean"]) {
-        if (![value isKindOfClass:[NSNumber class]] || ![self isBoolean:(NSNumber *)value]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected boolean but got %@", [value class]]];
-            return NO;
-        }
-    } else if ([expectedType isEqualToString:@"array"]) {
-        if (![value isKindOfClass:[NSArray class]]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected array but got %@", [value class]]];
-            return NO;
-        }
-    } else if ([expectedType isEqualToString:@"object"]) {
-        if (![value isKindOfClass:[NSDictionary class]]) {
-            [errors addObject:[NSString stringWithFormat:@"Expected object but got %@", [value class]]];
-            return NO;
-        }
+- (nullable CSCompiledSchema *)compileSchema:(id)schema
+                                    document:(CSCompiledSchemaDocument *)document
+                                  rootSchema:(NSDictionary *)rootSchema
+                                 compilation:(CSSchemaCompilation *)compilation
+                                       error:(NSError **)error {
+    if (![schema isKindOfClass:[NSDictionary class]]) {
+        return nil;
     }
-    return YES;
+    CSCompiledSchema *compiled = [[CSCompiledSchema alloc] init];
+    if (![self fillSchema:compiled fromDictionary:schema document:document rootSchema:rootSchema compilation:compilation error:error]) {
+        return nil;
+    }
+    return compiled;
 }
 
-- (void)validateObjectProperties:(NSDictionary *)object schema:(NSDictionary *)schema errors:(NSMutableArray<NSString *> *)errors {
-    NSDictionary *properties = schema[@"properties"];
-    NSArray *required = schema[@"required"];
-
-    // Check required properties
-    if (required) {
-        for (NSString *requiredProp in required) {
-            if (!object[requiredProp]) {
-                [errors addObject:[NSString stringWithFormat:@"Missing required property '%@'", requiredProp]];
+/// Read one schema object's keywords into `compiled`.
+- (BOOL)fillSchema:(CSCompiledSchema *)compiled
+    fromDictionary:(NSDictionary *)schema
+          document:(CSCompiledSchemaDocument *)document
+        rootSchema:(NSDictionary *)rootSchema
+       compilation:(CSSchemaCompilation *)compilation
+             error:(NSError **)error {
+    // $ref replaces the rest of the object (Draft-7)
+    id ref = schema[@"$ref"];
+    if ([ref isKindOfClass:[NSString class]]) {
+        if ([ref hasPrefix:@"#"]) {
+            CSCompiledSchema *target = document.refTargets[ref];
+            if (!target) {
+                id targetSchema = CSSchemaPointerTarget(rootSchema, ref);
+                if (![targetSchema isKindOfClass:[NSDictionary class]]) {
+                    if (error) {
+                        *error = [CSSchemaValidationError schemaRefNotResolvedError:ref context:@"local reference not found in schema"];
+                    }
+                    return NO;
+                }
+                // Registered before compiling so recursive references terminate
+                target = [[CSCompiledSchema alloc] init];
+                document.refTargets[ref] = target;
+                if (![self fillSchema:target fromDictionary:targetSchema document:document rootSchema:rootSchema compilation:compilation error:error]) {
+                    return NO;
+                }
             }
+            compiled.refTarget = target;
+        } else if (compilation.resolver) {
+            CSCompiledSchemaDocument *external = [self compiledDocumentForRef:ref compilation:compilation error:error];
+            if (!external) {
+                return NO;
+            }
+            compiled.refTarget = external.root;
         }
-    }
-
-    // Validate property types and constraints
-    if (properties) {
-        for (NSString *propName in object) {
-            NSDictionary *propSchema = properties[propName];
-            if (propSchema) {
-                // Recursively validate property
-                NSMutableArray *propErrors = [NSMutableArray array];
-                if (![self validateValue:object[propName]
-                          againstSchema:propSchema
-                                context:[NSString stringWithFormat:@"property '%@'", propName]
-                                  error:nil]) {
-                    [errors addObject:[NSString stringWithFormat:@"Property '%@' validation failed", propName]];
-                }
+        // Every link is checked as it is set, so the one closing a loop of
+        // $ref-only schemas finds its way back here; validation would spin
+        if (CSSchemaRefChainReaches(compiled.refTarget, compiled)) {
+            if (error) {
+                *error = [CSSchemaValidationError schemaRefNotResolvedError:ref context:@"reference cycle never reaches a schema"];
             }
+            return NO;
         }
+        // Without a resolver an external $ref is not checked
+        return YES;
     }
-}
 
-- (void)validateArrayItems:(NSArray *)array schema:(NSDictionary *)schema errors:(NSMutableArray<NSString *> *)errors {
-    NSDictionary *items = schema[@"items"];
-    NSNumber *minItems = schema[@"minItems"];
-    NSNumber *maxItems = schema[@"maxItems"];
+    id type = schema[@"type"];
+    compiled.type = [type isKindOfClass:[NSString class]] ? CSCompiledSchemaTypeFromName(type) : CSCompiledSchemaTypeNone;
 
-    // Check array length constraints
-    if (minItems && array.count < minItems.unsignedIntegerValue) {
-        [errors addObject:[NSString stringWithFormat:@"Array must have at least %@ items but has %lu",
-                         minItems, (unsigned long)array.count]];
+    id required = schema[@"required"];
+    if ([required isKindOfClass:[NSArray class]]) {
+        compiled.required = required;
     }
 
-    if (maxItems && array.count > maxItems.unsignedIntegerValue) {
-        [errors addObject:[NSString stringWithFormat:@"Array must have at most %@ items but has %lu",
-                         maxItems, (unsigned long)array.count]];
-    }
-
-    // Validate each item
-    if (items) {
-        for (NSUInteger i = 0; i < array.count; i++) {
-            NSMutableArray *itemErrors = [NSMutableArray array];
-            if (![self validateValue:array[i]
-                      againstSchema:items
-                            context:[NSString stringWithFormat:@"array item %lu", (unsigned long)i]
-                              error:nil]) {
-                [errors addObject:[NSString stringWithFormat:@"Array item %lu validation failed", (unsigned long)i]];
+    id properties = schema[@"properties"];
+    if ([properties isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary<NSString *, CSCompiledSchema *> *compiledProperties = [NSMutableDictionary dictionaryWithCapacity:[properties count]];
+        for (NSString *propName in properties) {
+            id propSchema = properties[propName];
+            if (![propSchema isKindOfClass:[NSDictionary class]]) continue;
+            CSCompiledSchema *compiledProp = [self compileSchema:propSchema document:document rootSchema:rootSchema compilation:compilation error:error];
+            if (!compiledProp) {
+                return NO;
             }
+            compiledProperties[propName] = compiledProp;
         }
-    }
-}
-
-- (void)validateStringConstraints:(NSString *)string schema:(NSDictionary *)schema errors:(NSMutableArray<NSString *> *)errors {
-    NSNumber *minLength = schema[@"minLength"];
-    NSNumber *maxLength = schema[@"maxLength"];
-    NSString *pattern = schema[@"pattern"];
-
-    if (minLength && string.length < minLength.unsignedIntegerValue) {
-        [errors addObject:[NSString stringWithFormat:@"String must be at least %@ characters but is %lu",
-                         minLength, (unsigned long)string.length]];
+        compiled.properties = compiledProperties;
     }
 
-    if (maxLength && string.length > maxLength.unsignedIntegerValue) {
-        [errors addObject:[NSString stringWithFormat:@"String must be at most %@ characters but is %lu",
-                         maxLength, (unsigned long)string.length]];
+    id items = schema[@"items"];
+    if ([items isKindOfClass:[NSDictionary class]]) {
+        compiled.items = [self compileSchema:items document:document rootSchema:rootSchema compilation:compilation error:error];
+        if (!compiled.items) {
+            return NO;
+        }
     }
 
-    if (pattern) {
-        NSError *regexError;
-        NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern
-                                                                               options:0
-                                                                                 error:&regexError];
-        if (regex) {
-            NSUInteger matches = [regex numberOfMatchesInString:string
-                                                        options:0
-                                                          range:NSMakeRange(0, string.length)];
-            if (matches == 0) {
-                [errors addObject:[NSString stringWithFormat:@"String does not match pattern '%@'", pattern]];
-            }
-        } else {
-            [errors addObject:[NSString stringWithFormat:@"Invalid regex pattern '%@': %@", pattern, regexError.localizedDescription]];
+    NSNumber * _Nullable (^number)(NSString *) = ^NSNumber * _Nullable (NSString *keyword) {
+        id value = schema[keyword];
+        return [value isKindOfClass:[NSNumber class]] ? value : nil;
+    };
+    compiled.minItems = number(@"minItems");
+    compiled.maxItems = number(@"maxItems");
+    compiled.minLength = number(@"minLength");
+    compiled.maxLength = number(@"maxLength");
+    compiled.minimum = number(@"minimum");
+    compiled.maximum = number(@"maximum");
+    compiled.multipleOf = number(@"multipleOf");
+
+    id pattern = schema[@"pattern"];
+    if ([pattern isKindOfClass:[NSString class]]) {
+        compiled.pattern = pattern;
+        NSError *regexError = nil;
+        compiled.regex = [NSRegularExpression regularExpressionWithPattern:pattern options:0 error:&regexError];
+        if (!compiled.regex) {
+            compiled.patternError = [NSString stringWithFormat:@"Invalid regex pattern '%@': %@", pattern, regexError.localizedDescription];
         }
     }
-}
-
-- (void)validateNumberConstraints:(NSNumber *)number schema:(NSDictionary *)schema errors:(NSMutableArray<NSString *> *)errors {
-    NSNumber *minimum = schema[@"minimum"];
-    NSNumber *maximum = schema[@"maximum"];
-    NSNumber *multipleOf = schema[@"multipleOf"];
 
-    if (minimum && [number compare:minimum] == NSOrderedAscending) {
-        [errors addObject:[NSString stringWithFormat:@"Number must be >= %@ but is %@", minimum, number]];
-    }
+    return YES;
+}
 
-    if (maximum && [number compare:maximum] == NSOrderedDescending) {
-        [errors addObject:[NSString stringWithFormat:@"Number must be <= %@ but is %@", maximum, number]];
+- (BOOL)validateValue:(id)value
+        againstSchema:(CSCompiledSchemaDocument *)schema
+         argumentName:(nullable NSString *)argumentName
+                error:(NSError **)error {
+    // Fast pass without collecting messages; walk again only to report
+    if (CSCompiledSchemaValidate(schema.root, value, nil)) {
+        return YES;
     }
 
-    if (multipleOf) {
-        double quotient = number.doubleValue / multipleOf.doubleValue;
-        if (fmod(quotient, 1.0) != 0.0) {
-            [errors addObject:[NSString stringWithFormat:@"Number must be a multiple of %@", multipleOf]];
+    if (error) {
+        NSMutableArray<NSString *> *errors = [NSMutableArray array];
+        CSCompiledSchemaValidate(schema.root, value, errors);
+        if (argumentName) {
+            *error = [CSSchemaValidationError mediaValidationError:argumentName
+                                                     validationErrors:errors
+                                                                value:value];
+        } else {
+            *error = [CSSchemaValidationError outputValidationError:errors value:value];
         }
     }
-}
-
-- (BOOL)isInteger:(NSNumber *)number {
-    return strcmp([number objCType], @encode(int)) == 0 ||
-           strcmp([number objCType], @encode(long)) == 0 ||
-           strcmp([number objCType], @encode(long long)) == 0 ||
-           strcmp([number objCType], @encode(unsigned int)) == 0 ||
-           strcmp([number objCType], @encode(unsigned long)) == 0 ||
-           strcmp([number objCType], @encode(unsigned long long)) == 0;
-}
-
-- (BOOL)isBoolean:(NSNumber *)number {
-    return strcmp([number objCType], @encode(BOOL)) == 0 ||
-           strcmp([number objCType], @encode(char)) == 0;
+    return NO;
 }
 
 @end
@@ -270,8 +270,38 @@ NSArray<NSString *> * _Nullable CSInputResolverExpandGlob(NSString *pattern, NSE
 
 #pragma mark - Media Adapter Registry
 
+/// Node of the magic-byte prefix trie. adapterIndex is the lowest-priority
+/// index of an adapter whose pattern ends here, or NSNotFound.
+@interface CSMagicTrieNode : NSObject
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, CSMagicTrieNode *> *children;
+@property (nonatomic, assign) NSUInteger adapterIndex;
+@end
+
+@implementation CSMagicTrieNode
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _children = [NSMutableDictionary dictionary];
+        _adapterIndex = NSNotFound;
+    }
+    return self;
+}
+
+@end
+
 @implementation CSMediaAdapterRegistry {
     NSArray<id<CSMediaAdapter>> *_adapters;
+    /// Extension -> index of the first table-driven adapter claiming it
+    NSDictionary<NSString *, NSNumber *> *_extensionIndex;
+    /// Indices of adapters with their own matchesExtension:, ascending
+    NSArray<NSNumber *> *_customExtensionAdapters;
+    /// Prefix trie over the magicPatterns of table-driven adapters
+    CSMagicTrieNode *_magicTrie;
+    /// Indices of adapters with their own matchesMagicBytes:, ascending
+    NSArray<NSNumber *> *_customMagicAdapters;
+    /// Base media type -> adapter that inspects content for it
+    NSDictionary<NSString *, id<CSMediaAdapter>> *_inspectionAdapters;
 }
 
 + (CSMediaAdapterRegistry *)shared {
@@ -287,6 +317,7 @@ NSArray<NSString *> * _Nullable CSInputResolverExpandGlob(NSString *pattern, NSE
     self = [super init];
     if (self) {
         [self _registerAllAdapters];
+        [self _buildLookupTables];
     }
     return self;
 }
@@ -431,27 +462,131 @@ NSArray<NSString *> * _Nullable CSInputResolverExpandGlob(NSString *pattern, NSE
     ];
 }
 
+/// Whether the adapter matches through CSBaseAdapter's table lookup for the
+/// selector, so its extensions/magicPatterns can be indexed up front
+static BOOL _usesBaseMatcher(id<CSMediaAdapter> adapter, SEL selector) {
+    if (![adapter isKindOfClass:[CSBaseAdapter class]]) {
+        return NO;
+    }
+    return [[adapter class] instanceMethodForSelector:selector] ==
+           [CSBaseAdapter instanceMethodForSelector:selector];
+}
+
+/// Index the adapters once so lookups no longer test every adapter in turn.
+/// Adapters that override a matcher keep being asked directly, in priority
+/// order, so the first match is the same adapter the linear scan returned.
+- (void)_buildLookupTables {
+    NSMutableDictionary<NSString *, NSNumber *> *extensionIndex = [NSMutableDictionary dictionary];
+    NSMutableArray<NSNumber *> *customExtension = [NSMutableArray array];
+    CSMagicTrieNode *trie = [[CSMagicTrieNode alloc] init];
+    NSMutableArray<NSNumber *> *customMagic = [NSMutableArray array];
+
+    for (NSUInteger i = 0; i < _adapters.count; i++) {
+        id<CSMediaAdapter> adapter = _adapters[i];
+
+        if (_usesBaseMatcher(adapter, @selector(matchesExtension:))) {
+            for (NSString *ext in ((CSBaseAdapter *)adapter).extensions) {
+                NSString *key = [ext lowercaseString];
+                if (!extensionIndex[key]) {
+                    extensionIndex[key] = @(i);
+                }
+            }
+        } else {
+            [customExtension addObject:@(i)];
+        }
+
+        if (_usesBaseMatcher(adapter, @selector(matchesMagicBytes:))) {
+            for (NSData *pattern in ((CSBaseAdapter *)adapter).magicPatterns) {
+                CSMagicTrieNode *node = trie;
+                const uint8_t *bytes = pattern.bytes;
+                for (NSUInteger b = 0; b < pattern.length; b++) {
+                    CSMagicTrieNode *child = node.children[@(bytes[b])];
+                    if (!child) {
+                        child = [[CSMagicTrieNode alloc] init];
+                        node.children[@(bytes[b])] = child;
+                    }
+                    node = child;
+                }
+                node.adapterIndex = MIN(node.adapterIndex, i);
+            }
+        } else {
+            [customMagic addObject:@(i)];
+        }
+    }
+
+    // Adapters that do content inspection
+    NSDictionary<NSString *, Class> *inspectionClasses = @{
+        @"media:json": [CSJsonAdapter class],
+        @"media:ndjson": [CSNdjsonAdapter class],
+        @"media:csv": [CSCsvAdapter class],
+        @"media:tsv": [CSTsvAdapter class],
+        @"media:yaml": [CSYamlAdapter class],
+        @"media:xml": [CSXmlAdapter class],
+        @"media:txt": [CSPlainTextAdapter class],
+    };
+    NSMutableDictionary<NSString *, id<CSMediaAdapter>> *inspection = [NSMutableDictionary dictionary];
+    [inspectionClasses enumerateKeysAndObjectsUsingBlock:^(NSString *baseType, Class adapterClass, BOOL *stop) {
+        for (id<CSMediaAdapter> adapter in self->_adapters) {
+            if ([adapter isKindOfClass:adapterClass]) {
+                inspection[baseType] = adapter;
+                break;
+            }
+        }
+    }];
+
+    _extensionIndex = [extensionIndex copy];
+    _customExtensionAdapters = [customExtension copy];
+    _magicTrie = trie;
+    _customMagicAdapters = [customMagic copy];
+    _inspectionAdapters = [inspection copy];
+}
+
 - (NSArray<id<CSMediaAdapter>> *)adapters {
     return _adapters;
 }
 
 - (nullable id<CSMediaAdapter>)adapterForExtension:(NSString *)extension {
     NSString *ext = [extension lowercaseString];
-    for (id<CSMediaAdapter> adapter in _adapters) {
-        if ([adapter matchesExtension:ext]) {
-            return adapter;
+    NSNumber *indexed = _extensionIndex[ext];
+    NSUInteger best = indexed ? indexed.unsignedIntegerValue : NSNotFound;
+
+    // A higher-priority adapter with its own matcher may still claim it
+    for (NSNumber *index in _customExtensionAdapters) {
+        NSUInteger i = index.unsignedIntegerValue;
+        if (i >= best) {
+            break;
+        }
+        if ([_adapters[i] matchesExtension:ext]) {
+            return _adapters[i];
         }
     }
-    return nil;
+    return best == NSNotFound ? nil : _adapters[best];
 }
 
 - (nullable id<CSMediaAdapter>)adapterForMagicBytes:(NSData *)bytes {
-    for (id<CSMediaAdapter> adapter in _adapters) {
-        if ([adapter matchesMagicBytes:bytes]) {
-            return adapter;
+    // Walk the trie along the content; every terminal passed is a pattern
+    // that is a prefix of the bytes
+    CSMagicTrieNode *node = _magicTrie;
+    NSUInteger best = node.adapterIndex;
+    const uint8_t *data = bytes.bytes;
+    for (NSUInteger b = 0; b < bytes.length && node.children.count > 0; b++) {
+        node = node.children[@(data[b])];
+        if (!node) {
+            break;
         }
+        best = MIN(best, node.adapterIndex);
     }
-    return nil;
+
+    for (NSNumber *index in _customMagicAdapters) {
+        NSUInteger i = index.unsignedIntegerValue;
+        if (i >= best) {
+            break;
+        }
+        if ([_adapters[i] matchesMagicBytes:bytes]) {
+            return _adapters[i];
+        }
+    }
+    return best == NSNotFound ? nil : _adapters[best];
 }
 
 - (nullable NSString *)detectMediaUrn:(NSString *)path
@@ -508,31 +643,7 @@ NSArray<NSString *> * _Nullable CSInputResolverExpandGlob(NSString *pattern, NSE
 
 /// Get adapter for a base type (for content inspection)
 - (nullable id<CSMediaAdapter>)_adapterForBaseType:(NSString *)baseType {
-    // Adapters that do content inspection
-    static NSDictionary<NSString *, Class> *inspectionAdapters = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        inspectionAdapters = @{
-            @"media:json": [CSJsonAdapter class],
-            @"media:ndjson": [CSNdjsonAdapter class],
-            @"media:csv": [CSCsvAdapter class],
-            @"media:tsv": [CSTsvAdapter class],
-            @"media:yaml": [CSYamlAdapter class],
-            @"media:xml": [CSXmlAdapter class],
-            @"media:txt": [CSPlainTextAdapter class],
-        };
-    });
-
-    Class adapterClass = inspectionAdapters[baseType];
-    if (adapterClass) {
-        // Find the existing adapter instance
-        for (id<CSMediaAdapter> adapter in _adapters) {
-            if ([adapter isKindOfClass:adapterClass]) {
-                return adapter;
-            }
-        }
-    }
-    return nil;
+    return _inspectionAdapters[baseType];
 }
 
 /// Determine structure from URN markers
@@ -713,11 +824,106 @@ static NSArray<NSString *> * _Nullable _resolvePaths(NSArray<NSString *> *paths,
     return result;
 }
 
-#pragma mark - Main Resolution Functions
+#pragma mark - Detection Cache
 
 /// Size limit for content inspection (64KB)
 static const NSUInteger kInspectionBufferSize = 65536;
 
+/// Files whose content is read and inspected at the same time
+static const NSUInteger kDetectionConcurrency = 8;
+
+/// A detection result, valid while the file keeps the recorded size and mtime
+@interface CSDetectionCacheEntry : NSObject
+@property (nonatomic, assign) uint64_t sizeBytes;
+@property (nonatomic, strong) NSDate *modificationDate;
+@property (nonatomic, copy) NSString *mediaUrn;
+@property (nonatomic, assign) CSContentStructure structure;
+@end
+
+@implementation CSDetectionCacheEntry
+@end
+
+/// Detection results by canonical path, so re-resolving an unchanged tree
+/// only stats each file
+static NSMutableDictionary<NSString *, CSDetectionCacheEntry *> *_detectionCache = nil;
+static NSLock *_detectionCacheLock = nil;
+
+static void _initDetectionCache(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _detectionCache = [NSMutableDictionary dictionary];
+        _detectionCacheLock = [[NSLock alloc] init];
+    });
+}
+
+void CSInputResolverClearDetectionCache(void) {
+    _initDetectionCache();
+    [_detectionCacheLock lock];
+    [_detectionCache removeAllObjects];
+    [_detectionCacheLock unlock];
+}
+
+/// Stat, read and detect one file, answering from the cache when its size
+/// and modification date are unchanged
+static CSResolvedFile * _Nullable _detectResolvedFile(NSString *filePath,
+                                                      CSMediaAdapterRegistry *registry,
+                                                      NSError **error) {
+    _initDetectionCache();
+
+    // Get file size and modification date
+    NSDictionary *attrs = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil];
+    uint64_t fileSize = [attrs[NSFileSize] unsignedLongLongValue];
+    NSDate *modified = attrs[NSFileModificationDate];
+
+    if (modified) {
+        [_detectionCacheLock lock];
+        CSDetectionCacheEntry *entry = _detectionCache[filePath];
+        [_detectionCacheLock unlock];
+        if (entry && entry.sizeBytes == fileSize && [entry.modificationDate isEqualToDate:modified]) {
+            return [CSResolvedFile fileWithPath:filePath
+                                       mediaUrn:entry.mediaUrn
+                                      sizeBytes:fileSize
+                               contentStructure:entry.structure];
+        }
+    }
+
+    // Read content for inspection
+    NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:filePath];
+    NSData *content = [handle readDataOfLength:kInspectionBufferSize];
+    [handle closeFile];
+
+    // Detect media type
+    CSContentStructure structure = CSContentStructureScalarOpaque;
+    NSString *mediaUrn = [registry detectMediaUrn:filePath
+                                          content:content ?: [NSData data]
+                                        structure:&structure
+                                            error:error];
+    if (!mediaUrn) {
+        return nil;
+    }
+
+    if (modified) {
+        CSDetectionCacheEntry *entry = [[CSDetectionCacheEntry alloc] init];
+        entry.sizeBytes = fileSize;
+        entry.modificationDate = modified;
+        entry.mediaUrn = mediaUrn;
+        entry.structure = structure;
+        [_detectionCacheLock lock];
+        if (_detectionCache.count >= kMaxFiles) {
+            [_detectionCache removeAllObjects];
+        }
+        _detectionCache[filePath] = entry;
+        [_detectionCacheLock unlock];
+    }
+
+    return [CSResolvedFile fileWithPath:filePath
+                               mediaUrn:mediaUrn
+                              sizeBytes:fileSize
+                       contentStructure:structure];
+}
+
+#pragma mark - Main Resolution Functions
+
 CSResolvedInputSet * _Nullable CSInputResolverResolvePath(NSString *path, NSError **error) {
     return CSInputResolverResolvePaths(@[path], error);
 }
@@ -753,43 +959,59 @@ CSResolvedInputSet * _Nullable CSInputResolverResolvePaths(NSArray<NSString *> *
         return nil;
     }
 
-    // Detect media type for each file
-    NSMutableArray<CSResolvedFile *> *resolvedFiles = [NSMutableArray array];
+    // Detect media type for each file, kDetectionConcurrency at a time.
+    // Results keep the input order; on failure the error of the earliest
+    // failing file is reported, as a sequential scan would.
     CSMediaAdapterRegistry *registry = [CSMediaAdapterRegistry shared];
-    NSFileManager *fm = [NSFileManager defaultManager];
+    NSUInteger count = filePaths.count;
+    NSMutableArray *slots = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [slots addObject:[NSNull null]];
+    }
+    NSLock *lock = [[NSLock alloc] init];
+    __block NSUInteger nextIndex = 0;
+    __block NSUInteger failedIndex = NSNotFound;
+    __block NSError *failure = nil;
+
+    size_t workers = (size_t)MIN(count, kDetectionConcurrency);
+    dispatch_apply(workers, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t worker) {
+        while (YES) {
+            [lock lock];
+            NSUInteger index = nextIndex++;
+            BOOL stop = index >= count || failedIndex != NSNotFound;
+            [lock unlock];
+            if (stop) {
+                return;
+            }
 
-    NSMutableSet<NSString *> *baseMediaTypes = [NSMutableSet set];
+            NSError *detectError = nil;
+            CSResolvedFile *resolved = _detectResolvedFile(filePaths[index], registry, &detectError);
 
-    for (NSString *filePath in filePaths) {
-        // Get file size
-        NSDictionary *attrs = [fm attributesOfItemAtPath:filePath error:nil];
-        uint64_t fileSize = [attrs[NSFileSize] unsignedLongLongValue];
-
-        // Read content for inspection
-        NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:filePath];
-        NSData *content = [handle readDataOfLength:kInspectionBufferSize];
-        [handle closeFile];
-
-        // Detect media type
-        CSContentStructure structure = CSContentStructureScalarOpaque;
-        NSString *mediaUrn = [registry detectMediaUrn:filePath
-                                              content:content ?: [NSData data]
-                                            structure:&structure
-                                                error:error];
-        if (!mediaUrn) {
-            return nil;
+            [lock lock];
+            if (resolved) {
+                slots[index] = resolved;
+            } else if (index < failedIndex) {
+                failedIndex = index;
+                failure = detectError;
+            }
+            [lock unlock];
         }
+    });
 
+    if (failedIndex != NSNotFound) {
+        if (error) {
+            *error = failure;
+        }
+        return nil;
+    }
+
+    NSArray<CSResolvedFile *> *resolvedFiles = slots;
+    NSMutableSet<NSString *> *baseMediaTypes = [NSMutableSet set];
+    for (CSResolvedFile *resolved in resolvedFiles) {
         // Extract base media type for homogeneity check
         // Base type is everything before any marker tags (list, record, textable, etc.)
-        NSString *baseType = [mediaUrn componentsSeparatedByString:@";"][0];
+        NSString *baseType = [resolved.mediaUrn componentsSeparatedByString:@";"][0];
         [baseMediaTypes addObject:baseType];
-
-        CSResolvedFile *resolved = [CSResolvedFile fileWithPath:filePath
-                                                       mediaUrn:mediaUrn
-                                                      sizeBytes:fileSize
-                                               contentStructure:structure];
-        [resolvedFiles addObject:resolved];
     }
 
     // Determine aggregate cardinality
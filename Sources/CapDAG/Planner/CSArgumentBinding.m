@@ -193,6 +193,10 @@ typedef NS_ENUM(NSInteger, CSArgumentBindingType) {
     return self.bindingType == CSArgumentBindingTypePreviousOutput;
 }
 
+- (nullable NSString *)previousOutputNodeId {
+    return [self referencesPrevious] ? self.nodeId : nil;
+}
+
 @end
 
 // MARK: - ResolvedArgument
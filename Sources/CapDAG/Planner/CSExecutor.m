@@ -12,12 +12,124 @@
 #import "CSCap.h"
 #import "CSPlanBuilder.h"
 
+/// Nodes a run executes at once unless withMaxParallelism: says otherwise
+static const NSUInteger CSMachineExecutorDefaultMaxParallelism = 8;
+
+/// ForEach items in flight at once unless withForEachWindow: says otherwise
+static const NSUInteger CSMachineExecutorDefaultForEachWindow = 8;
+
+/// Milliseconds elapsed since `start`
+static uint64_t CSMillisecondsSince(NSDate *start) {
+    return (uint64_t)([[NSDate date] timeIntervalSinceDate:start] * 1000);
+}
+
+/// The items a ForEach iterates: a list output, a single output, or nothing
+static NSArray *CSForEachItems(id _Nullable input) {
+    if ([input isKindOfClass:[NSArray class]]) {
+        return input;
+    }
+    return input ? @[input] : @[];
+}
+
+// MARK: - Run State
+
+@class CSMachineRunState;
+
+/// Parallelism and per-cap limits shared by an execute: call's run and every
+/// ForEach item run inside it, so the limits bound the whole execution rather
+/// than each run. Only touched on `queue`, which all those runs share.
+@interface CSMachineRunLimiter : NSObject
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, assign) NSUInteger maxParallelism;
+@property (nonatomic, copy) NSDictionary<NSString *, NSNumber *> *capConcurrencyLimits;
+/// Cap URN -> invocations in flight across all runs
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *runningPerCap;
+/// Nodes in flight across all runs. Streaming ForEach nodes don't count:
+/// they only wait on their item runs, whose nodes do.
+@property (nonatomic, assign) NSUInteger inFlight;
+/// Unfinished runs, outermost first; rescheduled when a slot frees up
+@property (nonatomic, strong) NSMutableArray<CSMachineRunState *> *runs;
+@end
+
+@implementation CSMachineRunLimiter
+@end
+
+/// Scheduler bookkeeping for one execute: call or ForEach item. Only touched
+/// on `queue`, the limiter's.
+@interface CSMachineRunState : NSObject
+@property (nonatomic, strong) dispatch_queue_t queue;
+/// Executor whose plan this run executes
+@property (nonatomic, strong) CSMachineExecutor *executor;
+@property (nonatomic, strong) CSMachineRunLimiter *limiter;
+@property (nonatomic, strong) NSDate *start;
+@property (nonatomic, copy) void (^completion)(CSMachineResult *result, id _Nullable retainedOutput);
+/// Node whose output is handed to `completion` (a ForEach body's output)
+@property (nonatomic, copy, nullable) NSString *retainedNodeId;
+/// Nodes in topological order; ready nodes launch lowest index first
+@property (nonatomic, strong) NSArray<CSMachineNode *> *orderedNodes;
+/// ForEach node ID -> body plan run once per item inside that node
+@property (nonatomic, strong) NSDictionary<NSString *, CSMachinePlan *> *forEachBodies;
+/// ForEach node ID -> nodes outside the body whose output the body reads
+@property (nonatomic, strong) NSDictionary<NSString *, NSSet<NSString *> *> *forEachBodyInputs;
+/// Node ID -> nodes whose output it reads
+@property (nonatomic, strong) NSDictionary<NSString *, NSSet<NSString *> *> *dependencies;
+/// Node ID -> number of dependencies not yet finished
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *pendingDependencies;
+/// Node ID -> indices (in orderedNodes) of nodes waiting on it
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *dependents;
+/// Node ID -> dependents not yet launched; its output is dropped at zero
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *unlaunchedConsumers;
+@property (nonatomic, strong) NSMutableIndexSet *ready;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, CSNodeExecutionResult *> *nodeResults;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *nodeOutputs;
+/// Nodes of this run in flight, streaming ForEach nodes included
+@property (nonatomic, assign) NSUInteger inFlight;
+/// First failure; once set, no further nodes are launched
+@property (nonatomic, copy, nullable) NSString *failure;
+@property (nonatomic, assign) BOOL finished;
+@end
+
+@implementation CSMachineRunState
+@end
+
+/// One streaming ForEach: a window of per-item body runs. Only touched on `queue`.
+@interface CSForEachRunState : NSObject
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) NSDate *start;
+@property (nonatomic, strong) CSMachineNode *node;
+@property (nonatomic, strong) CSMachinePlan *bodyPlan;
+/// The enclosing run's limiter, shared with every item run
+@property (nonatomic, strong) CSMachineRunLimiter *limiter;
+/// Outer node ID -> output, for body nodes that read outside the body
+@property (nonatomic, strong) NSDictionary<NSString *, id> *outerOutputs;
+@property (nonatomic, strong) NSArray *items;
+/// Per-item body output, filled in as items finish (NSNull until then)
+@property (nonatomic, strong) NSMutableArray *results;
+@property (nonatomic, assign) NSUInteger nextItem;
+@property (nonatomic, assign) NSUInteger inFlight;
+@property (nonatomic, copy, nullable) NSString *failure;
+@property (nonatomic, assign) BOOL finished;
+@property (nonatomic, copy) void (^completion)(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error);
+@end
+
+@implementation CSForEachRunState
+@end
+
 @interface CSMachineExecutor ()
 @property (nonatomic, strong) id<CSCapExecutorProtocol> executor;
 @property (nonatomic, strong) CSMachinePlan *plan;
 @property (nonatomic, strong) NSArray<CSCapInputFile *> *inputFiles;
 @property (nonatomic, strong) NSDictionary<NSString *, NSData *> *slotValues;
 @property (nonatomic, strong, nullable) id<CSCapSettingsProviderProtocol> settingsProvider;
+@property (nonatomic, assign) NSUInteger maxParallelism;
+@property (nonatomic, strong) NSDictionary<NSString *, NSNumber *> *capConcurrencyLimits;
+@property (nonatomic, assign) NSUInteger forEachWindow;
+/// InputSlot node ID -> output to use instead of the input files (per-item body runs)
+@property (nonatomic, strong) NSDictionary<NSString *, id> *inputSlotOverrides;
+/// Outputs of nodes outside the plan that its nodes read (per-item body runs)
+@property (nonatomic, strong) NSDictionary<NSString *, id> *outerOutputs;
+/// Limiter of the enclosing run (per-item body runs); nil creates a new one
+@property (nonatomic, strong, nullable) CSMachineRunLimiter *limiter;
 @end
 
 @implementation CSMachineExecutor
@@ -32,6 +144,11 @@
         _inputFiles = inputFiles;
         _slotValues = @{};
         _settingsProvider = nil;
+        _maxParallelism = CSMachineExecutorDefaultMaxParallelism;
+        _capConcurrencyLimits = @{};
+        _forEachWindow = CSMachineExecutorDefaultForEachWindow;
+        _inputSlotOverrides = @{};
+        _outerOutputs = @{};
     }
     return self;
 }
@@ -46,99 +163,540 @@
     return self;
 }
 
+- (instancetype)withMaxParallelism:(NSUInteger)maxParallelism {
+    self.maxParallelism = MAX(maxParallelism, (NSUInteger)1);
+    return self;
+}
+
+- (instancetype)withCapConcurrencyLimits:(NSDictionary<NSString *, NSNumber *> *)limits {
+    self.capConcurrencyLimits = [limits copy];
+    return self;
+}
+
+- (instancetype)withForEachWindow:(NSUInteger)window {
+    self.forEachWindow = MAX(window, (NSUInteger)1);
+    return self;
+}
+
 // MARK: - Execute Plan
 
 - (void)execute:(void (^)(CSMachineResult * _Nullable result, NSError * _Nullable error))completion {
+    [self runRetainingOutputOf:nil completion:^(CSMachineResult * _Nullable result, id _Nullable retainedOutput, NSError * _Nullable error) {
+        completion(result, error);
+    }];
+}
+
+- (void)runRetainingOutputOf:(nullable NSString *)retainedNodeId
+                  completion:(void (^)(CSMachineResult * _Nullable result, id _Nullable retainedOutput, NSError * _Nullable error))completion {
     NSDate *start = [NSDate date];
 
     // Validate plan
     NSError *validateError = [self.plan validate];
     if (validateError) {
-        completion(nil, validateError);
+        completion(nil, nil, validateError);
         return;
     }
 
     // Get topological order
     NSError *topoError = nil;
-    NSArray<CSMachineNode *> *orderedNodes = [self.plan topologicalOrder:&topoError];
+    NSArray<CSMachineNode *> *topoNodes = [self.plan topologicalOrder:&topoError];
     if (topoError) {
-        completion(nil, topoError);
+        completion(nil, nil, topoError);
         return;
     }
 
-    NSMutableDictionary<NSString *, CSNodeExecutionResult *> *nodeResults = [NSMutableDictionary dictionary];
-    NSMutableDictionary<NSString *, id> *nodeOutputs = [NSMutableDictionary dictionary];
+    // ForEach bodies closed by a Collect run per item inside their ForEach
+    // node; their nodes are not scheduled at the top level
+    NSMutableDictionary<NSString *, NSString *> *bodyOwners = [NSMutableDictionary dictionary];
+    NSDictionary<NSString *, CSMachinePlan *> *forEachBodies = [self streamingForEachBodies:topoNodes bodyOwners:bodyOwners];
+    NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *bodyInputs = [NSMutableDictionary dictionary];
+    NSArray<CSMachineNode *> *orderedNodes = nil;
+    NSDictionary<NSString *, NSSet<NSString *> *> *dependencies = [self schedulingDependencies:topoNodes
+                                                                                    bodyOwners:bodyOwners
+                                                                                    bodyInputs:bodyInputs
+                                                                                  orderedNodes:&orderedNodes];
+    if (!dependencies) {
+        // A body reads a node that itself waits on the ForEach; run unstreamed
+        forEachBodies = @{};
+        [bodyOwners removeAllObjects];
+        [bodyInputs removeAllObjects];
+        dependencies = [self schedulingDependencies:topoNodes
+                                         bodyOwners:bodyOwners
+                                         bodyInputs:bodyInputs
+                                       orderedNodes:&orderedNodes];
+    }
+
+    CSMachineRunLimiter *limiter = self.limiter;
+    if (!limiter) {
+        limiter = [[CSMachineRunLimiter alloc] init];
+        limiter.queue = dispatch_queue_create("com.capdag.machine-executor.run", DISPATCH_QUEUE_SERIAL);
+        limiter.maxParallelism = self.maxParallelism;
+        limiter.capConcurrencyLimits = self.capConcurrencyLimits;
+        limiter.runningPerCap = [NSMutableDictionary dictionary];
+        limiter.runs = [NSMutableArray array];
+    }
+
+    CSMachineRunState *run = [[CSMachineRunState alloc] init];
+    run.queue = limiter.queue;
+    run.executor = self;
+    run.limiter = limiter;
+    run.start = start;
+    run.completion = ^(CSMachineResult *result, id _Nullable retainedOutput) {
+        completion(result, retainedOutput, nil);
+    };
+    run.retainedNodeId = retainedNodeId;
+    run.orderedNodes = orderedNodes;
+    run.forEachBodies = forEachBodies;
+    run.forEachBodyInputs = bodyInputs;
+    run.dependencies = dependencies;
+    run.pendingDependencies = [NSMutableDictionary dictionary];
+    run.dependents = [NSMutableDictionary dictionary];
+    run.unlaunchedConsumers = [NSMutableDictionary dictionary];
+    run.ready = [NSMutableIndexSet indexSet];
+    run.nodeResults = [NSMutableDictionary dictionary];
+    run.nodeOutputs = [self.outerOutputs mutableCopy];
+
+    for (NSUInteger i = 0; i < orderedNodes.count; i++) {
+        NSString *nodeId = orderedNodes[i].nodeId;
+        NSSet<NSString *> *nodeDependencies = dependencies[nodeId];
+        run.pendingDependencies[nodeId] = @(nodeDependencies.count);
+        if (nodeDependencies.count == 0) {
+            [run.ready addIndex:i];
+        }
+        for (NSString *dependsOn in nodeDependencies) {
+            if (!run.dependents[dependsOn]) {
+                run.dependents[dependsOn] = [NSMutableArray array];
+            }
+            [run.dependents[dependsOn] addObject:@(i)];
+        }
+    }
+    for (NSString *nodeId in run.dependents) {
+        run.unlaunchedConsumers[nodeId] = @(run.dependents[nodeId].count);
+    }
 
-    [self executeNodesSequentially:orderedNodes
-                       nodeResults:nodeResults
-                       nodeOutputs:nodeOutputs
-                       currentIndex:0
-                         startTime:start
-                        completion:completion];
+    dispatch_async(run.queue, ^{
+        [limiter.runs addObject:run];
+        [self scheduleReadyNodes:run];
+    });
 }
 
-- (void)executeNodesSequentially:(NSArray<CSMachineNode *> *)orderedNodes
-                     nodeResults:(NSMutableDictionary *)nodeResults
-                     nodeOutputs:(NSMutableDictionary *)nodeOutputs
-                    currentIndex:(NSUInteger)index
-                       startTime:(NSDate *)start
-                      completion:(void (^)(CSMachineResult * _Nullable result, NSError * _Nullable error))completion {
-
-    if (index >= orderedNodes.count) {
-        // All nodes executed - create result
-        CSMachineResult *result = [[CSMachineResult alloc] init];
-        result.success = YES;
-        result.nodeResults = [nodeResults allValues];
-        result.finalOutput = nil; // Would extract from output nodes
-        result.error = nil;
-        result.totalDurationMs = (uint64_t)([[NSDate date] timeIntervalSinceDate:start] * 1000);
-
-        completion(result, nil);
-        return;
+/// Dependencies between the nodes a run launches: plan edges, plus node
+/// fields that read another node's output. A body node stands for its
+/// ForEach, so a body reading an outer node holds the ForEach back until
+/// that node finishes; those outer nodes are added to `bodyInputs`. Only
+/// references to earlier nodes in topological order count, so a dangling
+/// reference cannot stall the run. Sets `orderedNodes` to the launched
+/// nodes in an order that respects the dependencies, or returns nil if
+/// folding a body into its ForEach creates a cycle.
+- (nullable NSDictionary<NSString *, NSSet<NSString *> *> *)schedulingDependencies:(NSArray<CSMachineNode *> *)topoNodes
+                                                                       bodyOwners:(NSDictionary<NSString *, NSString *> *)bodyOwners
+                                                                       bodyInputs:(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *)bodyInputs
+                                                                     orderedNodes:(NSArray<CSMachineNode *> **)orderedNodes {
+    NSMutableDictionary<NSString *, NSNumber *> *topoIndex = [NSMutableDictionary dictionaryWithCapacity:topoNodes.count];
+    for (NSUInteger i = 0; i < topoNodes.count; i++) {
+        topoIndex[topoNodes[i].nodeId] = @(i);
     }
 
-    CSMachineNode *node = orderedNodes[index];
+    NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *dependencies = [NSMutableDictionary dictionary];
+    for (CSMachineNode *node in topoNodes) {
+        if (!bodyOwners[node.nodeId]) {
+            dependencies[node.nodeId] = [NSMutableSet set];
+        }
+    }
+    void (^addDependency)(NSString *, NSString *) = ^(NSString *nodeId, NSString *dependsOn) {
+        NSNumber *nodeIndex = topoIndex[nodeId];
+        NSNumber *dependsOnIndex = topoIndex[dependsOn];
+        if (!nodeIndex || !dependsOnIndex || dependsOnIndex.unsignedIntegerValue >= nodeIndex.unsignedIntegerValue) return;
+        NSString *dependent = bodyOwners[nodeId] ?: nodeId;
+        NSString *owner = bodyOwners[dependsOn] ?: dependsOn;
+        if ([dependent isEqualToString:owner]) return;
+        [dependencies[dependent] addObject:owner];
+        if (bodyOwners[nodeId]) {
+            if (!bodyInputs[dependent]) {
+                bodyInputs[dependent] = [NSMutableSet set];
+            }
+            [bodyInputs[dependent] addObject:dependsOn];
+        }
+    };
+    for (CSMachinePlanEdge *edge in self.plan.edges) {
+        addDependency(edge.toNode, edge.fromNode);
+    }
+    for (CSMachineNode *node in topoNodes) {
+        if (node.sourceNode) addDependency(node.nodeId, node.sourceNode);
+        if (node.inputNode) addDependency(node.nodeId, node.inputNode);
+        for (NSString *inputId in node.inputNodes) {
+            addDependency(node.nodeId, inputId);
+        }
+        for (CSArgumentBinding *binding in node.argBindings.allValues) {
+            NSString *previous = [binding previousOutputNodeId];
+            if (previous) addDependency(node.nodeId, previous);
+        }
+    }
+
+    // Folding a body into its ForEach can move an outer node ahead of the
+    // ForEach; re-sort, keeping the plan's topological order where free
+    NSMutableDictionary<NSString *, NSNumber *> *pending = [NSMutableDictionary dictionaryWithCapacity:dependencies.count];
+    NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *dependents = [NSMutableDictionary dictionary];
+    NSMutableIndexSet *ready = [NSMutableIndexSet indexSet];
+    for (NSString *nodeId in dependencies) {
+        pending[nodeId] = @(dependencies[nodeId].count);
+        if (dependencies[nodeId].count == 0) {
+            [ready addIndex:topoIndex[nodeId].unsignedIntegerValue];
+        }
+        for (NSString *dependsOn in dependencies[nodeId]) {
+            if (!dependents[dependsOn]) {
+                dependents[dependsOn] = [NSMutableArray array];
+            }
+            [dependents[dependsOn] addObject:nodeId];
+        }
+    }
+    NSMutableArray<CSMachineNode *> *ordered = [NSMutableArray arrayWithCapacity:dependencies.count];
+    while (ready.count > 0) {
+        NSUInteger index = ready.firstIndex;
+        [ready removeIndex:index];
+        CSMachineNode *node = topoNodes[index];
+        [ordered addObject:node];
+        for (NSString *dependentId in dependents[node.nodeId]) {
+            NSUInteger remaining = pending[dependentId].unsignedIntegerValue - 1;
+            pending[dependentId] = @(remaining);
+            if (remaining == 0) {
+                [ready addIndex:topoIndex[dependentId].unsignedIntegerValue];
+            }
+        }
+    }
+    if (ordered.count < dependencies.count) {
+        return nil;
+    }
 
-    [self executeNode:node
-          nodeResults:nodeResults
-          nodeOutputs:nodeOutputs
-           completion:^(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error) {
+    *orderedNodes = ordered;
+    return dependencies;
+}
 
-        if (error) {
-            CSMachineResult *result = [[CSMachineResult alloc] init];
-            result.success = NO;
-            result.nodeResults = [nodeResults allValues];
-            result.finalOutput = nil;
-            result.error = [NSString stringWithFormat:@"Node '%@' execution error: %@", node.nodeId, error.localizedDescription];
-            result.totalDurationMs = (uint64_t)([[NSDate date] timeIntervalSinceDate:start] * 1000);
-            completion(result, nil);
-            return;
+/// ForEach nodes that can stream: closed by a Collect, with a body free of
+/// nested ForEach/Collect. Returns ForEach ID -> body plan and fills
+/// `bodyOwners` with body node ID -> ForEach ID.
+- (NSDictionary<NSString *, CSMachinePlan *> *)streamingForEachBodies:(NSArray<CSMachineNode *> *)nodes
+                                                          bodyOwners:(NSMutableDictionary<NSString *, NSString *> *)bodyOwners {
+    NSMutableDictionary<NSString *, CSMachinePlan *> *bodies = [NSMutableDictionary dictionary];
+    for (CSMachineNode *node in nodes) {
+        if (![node isFanOut] || bodyOwners[node.nodeId]) continue;
+
+        BOOL closed = NO;
+        for (CSMachineNode *candidate in nodes) {
+            if ([candidate isFanIn] && [candidate.inputNodes containsObject:node.bodyExit]) {
+                closed = YES;
+                break;
+            }
         }
+        if (!closed) continue;
+
+        NSError *error = nil;
+        CSMachinePlan *bodyPlan = [self.plan extractForeachBody:node.nodeId itemMediaUrn:@"media:" error:&error];
+        if (!bodyPlan) continue;
+
+        NSString *bodyInputId = [NSString stringWithFormat:@"%@_body_input", node.nodeId];
+        NSString *bodyOutputId = [NSString stringWithFormat:@"%@_body_output", node.nodeId];
+        NSMutableArray<NSString *> *bodyNodeIds = [NSMutableArray array];
+        BOOL streamable = YES;
+        for (NSString *bodyNodeId in bodyPlan.nodes) {
+            if ([bodyNodeId isEqualToString:bodyInputId] || [bodyNodeId isEqualToString:bodyOutputId]) continue;
+            CSMachineNode *bodyNode = bodyPlan.nodes[bodyNodeId];
+            if ([bodyNode isFanOut] || [bodyNode isFanIn] || bodyOwners[bodyNodeId]) {
+                streamable = NO;
+                break;
+            }
+            [bodyNodeIds addObject:bodyNodeId];
+        }
+        if (!streamable) continue;
 
-        if (!execResult.success) {
-            CSMachineResult *result = [[CSMachineResult alloc] init];
-            result.success = NO;
-            result.nodeResults = [nodeResults allValues];
-            result.finalOutput = nil;
-            result.error = [NSString stringWithFormat:@"Node '%@' failed: %@", node.nodeId, execResult.error ?: @"unknown error"];
-            result.totalDurationMs = (uint64_t)([[NSDate date] timeIntervalSinceDate:start] * 1000);
-            completion(result, nil);
-            return;
+        bodies[node.nodeId] = bodyPlan;
+        for (NSString *bodyNodeId in bodyNodeIds) {
+            bodyOwners[bodyNodeId] = node.nodeId;
         }
+    }
+    return bodies;
+}
 
-        if (output) {
-            nodeOutputs[node.nodeId] = output;
+// MARK: - Scheduling
+
+/// Launch ready nodes up to the limiter's parallelism and per-cap limits;
+/// finish the run once nothing is in flight and nothing more can start.
+/// On run.queue.
+- (void)scheduleReadyNodes:(CSMachineRunState *)run {
+    if (run.finished) return;
+
+    CSMachineRunLimiter *limiter = run.limiter;
+    if (!run.failure) {
+        NSMutableIndexSet *launched = [NSMutableIndexSet indexSet];
+        [run.ready enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            CSMachineNode *node = run.orderedNodes[index];
+            if (!run.forEachBodies[node.nodeId] && limiter.inFlight >= limiter.maxParallelism) {
+                return;
+            }
+            if (node.capUrn) {
+                NSNumber *limit = limiter.capConcurrencyLimits[node.capUrn];
+                NSUInteger running = [limiter.runningPerCap[node.capUrn] unsignedIntegerValue];
+                if (limit && running >= MAX(limit.unsignedIntegerValue, (NSUInteger)1)) {
+                    return;
+                }
+            }
+            [launched addIndex:index];
+            [self launchNode:node run:run];
+        }];
+        [run.ready removeIndexes:launched];
+    }
+
+    if (run.inFlight == 0 && (run.failure || run.ready.count == 0)) {
+        [self finishRun:run];
+    }
+}
+
+- (void)launchNode:(CSMachineNode *)node run:(CSMachineRunState *)run {
+    CSMachineRunLimiter *limiter = run.limiter;
+    run.inFlight += 1;
+    if (!run.forEachBodies[node.nodeId]) {
+        limiter.inFlight += 1;
+    }
+    if (node.capUrn) {
+        limiter.runningPerCap[node.capUrn] = @([limiter.runningPerCap[node.capUrn] unsignedIntegerValue] + 1);
+    }
+
+    // Nodes read a snapshot; every output they depend on is already in it
+    NSDictionary *nodeResults = [run.nodeResults copy];
+    NSDictionary *nodeOutputs = [run.nodeOutputs copy];
+    uint64_t startOffsetMs = CSMillisecondsSince(run.start);
+
+    // Outputs no remaining node reads are released as soon as possible
+    for (NSString *dependsOn in run.dependencies[node.nodeId]) {
+        NSUInteger remaining = [run.unlaunchedConsumers[dependsOn] unsignedIntegerValue] - 1;
+        run.unlaunchedConsumers[dependsOn] = @(remaining);
+        if (remaining == 0) {
+            [self releaseOutputOf:dependsOn run:run];
         }
-        nodeResults[node.nodeId] = execResult;
-
-        // Continue with next node
-        [self executeNodesSequentially:orderedNodes
-                           nodeResults:nodeResults
-                           nodeOutputs:nodeOutputs
-                          currentIndex:index + 1
-                             startTime:start
-                            completion:completion];
-    }];
+    }
+
+    CSMachinePlan *bodyPlan = run.forEachBodies[node.nodeId];
+    void (^nodeCompletion)(CSNodeExecutionResult *, id, NSError *) = ^(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error) {
+        dispatch_async(run.queue, ^{
+            [self finishNode:node
+                         run:run
+               startOffsetMs:startOffsetMs
+                  execResult:execResult
+                      output:output
+                       error:error];
+        });
+    };
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        if (bodyPlan) {
+            [self executeStreamingForEachNode:node
+                                     bodyPlan:bodyPlan
+                                  bodyInputs:run.forEachBodyInputs[node.nodeId]
+                                  nodeOutputs:nodeOutputs
+                                      limiter:limiter
+                                   completion:nodeCompletion];
+        } else {
+            [self executeNode:node nodeResults:nodeResults nodeOutputs:nodeOutputs completion:nodeCompletion];
+        }
+    });
+}
+
+- (void)releaseOutputOf:(NSString *)nodeId run:(CSMachineRunState *)run {
+    if ([nodeId isEqualToString:run.retainedNodeId]) return;
+    [run.nodeOutputs removeObjectForKey:nodeId];
+    // A streaming ForEach also publishes its results under its body exit
+    NSString *bodyExit = run.forEachBodies[nodeId] ? [self.plan getNode:nodeId].bodyExit : nil;
+    if (bodyExit) {
+        [run.nodeOutputs removeObjectForKey:bodyExit];
+    }
+}
+
+- (void)finishNode:(CSMachineNode *)node
+               run:(CSMachineRunState *)run
+     startOffsetMs:(uint64_t)startOffsetMs
+        execResult:(nullable CSNodeExecutionResult *)execResult
+            output:(nullable id)output
+             error:(nullable NSError *)error {
+    CSMachineRunLimiter *limiter = run.limiter;
+    BOOL freesSlot = !run.forEachBodies[node.nodeId];
+    run.inFlight -= 1;
+    if (freesSlot) {
+        limiter.inFlight -= 1;
+    }
+    if (node.capUrn) {
+        limiter.runningPerCap[node.capUrn] = @([limiter.runningPerCap[node.capUrn] unsignedIntegerValue] - 1);
+    }
+
+    if (error) {
+        if (!run.failure) {
+            run.failure = [NSString stringWithFormat:@"Node '%@' execution error: %@", node.nodeId, error.localizedDescription];
+        }
+    } else if (!execResult.success) {
+        if (!run.failure) {
+            run.failure = [NSString stringWithFormat:@"Node '%@' failed: %@", node.nodeId, execResult.error ?: @"unknown error"];
+        }
+    } else {
+        execResult.startOffsetMs = startOffsetMs;
+        BOOL hasConsumers = run.unlaunchedConsumers[node.nodeId].unsignedIntegerValue > 0;
+        if (output && (hasConsumers || [node.nodeId isEqualToString:run.retainedNodeId])) {
+            run.nodeOutputs[node.nodeId] = output;
+            if (run.forEachBodies[node.nodeId]) {
+                // Collect reads the body exit; it holds the per-item results
+                run.nodeOutputs[node.bodyExit] = output;
+            }
+        }
+        run.nodeResults[node.nodeId] = execResult;
+
+        for (NSNumber *dependentIndex in run.dependents[node.nodeId]) {
+            NSString *dependentId = run.orderedNodes[dependentIndex.unsignedIntegerValue].nodeId;
+            NSUInteger remaining = [run.pendingDependencies[dependentId] unsignedIntegerValue] - 1;
+            run.pendingDependencies[dependentId] = @(remaining);
+            if (remaining == 0) {
+                [run.ready addIndex:dependentIndex.unsignedIntegerValue];
+            }
+        }
+    }
+
+    [self scheduleReadyNodes:run];
+    if (freesSlot) {
+        // Other runs under the same limiter may have been waiting for the slot
+        for (CSMachineRunState *other in [limiter.runs copy]) {
+            if (other != run) {
+                [other.executor scheduleReadyNodes:other];
+            }
+        }
+    }
+}
+
+- (void)finishRun:(CSMachineRunState *)run {
+    run.finished = YES;
+    [run.limiter.runs removeObjectIdenticalTo:run];
+
+    NSMutableArray<CSNodeExecutionResult *> *nodeResults = [NSMutableArray arrayWithCapacity:run.nodeResults.count];
+    for (CSMachineNode *node in run.orderedNodes) {
+        CSNodeExecutionResult *nodeResult = run.nodeResults[node.nodeId];
+        if (nodeResult) {
+            [nodeResults addObject:nodeResult];
+        }
+    }
+
+    CSMachineResult *result = [[CSMachineResult alloc] init];
+    result.success = (run.failure == nil);
+    result.nodeResults = nodeResults;
+    result.finalOutput = nil; // Would extract from output nodes
+    result.error = run.failure;
+    result.totalDurationMs = CSMillisecondsSince(run.start);
+
+    id retainedOutput = run.retainedNodeId ? run.nodeOutputs[run.retainedNodeId] : nil;
+    run.completion(result, retainedOutput);
+}
+
+// MARK: - Streaming ForEach
+
+/// Run the body once per item, at most forEachWindow items at a time. Each
+/// item's body output is stored as it finishes and the item run is dropped,
+/// so only the window's intermediate outputs are alive at once. The outputs
+/// of `bodyInputs`, the outer nodes the body reads, are handed to every
+/// item run, and every item run schedules under the enclosing `limiter`.
+/// The node's output is the per-item results in item order, which Collect
+/// consumes; an item whose body produces no output fails it.
+- (void)executeStreamingForEachNode:(CSMachineNode *)node
+                           bodyPlan:(CSMachinePlan *)bodyPlan
+                         bodyInputs:(nullable NSSet<NSString *> *)bodyInputs
+                        nodeOutputs:(NSDictionary *)nodeOutputs
+                            limiter:(CSMachineRunLimiter *)limiter
+                         completion:(void (^)(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error))completion {
+    CSForEachRunState *state = [[CSForEachRunState alloc] init];
+    state.queue = dispatch_queue_create("com.capdag.machine-executor.foreach", DISPATCH_QUEUE_SERIAL);
+    state.start = [NSDate date];
+    state.node = node;
+    state.bodyPlan = bodyPlan;
+    state.limiter = limiter;
+    NSMutableDictionary *outerOutputs = [NSMutableDictionary dictionaryWithCapacity:bodyInputs.count];
+    for (NSString *inputId in bodyInputs) {
+        if (nodeOutputs[inputId]) {
+            outerOutputs[inputId] = nodeOutputs[inputId];
+        }
+    }
+    state.outerOutputs = outerOutputs;
+    state.items = CSForEachItems(nodeOutputs[node.inputNode]);
+    state.results = [NSMutableArray arrayWithCapacity:state.items.count];
+    for (NSUInteger i = 0; i < state.items.count; i++) {
+        [state.results addObject:[NSNull null]];
+    }
+    state.completion = completion;
+
+    dispatch_async(state.queue, ^{
+        [self launchForEachItems:state];
+    });
+}
+
+/// Top the window up with new item runs; finish once all are done. On state.queue.
+- (void)launchForEachItems:(CSForEachRunState *)state {
+    if (state.finished) return;
+
+    NSString *bodyInputId = [NSString stringWithFormat:@"%@_body_input", state.node.nodeId];
+    NSString *bodyOutputId = [NSString stringWithFormat:@"%@_body_output", state.node.nodeId];
+
+    while (!state.failure && state.inFlight < self.forEachWindow && state.nextItem < state.items.count) {
+        NSUInteger index = state.nextItem++;
+        state.inFlight += 1;
+
+        id item = state.items[index];
+        NSArray<CSCapInputFile *> *itemFiles = self.inputFiles;
+        if ([item isKindOfClass:[NSDictionary class]] &&
+            [item[@"file_path"] isKindOfClass:[NSString class]] &&
+            [item[@"media_urn"] isKindOfClass:[NSString class]]) {
+            itemFiles = @[[CSCapInputFile withFilePath:item[@"file_path"] mediaUrn:item[@"media_urn"]]];
+        }
+
+        CSMachineExecutor *itemExecutor = [[CSMachineExecutor alloc] initWithExecutor:self.executor
+                                                                                 plan:state.bodyPlan
+                                                                           inputFiles:itemFiles];
+        itemExecutor.slotValues = self.slotValues;
+        itemExecutor.settingsProvider = self.settingsProvider;
+        itemExecutor.limiter = state.limiter;
+        itemExecutor.inputSlotOverrides = @{bodyInputId: item};
+        itemExecutor.outerOutputs = state.outerOutputs;
+
+        [itemExecutor runRetainingOutputOf:bodyOutputId completion:^(CSMachineResult * _Nullable result, id _Nullable output, NSError * _Nullable error) {
+            dispatch_async(state.queue, ^{
+                state.inFlight -= 1;
+                if (error || !result.success) {
+                    if (!state.failure) {
+                        state.failure = [NSString stringWithFormat:@"Item %lu: %@", (unsigned long)index,
+                                         error.localizedDescription ?: result.error ?: @"unknown error"];
+                    }
+                } else if (!output) {
+                    // Dropping it would shift every later item in Collect
+                    if (!state.failure) {
+                        state.failure = [NSString stringWithFormat:@"Item %lu: body produced no output", (unsigned long)index];
+                    }
+                } else {
+                    state.results[index] = output;
+                }
+                [self launchForEachItems:state];
+            });
+        }];
+    }
+
+    if (state.inFlight == 0 && (state.failure || state.nextItem == state.items.count)) {
+        state.finished = YES;
+
+        CSNodeExecutionResult *result = [[CSNodeExecutionResult alloc] init];
+        result.nodeId = state.node.nodeId;
+        result.success = (state.failure == nil);
+        result.binaryOutput = nil;
+        result.textOutput = [self jsonToString:@{
+            @"iteration_count": @(state.items.count),
+            @"body_entry": state.node.bodyEntry,
+            @"body_exit": state.node.bodyExit
+        }];
+        result.error = state.failure;
+        result.durationMs = CSMillisecondsSince(state.start);
+
+        state.completion(result, state.failure ? nil : [state.results copy], nil);
+    }
 }
 
 // MARK: - Execute Node
@@ -190,7 +748,9 @@
                   completion:(void (^)(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error))completion {
 
     id output;
-    if (self.inputFiles.count == 1) {
+    if (self.inputSlotOverrides[node.nodeId]) {
+        output = self.inputSlotOverrides[node.nodeId];
+    } else if (self.inputFiles.count == 1) {
         output = @{
             @"file_path": self.inputFiles[0].filePath,
             @"media_urn": self.inputFiles[0].mediaUrn
@@ -244,16 +804,7 @@
                      start:(NSDate *)start
                 completion:(void (^)(CSNodeExecutionResult * _Nullable execResult, id _Nullable output, NSError * _Nullable error))completion {
 
-    id input = nodeOutputs[node.inputNode];
-    NSArray *items;
-
-    if ([input isKindOfClass:[NSArray class]]) {
-        items = input;
-    } else if (input) {
-        items = @[input];
-    } else {
-        items = @[];
-    }
+    NSArray *items = CSForEachItems(nodeOutputs[node.inputNode]);
 
     id output = @{
         @"iteration_count": @(items.count),
@@ -101,6 +101,190 @@
 
 @end
 
+// =============================================================================
+// CSLiveCapGraphTopology
+// =============================================================================
+
+/// Marks "no node" / "cannot reach the target" in uint32 arrays
+static const uint32_t CSLiveCapGraphNone = UINT32_MAX;
+
+/// Partial paths a k-best search may pop before settling for what it has
+static const NSUInteger CSLiveCapGraphSearchBudget = 200000;
+
+/// Sources (and targets) whose query state is kept between graph mutations
+static const NSUInteger CSLiveCapGraphQueryCacheLimit = 256;
+
+/// Whether an edge can follow a node of the given cardinality
+static BOOL CSLiveEdgeAcceptsCardinality(CSLiveMachinePlanEdge *edge, BOOL sourceIsList) {
+    switch (edge.edgeType) {
+        case CSLiveMachinePlanEdgeTypeCap:
+            return [edge.fromSpec isList] == sourceIsList;
+        case CSLiveMachinePlanEdgeTypeForEach:
+            return sourceIsList && ![edge.toSpec isList];
+        case CSLiveMachinePlanEdgeTypeCollect:
+        case CSLiveMachinePlanEdgeTypeWrapInList:
+            return !sourceIsList && [edge.toSpec isList];
+    }
+}
+
+/// Integer-ID snapshot of the graph, built lazily after the edges change.
+///
+/// Every media URN that appears on an edge gets a node ID. For each node the
+/// edges it may traverse (conformsTo + cardinality, resolved once here) are
+/// stored in CSR form, with the reverse pairs alongside for target-distance
+/// searches. Queries then run on plain uint32 arrays.
+@interface CSLiveCapGraphTopology : NSObject
+@property (nonatomic, strong) NSArray<CSMediaUrn *> *nodeUrns;
+@property (nonatomic, strong) NSDictionary<NSString *, NSNumber *> *nodeIds;
+/// Per edge: target node ID, uint32
+@property (nonatomic, strong) NSData *edgeTargets;
+/// Per node + 1: offset into outEdges, uint32
+@property (nonatomic, strong) NSData *outOffsets;
+/// Edge indices, ascending within each node, uint32
+@property (nonatomic, strong) NSData *outEdges;
+/// Per node + 1: offset into inEdges/inSources, uint32
+@property (nonatomic, strong) NSData *inOffsets;
+@property (nonatomic, strong) NSData *inEdges;
+@property (nonatomic, strong) NSData *inSources;
+@end
+
+@implementation CSLiveCapGraphTopology
+
++ (instancetype)topologyWithEdges:(NSArray<CSLiveMachinePlanEdge *> *)edges {
+    CSLiveCapGraphTopology *topology = [[CSLiveCapGraphTopology alloc] init];
+
+    // 1. Node IDs, in first-seen order
+    NSMutableDictionary<NSString *, NSNumber *> *nodeIds = [NSMutableDictionary dictionary];
+    NSMutableArray<CSMediaUrn *> *nodeUrns = [NSMutableArray array];
+    uint32_t (^idForUrn)(CSMediaUrn *) = ^uint32_t(CSMediaUrn *urn) {
+        NSString *canonical = [urn toString];
+        NSNumber *existing = nodeIds[canonical];
+        if (existing) {
+            return existing.unsignedIntValue;
+        }
+        uint32_t nodeId = (uint32_t)nodeUrns.count;
+        nodeIds[canonical] = @(nodeId);
+        [nodeUrns addObject:urn];
+        return nodeId;
+    };
+
+    NSMutableData *edgeTargets = [NSMutableData dataWithLength:edges.count * sizeof(uint32_t)];
+    uint32_t *targets = edgeTargets.mutableBytes;
+    for (NSUInteger e = 0; e < edges.count; e++) {
+        idForUrn(edges[e].fromSpec);
+        targets[e] = idForUrn(edges[e].toSpec);
+    }
+
+    // 2. Group edges by from_spec, and bucket the groups by one required tag
+    //    key so each node only tests patterns it could possibly conform to
+    NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *edgesByFrom = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, CSMediaUrn *> *fromUrns = [NSMutableDictionary dictionary];
+    for (NSUInteger e = 0; e < edges.count; e++) {
+        NSString *fromCanonical = [edges[e].fromSpec toString];
+        if (!edgesByFrom[fromCanonical]) {
+            edgesByFrom[fromCanonical] = [NSMutableArray array];
+            fromUrns[fromCanonical] = edges[e].fromSpec;
+        }
+        [edgesByFrom[fromCanonical] addObject:@(e)];
+    }
+
+    NSMutableArray<NSString *> *unconstrainedFroms = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *fromsByKey = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSSet<NSString *> *> *requiredKeys = [NSMutableDictionary dictionary];
+    for (NSString *fromCanonical in edgesByFrom) {
+        NSSet<NSString *> *required = [fromUrns[fromCanonical] requiredTagKeys];
+        requiredKeys[fromCanonical] = required;
+        NSString *bucketKey = [[required allObjects] sortedArrayUsingSelector:@selector(compare:)].firstObject;
+        if (!bucketKey) {
+            [unconstrainedFroms addObject:fromCanonical];
+        } else {
+            if (!fromsByKey[bucketKey]) {
+                fromsByKey[bucketKey] = [NSMutableArray array];
+            }
+            [fromsByKey[bucketKey] addObject:fromCanonical];
+        }
+    }
+
+    // 3. Forward CSR: every edge each node may traverse
+    NSUInteger nodeCount = nodeUrns.count;
+    NSMutableData *outOffsets = [NSMutableData dataWithLength:(nodeCount + 1) * sizeof(uint32_t)];
+    NSMutableData *outEdges = [NSMutableData data];
+    for (NSUInteger n = 0; n < nodeCount; n++) {
+        ((uint32_t *)outOffsets.mutableBytes)[n] = (uint32_t)(outEdges.length / sizeof(uint32_t));
+
+        CSMediaUrn *node = nodeUrns[n];
+        NSSet<NSString *> *nodeKeys = [NSSet setWithArray:node.tags.allKeys];
+        BOOL nodeIsList = [node isList];
+
+        NSMutableArray<NSString *> *candidates = [unconstrainedFroms mutableCopy];
+        for (NSString *key in nodeKeys) {
+            NSArray<NSString *> *bucket = fromsByKey[key];
+            if (bucket) {
+                [candidates addObjectsFromArray:bucket];
+            }
+        }
+
+        NSMutableIndexSet *nodeEdges = [NSMutableIndexSet indexSet];
+        for (NSString *fromCanonical in candidates) {
+            if (![requiredKeys[fromCanonical] isSubsetOfSet:nodeKeys]) {
+                continue;
+            }
+            NSError *error = nil;
+            if (![node conformsTo:fromUrns[fromCanonical] error:&error] || error) {
+                continue;
+            }
+            for (NSNumber *edgeIndex in edgesByFrom[fromCanonical]) {
+                if (CSLiveEdgeAcceptsCardinality(edges[edgeIndex.unsignedIntegerValue], nodeIsList)) {
+                    [nodeEdges addIndex:edgeIndex.unsignedIntegerValue];
+                }
+            }
+        }
+        [nodeEdges enumerateIndexesUsingBlock:^(NSUInteger e, BOOL *stop) {
+            uint32_t value = (uint32_t)e;
+            [outEdges appendBytes:&value length:sizeof(value)];
+        }];
+    }
+    ((uint32_t *)outOffsets.mutableBytes)[nodeCount] = (uint32_t)(outEdges.length / sizeof(uint32_t));
+
+    // 4. Reverse pairs, grouped by target node
+    NSUInteger pairCount = outEdges.length / sizeof(uint32_t);
+    const uint32_t *outOff = outOffsets.bytes;
+    const uint32_t *outE = outEdges.bytes;
+    NSMutableData *inOffsets = [NSMutableData dataWithLength:(nodeCount + 1) * sizeof(uint32_t)];
+    NSMutableData *inEdges = [NSMutableData dataWithLength:pairCount * sizeof(uint32_t)];
+    NSMutableData *inSources = [NSMutableData dataWithLength:pairCount * sizeof(uint32_t)];
+    uint32_t *inOff = inOffsets.mutableBytes;
+    for (NSUInteger i = 0; i < pairCount; i++) {
+        inOff[targets[outE[i]] + 1]++;
+    }
+    for (NSUInteger n = 0; n < nodeCount; n++) {
+        inOff[n + 1] += inOff[n];
+    }
+    NSMutableData *fill = [NSMutableData dataWithBytes:inOff length:nodeCount * sizeof(uint32_t)];
+    uint32_t *cursor = fill.mutableBytes;
+    uint32_t *inE = inEdges.mutableBytes;
+    uint32_t *inS = inSources.mutableBytes;
+    for (NSUInteger n = 0; n < nodeCount; n++) {
+        for (uint32_t i = outOff[n]; i < outOff[n + 1]; i++) {
+            uint32_t slot = cursor[targets[outE[i]]]++;
+            inE[slot] = outE[i];
+            inS[slot] = (uint32_t)n;
+        }
+    }
+
+    topology.nodeUrns = nodeUrns;
+    topology.nodeIds = nodeIds;
+    topology.edgeTargets = edgeTargets;
+    topology.outOffsets = outOffsets;
+    topology.outEdges = outEdges;
+    topology.inOffsets = inOffsets;
+    topology.inEdges = inEdges;
+    topology.inSources = inSources;
+    return topology;
+}
+
+@end
+
 // =============================================================================
 // CSLiveCapGraph
 // =============================================================================
@@ -118,6 +302,16 @@
 @property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *capToEdges;
 /// Cached identity URN for skip checks
 @property (nonatomic, strong, nullable) CSCapUrn *identityUrn;
+/// A cap was added outside sync, so ForEach/Collect edges may be missing
+@property (nonatomic, assign) BOOL transitionsStale;
+/// Guards the lazily built query state below, so concurrent queries are safe
+@property (nonatomic, strong) NSLock *queryCacheLock;
+/// Integer snapshot of the edges; nil until the next query after a mutation
+@property (nonatomic, strong, nullable) CSLiveCapGraphTopology *topology;
+/// "source canonical|maxDepth" -> CSLiveReachableNode entries
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSData *> *reachabilityCache;
+/// Target canonical -> per-node cap-step and hop distances to the target
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSData *> *targetDistanceCache;
 @end
 
 @implementation CSLiveCapGraph
@@ -129,6 +323,9 @@
     graph.incoming = [NSMutableDictionary dictionary];
     graph.nodes = [NSMutableSet set];
     graph.capToEdges = [NSMutableDictionary dictionary];
+    graph.reachabilityCache = [NSMutableDictionary dictionary];
+    graph.targetDistanceCache = [NSMutableDictionary dictionary];
+    graph.queryCacheLock = [[NSLock alloc] init];
     // Parse identity URN once
     NSError *error = nil;
     graph.identityUrn = [CSCapUrn fromString:CSCapIdentity error:&error];
@@ -141,29 +338,75 @@
     [self.incoming removeAllObjects];
     [self.nodes removeAllObjects];
     [self.capToEdges removeAllObjects];
+    self.transitionsStale = NO;
+    [self invalidateDerivedState];
 }
 
 // MARK: - Sync
 
 - (void)syncFromCaps:(NSArray<CSCap *> *)caps {
-    [self clear];
+    // Caps added directly via addCap: have no transitions yet; start over
+    if (self.transitionsStale) {
+        [self clear];
+        // Same dedup as the diff below: the first cap per URN wins
+        NSMutableSet<NSString *> *seen = [NSMutableSet set];
+        for (CSCap *cap in caps) {
+            CSLiveMachinePlanEdge *edge = [self capEdgeForCap:cap];
+            if (!edge) continue;
+            NSString *capCanonical = [edge.capUrn toString];
+            if ([seen containsObject:capCanonical]) continue;
+            [seen addObject:capCanonical];
+            [self appendEdge:edge];
+        }
+        [self insertCardinalityTransitions];
+        return;
+    }
+
+    // Diff against the caps already in the graph
+    NSMutableSet<NSString *> *wanted = [NSMutableSet set];
+    NSMutableArray<CSCap *> *added = [NSMutableArray array];
+    NSMutableArray<NSString *> *removed = [NSMutableArray array];
     for (CSCap *cap in caps) {
-        [self addCap:cap];
+        CSLiveMachinePlanEdge *edge = [self capEdgeForCap:cap];
+        if (!edge) continue;
+        NSString *capCanonical = [edge.capUrn toString];
+        if ([wanted containsObject:capCanonical]) continue;
+        [wanted addObject:capCanonical];
+
+        NSArray<NSNumber *> *existing = self.capToEdges[capCanonical];
+        if (!existing) {
+            [added addObject:cap];
+            continue;
+        }
+        // Same URN under a new title: replace the edge
+        NSString *existingTitle = self.edges[existing.firstObject.unsignedIntegerValue].capTitle;
+        if (existingTitle != cap.title && ![existingTitle isEqualToString:cap.title]) {
+            [removed addObject:capCanonical];
+            [added addObject:cap];
+        }
+    }
+    for (NSString *capCanonical in self.capToEdges) {
+        if (![wanted containsObject:capCanonical]) {
+            [removed addObject:capCanonical];
+        }
+    }
+
+    if (added.count > 0 || removed.count > 0) {
+        [self updateWithAddedCaps:added removedCapUrns:removed];
     }
-    [self insertCardinalityTransitions];
 }
 
 - (void)syncFromCapUrns:(NSArray<NSString *> *)capUrns
                registry:(id<CSCapRegistryProtocol>)registry
              completion:(void (^)(void))completion {
-    [self clear];
-
     [registry getCachedCaps:^(NSArray<CSCap *> * _Nullable allCaps, NSError * _Nullable error) {
         if (error || !allCaps) {
+            [self clear];
             completion();
             return;
         }
 
+        NSMutableArray<CSCap *> *matchingCaps = [NSMutableArray array];
         for (NSString *capUrnStr in capUrns) {
             NSError *parseError = nil;
             CSCapUrn *capUrn = [CSCapUrn fromString:capUrnStr error:&parseError];
@@ -188,60 +431,222 @@
             }
 
             if (matchingCap) {
-                [self addCap:matchingCap];
+                [matchingCaps addObject:matchingCap];
             }
         }
 
-        [self insertCardinalityTransitions];
+        [self syncFromCaps:matchingCaps];
         completion();
     }];
 }
 
+- (void)updateWithAddedCaps:(NSArray<CSCap *> *)addedCaps
+             removedCapUrns:(NSArray<NSString *> *)removedCapUrns {
+    if (self.transitionsStale) {
+        // No transitions to patch; fall back to a full recompute afterwards
+        [self removeDerivedEdges];
+    }
+
+    // Edges whose endpoints may flip a ForEach/Collect decision
+    NSMutableArray<CSLiveMachinePlanEdge *> *changed = [NSMutableArray array];
+
+    NSMutableIndexSet *dropped = [NSMutableIndexSet indexSet];
+    for (NSString *capUrnStr in removedCapUrns) {
+        NSString *capCanonical = [[CSCapUrn fromString:capUrnStr error:nil] toString] ?: capUrnStr;
+        for (NSNumber *edgeIdx in self.capToEdges[capCanonical]) {
+            [dropped addIndex:edgeIdx.unsignedIntegerValue];
+            [changed addObject:self.edges[edgeIdx.unsignedIntegerValue]];
+        }
+    }
+
+    NSMutableArray<CSLiveMachinePlanEdge *> *addedEdges = [NSMutableArray array];
+    NSMutableSet<NSString *> *addedCanonicals = [NSMutableSet set];
+    for (CSCap *cap in addedCaps) {
+        CSLiveMachinePlanEdge *edge = [self capEdgeForCap:cap];
+        if (!edge) continue;
+        NSString *capCanonical = [edge.capUrn toString];
+        if ([addedCanonicals containsObject:capCanonical]) continue;
+
+        // Already present and not being removed
+        NSArray<NSNumber *> *existing = self.capToEdges[capCanonical];
+        if (existing && ![dropped containsIndex:existing.firstObject.unsignedIntegerValue]) continue;
+
+        [addedCanonicals addObject:capCanonical];
+        [addedEdges addObject:edge];
+        [changed addObject:edge];
+    }
+
+    if (changed.count == 0) {
+        if (self.transitionsStale) {
+            [self insertCardinalityTransitions];
+        }
+        return;
+    }
+
+    // Cap edges after the update
+    NSMutableArray<CSLiveMachinePlanEdge *> *edges = [NSMutableArray arrayWithCapacity:self.edges.count + addedEdges.count];
+    for (NSUInteger i = 0; i < self.edges.count; i++) {
+        if (![dropped containsIndex:i]) {
+            [edges addObject:self.edges[i]];
+        }
+    }
+    [edges addObjectsFromArray:addedEdges];
+
+    if (self.transitionsStale) {
+        self.edges = edges;
+        [self rebuildIndices];
+        [self insertCardinalityTransitions];
+        return;
+    }
+
+    // List specs whose transitions may change: outputs of changed caps, and
+    // lists whose item a changed cap accepts or produces. Every other list's
+    // ForEach/Collect edges are kept as they are.
+    NSMutableDictionary<NSString *, CSMediaUrn *> *candidateLists = [NSMutableDictionary dictionary];
+    for (CSLiveMachinePlanEdge *edge in edges) {
+        if ([edge.toSpec isList]) {
+            candidateLists[[edge.toSpec toString]] = edge.toSpec;
+        }
+    }
+    for (CSLiveMachinePlanEdge *edge in changed) {
+        if ([edge.toSpec isList]) {
+            candidateLists[[edge.toSpec toString]] = edge.toSpec;
+        }
+    }
+
+    NSMutableSet<NSString *> *affectedLists = [NSMutableSet set];
+    [candidateLists enumerateKeysAndObjectsUsingBlock:^(NSString *listCanonical, CSMediaUrn *listSpec, BOOL *stop) {
+        CSMediaUrn *itemSpec = [listSpec withoutTag:@"list"];
+        for (CSLiveMachinePlanEdge *edge in changed) {
+            if ([[edge.toSpec toString] isEqualToString:listCanonical] ||
+                [itemSpec conformsTo:edge.fromSpec] ||
+                (![edge.toSpec isList] && [edge.toSpec isEquivalentTo:itemSpec])) {
+                [affectedLists addObject:listCanonical];
+                break;
+            }
+        }
+    }];
+
+    // Drop the affected lists' transitions, keep everything else
+    NSMutableArray<CSLiveMachinePlanEdge *> *kept = [NSMutableArray arrayWithCapacity:edges.count];
+    for (CSLiveMachinePlanEdge *edge in edges) {
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeForEach &&
+            [affectedLists containsObject:[edge.fromSpec toString]]) {
+            continue;
+        }
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeCollect &&
+            [affectedLists containsObject:[edge.toSpec toString]]) {
+            continue;
+        }
+        [kept addObject:edge];
+    }
+    self.edges = kept;
+    [self rebuildIndices];
+
+    // Recompute them with the same rules as a full rebuild
+    NSArray<NSString *> *sortedLists = [[affectedLists allObjects] sortedArrayUsingSelector:@selector(compare:)];
+    NSMutableArray<CSMediaUrn *> *capListOutputs = [NSMutableArray array];
+    for (NSString *listCanonical in sortedLists) {
+        CSMediaUrn *listSpec = candidateLists[listCanonical];
+        BOOL isCapOutput = NO;
+        for (CSLiveMachinePlanEdge *edge in self.edges) {
+            if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap &&
+                [[edge.toSpec toString] isEqualToString:listCanonical]) {
+                isCapOutput = YES;
+                break;
+            }
+        }
+        if (!isCapOutput) continue;
+
+        [capListOutputs addObject:listSpec];
+        CSMediaUrn *itemSpec = [listSpec withoutTag:@"list"];
+        if ([self hasCapAcceptingItem:itemSpec]) {
+            [self appendEdge:[CSLiveMachinePlanEdge forEachEdgeFrom:listSpec to:itemSpec]];
+        }
+    }
+    for (CSMediaUrn *listSpec in capListOutputs) {
+        [self appendCollectEdgeIfNeededForList:listSpec];
+    }
+}
+
+/// Remove every ForEach/Collect/WrapInList edge, keeping cap edges
+- (void)removeDerivedEdges {
+    NSMutableArray<CSLiveMachinePlanEdge *> *capEdges = [NSMutableArray arrayWithCapacity:self.edges.count];
+    for (CSLiveMachinePlanEdge *edge in self.edges) {
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap) {
+            [capEdges addObject:edge];
+        }
+    }
+    self.edges = capEdges;
+    [self rebuildIndices];
+}
+
 // MARK: - Add Cap
 
 - (void)addCap:(CSCap *)cap {
+    if ([self appendCapEdgeForCap:cap]) {
+        // Transitions are only inserted by sync; the next sync recomputes them
+        self.transitionsStale = YES;
+    }
+}
+
+- (BOOL)appendCapEdgeForCap:(CSCap *)cap {
+    CSLiveMachinePlanEdge *edge = [self capEdgeForCap:cap];
+    if (!edge) return NO;
+    [self appendEdge:edge];
+    return YES;
+}
+
+/// Cap edge for a capability, or nil for empty specs and identity caps
+- (nullable CSLiveMachinePlanEdge *)capEdgeForCap:(CSCap *)cap {
     NSString *inSpecStr = [cap.capUrn getInSpec];
     NSString *outSpecStr = [cap.capUrn getOutSpec];
 
     // Skip caps with empty specs
     if (inSpecStr.length == 0 || outSpecStr.length == 0) {
-        return;
+        return nil;
     }
 
     // Skip identity caps
     if (self.identityUrn && [cap.capUrn isEquivalent:self.identityUrn]) {
-        return;
+        return nil;
     }
 
     // Parse media URNs
     NSError *error = nil;
     CSMediaUrn *fromSpec = [CSMediaUrn fromString:inSpecStr error:&error];
-    if (!fromSpec) return;
+    if (!fromSpec) return nil;
 
     error = nil;
     CSMediaUrn *toSpec = [CSMediaUrn fromString:outSpecStr error:&error];
-    if (!toSpec) return;
-
-    NSString *fromCanonical = [fromSpec toString];
-    NSString *toCanonical = [toSpec toString];
-    NSString *capCanonical = [cap.capUrn toString];
+    if (!toSpec) return nil;
 
     // Determine cardinality from media URNs
-    CSInputCardinality inputCard = CSInputCardinalityFromMediaUrn(fromCanonical);
-    CSInputCardinality outputCard = CSInputCardinalityFromMediaUrn(toCanonical);
+    CSInputCardinality inputCard = CSInputCardinalityFromMediaUrn([fromSpec toString]);
+    CSInputCardinality outputCard = CSInputCardinalityFromMediaUrn([toSpec toString]);
+
+    return [CSLiveMachinePlanEdge capEdgeFrom:fromSpec
+                                           to:toSpec
+                                       capUrn:cap.capUrn
+                                        title:cap.title
+                                  specificity:(NSUInteger)[cap.capUrn specificity]
+                             inputCardinality:inputCard
+                            outputCardinality:outputCard];
+}
 
-    // Create edge
+// MARK: - Edge Indices
+
+- (void)appendEdge:(CSLiveMachinePlanEdge *)edge {
     NSUInteger edgeIdx = self.edges.count;
-    CSLiveMachinePlanEdge *edge = [CSLiveMachinePlanEdge capEdgeFrom:fromSpec
-                                                  to:toSpec
-                                              capUrn:cap.capUrn
-                                               title:cap.title
-                                         specificity:(NSUInteger)[cap.capUrn specificity]
-                                    inputCardinality:inputCard
-                                   outputCardinality:outputCard];
     [self.edges addObject:edge];
+    [self indexEdge:edge atIndex:edgeIdx];
+    [self invalidateDerivedState];
+}
+
+- (void)indexEdge:(CSLiveMachinePlanEdge *)edge atIndex:(NSUInteger)edgeIdx {
+    NSString *fromCanonical = [edge.fromSpec toString];
+    NSString *toCanonical = [edge.toSpec toString];
 
-    // Update indices
     if (!self.outgoing[fromCanonical]) {
         self.outgoing[fromCanonical] = [NSMutableArray array];
     }
@@ -255,10 +660,25 @@
     [self.nodes addObject:fromCanonical];
     [self.nodes addObject:toCanonical];
 
-    if (!self.capToEdges[capCanonical]) {
-        self.capToEdges[capCanonical] = [NSMutableArray array];
+    if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap) {
+        NSString *capCanonical = [edge.capUrn toString];
+        if (!self.capToEdges[capCanonical]) {
+            self.capToEdges[capCanonical] = [NSMutableArray array];
+        }
+        [self.capToEdges[capCanonical] addObject:@(edgeIdx)];
     }
-    [self.capToEdges[capCanonical] addObject:@(edgeIdx)];
+}
+
+/// Recreate every index from `edges` after edges were removed
+- (void)rebuildIndices {
+    [self.outgoing removeAllObjects];
+    [self.incoming removeAllObjects];
+    [self.nodes removeAllObjects];
+    [self.capToEdges removeAllObjects];
+    for (NSUInteger i = 0; i < self.edges.count; i++) {
+        [self indexEdge:self.edges[i] atIndex:i];
+    }
+    [self invalidateDerivedState];
 }
 
 // MARK: - Stats
@@ -271,43 +691,6 @@
     return self.edges.count;
 }
 
-// MARK: - Outgoing Edges (conformsTo matching)
-
-/// Get all edges whose from_spec the source conforms to, with cardinality checks.
-/// Scans ALL edges (not index) because conformsTo cannot use dictionary lookup.
-- (NSArray<CSLiveMachinePlanEdge *> *)getOutgoingEdges:(CSMediaUrn *)source {
-    NSMutableArray<CSLiveMachinePlanEdge *> *result = [NSMutableArray array];
-    BOOL sourceIsList = [source isList];
-
-    for (CSLiveMachinePlanEdge *edge in self.edges) {
-        BOOL edgeExpectsList = [edge.fromSpec isList];
-
-        // Check cardinality compatibility
-        BOOL cardinalityCompatible = NO;
-        switch (edge.edgeType) {
-            case CSLiveMachinePlanEdgeTypeCap:
-                cardinalityCompatible = (edgeExpectsList == sourceIsList);
-                break;
-            case CSLiveMachinePlanEdgeTypeForEach:
-                cardinalityCompatible = (sourceIsList && ![edge.toSpec isList]);
-                break;
-            case CSLiveMachinePlanEdgeTypeCollect:
-            case CSLiveMachinePlanEdgeTypeWrapInList:
-                cardinalityCompatible = (!sourceIsList && [edge.toSpec isList]);
-                break;
-        }
-
-        if (!cardinalityCompatible) continue;
-
-        // Check type conformance
-        if ([source conformsTo:edge.fromSpec]) {
-            [result addObject:edge];
-        }
-    }
-
-    return result;
-}
-
 // MARK: - Cardinality Transitions
 
 - (void)insertCardinalityTransitions {
@@ -331,6 +714,7 @@
         return [[a toString] compare:[b toString]];
     }];
 
+    self.transitionsStale = NO;
     if (listOutputs.count == 0) return;
 
     // For each list output, check if we have caps that accept the singular version
@@ -338,44 +722,14 @@
 
     for (CSMediaUrn *listSpec in listOutputs) {
         CSMediaUrn *itemSpec = [listSpec withoutTag:@"list"];
-
-        // Check if any edge accepts the item spec
-        BOOL hasSingularConsumer = NO;
-        for (CSLiveMachinePlanEdge *edge in self.edges) {
-            if ([itemSpec conformsTo:edge.fromSpec]) {
-                hasSingularConsumer = YES;
-                break;
-            }
-        }
-
-        if (hasSingularConsumer) {
+        if ([self hasCapAcceptingItem:itemSpec]) {
             [foreachEdgesToAdd addObject:@[listSpec, itemSpec]];
         }
     }
 
     // Add ForEach edges
     for (NSArray<CSMediaUrn *> *pair in foreachEdgesToAdd) {
-        CSMediaUrn *listSpec = pair[0];
-        CSMediaUrn *itemSpec = pair[1];
-        NSString *listCanonical = [listSpec toString];
-        NSString *itemCanonical = [itemSpec toString];
-
-        NSUInteger edgeIdx = self.edges.count;
-        CSLiveMachinePlanEdge *foreachEdge = [CSLiveMachinePlanEdge forEachEdgeFrom:listSpec to:itemSpec];
-        [self.edges addObject:foreachEdge];
-
-        if (!self.outgoing[listCanonical]) {
-            self.outgoing[listCanonical] = [NSMutableArray array];
-        }
-        [self.outgoing[listCanonical] addObject:@(edgeIdx)];
-
-        if (!self.incoming[itemCanonical]) {
-            self.incoming[itemCanonical] = [NSMutableArray array];
-        }
-        [self.incoming[itemCanonical] addObject:@(edgeIdx)];
-
-        [self.nodes addObject:listCanonical];
-        [self.nodes addObject:itemCanonical];
+        [self appendEdge:[CSLiveMachinePlanEdge forEachEdgeFrom:pair[0] to:pair[1]]];
     }
 
     // Insert Collect edges for existing list types
@@ -402,256 +756,523 @@
         return [[a toString] compare:[b toString]];
     }];
 
-    NSMutableArray<NSArray<CSMediaUrn *> *> *collectEdgesToAdd = [NSMutableArray array];
-
     for (CSMediaUrn *listSpec in existingListOutputs) {
-        CSMediaUrn *itemSpec = [listSpec withoutTag:@"list"];
+        [self appendCollectEdgeIfNeededForList:listSpec];
+    }
+}
 
-        // Check if we have any cap that outputs the singular version
-        BOOL hasSingularOutput = NO;
-        for (CSLiveMachinePlanEdge *edge in self.edges) {
-            if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap &&
-                ![edge.toSpec isList] &&
-                [edge.toSpec isEquivalentTo:itemSpec]) {
-                hasSingularOutput = YES;
-                break;
-            }
+/// Whether any cap edge accepts the item type (a ForEach into it is useful)
+- (BOOL)hasCapAcceptingItem:(CSMediaUrn *)itemSpec {
+    for (CSLiveMachinePlanEdge *edge in self.edges) {
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap && [itemSpec conformsTo:edge.fromSpec]) {
+            return YES;
         }
+    }
+    return NO;
+}
 
-        // Also check if any cap can consume the item
-        BOOL hasItemConsumer = NO;
-        if (!hasSingularOutput) {
-            for (CSLiveMachinePlanEdge *edge in self.edges) {
-                if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap &&
-                    [itemSpec conformsTo:edge.fromSpec]) {
-                    hasItemConsumer = YES;
-                    break;
-                }
-            }
-        }
+/// Add item→list Collect if a cap produces or consumes the item and none exists yet
+- (void)appendCollectEdgeIfNeededForList:(CSMediaUrn *)listSpec {
+    CSMediaUrn *itemSpec = [listSpec withoutTag:@"list"];
 
-        if (hasSingularOutput || hasItemConsumer) {
-            [collectEdgesToAdd addObject:@[itemSpec, listSpec]];
+    // Check if we have any cap that outputs the singular version
+    BOOL hasSingularOutput = NO;
+    for (CSLiveMachinePlanEdge *edge in self.edges) {
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeCap &&
+            ![edge.toSpec isList] &&
+            [edge.toSpec isEquivalentTo:itemSpec]) {
+            hasSingularOutput = YES;
+            break;
         }
     }
 
-    // Add Collect edges (checking for duplicates)
-    for (NSArray<CSMediaUrn *> *pair in collectEdgesToAdd) {
-        CSMediaUrn *itemSpec = pair[0];
-        CSMediaUrn *listSpec = pair[1];
+    // Also check if any cap can consume the item
+    if (!hasSingularOutput && ![self hasCapAcceptingItem:itemSpec]) {
+        return;
+    }
 
-        // Check for duplicate
-        BOOL alreadyExists = NO;
-        for (CSLiveMachinePlanEdge *edge in self.edges) {
-            if (edge.edgeType == CSLiveMachinePlanEdgeTypeCollect &&
-                [edge.fromSpec isEquivalentTo:itemSpec] &&
-                [edge.toSpec isEquivalentTo:listSpec]) {
-                alreadyExists = YES;
-                break;
-            }
+    // Check for duplicate
+    for (CSLiveMachinePlanEdge *edge in self.edges) {
+        if (edge.edgeType == CSLiveMachinePlanEdgeTypeCollect &&
+            [edge.fromSpec isEquivalentTo:itemSpec] &&
+            [edge.toSpec isEquivalentTo:listSpec]) {
+            return;
         }
-        if (alreadyExists) continue;
+    }
 
-        NSString *itemCanonical = [itemSpec toString];
-        NSString *listCanonical = [listSpec toString];
+    [self appendEdge:[CSLiveMachinePlanEdge collectEdgeFrom:itemSpec to:listSpec]];
+}
 
-        NSUInteger edgeIdx = self.edges.count;
-        CSLiveMachinePlanEdge *collectEdge = [CSLiveMachinePlanEdge collectEdgeFrom:itemSpec to:listSpec];
-        [self.edges addObject:collectEdge];
+// MARK: - Topology
 
-        if (!self.outgoing[itemCanonical]) {
-            self.outgoing[itemCanonical] = [NSMutableArray array];
-        }
-        [self.outgoing[itemCanonical] addObject:@(edgeIdx)];
+- (CSLiveCapGraphTopology *)currentTopology {
+    [self.queryCacheLock lock];
+    if (!self.topology) {
+        self.topology = [CSLiveCapGraphTopology topologyWithEdges:self.edges];
+    }
+    CSLiveCapGraphTopology *topology = self.topology;
+    [self.queryCacheLock unlock];
+    return topology;
+}
 
-        if (!self.incoming[listCanonical]) {
-            self.incoming[listCanonical] = [NSMutableArray array];
-        }
-        [self.incoming[listCanonical] addObject:@(edgeIdx)];
+/// Drop the integer snapshot and every cached query. Called on any edge change.
+- (void)invalidateDerivedState {
+    [self.queryCacheLock lock];
+    self.topology = nil;
+    [self.reachabilityCache removeAllObjects];
+    [self.targetDistanceCache removeAllObjects];
+    [self.queryCacheLock unlock];
+}
+
+// MARK: - Outgoing Edges (conformsTo matching)
 
-        [self.nodes addObject:itemCanonical];
-        [self.nodes addObject:listCanonical];
+/// Indices (uint32, ascending) of the edges `source` may traverse. A source
+/// that is already a graph node reads its precomputed adjacency; any other
+/// source is matched against every edge once.
+- (NSData *)outgoingEdgeIndicesForSource:(CSMediaUrn *)source topology:(CSLiveCapGraphTopology *)topology {
+    NSNumber *nodeId = topology.nodeIds[[source toString]];
+    if (nodeId) {
+        const uint32_t *offsets = topology.outOffsets.bytes;
+        uint32_t n = nodeId.unsignedIntValue;
+        return [NSData dataWithBytes:(const uint32_t *)topology.outEdges.bytes + offsets[n]
+                              length:(offsets[n + 1] - offsets[n]) * sizeof(uint32_t)];
     }
+
+    NSMutableData *indices = [NSMutableData data];
+    BOOL sourceIsList = [source isList];
+    NSSet<NSString *> *sourceKeys = [NSSet setWithArray:source.tags.allKeys];
+    for (NSUInteger e = 0; e < self.edges.count; e++) {
+        CSLiveMachinePlanEdge *edge = self.edges[e];
+        if (!CSLiveEdgeAcceptsCardinality(edge, sourceIsList)) continue;
+        if (![[edge.fromSpec requiredTagKeys] isSubsetOfSet:sourceKeys]) continue;
+        if ([source conformsTo:edge.fromSpec]) {
+            uint32_t value = (uint32_t)e;
+            [indices appendBytes:&value length:sizeof(value)];
+        }
+    }
+    return indices;
 }
 
 // MARK: - Reachable Targets (BFS)
 
+/// One reachable node, as cached per (source, maxDepth)
+typedef struct {
+    uint32_t node;
+    uint32_t minDepth;
+    uint32_t pathCount;
+} CSLiveReachableNode;
+
 - (NSArray<CSReachableTargetInfo *> *)getReachableTargetsFromSource:(CSMediaUrn *)source
                                                           maxDepth:(NSUInteger)maxDepth {
-    NSMutableDictionary<NSString *, CSReachableTargetInfo *> *results = [NSMutableDictionary dictionary];
-    NSMutableSet<NSString *> *visited = [NSMutableSet set];
-    // Queue entries: [CSMediaUrn, NSNumber(depth)]
-    NSMutableArray<NSArray *> *queue = [NSMutableArray array];
-
+    CSLiveCapGraphTopology *topology = [self currentTopology];
     NSString *sourceCanonical = [source toString];
-    [queue addObject:@[source, @0]];
-    [visited addObject:sourceCanonical];
+    NSString *cacheKey = [NSString stringWithFormat:@"%@|%lu", sourceCanonical, (unsigned long)maxDepth];
+
+    [self.queryCacheLock lock];
+    NSData *reachable = self.reachabilityCache[cacheKey];
+    [self.queryCacheLock unlock];
+    if (!reachable) {
+        // Computed unlocked; a concurrent query for the same key stores an equal result
+        reachable = [self computeReachableFromSource:source maxDepth:maxDepth topology:topology];
+        [self.queryCacheLock lock];
+        if (self.topology == topology) {
+            if (self.reachabilityCache.count >= CSLiveCapGraphQueryCacheLimit) {
+                [self.reachabilityCache removeAllObjects];
+            }
+            self.reachabilityCache[cacheKey] = reachable;
+        }
+        [self.queryCacheLock unlock];
+    }
+
+    // Fresh info objects per call: callers may mutate them
+    NSUInteger count = reachable.length / sizeof(CSLiveReachableNode);
+    const CSLiveReachableNode *entries = reachable.bytes;
+    NSMutableArray<CSReachableTargetInfo *> *result = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *canonical = [topology.nodeUrns[entries[i].node] toString];
+        CSReachableTargetInfo *info = [[CSReachableTargetInfo alloc] init];
+        info.mediaUrn = canonical;
+        info.displayName = canonical;
+        info.minDepth = entries[i].minDepth;
+        info.pathCount = entries[i].pathCount;
+        [result addObject:info];
+    }
+    return result;
+}
 
-    while (queue.count > 0) {
-        NSArray *item = queue.firstObject;
-        [queue removeObjectAtIndex:0];
+/// BFS over node IDs. Every traversal of an edge into a node counts toward
+/// that node's pathCount; each node is expanded once, at its minimum depth.
+/// Returns CSLiveReachableNode entries sorted by (minDepth, canonical URN).
+- (NSData *)computeReachableFromSource:(CSMediaUrn *)source
+                              maxDepth:(NSUInteger)maxDepth
+                              topology:(CSLiveCapGraphTopology *)topology {
+    NSUInteger nodeCount = topology.nodeUrns.count;
+    const uint32_t *targets = topology.edgeTargets.bytes;
+    const uint32_t *outOffsets = topology.outOffsets.bytes;
+    const uint32_t *outEdges = topology.outEdges.bytes;
+
+    NSMutableData *minDepthData = [NSMutableData dataWithLength:nodeCount * sizeof(uint32_t)];
+    NSMutableData *pathCountData = [NSMutableData dataWithLength:nodeCount * sizeof(uint32_t)];
+    NSMutableData *visitedData = [NSMutableData dataWithLength:nodeCount];
+    NSMutableData *queueData = [NSMutableData dataWithLength:nodeCount * sizeof(uint32_t)];
+    uint32_t *minDepth = minDepthData.mutableBytes;
+    uint32_t *pathCount = pathCountData.mutableBytes;
+    uint8_t *visited = visitedData.mutableBytes;
+    uint32_t *queue = queueData.mutableBytes;
+    NSUInteger queueHead = 0, queueTail = 0;
+
+    NSNumber *sourceId = topology.nodeIds[[source toString]];
+    if (sourceId) {
+        visited[sourceId.unsignedIntValue] = 1;
+    }
 
-        CSMediaUrn *current = item[0];
-        NSUInteger depth = [item[1] unsignedIntegerValue];
+    // Traversing `edge` at `depth` reaches its target at depth + 1
+    void (^traverse)(uint32_t, uint32_t) = ^(uint32_t edge, uint32_t depth) {
+        uint32_t target = targets[edge];
+        if (pathCount[target] == 0) {
+            minDepth[target] = depth + 1;
+        }
+        pathCount[target] += 1;
+        if (!visited[target]) {
+            visited[target] = 1;
+            queue[queueTail++] = target;
+        }
+    };
 
+    if (maxDepth > 0) {
+        NSData *sourceEdges = [self outgoingEdgeIndicesForSource:source topology:topology];
+        const uint32_t *edges = sourceEdges.bytes;
+        for (NSUInteger i = 0; i < sourceEdges.length / sizeof(uint32_t); i++) {
+            traverse(edges[i], 0);
+        }
+    }
+    while (queueHead < queueTail) {
+        uint32_t node = queue[queueHead++];
+        uint32_t depth = minDepth[node];
         if (depth >= maxDepth) continue;
+        for (uint32_t i = outOffsets[node]; i < outOffsets[node + 1]; i++) {
+            traverse(outEdges[i], depth);
+        }
+    }
 
-        NSArray<CSLiveMachinePlanEdge *> *outEdges = [self getOutgoingEdges:current];
-        for (CSLiveMachinePlanEdge *edge in outEdges) {
-            NSUInteger newDepth = depth + 1;
-            NSString *outputCanonical = [edge.toSpec toString];
-
-            // Record this target
-            CSReachableTargetInfo *info = results[outputCanonical];
-            if (!info) {
-                info = [[CSReachableTargetInfo alloc] init];
-                info.mediaUrn = outputCanonical;
-                info.displayName = outputCanonical;
-                info.minDepth = newDepth;
-                info.pathCount = 0;
-                results[outputCanonical] = info;
-            }
-            info.pathCount += 1;
+    NSMutableArray<NSNumber *> *reached = [NSMutableArray array];
+    for (uint32_t n = 0; n < nodeCount; n++) {
+        if (pathCount[n] > 0) {
+            [reached addObject:@(n)];
+        }
+    }
+    NSArray<CSMediaUrn *> *nodeUrns = topology.nodeUrns;
+    [reached sortUsingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+        uint32_t na = a.unsignedIntValue, nb = b.unsignedIntValue;
+        if (minDepth[na] != minDepth[nb]) {
+            return minDepth[na] < minDepth[nb] ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return [[nodeUrns[na] toString] compare:[nodeUrns[nb] toString]];
+    }];
+
+    NSMutableData *result = [NSMutableData dataWithLength:reached.count * sizeof(CSLiveReachableNode)];
+    CSLiveReachableNode *entries = result.mutableBytes;
+    for (NSUInteger i = 0; i < reached.count; i++) {
+        uint32_t n = reached[i].unsignedIntValue;
+        entries[i] = (CSLiveReachableNode){ .node = n, .minDepth = minDepth[n], .pathCount = pathCount[n] };
+    }
+    return result;
+}
 
-            // Continue BFS if not visited
-            if (![visited containsObject:outputCanonical]) {
-                [visited addObject:outputCanonical];
-                [queue addObject:@[edge.toSpec, @(newDepth)]];
+// MARK: - Path Finding (k-best search with exact target matching)
+
+/// Per node: fewest cap steps and fewest edges to any node equivalent to
+/// `target` (CSLiveCapGraphNone if unreachable). Cached per target.
+/// Layout: nodeCount uint32 cap distances, then nodeCount uint32 hop distances.
+- (NSData *)distancesToTarget:(CSMediaUrn *)target topology:(CSLiveCapGraphTopology *)topology {
+    NSString *targetCanonical = [target toString];
+    [self.queryCacheLock lock];
+    NSData *cached = self.targetDistanceCache[targetCanonical];
+    [self.queryCacheLock unlock];
+    if (cached) {
+        return cached;
+    }
+
+    NSUInteger nodeCount = topology.nodeUrns.count;
+    NSMutableData *distances = [NSMutableData dataWithLength:2 * nodeCount * sizeof(uint32_t)];
+    uint32_t *capDist = distances.mutableBytes;
+    uint32_t *hopDist = capDist + nodeCount;
+    for (NSUInteger n = 0; n < nodeCount; n++) {
+        capDist[n] = CSLiveCapGraphNone;
+        hopDist[n] = CSLiveCapGraphNone;
+    }
+
+    const uint32_t *inOffsets = topology.inOffsets.bytes;
+    const uint32_t *inEdges = topology.inEdges.bytes;
+    const uint32_t *inSources = topology.inSources.bytes;
+
+    // A node enters a level at most twice: carried over from the previous
+    // level, or reached through a free cardinality edge within this one
+    NSUInteger capacity = 2 * nodeCount + 1;
+    NSMutableData *queueData = [NSMutableData dataWithLength:capacity * sizeof(uint32_t)];
+    NSMutableData *nextData = [NSMutableData dataWithLength:capacity * sizeof(uint32_t)];
+    uint32_t *queue = queueData.mutableBytes;
+    uint32_t *next = nextData.mutableBytes;
+    NSUInteger queueCount = 0, nextCount = 0;
+
+    for (NSUInteger n = 0; n < nodeCount; n++) {
+        CSMediaUrn *node = topology.nodeUrns[n];
+        if ([[node toString] isEqualToString:targetCanonical] || [node isEquivalentTo:target]) {
+            capDist[n] = 0;
+            hopDist[n] = 0;
+            queue[queueCount++] = (uint32_t)n;
+        }
+    }
+
+    // Hop distances: plain reverse BFS
+    NSMutableData *hopQueueData = [NSMutableData dataWithBytes:queue length:queueCount * sizeof(uint32_t)];
+    [hopQueueData setLength:(nodeCount + 1) * sizeof(uint32_t)];
+    uint32_t *hopQueue = hopQueueData.mutableBytes;
+    NSUInteger hopHead = 0, hopTail = queueCount;
+    while (hopHead < hopTail) {
+        uint32_t node = hopQueue[hopHead++];
+        for (uint32_t i = inOffsets[node]; i < inOffsets[node + 1]; i++) {
+            uint32_t from = inSources[i];
+            if (hopDist[from] == CSLiveCapGraphNone) {
+                hopDist[from] = hopDist[node] + 1;
+                hopQueue[hopTail++] = from;
             }
         }
     }
 
-    // Sort by (minDepth, displayName)
-    NSArray<CSReachableTargetInfo *> *sorted = [[results allValues] sortedArrayUsingComparator:
-        ^NSComparisonResult(CSReachableTargetInfo *a, CSReachableTargetInfo *b) {
-            if (a.minDepth != b.minDepth) {
-                return a.minDepth < b.minDepth ? NSOrderedAscending : NSOrderedDescending;
+    // Cap distances: level by level; cardinality edges are free within a level
+    uint32_t level = 0;
+    while (queueCount > 0) {
+        for (NSUInteger q = 0; q < queueCount; q++) {
+            uint32_t node = queue[q];
+            if (capDist[node] != level) continue;
+            for (uint32_t i = inOffsets[node]; i < inOffsets[node + 1]; i++) {
+                uint32_t from = inSources[i];
+                BOOL isCap = [self.edges[inEdges[i]] isCap];
+                uint32_t candidate = level + (isCap ? 1 : 0);
+                if (candidate < capDist[from]) {
+                    capDist[from] = candidate;
+                    if (isCap) {
+                        next[nextCount++] = from;
+                    } else {
+                        queue[queueCount++] = from;
+                    }
+                }
             }
-            return [a.displayName compare:b.displayName];
-        }];
+        }
+        uint32_t *swap = queue;
+        queue = next;
+        next = swap;
+        queueCount = nextCount;
+        nextCount = 0;
+        level++;
+    }
+
+    [self.queryCacheLock lock];
+    if (self.topology == topology) {
+        if (self.targetDistanceCache.count >= CSLiveCapGraphQueryCacheLimit) {
+            [self.targetDistanceCache removeAllObjects];
+        }
+        self.targetDistanceCache[targetCanonical] = distances;
+    }
+    [self.queryCacheLock unlock];
+    return distances;
+}
 
-    return sorted;
+/// A path in the k-best search tree; `parent` indexes the same array (-1 at the source)
+typedef struct {
+    uint32_t node;
+    uint32_t edge;
+    int32_t parent;
+    uint32_t length;
+    uint32_t capSteps;
+    uint32_t specificity;
+    uint32_t bound;
+} CSLivePartialPath;
+
+/// Heap order: lowest cap-step bound first, then highest specificity, then oldest
+static BOOL CSLivePartialPathPrecedes(const CSLivePartialPath *paths, uint32_t a, uint32_t b) {
+    if (paths[a].bound != paths[b].bound) return paths[a].bound < paths[b].bound;
+    if (paths[a].specificity != paths[b].specificity) return paths[a].specificity > paths[b].specificity;
+    return a < b;
 }
 
-// MARK: - Path Finding (DFS with exact target matching)
+static void CSLiveHeapPush(NSMutableData *heapData, const CSLivePartialPath *paths, uint32_t value) {
+    [heapData appendBytes:&value length:sizeof(value)];
+    uint32_t *heap = heapData.mutableBytes;
+    NSUInteger i = heapData.length / sizeof(uint32_t) - 1;
+    while (i > 0) {
+        NSUInteger parent = (i - 1) / 2;
+        if (!CSLivePartialPathPrecedes(paths, heap[i], heap[parent])) break;
+        uint32_t tmp = heap[i]; heap[i] = heap[parent]; heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static uint32_t CSLiveHeapPop(NSMutableData *heapData, const CSLivePartialPath *paths) {
+    uint32_t *heap = heapData.mutableBytes;
+    NSUInteger count = heapData.length / sizeof(uint32_t);
+    uint32_t top = heap[0];
+    heap[0] = heap[count - 1];
+    count -= 1;
+    heapData.length = count * sizeof(uint32_t);
+    heap = heapData.mutableBytes;
+    NSUInteger i = 0;
+    while (YES) {
+        NSUInteger left = 2 * i + 1, right = left + 1, best = i;
+        if (left < count && CSLivePartialPathPrecedes(paths, heap[left], heap[best])) best = left;
+        if (right < count && CSLivePartialPathPrecedes(paths, heap[right], heap[best])) best = right;
+        if (best == i) break;
+        uint32_t tmp = heap[i]; heap[i] = heap[best]; heap[best] = tmp;
+        i = best;
+    }
+    return top;
+}
 
 - (NSArray<CSStrand *> *)findPathsToExactTarget:(CSMediaUrn *)source
                                                    target:(CSMediaUrn *)target
                                                  maxDepth:(NSUInteger)maxDepth
                                                  maxPaths:(NSUInteger)maxPaths {
     // If source already satisfies target, return empty
-    if ([source isEquivalentTo:target]) {
+    if (maxPaths == 0 || maxDepth == 0 || [source isEquivalentTo:target]) {
         return @[];
     }
 
-    NSMutableArray<CSStrand *> *allPaths = [NSMutableArray array];
-    NSMutableArray<CSStrandStep *> *currentPath = [NSMutableArray array];
-    NSMutableSet<NSString *> *visited = [NSMutableSet set];
+    CSLiveCapGraphTopology *topology = [self currentTopology];
+    NSData *distances = [self distancesToTarget:target topology:topology];
+    NSUInteger nodeCount = topology.nodeUrns.count;
+    const uint32_t *capDist = distances.bytes;
+    const uint32_t *hopDist = capDist + nodeCount;
+    const uint32_t *targets = topology.edgeTargets.bytes;
+    const uint32_t *outOffsets = topology.outOffsets.bytes;
+    const uint32_t *outEdges = topology.outEdges.bytes;
+    NSNumber *sourceIdNumber = topology.nodeIds[[source toString]];
+    uint32_t sourceId = sourceIdNumber ? sourceIdNumber.unsignedIntValue : CSLiveCapGraphNone;
+
+    // A* over simple paths: g = cap steps so far, h = fewest cap steps to the
+    // target (admissible, consistent), so complete paths pop in cap-step order.
+    NSMutableData *pathData = [NSMutableData data];
+    NSMutableData *heapData = [NSMutableData data];
+    void (^extend)(int32_t, uint32_t) = ^(int32_t parent, uint32_t edgeIndex) {
+        uint32_t node = targets[edgeIndex];
+        const CSLivePartialPath *paths = pathData.bytes;
+        uint32_t length = parent < 0 ? 1 : paths[parent].length + 1;
+        if (hopDist[node] == CSLiveCapGraphNone || length + hopDist[node] > maxDepth) return;
+        if (node == sourceId) return;
+        for (int32_t p = parent; p >= 0; p = paths[p].parent) {
+            if (paths[p].node == node) return;   // simple paths only
+        }
+        CSLiveMachinePlanEdge *edge = self.edges[edgeIndex];
+        CSLivePartialPath path = {
+            .node = node,
+            .edge = edgeIndex,
+            .parent = parent,
+            .length = length,
+            .capSteps = (parent < 0 ? 0 : paths[parent].capSteps) + ([edge isCap] ? 1 : 0),
+            .specificity = (parent < 0 ? 0 : paths[parent].specificity) + (uint32_t)edge.specificity,
+        };
+        path.bound = path.capSteps + capDist[node];
+        [pathData appendBytes:&path length:sizeof(path)];
+        CSLiveHeapPush(heapData, pathData.bytes, (uint32_t)(pathData.length / sizeof(CSLivePartialPath) - 1));
+    };
+
+    NSData *sourceEdges = [self outgoingEdgeIndicesForSource:source topology:topology];
+    for (NSUInteger i = 0; i < sourceEdges.length / sizeof(uint32_t); i++) {
+        extend(-1, ((const uint32_t *)sourceEdges.bytes)[i]);
+    }
 
-    [self dfsFindPaths:source
-                target:target
-               current:source
-           currentPath:currentPath
-               visited:visited
-              allPaths:allPaths
-              maxDepth:maxDepth
-              maxPaths:maxPaths];
+    // Pop until maxPaths complete paths are found, then keep draining paths
+    // whose bound ties the last one so specificity/lex ordering is exact
+    NSMutableArray<NSNumber *> *complete = [NSMutableArray array];
+    uint32_t boundary = CSLiveCapGraphNone;
+    NSUInteger pops = 0;
+    while (heapData.length > 0 && pops < CSLiveCapGraphSearchBudget) {
+        uint32_t index = CSLiveHeapPop(heapData, pathData.bytes);
+        pops++;
+        CSLivePartialPath path = ((const CSLivePartialPath *)pathData.bytes)[index];
+        if (path.bound > boundary) break;
+
+        if (hopDist[path.node] == 0) {
+            [complete addObject:@(index)];
+            if (complete.count == maxPaths) {
+                boundary = path.capSteps;
+            }
+            continue;
+        }
+        if (path.length >= maxDepth) continue;
+        for (uint32_t i = outOffsets[path.node]; i < outOffsets[path.node + 1]; i++) {
+            extend((int32_t)index, outEdges[i]);
+        }
+    }
+
+    const CSLivePartialPath *paths = pathData.bytes;
+    NSMutableArray<CSStrand *> *allPaths = [NSMutableArray arrayWithCapacity:complete.count];
+    for (NSNumber *index in complete) {
+        NSMutableArray<CSStrandStep *> *steps = [NSMutableArray array];
+        for (int32_t p = index.intValue; p >= 0; p = paths[p].parent) {
+            [steps insertObject:[self stepForEdge:self.edges[paths[p].edge]] atIndex:0];
+        }
+        [allPaths addObject:[self strandFromSource:source target:target steps:steps]];
+    }
 
     // Sort paths deterministically
     [allPaths sortUsingComparator:^NSComparisonResult(CSStrand *a, CSStrand *b) {
         return [CSLiveCapGraph comparePaths:a with:b];
     }];
-
+    if (allPaths.count > maxPaths) {
+        [allPaths removeObjectsInRange:NSMakeRange(maxPaths, allPaths.count - maxPaths)];
+    }
     return allPaths;
 }
 
-- (void)dfsFindPaths:(CSMediaUrn *)source
-              target:(CSMediaUrn *)target
-             current:(CSMediaUrn *)current
-         currentPath:(NSMutableArray<CSStrandStep *> *)currentPath
-             visited:(NSMutableSet<NSString *> *)visited
-            allPaths:(NSMutableArray<CSStrand *> *)allPaths
-            maxDepth:(NSUInteger)maxDepth
-            maxPaths:(NSUInteger)maxPaths {
-
-    if (allPaths.count >= maxPaths) return;
-
-    // Check if we reached the EXACT target using isEquivalentTo:
-    if ([current isEquivalentTo:target]) {
-        NSMutableArray<NSString *> *titles = [NSMutableArray array];
-        NSInteger capStepCount = 0;
-        for (CSStrandStep *step in currentPath) {
-            [titles addObject:[step title]];
-            if ([step isCap]) capStepCount++;
-        }
-
-        CSStrand *path = [[CSStrand alloc] init];
-        path.sourceSpec = [source toString];
-        path.targetSpec = [target toString];
-        path.steps = [currentPath copy];
-        path.totalSteps = (NSInteger)currentPath.count;
-        path.capStepCount = capStepCount;
-        path.pathDescription = [titles componentsJoinedByString:@" → "];
-        [allPaths addObject:path];
-        return;
-    }
-
-    if (currentPath.count >= maxDepth) return;
+- (CSStrandStep *)stepForEdge:(CSLiveMachinePlanEdge *)edge {
+    CSStrandStep *step = [[CSStrandStep alloc] init];
+    step.fromSpec = [edge.fromSpec toString];
+    step.toSpec = [edge.toSpec toString];
 
-    NSString *currentCanonical = [current toString];
-    [visited addObject:currentCanonical];
-
-    // Explore outgoing edges
-    NSArray<CSLiveMachinePlanEdge *> *outEdges = [self getOutgoingEdges:current];
-    for (CSLiveMachinePlanEdge *edge in outEdges) {
-        NSString *nextCanonical = [edge.toSpec toString];
-
-        if (![visited containsObject:nextCanonical]) {
-            // Convert edge type to step info
-            CSStrandStep *step = [[CSStrandStep alloc] init];
-            step.fromSpec = [edge.fromSpec toString];
-            step.toSpec = [edge.toSpec toString];
-
-            switch (edge.edgeType) {
-                case CSLiveMachinePlanEdgeTypeCap:
-                    step.stepType = CSStrandStepTypeCap;
-                    step.capUrn = [edge.capUrn toString];
-                    step.specificity = edge.specificity;
-                    break;
-                case CSLiveMachinePlanEdgeTypeForEach:
-                    step.stepType = CSStrandStepTypeForEach;
-                    step.itemMediaUrn = [edge.toSpec toString];
-                    step.listMediaUrn = [edge.fromSpec toString];
-                    break;
-                case CSLiveMachinePlanEdgeTypeCollect:
-                    step.stepType = CSStrandStepTypeCollect;
-                    step.itemMediaUrn = [edge.fromSpec toString];
-                    step.listMediaUrn = [edge.toSpec toString];
-                    break;
-                case CSLiveMachinePlanEdgeTypeWrapInList:
-                    step.stepType = CSStrandStepTypeWrapInList;
-                    step.itemMediaUrn = [edge.fromSpec toString];
-                    step.listMediaUrn = [edge.toSpec toString];
-                    break;
-            }
-
-            [currentPath addObject:step];
-
-            [self dfsFindPaths:source
-                        target:target
-                       current:edge.toSpec
-                   currentPath:currentPath
-                       visited:visited
-                      allPaths:allPaths
-                      maxDepth:maxDepth
-                      maxPaths:maxPaths];
+    switch (edge.edgeType) {
+        case CSLiveMachinePlanEdgeTypeCap:
+            step.stepType = CSStrandStepTypeCap;
+            step.capUrn = [edge.capUrn toString];
+            step.specificity = edge.specificity;
+            break;
+        case CSLiveMachinePlanEdgeTypeForEach:
+            step.stepType = CSStrandStepTypeForEach;
+            step.itemMediaUrn = [edge.toSpec toString];
+            step.listMediaUrn = [edge.fromSpec toString];
+            break;
+        case CSLiveMachinePlanEdgeTypeCollect:
+            step.stepType = CSStrandStepTypeCollect;
+            step.itemMediaUrn = [edge.fromSpec toString];
+            step.listMediaUrn = [edge.toSpec toString];
+            break;
+        case CSLiveMachinePlanEdgeTypeWrapInList:
+            step.stepType = CSStrandStepTypeWrapInList;
+            step.itemMediaUrn = [edge.fromSpec toString];
+            step.listMediaUrn = [edge.toSpec toString];
+            break;
+    }
+    return step;
+}
 
-            [currentPath removeLastObject];
-        }
+- (CSStrand *)strandFromSource:(CSMediaUrn *)source
+                        target:(CSMediaUrn *)target
+                         steps:(NSArray<CSStrandStep *> *)steps {
+    NSMutableArray<NSString *> *titles = [NSMutableArray array];
+    NSInteger capStepCount = 0;
+    for (CSStrandStep *step in steps) {
+        [titles addObject:[step title]];
+        if ([step isCap]) capStepCount++;
     }
 
-    // Remove from visited for backtracking (enables multiple paths through same node)
-    [visited removeObject:currentCanonical];
+    CSStrand *path = [[CSStrand alloc] init];
+    path.sourceSpec = [source toString];
+    path.targetSpec = [target toString];
+    path.steps = steps;
+    path.totalSteps = (NSInteger)steps.count;
+    path.capStepCount = capStepCount;
+    path.pathDescription = [titles componentsJoinedByString:@" → "];
+    return path;
 }
 
 // MARK: - Path Comparison (Deterministic Ordering)
@@ -56,6 +56,16 @@
     return edge;
 }
 
+- (id)copyWithZone:(NSZone *)zone {
+    CSMachinePlanEdge *copy = [[CSMachinePlanEdge allocWithZone:zone] init];
+    copy.fromNode = self.fromNode;
+    copy.toNode = self.toNode;
+    copy.edgeType = self.edgeType;
+    copy.jsonField = self.jsonField;
+    copy.jsonPath = self.jsonPath;
+    return copy;
+}
+
 @end
 
 // MARK: - MachineNode
@@ -143,6 +153,30 @@
     return self.wrapItemMediaUrn != nil && self.wrapListMediaUrn != nil;
 }
 
+- (id)copyWithZone:(NSZone *)zone {
+    CSMachineNode *copy = [[CSMachineNode allocWithZone:zone] init];
+    copy.nodeId = self.nodeId;
+    copy.nodeDescription = self.nodeDescription;
+    copy.capUrn = self.capUrn;
+    copy.argBindings = [self.argBindings copy];
+    copy.preferredCap = self.preferredCap;
+    copy.inputNode = self.inputNode;
+    copy.bodyEntry = self.bodyEntry;
+    copy.bodyExit = self.bodyExit;
+    copy.inputNodes = [self.inputNodes copy];
+    copy.outputMediaUrn = self.outputMediaUrn;
+    copy.mergeStrategy = self.mergeStrategy;
+    copy.outputCount = self.outputCount;
+    copy.wrapItemMediaUrn = self.wrapItemMediaUrn;
+    copy.wrapListMediaUrn = self.wrapListMediaUrn;
+    copy.slotName = self.slotName;
+    copy.expectedMediaUrn = self.expectedMediaUrn;
+    copy.cardinality = self.cardinality;
+    copy.outputName = self.outputName;
+    copy.sourceNode = self.sourceNode;
+    return copy;
+}
+
 @end
 
 // MARK: - MachinePlan
@@ -182,6 +216,23 @@
     return self.nodes[nodeId];
 }
 
+- (id)copyWithZone:(NSZone *)zone {
+    CSMachinePlan *copy = [[CSMachinePlan allocWithZone:zone] init];
+    copy.name = self.name;
+    copy.nodes = [NSMutableDictionary dictionaryWithCapacity:self.nodes.count];
+    for (NSString *nodeId in self.nodes) {
+        copy.nodes[nodeId] = [self.nodes[nodeId] copy];
+    }
+    copy.edges = [NSMutableArray arrayWithCapacity:self.edges.count];
+    for (CSMachinePlanEdge *edge in self.edges) {
+        [copy.edges addObject:[edge copy]];
+    }
+    copy.entryNodes = [self.entryNodes mutableCopy];
+    copy.outputNodes = [self.outputNodes mutableCopy];
+    copy.metadata = [self.metadata copy];
+    return copy;
+}
+
 - (NSError * _Nullable)validate {
     // Check all edge references exist
     for (CSMachinePlanEdge *edge in self.edges) {
@@ -20,6 +20,17 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
 // MARK: - Supporting Structures Implementation
 
 @implementation CSReachableTargetInfo
+
+- (id)copyWithZone:(NSZone *)zone {
+    CSReachableTargetInfo *copy = [[CSReachableTargetInfo allocWithZone:zone] init];
+    copy.mediaUrn = self.mediaUrn;
+    copy.displayName = self.displayName;
+    copy.minDepth = self.minDepth;
+    copy.maxDepth = self.maxDepth;
+    copy.pathCount = self.pathCount;
+    return copy;
+}
+
 @end
 
 @implementation CSStrandStep
@@ -66,12 +77,30 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
 @implementation CSMachineInfo
 @end
 
+/// Entries per memo table; a full table is emptied before the next insert
+static const NSUInteger CSPlanBuilderMemoLimit = 512;
+
+typedef void (^CSPlanBuilderMemoCompletion)(id _Nullable value, NSError * _Nullable error);
+
 // MARK: - CSMachinePlanBuilder Implementation
 
 @interface CSMachinePlanBuilder ()
 @property (nonatomic, strong) id<CSCapRegistryProtocol> capRegistry;
 @property (nonatomic, strong) id<CSMediaUrnRegistryProtocol> mediaRegistry;
 @property (nonatomic, strong, nullable) NSSet<NSString *> *availableCapUrns;
+/// Guards the memo state below
+@property (nonatomic, strong) NSLock *memoLock;
+/// Bumped whenever the memo is emptied; results computed before are not stored
+@property (nonatomic, assign) NSUInteger memoEpoch;
+/// The caps array and registry generation the memo was computed from
+@property (nonatomic, strong, nullable) NSArray<CSCap *> *memoCaps;
+@property (nonatomic, strong, nullable) NSNumber *memoRegistryGeneration;
+/// "source\ntarget" -> cap URN path, or the NSError it failed with
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *pathMemo;
+/// "source\ntarget\ncardinality" -> plan (handed out as copies), or NSError
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *planMemo;
+/// "source\nmaxDepth" -> reachable targets, or NSError
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *reachableMemo;
 @end
 
 @implementation CSMachinePlanBuilder
@@ -83,15 +112,28 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
         _capRegistry = capRegistry;
         _mediaRegistry = mediaRegistry;
         _availableCapUrns = nil;
+        _memoLock = [[NSLock alloc] init];
+        _pathMemo = [NSMutableDictionary dictionary];
+        _planMemo = [NSMutableDictionary dictionary];
+        _reachableMemo = [NSMutableDictionary dictionary];
     }
     return self;
 }
 
 - (instancetype)withAvailableCaps:(NSSet<NSString *> *)availableCaps {
-    self.availableCapUrns = availableCaps;
+    [self.memoLock lock];
+    self.availableCapUrns = [availableCaps copy];
+    [self clearMemo];
+    [self.memoLock unlock];
     return self;
 }
 
+- (void)invalidateCaches {
+    [self.memoLock lock];
+    [self clearMemo];
+    [self.memoLock unlock];
+}
+
 - (BOOL)isCapAvailable:(NSString *)capUrn {
     if (self.availableCapUrns) {
         return [self.availableCapUrns containsObject:capUrn];
@@ -99,6 +141,99 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
     return YES;
 }
 
+// MARK: - Memo
+
+/// Caller holds memoLock
+- (void)clearMemo {
+    [self.pathMemo removeAllObjects];
+    [self.planMemo removeAllObjects];
+    [self.reachableMemo removeAllObjects];
+    self.memoCaps = nil;
+    self.memoRegistryGeneration = nil;
+    self.memoEpoch += 1;
+}
+
+- (nullable NSNumber *)registryGeneration {
+    if ([self.capRegistry respondsToSelector:@selector(capsGeneration)]) {
+        return @([self.capRegistry capsGeneration]);
+    }
+    return nil;
+}
+
+/// Answer `key` from `table` if the memo still matches the registry's caps;
+/// otherwise fetch the caps and call `compute`, which reports through `done`.
+/// Results and non-registry errors are memoized for the caps they came from.
+- (void)memoTable:(NSMutableDictionary<NSString *, id> *)table
+              key:(NSString *)key
+          compute:(void (^)(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error, CSPlanBuilderMemoCompletion done))compute
+       completion:(CSPlanBuilderMemoCompletion)completion {
+    // Read before fetching: a change in between only makes the memo look stale
+    NSNumber *registryGeneration = [self registryGeneration];
+
+    // With a generation to compare, a hit skips getCachedCaps entirely
+    if (registryGeneration) {
+        [self.memoLock lock];
+        id hit = [registryGeneration isEqual:self.memoRegistryGeneration] ? table[key] : nil;
+        [self.memoLock unlock];
+        if (hit) {
+            [self deliverMemoEntry:hit completion:completion];
+            return;
+        }
+    }
+
+    [self.capRegistry getCachedCaps:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error) {
+        if (error || !caps) {
+            compute(caps, error, completion);
+            return;
+        }
+
+        [self.memoLock lock];
+        BOOL sameGeneration = registryGeneration == self.memoRegistryGeneration ||
+                              [registryGeneration isEqual:self.memoRegistryGeneration];
+        // Without a generation, equal caps in a fresh array keep the memo
+        BOOL sameCaps = caps == self.memoCaps || (self.memoCaps && [caps isEqualToArray:self.memoCaps]);
+        if (!sameGeneration || !sameCaps) {
+            [self clearMemo];
+        }
+        self.memoCaps = caps;
+        self.memoRegistryGeneration = registryGeneration;
+        id hit = table[key];
+        NSUInteger epoch = self.memoEpoch;
+        [self.memoLock unlock];
+
+        if (hit) {
+            [self deliverMemoEntry:hit completion:completion];
+            return;
+        }
+
+        compute(caps, nil, ^(id _Nullable value, NSError * _Nullable computeError) {
+            id entry = value ?: computeError;
+            if (entry && !(computeError && computeError.code == CSPlannerErrorCodeRegistryError)) {
+                [self.memoLock lock];
+                if (self.memoEpoch == epoch) {
+                    if (table.count >= CSPlanBuilderMemoLimit) {
+                        [table removeAllObjects];
+                    }
+                    table[key] = entry;
+                }
+                [self.memoLock unlock];
+            }
+            [self deliverMemoEntry:entry completion:completion];
+        });
+    }];
+}
+
+/// Hand out a memo entry; callers get their own copies of mutable results
+- (void)deliverMemoEntry:(nullable id)entry completion:(CSPlanBuilderMemoCompletion)completion {
+    if ([entry isKindOfClass:[NSError class]]) {
+        completion(nil, entry);
+    } else if ([entry isKindOfClass:[NSArray class]]) {
+        completion([[NSArray alloc] initWithArray:entry copyItems:YES], nil);
+    } else {
+        completion([entry copy], nil);
+    }
+}
+
 // MARK: - Helper: Find file-path argument
 
 + (nullable NSString *)findFilePathArg:(CSCap *)cap {
@@ -138,151 +273,163 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
 - (void)findPathFromSource:(NSString *)sourceMedia
                   toTarget:(NSString *)targetMedia
                 completion:(void (^)(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable error))completion {
+    NSString *key = [NSString stringWithFormat:@"%@\n%@", sourceMedia, targetMedia];
+    [self memoTable:self.pathMemo key:key compute:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error, CSPlanBuilderMemoCompletion done) {
+        [self findPathFromSource:sourceMedia toTarget:targetMedia caps:caps error:error completion:^(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable pathError) {
+            done(capUrns, pathError);
+        }];
+    } completion:^(id _Nullable value, NSError * _Nullable error) {
+        completion(value, error);
+    }];
+}
 
-    [self.capRegistry getCachedCaps:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error) {
-        if (error) {
-            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                 code:CSPlannerErrorCodeRegistryError
-                                             userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Failed to list caps: %@", error.localizedDescription]}]);
-            return;
-        }
+- (void)findPathFromSource:(NSString *)sourceMedia
+                  toTarget:(NSString *)targetMedia
+                      caps:(nullable NSArray<CSCap *> *)caps
+                     error:(nullable NSError *)error
+                completion:(void (^)(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable error))completion {
+    if (error) {
+        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                             code:CSPlannerErrorCodeRegistryError
+                                         userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Failed to list caps: %@", error.localizedDescription]}]);
+        return;
+    }
 
-        NSError *parseError = nil;
-        CSMediaUrn *sourceUrn = [CSMediaUrn fromString:sourceMedia error:&parseError];
-        if (!sourceUrn) {
-            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                 code:CSPlannerErrorCodeInvalidInput
-                                             userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid source media URN '%@': %@", sourceMedia, parseError.localizedDescription]}]);
-            return;
-        }
+    NSError *parseError = nil;
+    CSMediaUrn *sourceUrn = [CSMediaUrn fromString:sourceMedia error:&parseError];
+    if (!sourceUrn) {
+        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                             code:CSPlannerErrorCodeInvalidInput
+                                         userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid source media URN '%@': %@", sourceMedia, parseError.localizedDescription]}]);
+        return;
+    }
 
-        CSMediaUrn *targetUrn = [CSMediaUrn fromString:targetMedia error:&parseError];
-        if (!targetUrn) {
-            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                 code:CSPlannerErrorCodeInvalidInput
-                                             userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid target media URN '%@': %@", targetMedia, parseError.localizedDescription]}]);
-            return;
-        }
+    CSMediaUrn *targetUrn = [CSMediaUrn fromString:targetMedia error:&parseError];
+    if (!targetUrn) {
+        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                             code:CSPlannerErrorCodeInvalidInput
+                                         userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid target media URN '%@': %@", targetMedia, parseError.localizedDescription]}]);
+        return;
+    }
 
-        // Check if source already satisfies target
-        if ([sourceUrn conformsTo:targetUrn]) {
-            completion(@[], nil);
-            return;
-        }
+    // Check if source already satisfies target
+    if ([sourceUrn conformsTo:targetUrn]) {
+        completion(@[], nil);
+        return;
+    }
 
-        // Build graph: input_canonical -> [(cap_urn, output_urn)]
-        NSMutableDictionary<NSString *, NSMutableArray *> *graph = [NSMutableDictionary dictionary];
-        NSMutableSet *seenEdges = [NSMutableSet set];
-        NSMutableArray<CSMediaUrn *> *inputUrns = [NSMutableArray array];
+    // Build graph: input_canonical -> [(cap_urn, output_urn)]
+    NSMutableDictionary<NSString *, NSMutableArray *> *graph = [NSMutableDictionary dictionary];
+    NSMutableSet *seenEdges = [NSMutableSet set];
+    NSMutableArray<CSMediaUrn *> *inputUrns = [NSMutableArray array];
 
-        for (CSCap *cap in caps) {
-            NSString *capUrnString = [cap.capUrn toString];
+    for (CSCap *cap in caps) {
+        NSString *capUrnString = [cap.capUrn toString];
 
-            if (![self isCapAvailable:capUrnString]) {
-                continue;
-            }
+        if (![self isCapAvailable:capUrnString]) {
+            continue;
+        }
 
-            NSString *inputSpec = [cap.capUrn inSpec];
-            NSString *outputSpec = [cap.capUrn outSpec];
+        NSString *inputSpec = [cap.capUrn inSpec];
+        NSString *outputSpec = [cap.capUrn outSpec];
 
-            if (inputSpec.length == 0 || outputSpec.length == 0) {
-                continue;
-            }
+        if (inputSpec.length == 0 || outputSpec.length == 0) {
+            continue;
+        }
 
-            CSMediaUrn *inputUrn = [CSMediaUrn fromString:inputSpec error:nil];
-            CSMediaUrn *outputUrn = [CSMediaUrn fromString:outputSpec error:nil];
+        CSMediaUrn *inputUrn = [CSMediaUrn fromString:inputSpec error:nil];
+        CSMediaUrn *outputUrn = [CSMediaUrn fromString:outputSpec error:nil];
 
-            if (!inputUrn || !outputUrn) {
-                continue;
-            }
+        if (!inputUrn || !outputUrn) {
+            continue;
+        }
 
-            NSString *inputCanonical = [inputUrn toString];
+        NSString *inputCanonical = [inputUrn toString];
 
-            // Check for duplicates - FAIL HARD
-            NSString *edgeKey = [NSString stringWithFormat:@"%@|%@", inputCanonical, capUrnString];
-            if ([seenEdges containsObject:edgeKey]) {
-                NSString *errorMsg = [NSString stringWithFormat:
-                    @"BUG: Duplicate cap_urn detected in graph building (find_path): %@ (input_spec: %@). "
-                    "This indicates stale caps in the registry - run upload-standards to sync.", capUrnString, inputSpec];
-                completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                    code:CSPlannerErrorCodeInternal
-                                                userInfo:@{NSLocalizedDescriptionKey: errorMsg}]);
-                return;
-            }
-            [seenEdges addObject:edgeKey];
+        // Check for duplicates - FAIL HARD
+        NSString *edgeKey = [NSString stringWithFormat:@"%@|%@", inputCanonical, capUrnString];
+        if ([seenEdges containsObject:edgeKey]) {
+            NSString *errorMsg = [NSString stringWithFormat:
+                @"BUG: Duplicate cap_urn detected in graph building (find_path): %@ (input_spec: %@). "
+                "This indicates stale caps in the registry - run upload-standards to sync.", capUrnString, inputSpec];
+            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                                code:CSPlannerErrorCodeInternal
+                                            userInfo:@{NSLocalizedDescriptionKey: errorMsg}]);
+            return;
+        }
+        [seenEdges addObject:edgeKey];
 
-            // Track unique input URNs
-            BOOL hasInputUrn = NO;
-            for (CSMediaUrn *existing in inputUrns) {
-                if ([[existing toString] isEqualToString:[inputUrn toString]]) {
-                    hasInputUrn = YES;
-                    break;
-                }
-            }
-            if (!hasInputUrn) {
-                [inputUrns addObject:inputUrn];
+        // Track unique input URNs
+        BOOL hasInputUrn = NO;
+        for (CSMediaUrn *existing in inputUrns) {
+            if ([[existing toString] isEqualToString:[inputUrn toString]]) {
+                hasInputUrn = YES;
+                break;
             }
+        }
+        if (!hasInputUrn) {
+            [inputUrns addObject:inputUrn];
+        }
 
-            // Add to graph
-            if (!graph[inputCanonical]) {
-                graph[inputCanonical] = [NSMutableArray array];
-            }
-            [graph[inputCanonical] addObject:@[capUrnString, outputUrn]];
+        // Add to graph
+        if (!graph[inputCanonical]) {
+            graph[inputCanonical] = [NSMutableArray array];
         }
+        [graph[inputCanonical] addObject:@[capUrnString, outputUrn]];
+    }
 
-        // Sort input URNs by decreasing specificity
-        [inputUrns sortUsingComparator:^NSComparisonResult(CSMediaUrn *a, CSMediaUrn *b) {
-            return [@([b specificity]) compare:@([a specificity])];
-        }];
+    // Sort input URNs by decreasing specificity
+    [inputUrns sortUsingComparator:^NSComparisonResult(CSMediaUrn *a, CSMediaUrn *b) {
+        return [@([b specificity]) compare:@([a specificity])];
+    }];
 
-        // BFS to find shortest path
-        NSMutableArray *queue = [NSMutableArray array];
-        NSMutableSet *visited = [NSMutableSet set];
+    // BFS to find shortest path
+    NSMutableArray *queue = [NSMutableArray array];
+    NSMutableSet *visited = [NSMutableSet set];
 
-        NSString *sourceCanonical = [sourceUrn toString];
-        [queue addObject:@[sourceUrn, @[]]];
-        [visited addObject:sourceCanonical];
+    NSString *sourceCanonical = [sourceUrn toString];
+    [queue addObject:@[sourceUrn, @[]]];
+    [visited addObject:sourceCanonical];
 
-        while (queue.count > 0) {
-            NSArray *item = queue.firstObject;
-            [queue removeObjectAtIndex:0];
+    while (queue.count > 0) {
+        NSArray *item = queue.firstObject;
+        [queue removeObjectAtIndex:0];
 
-            CSMediaUrn *currentUrn = item[0];
-            NSArray *path = item[1];
+        CSMediaUrn *currentUrn = item[0];
+        NSArray *path = item[1];
 
-            if ([currentUrn conformsTo:targetUrn]) {
-                completion(path, nil);
-                return;
-            }
+        if ([currentUrn conformsTo:targetUrn]) {
+            completion(path, nil);
+            return;
+        }
 
-            for (CSMediaUrn *capInputUrn in inputUrns) {
-                if (![currentUrn conformsTo:capInputUrn]) {
-                    continue;
-                }
+        for (CSMediaUrn *capInputUrn in inputUrns) {
+            if (![currentUrn conformsTo:capInputUrn]) {
+                continue;
+            }
 
-                NSString *capInputCanonical = [capInputUrn toString];
-                NSArray *neighbors = graph[capInputCanonical];
+            NSString *capInputCanonical = [capInputUrn toString];
+            NSArray *neighbors = graph[capInputCanonical];
 
-                for (NSArray *neighbor in neighbors) {
-                    NSString *capUrn = neighbor[0];
-                    CSMediaUrn *outputUrn = neighbor[1];
-                    NSString *outputCanonical = [outputUrn toString];
+            for (NSArray *neighbor in neighbors) {
+                NSString *capUrn = neighbor[0];
+                CSMediaUrn *outputUrn = neighbor[1];
+                NSString *outputCanonical = [outputUrn toString];
 
-                    if (![visited containsObject:outputCanonical]) {
-                        [visited addObject:outputCanonical];
-                        NSMutableArray *newPath = [path mutableCopy];
-                        [newPath addObject:capUrn];
-                        [queue addObject:@[outputUrn, newPath]];
-                    }
+                if (![visited containsObject:outputCanonical]) {
+                    [visited addObject:outputCanonical];
+                    NSMutableArray *newPath = [path mutableCopy];
+                    [newPath addObject:capUrn];
+                    [queue addObject:@[outputUrn, newPath]];
                 }
             }
         }
+    }
 
-        // No path found
-        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                            code:CSPlannerErrorCodeNotFound
-                                        userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"No path found from '%@' to '%@'", sourceMedia, targetMedia]}]);
-    }];
+    // No path found
+    completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                        code:CSPlannerErrorCodeNotFound
+                                    userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"No path found from '%@' to '%@'", sourceMedia, targetMedia]}]);
 }
 
 // MARK: - Build Plan
@@ -291,6 +438,22 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
                    toTarget:(NSString *)targetMedia
                  inputFiles:(NSArray<CSCapInputFile *> *)inputFiles
                  completion:(void (^)(CSMachinePlan * _Nullable plan, NSError * _Nullable error))completion {
+    // The input files only decide the input slot's cardinality
+    CSInputCardinality inputCardinality = (inputFiles.count == 1) ? CSInputCardinalitySingle : CSInputCardinalitySequence;
+    NSString *key = [NSString stringWithFormat:@"%@\n%@\n%ld", sourceMedia, targetMedia, (long)inputCardinality];
+    [self memoTable:self.planMemo key:key compute:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error, CSPlanBuilderMemoCompletion done) {
+        [self buildPlanFromSource:sourceMedia toTarget:targetMedia inputCardinality:inputCardinality completion:^(CSMachinePlan * _Nullable plan, NSError * _Nullable planError) {
+            done(plan, planError);
+        }];
+    } completion:^(id _Nullable value, NSError * _Nullable error) {
+        completion(value, error);
+    }];
+}
+
+- (void)buildPlanFromSource:(NSString *)sourceMedia
+                   toTarget:(NSString *)targetMedia
+           inputCardinality:(CSInputCardinality)inputCardinality
+                 completion:(void (^)(CSMachinePlan * _Nullable plan, NSError * _Nullable error))completion {
 
     [self findPathFromSource:sourceMedia toTarget:targetMedia completion:^(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable error) {
         if (error) {
@@ -321,7 +484,7 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
                                                                       target:targetMedia
                                                                  chainInfos:infos
                                                                    analysis:analysis
-                                                                 inputFiles:inputFiles];
+                                                           inputCardinality:inputCardinality];
 
             completion(plan, nil);
         }];
@@ -381,12 +544,10 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
                                                  target:(NSString *)targetMedia
                                              chainInfos:(NSArray<CSMachineInfo *> *)chainInfos
                                                analysis:(CSCardinalityChainAnalysis *)analysis
-                                             inputFiles:(NSArray<CSCapInputFile *> *)inputFiles {
+                                       inputCardinality:(CSInputCardinality)inputCardinality {
 
     CSMachinePlan *plan = [CSMachinePlan planWithName:[NSString stringWithFormat:@"Transform: %@ -> %@", sourceMedia, targetMedia]];
 
-    CSInputCardinality inputCardinality = (inputFiles.count == 1) ? CSInputCardinalitySingle : CSInputCardinalitySequence;
-
     NSString *inputSlotId = @"input_slot";
     [plan addNode:[CSMachineNode inputSlotNode:inputSlotId
                                   slotName:@"input"
@@ -739,132 +900,144 @@ NSString * const CSPlannerErrorDomain = @"CSPlannerError";
 - (void)getReachableTargetsWithMetadataFromSource:(NSString *)sourceMedia
                                          maxDepth:(NSUInteger)maxDepth
                                        completion:(void (^)(NSArray<CSReachableTargetInfo *> * _Nullable targets, NSError * _Nullable error))completion {
+    NSString *key = [NSString stringWithFormat:@"%@\n%lu", sourceMedia, (unsigned long)maxDepth];
+    [self memoTable:self.reachableMemo key:key compute:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error, CSPlanBuilderMemoCompletion done) {
+        [self getReachableTargetsWithMetadataFromSource:sourceMedia maxDepth:maxDepth caps:caps error:error completion:^(NSArray<CSReachableTargetInfo *> * _Nullable targets, NSError * _Nullable targetsError) {
+            done(targets, targetsError);
+        }];
+    } completion:^(id _Nullable value, NSError * _Nullable error) {
+        completion(value, error);
+    }];
+}
 
-    [self.capRegistry getCachedCaps:^(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error) {
-        if (error) {
-            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                code:CSPlannerErrorCodeRegistryError
-                                            userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Failed to list caps: %@", error.localizedDescription]}]);
-            return;
-        }
+- (void)getReachableTargetsWithMetadataFromSource:(NSString *)sourceMedia
+                                         maxDepth:(NSUInteger)maxDepth
+                                             caps:(nullable NSArray<CSCap *> *)caps
+                                            error:(nullable NSError *)error
+                                       completion:(void (^)(NSArray<CSReachableTargetInfo *> * _Nullable targets, NSError * _Nullable error))completion {
+    if (error) {
+        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                            code:CSPlannerErrorCodeRegistryError
+                                        userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Failed to list caps: %@", error.localizedDescription]}]);
+        return;
+    }
 
-        NSError *parseError = nil;
-        CSMediaUrn *sourceUrn = [CSMediaUrn fromString:sourceMedia error:&parseError];
-        if (!sourceUrn) {
-            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                code:CSPlannerErrorCodeInvalidInput
-                                            userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid source media URN '%@': %@", sourceMedia, parseError.localizedDescription]}]);
-            return;
-        }
+    NSError *parseError = nil;
+    CSMediaUrn *sourceUrn = [CSMediaUrn fromString:sourceMedia error:&parseError];
+    if (!sourceUrn) {
+        completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                            code:CSPlannerErrorCodeInvalidInput
+                                        userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Invalid source media URN '%@': %@", sourceMedia, parseError.localizedDescription]}]);
+        return;
+    }
 
-        NSMutableDictionary<NSString *, CSReachableTargetInfo *> *results = [NSMutableDictionary dictionary];
-        NSMutableSet *visited = [NSMutableSet set];
-        NSMutableArray *queue = [NSMutableArray array];
+    NSMutableDictionary<NSString *, CSReachableTargetInfo *> *results = [NSMutableDictionary dictionary];
+    NSMutableSet *visited = [NSMutableSet set];
+    NSMutableArray *queue = [NSMutableArray array];
 
-        NSString *sourceCanonical = [sourceUrn toString];
-        [queue addObject:@[sourceUrn, @0]];
-        [visited addObject:sourceCanonical];
+    NSString *sourceCanonical = [sourceUrn toString];
+    [queue addObject:@[sourceUrn, @0]];
+    [visited addObject:sourceCanonical];
 
-        // Build graph
-        NSMutableDictionary<NSString *, NSMutableArray<CSMediaUrn *> *> *graph = [NSMutableDictionary dictionary];
-        NSMutableArray<CSMediaUrn *> *inputUrns = [NSMutableArray array];
-        NSMutableSet *seenEdges = [NSMutableSet set];
+    // Build graph
+    NSMutableDictionary<NSString *, NSMutableArray<CSMediaUrn *> *> *graph = [NSMutableDictionary dictionary];
+    NSMutableArray<CSMediaUrn *> *inputUrns = [NSMutableArray array];
+    NSMutableSet *seenEdges = [NSMutableSet set];
 
-        for (CSCap *cap in caps) {
-            NSString *capUrnString = [[cap capUrn] toString];
+    for (CSCap *cap in caps) {
+        NSString *capUrnString = [[cap capUrn] toString];
 
-            if (![self isCapAvailable:capUrnString]) {
-                continue;
-            }
+        if (![self isCapAvailable:capUrnString]) {
+            continue;
+        }
 
-            NSString *inputSpec = [[cap capUrn] inSpec];
-            NSString *outputSpec = [[cap capUrn] outSpec];
+        NSString *inputSpec = [[cap capUrn] inSpec];
+        NSString *outputSpec = [[cap capUrn] outSpec];
 
-            if (inputSpec.length == 0 || outputSpec.length == 0) {
-                continue;
-            }
+        if (inputSpec.length == 0 || outputSpec.length == 0) {
+            continue;
+        }
 
-            CSMediaUrn *inputUrn = [CSMediaUrn fromString:inputSpec error:nil];
-            CSMediaUrn *outputUrn = [CSMediaUrn fromString:outputSpec error:nil];
+        CSMediaUrn *inputUrn = [CSMediaUrn fromString:inputSpec error:nil];
+        CSMediaUrn *outputUrn = [CSMediaUrn fromString:outputSpec error:nil];
 
-            if (!inputUrn || !outputUrn) {
-                continue;
-            }
+        if (!inputUrn || !outputUrn) {
+            continue;
+        }
 
-            NSString *inputCanonical = [inputUrn toString];
+        NSString *inputCanonical = [inputUrn toString];
 
-            NSString *edgeKey = [NSString stringWithFormat:@"%@|%@", inputCanonical, capUrnString];
-            if ([seenEdges containsObject:edgeKey]) {
-                NSString *errorMsg = [NSString stringWithFormat:
-                    @"BUG: Duplicate cap_urn detected in graph building (get_reachable_targets_with_metadata): %@ (input_spec: %@). "
-                    "This indicates stale caps in the registry - run upload-standards to sync.", capUrnString, inputSpec];
-                completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
-                                                    code:CSPlannerErrorCodeInternal
-                                                userInfo:@{NSLocalizedDescriptionKey: errorMsg}]);
-                return;
-            }
-            [seenEdges addObject:edgeKey];
+        NSString *edgeKey = [NSString stringWithFormat:@"%@|%@", inputCanonical, capUrnString];
+        if ([seenEdges containsObject:edgeKey]) {
+            NSString *errorMsg = [NSString stringWithFormat:
+                @"BUG: Duplicate cap_urn detected in graph building (get_reachable_targets_with_metadata): %@ (input_spec: %@). "
+                "This indicates stale caps in the registry - run upload-standards to sync.", capUrnString, inputSpec];
+            completion(nil, [NSError errorWithDomain:CSPlannerErrorDomain
+                                                code:CSPlannerErrorCodeInternal
+                                            userInfo:@{NSLocalizedDescriptionKey: errorMsg}]);
+            return;
+        }
+        [seenEdges addObject:edgeKey];
 
-            BOOL hasInputUrn = NO;
-            for (CSMediaUrn *existing in inputUrns) {
-                if ([[existing toString] isEqualToString:[inputUrn toString]]) {
-                    hasInputUrn = YES;
-                    break;
-                }
-            }
-            if (!hasInputUrn) {
-                [inputUrns addObject:inputUrn];
+        BOOL hasInputUrn = NO;
+        for (CSMediaUrn *existing in inputUrns) {
+            if ([[existing toString] isEqualToString:[inputUrn toString]]) {
+                hasInputUrn = YES;
+                break;
             }
+        }
+        if (!hasInputUrn) {
+            [inputUrns addObject:inputUrn];
+        }
 
-            if (!graph[inputCanonical]) {
-                graph[inputCanonical] = [NSMutableArray array];
-            }
-            [graph[inputCanonical] addObject:outputUrn];
+        if (!graph[inputCanonical]) {
+            graph[inputCanonical] = [NSMutableArray array];
         }
+        [graph[inputCanonical] addObject:outputUrn];
+    }
 
-        // BFS with depth tracking
-        while (queue.count > 0) {
-            NSArray *item = queue.firstObject;
-            [queue removeObjectAtIndex:0];
+    // BFS with depth tracking
+    while (queue.count > 0) {
+        NSArray *item = queue.firstObject;
+        [queue removeObjectAtIndex:0];
 
-            CSMediaUrn *currentUrn = item[0];
-            NSUInteger depth = [item[1] unsignedIntegerValue];
+        CSMediaUrn *currentUrn = item[0];
+        NSUInteger depth = [item[1] unsignedIntegerValue];
 
-            if (depth >= maxDepth) {
+        if (depth >= maxDepth) {
+            continue;
+        }
+
+        for (CSMediaUrn *capInputUrn in inputUrns) {
+            if (![currentUrn conformsTo:capInputUrn]) {
                 continue;
             }
 
-            for (CSMediaUrn *capInputUrn in inputUrns) {
-                if (![currentUrn conformsTo:capInputUrn]) {
-                    continue;
-                }
-
-                NSString *capInputCanonical = [capInputUrn toString];
-                NSArray<CSMediaUrn *> *neighbors = graph[capInputCanonical];
+            NSString *capInputCanonical = [capInputUrn toString];
+            NSArray<CSMediaUrn *> *neighbors = graph[capInputCanonical];
 
-                for (CSMediaUrn *outputUrn in neighbors) {
-                    NSUInteger newDepth = depth + 1;
-                    NSString *outputCanonical = [outputUrn toString];
+            for (CSMediaUrn *outputUrn in neighbors) {
+                NSUInteger newDepth = depth + 1;
+                NSString *outputCanonical = [outputUrn toString];
 
-                    if (!results[outputCanonical]) {
-                        CSReachableTargetInfo *info = [[CSReachableTargetInfo alloc] init];
-                        info.mediaUrn = outputCanonical;
-                        info.displayName = outputCanonical; // Will be enriched by media registry
-                        info.minDepth = newDepth;
-                        info.maxDepth = newDepth;
-                        results[outputCanonical] = info;
-                    }
+                if (!results[outputCanonical]) {
+                    CSReachableTargetInfo *info = [[CSReachableTargetInfo alloc] init];
+                    info.mediaUrn = outputCanonical;
+                    info.displayName = outputCanonical; // Will be enriched by media registry
+                    info.minDepth = newDepth;
+                    info.maxDepth = newDepth;
+                    results[outputCanonical] = info;
+                }
 
-                    if (![visited containsObject:outputCanonical]) {
-                        [visited addObject:outputCanonical];
-                        [queue addObject:@[outputUrn, @(newDepth)]];
-                    }
+                if (![visited containsObject:outputCanonical]) {
+                    [visited addObject:outputCanonical];
+                    [queue addObject:@[outputUrn, @(newDepth)]];
                 }
             }
         }
+    }
 
-        completion([results allValues], nil);
-    }];
+    completion([results allValues], nil);
 }
 
 // MARK: - Find All Paths (DFS)
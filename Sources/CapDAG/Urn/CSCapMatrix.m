@@ -5,6 +5,7 @@
 
 #import "CSCapMatrix.h"
 #import "CSCapUrn.h"
+#import "CSMediaUrn.h"
 
 // Error domain for capability host registry
 static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
@@ -21,11 +22,51 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
 @implementation CSCapSetEntry
 @end
 
+/// Keys a media URN pattern requires an instance to carry
+static NSSet<NSString *> *CSRequiredMediaKeys(NSString *spec) {
+    if ([spec isEqualToString:@"media:"]) {
+        return [NSSet set];
+    }
+    return [[CSMediaUrn fromString:spec error:nil] requiredTagKeys] ?: [NSSet set];
+}
+
+/// Every key present on a media URN instance
+static NSSet<NSString *> *CSMediaKeys(NSString *spec) {
+    if ([spec isEqualToString:@"media:"]) {
+        return [NSSet set];
+    }
+    return [NSSet setWithArray:[CSMediaUrn fromString:spec error:nil].tags.allKeys ?: @[]];
+}
+
+/**
+ * One registered cap in the inverted index, with the media keys needed to
+ * reject it cheaply before -[CSCapUrn accepts:] runs.
+ */
+@interface CSCapIndexEntry : NSObject
+@property (nonatomic, weak) CSCapSetEntry *owner;
+/// Registration sequence of the owning set, then position within its capabilities
+@property (nonatomic, assign) NSUInteger setOrder;
+@property (nonatomic, assign) NSUInteger capIndex;
+@property (nonatomic, strong) CSCap *cap;
+/// Keys the request's in spec must carry (cap in spec is the pattern); empty for media:
+@property (nonatomic, strong) NSSet<NSString *> *requiredInKeys;
+/// Keys on the cap's out spec (the instance side of the out check); nil for media:, which accepts any request out
+@property (nonatomic, strong, nullable) NSSet<NSString *> *outKeys;
+@end
+
+@implementation CSCapIndexEntry
+@end
+
 /**
  * CSCapMatrix implementation
  */
 @interface CSCapMatrix ()
 @property (nonatomic, strong) NSMutableDictionary<NSString *, CSCapSetEntry *> *sets;
+/// Caps whose op tag has an exact value, keyed by that value
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<CSCapIndexEntry *> *> *capsByOp;
+/// Caps with op=* or no op tag
+@property (nonatomic, strong) NSMutableArray<CSCapIndexEntry *> *capsWithoutExactOp;
+@property (nonatomic, assign) NSUInteger nextSetOrder;
 @end
 
 @implementation CSCapMatrix
@@ -38,6 +79,8 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
     self = [super init];
     if (self) {
         _sets = [[NSMutableDictionary alloc] init];
+        _capsByOp = [[NSMutableDictionary alloc] init];
+        _capsWithoutExactOp = [[NSMutableArray alloc] init];
     }
     return self;
 }
@@ -89,9 +132,138 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
     entry.capabilities = capabilities;
     
     self.sets[name] = entry;
+    [self indexCapSetEntry:entry];
     return YES;
 }
 
+#pragma mark - Index
+
+- (void)indexCapSetEntry:(CSCapSetEntry *)entry {
+    NSUInteger setOrder = self.nextSetOrder++;
+    [entry.capabilities enumerateObjectsUsingBlock:^(CSCap *cap, NSUInteger idx, BOOL *stop) {
+        CSCapUrn *urn = cap.capUrn;
+        if (!urn) {
+            return;
+        }
+        CSCapIndexEntry *indexEntry = [[CSCapIndexEntry alloc] init];
+        indexEntry.owner = entry;
+        indexEntry.setOrder = setOrder;
+        indexEntry.capIndex = idx;
+        indexEntry.cap = cap;
+        indexEntry.requiredInKeys = CSRequiredMediaKeys(urn.inSpec);
+        indexEntry.outKeys = [urn.outSpec isEqualToString:@"media:"] ? nil : CSMediaKeys(urn.outSpec);
+
+        NSString *op = [urn getTag:@"op"];
+        if (op && ![op isEqualToString:@"*"]) {
+            NSMutableArray *bucket = self.capsByOp[op];
+            if (!bucket) {
+                bucket = [NSMutableArray array];
+                self.capsByOp[op] = bucket;
+            }
+            [bucket addObject:indexEntry];
+        } else {
+            [self.capsWithoutExactOp addObject:indexEntry];
+        }
+    }];
+}
+
+- (void)unindexCapSetEntry:(CSCapSetEntry *)entry {
+    NSPredicate *keep = [NSPredicate predicateWithBlock:^BOOL(CSCapIndexEntry *indexEntry, NSDictionary *bindings) {
+        return indexEntry.owner != entry;
+    }];
+    for (CSCap *cap in entry.capabilities) {
+        NSString *op = [cap.capUrn getTag:@"op"];
+        if (op && ![op isEqualToString:@"*"]) {
+            NSMutableArray *bucket = self.capsByOp[op];
+            [bucket filterUsingPredicate:keep];
+            if (bucket.count == 0) {
+                [self.capsByOp removeObjectForKey:op];
+            }
+        }
+    }
+    [self.capsWithoutExactOp filterUsingPredicate:keep];
+}
+
+/// Call `block` with every indexed cap that could accept `request`, bucket by
+/// bucket (no particular order). -[CSCapUrn accepts:] still has the final say.
+///
+/// A cap tag must be present on the request unless the cap leaves it out, so
+/// a request op=v can only match caps with op=v, op=* or no op; a request with
+/// no op only caps without an exact op; a request op=* any cap.
+- (void)enumerateCandidatesForRequest:(CSCapUrn *)request
+                           usingBlock:(void (^)(CSCapIndexEntry *indexEntry, BOOL *stop))block {
+    NSSet<NSString *> *requestInKeys = CSMediaKeys(request.inSpec);
+    NSSet<NSString *> *requestRequiredOutKeys = CSRequiredMediaKeys(request.outSpec);
+
+    __block BOOL stop = NO;
+    void (^visit)(NSArray<CSCapIndexEntry *> *) = ^(NSArray<CSCapIndexEntry *> *bucket) {
+        for (CSCapIndexEntry *indexEntry in bucket) {
+            if (![indexEntry.requiredInKeys isSubsetOfSet:requestInKeys]) {
+                continue;
+            }
+            if (indexEntry.outKeys && ![requestRequiredOutKeys isSubsetOfSet:indexEntry.outKeys]) {
+                continue;
+            }
+            block(indexEntry, &stop);
+            if (stop) {
+                return;
+            }
+        }
+    };
+
+    NSString *op = [request getTag:@"op"];
+    if ([op isEqualToString:@"*"]) {
+        for (NSArray<CSCapIndexEntry *> *bucket in self.capsByOp.allValues) {
+            visit(bucket);
+            if (stop) {
+                return;
+            }
+        }
+    } else if (op) {
+        NSArray<CSCapIndexEntry *> *bucket = self.capsByOp[op];
+        if (bucket) {
+            visit(bucket);
+            if (stop) {
+                return;
+            }
+        }
+    }
+    visit(self.capsWithoutExactOp);
+}
+
+/// For each set, the first of its capabilities (in registration order) that
+/// accepts `request`, ordered by set registration.
+- (NSArray<CSCapIndexEntry *> *)firstMatchPerSetForRequest:(CSCapUrn *)request {
+    NSMutableArray<CSCapIndexEntry *> *candidates = [NSMutableArray array];
+    [self enumerateCandidatesForRequest:request usingBlock:^(CSCapIndexEntry *indexEntry, BOOL *stop) {
+        [candidates addObject:indexEntry];
+    }];
+    [candidates sortUsingComparator:^NSComparisonResult(CSCapIndexEntry *a, CSCapIndexEntry *b) {
+        if (a.setOrder != b.setOrder) {
+            return a.setOrder < b.setOrder ? NSOrderedAscending : NSOrderedDescending;
+        }
+        if (a.capIndex != b.capIndex) {
+            return a.capIndex < b.capIndex ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+
+    NSMutableArray<CSCapIndexEntry *> *matches = [NSMutableArray array];
+    CSCapSetEntry *lastMatchedSet = nil;
+    for (CSCapIndexEntry *indexEntry in candidates) {
+        if (indexEntry.owner == lastMatchedSet) {
+            continue; // Already found this set's first matching capability
+        }
+        if ([indexEntry.cap.capUrn accepts:request]) {
+            [matches addObject:indexEntry];
+            lastMatchedSet = indexEntry.owner;
+        }
+    }
+    return matches;
+}
+
+#pragma mark - Lookup
+
 - (nullable NSArray<id<CSCapSet>> *)findCapSets:(NSString *)requestUrn
                                             error:(NSError * _Nullable * _Nullable)error {
     
@@ -106,14 +278,8 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
     }
     
     NSMutableArray<id<CSCapSet>> *matchingHosts = [[NSMutableArray alloc] init];
-    
-    for (CSCapSetEntry *entry in [self.sets allValues]) {
-        for (CSCap *cap in entry.capabilities) {
-            if ([cap.capUrn accepts:request]) {
-                [matchingHosts addObject:entry.host];
-                break; // Found a matching capability for this host, no need to check others
-            }
-        }
+    for (CSCapIndexEntry *match in [self firstMatchPerSetForRequest:request]) {
+        [matchingHosts addObject:match.owner.host];
     }
 
     if (matchingHosts.count == 0) {
@@ -143,18 +309,14 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
     id<CSCapSet> bestHost = nil;
     CSCap *bestCap = nil;
     NSInteger bestSpecificity = -1;
-    
-    for (CSCapSetEntry *entry in [self.sets allValues]) {
-        for (CSCap *cap in entry.capabilities) {
-            if ([cap.capUrn accepts:request]) {
-                NSInteger specificity = [cap.capUrn specificity];
-                if (bestSpecificity == -1 || specificity > bestSpecificity) {
-                    bestHost = entry.host;
-                    bestCap = cap;
-                    bestSpecificity = specificity;
-                }
-                break; // Found a matching capability for this host, check next host
-            }
+
+    // Each set competes with its first matching capability; ties keep the earlier set
+    for (CSCapIndexEntry *match in [self firstMatchPerSetForRequest:request]) {
+        NSInteger specificity = [match.cap.capUrn specificity];
+        if (bestSpecificity == -1 || specificity > bestSpecificity) {
+            bestHost = match.owner.host;
+            bestCap = match.cap;
+            bestSpecificity = specificity;
         }
     }
     
@@ -185,12 +347,25 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
 }
 
 - (BOOL)acceptsRequest:(NSString *)requestUrn {
-    NSArray<id<CSCapSet>> *sets = [self findCapSets:requestUrn error:nil];
-    return sets != nil && sets.count > 0;
+    CSCapUrn *request = [CSCapUrn fromString:requestUrn error:nil];
+    if (!request) {
+        return NO;
+    }
+
+    __block BOOL accepted = NO;
+    [self enumerateCandidatesForRequest:request usingBlock:^(CSCapIndexEntry *indexEntry, BOOL *stop) {
+        if ([indexEntry.cap.capUrn accepts:request]) {
+            accepted = YES;
+            *stop = YES;
+        }
+    }];
+    return accepted;
 }
 
 - (BOOL)unregisterCapSet:(NSString *)name {
-    if (self.sets[name]) {
+    CSCapSetEntry *entry = self.sets[name];
+    if (entry) {
+        [self unindexCapSetEntry:entry];
         [self.sets removeObjectForKey:name];
         return YES;
     }
@@ -199,6 +374,8 @@ static NSString * const CSCapMatrixErrorDomain = @"CSCapMatrixError";
 
 - (void)clear {
     [self.sets removeAllObjects];
+    [self.capsByOp removeAllObjects];
+    [self.capsWithoutExactOp removeAllObjects];
 }
 
 @end
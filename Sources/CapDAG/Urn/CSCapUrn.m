@@ -7,6 +7,7 @@
 
 #import "CSCapUrn.h"
 #import "CSMediaUrn.h"
+#import "CSUrnInternCache.h"
 @import TaggedUrn;
 
 NSErrorDomain const CSCapUrnErrorDomain = @"CSCapUrnErrorDomain";
@@ -28,7 +29,11 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
     return result;
 }
 
-@interface CSCapUrn ()
+@interface CSCapUrn () {
+    /// Derived once by precomputeDerivedValues — instances never change after construction
+    NSUInteger _specificity;
+    NSUInteger _hash;
+}
 @property (nonatomic, strong) NSString *inSpec;
 @property (nonatomic, strong) NSString *outSpec;
 @property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *mutableTags;
@@ -36,6 +41,21 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
 
 @implementation CSCapUrn
 
+#pragma mark - Interning
+
++ (CSUrnInternCache<CSCapUrn *> *)internCache {
+    static CSUrnInternCache<CSCapUrn *> *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[CSUrnInternCache alloc] initWithCapacity:CSUrnInternCacheDefaultCapacity];
+    });
+    return cache;
+}
+
++ (void)clearInternCache {
+    [[self internCache] removeAllObjects];
+}
+
 - (NSDictionary<NSString *, NSString *> *)tags {
     return [self.mutableTags copy];
 }
@@ -115,6 +135,13 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
 }
 
 + (nullable instancetype)fromString:(NSString *)string error:(NSError **)error {
+    if (string) {
+        CSCapUrn *interned = [[self internCache] objectForString:string];
+        if (interned) {
+            return interned;
+        }
+    }
+
     if (!string || string.length == 0) {
         if (error) {
             *error = [NSError errorWithDomain:CSCapUrnErrorDomain
@@ -206,7 +233,11 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
         }
     }
 
-    return [self fromInSpec:inSpecValue outSpec:outSpecValue tags:remainingTags error:error];
+    CSCapUrn *capUrn = [self fromInSpec:inSpecValue outSpec:outSpecValue tags:remainingTags error:error];
+    if (!capUrn) {
+        return nil;
+    }
+    return [[self internCache] internObject:capUrn forString:string];
 }
 
 + (nullable instancetype)fromTags:(NSDictionary<NSString *, NSString *> *)tags error:(NSError **)error {
@@ -361,9 +392,44 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
     instance.inSpec = processedInSpec;
     instance.outSpec = processedOutSpec;
     instance.mutableTags = [tags mutableCopy];
+    [instance precomputeDerivedValues];
     return instance;
 }
 
+/// Cache specificity and hash. Called once, after the last field is set.
+- (void)precomputeDerivedValues {
+    NSUInteger count = 0;
+
+    // Direction specs contribute their MediaUrn tag count (more tags = more specific)
+    // "media:" is the wildcard (contributes 0 to specificity)
+    if (self.inSpec && ![self.inSpec isEqualToString:@"media:"]) {
+        NSError *error = nil;
+        CSMediaUrn *inUrn = [CSMediaUrn fromString:self.inSpec error:&error];
+        NSAssert(inUrn != nil, @"CU2: Failed to parse in media URN '%@': %@", self.inSpec, error.localizedDescription);
+        count += (NSUInteger)inUrn.specificity;
+    }
+    if (self.outSpec && ![self.outSpec isEqualToString:@"media:"]) {
+        NSError *error = nil;
+        CSMediaUrn *outUrn = [CSMediaUrn fromString:self.outSpec error:&error];
+        NSAssert(outUrn != nil, @"CU2: Failed to parse out media URN '%@': %@", self.outSpec, error.localizedDescription);
+        count += (NSUInteger)outUrn.specificity;
+    }
+
+    // Count non-wildcard tags; hash entries order-independently so it agrees
+    // with the dictionary comparison in isEqual:
+    NSUInteger tagsHash = 0;
+    for (NSString *key in self.mutableTags) {
+        NSString *value = self.mutableTags[key];
+        if (![value isEqualToString:@"*"]) {
+            count++;
+        }
+        tagsHash += key.hash ^ (value.hash * 31);
+    }
+
+    _specificity = count;
+    _hash = self.inSpec.hash ^ (self.outSpec.hash * 31) ^ tagsHash;
+}
+
 - (instancetype)init {
     if (self = [super init]) {
         _mutableTags = [NSMutableDictionary dictionary];
@@ -636,30 +702,7 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
 }
 
 - (NSUInteger)specificity {
-    NSUInteger count = 0;
-
-    // Direction specs contribute their MediaUrn tag count (more tags = more specific)
-    // "media:" is the wildcard (contributes 0 to specificity)
-    if (![self.inSpec isEqualToString:@"media:"]) {
-        NSError *error = nil;
-        CSTaggedUrn *inUrn = [CSTaggedUrn fromString:self.inSpec error:&error];
-        NSAssert(inUrn != nil, @"CU2: Failed to parse in media URN '%@': %@", self.inSpec, error.localizedDescription);
-        count += inUrn.tags.count;
-    }
-    if (![self.outSpec isEqualToString:@"media:"]) {
-        NSError *error = nil;
-        CSTaggedUrn *outUrn = [CSTaggedUrn fromString:self.outSpec error:&error];
-        NSAssert(outUrn != nil, @"CU2: Failed to parse out media URN '%@': %@", self.outSpec, error.localizedDescription);
-        count += outUrn.tags.count;
-    }
-
-    // Count non-wildcard tags
-    for (NSString *value in self.mutableTags.allValues) {
-        if (![value isEqualToString:@"*"]) {
-            count++;
-        }
-    }
-    return count;
+    return _specificity;
 }
 
 - (BOOL)isMoreSpecificThan:(CSCapUrn *)other {
@@ -732,11 +775,17 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
 }
 
 - (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
     if (![object isKindOfClass:[CSCapUrn class]]) {
         return NO;
     }
 
     CSCapUrn *other = (CSCapUrn *)object;
+    if (_hash != other->_hash) {
+        return NO;
+    }
     // Compare direction specs first
     if (![self.inSpec isEqualToString:other.inSpec]) {
         return NO;
@@ -749,8 +798,7 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
 }
 
 - (NSUInteger)hash {
-    // Include direction specs in hash
-    return self.inSpec.hash ^ self.outSpec.hash ^ self.mutableTags.hash;
+    return _hash;
 }
 
 #pragma mark - NSCopying
@@ -779,6 +827,7 @@ static BOOL CSMediaUrnInstanceConformsToPattern(NSString *instance, NSString *pa
         if (!_mutableTags) {
             _mutableTags = [NSMutableDictionary dictionary];
         }
+        [self precomputeDerivedValues];
     }
     return self;
 }
@@ -8,11 +8,33 @@
 
 #import "CSMediaUrn.h"
 #import "CSTaggedUrn.h"
+#import "CSUrnInternCache.h"
 
 NSErrorDomain const CSMediaUrnErrorDomain = @"CSMediaUrnErrorDomain";
 
+@interface CSMediaUrn () {
+    /// Derived once in fromTaggedUrn:error: — the inner TaggedUrn never changes
+    NSString *_canonical;
+    NSUInteger _hash;
+    NSInteger _specificity;
+}
+@end
+
 @implementation CSMediaUrn
 
++ (CSUrnInternCache<CSMediaUrn *> *)internCache {
+    static CSUrnInternCache<CSMediaUrn *> *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[CSUrnInternCache alloc] initWithCapacity:CSUrnInternCacheDefaultCapacity];
+    });
+    return cache;
+}
+
++ (void)clearInternCache {
+    [[self internCache] removeAllObjects];
+}
+
 + (NSString *)PREFIX {
     return @"media";
 }
@@ -39,10 +61,20 @@ NSErrorDomain const CSMediaUrnErrorDomain = @"CSMediaUrnErrorDomain";
 
     CSMediaUrn *mediaUrn = [[CSMediaUrn alloc] init];
     mediaUrn->_inner = urn;
+    mediaUrn->_canonical = [urn toString];
+    mediaUrn->_hash = mediaUrn->_canonical.hash;
+    mediaUrn->_specificity = (NSInteger)urn.tags.count;
     return mediaUrn;
 }
 
 + (nullable instancetype)fromString:(NSString *)string error:(NSError **)error {
+    if (string) {
+        CSMediaUrn *interned = [[self internCache] objectForString:string];
+        if (interned) {
+            return interned;
+        }
+    }
+
     // Parse as TaggedUrn first (matching Rust: TaggedUrn::from_str then try_into)
     NSError *parseError = nil;
     CSTaggedUrn *urn = [CSTaggedUrn fromString:string error:&parseError];
@@ -56,7 +88,11 @@ NSErrorDomain const CSMediaUrnErrorDomain = @"CSMediaUrnErrorDomain";
     }
 
     // Validate prefix (matching Rust: check prefix == "media")
-    return [self fromTaggedUrn:urn error:error];
+    CSMediaUrn *mediaUrn = [self fromTaggedUrn:urn error:error];
+    if (!mediaUrn) {
+        return nil;
+    }
+    return [[self internCache] internObject:mediaUrn forString:string];
 }
 
 - (nullable NSString *)getTag:(NSString *)key {
@@ -67,14 +103,46 @@ NSErrorDomain const CSMediaUrnErrorDomain = @"CSMediaUrnErrorDomain";
     return self.inner.tags;
 }
 
+- (NSSet<NSString *> *)requiredTagKeys {
+    NSMutableSet<NSString *> *keys = [NSMutableSet set];
+    [self.tags enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *value, BOOL *stop) {
+        if (![value isEqualToString:@"?"] && ![value isEqualToString:@"!"]) {
+            [keys addObject:key];
+        }
+    }];
+    return keys;
+}
+
 - (NSString *)toString {
-    return [self.inner toString];
+    return _canonical;
 }
 
 - (NSString *)description {
     return [self toString];
 }
 
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:[CSMediaUrn class]]) {
+        return NO;
+    }
+    CSMediaUrn *other = (CSMediaUrn *)object;
+    return _hash == other->_hash && [_canonical isEqualToString:other->_canonical];
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Immutable: a copy is the same value
+    return self;
+}
+
 - (BOOL)conformsTo:(CSMediaUrn *)pattern error:(NSError **)error {
     return [self.inner conformsTo:pattern.inner error:error];
 }
@@ -192,7 +260,7 @@ NSErrorDomain const CSMediaUrnErrorDomain = @"CSMediaUrnErrorDomain";
 // MARK: - Specificity
 
 - (NSInteger)specificity {
-    return [[self tags] count];
+    return _specificity;
 }
 
 // MARK: - List cardinality builders
@@ -0,0 +1,39 @@
+//
+//  CSUrnInternCache.h
+//  CapDAG
+//
+//  Bounded, thread-safe string → parsed URN cache shared by CSCapUrn and
+//  CSMediaUrn. Only immutable instances may be interned: every caller that
+//  parses the same string gets the same object back.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Default number of entries kept per cache
+FOUNDATION_EXPORT const NSUInteger CSUrnInternCacheDefaultCapacity;
+
+@interface CSUrnInternCache<ObjectType> : NSObject
+
+/// Maximum number of entries; the oldest entry is evicted when full
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// Number of entries currently held
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/// Interned instance for the exact string, or nil
+- (nullable ObjectType)objectForString:(NSString *)string;
+
+/// Intern an instance for the exact string. If another thread interned the
+/// same string first, that instance wins and is returned.
+- (ObjectType)internObject:(ObjectType)object forString:(NSString *)string;
+
+/// Drop every entry
+- (void)removeAllObjects;
+
+@end
+
+NS_ASSUME_NONNULL_END
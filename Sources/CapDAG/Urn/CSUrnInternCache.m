@@ -0,0 +1,72 @@
+//
+//  CSUrnInternCache.m
+//  CapDAG
+//
+//  Bounded, thread-safe string → parsed URN cache
+//
+
+#import "CSUrnInternCache.h"
+
+const NSUInteger CSUrnInternCacheDefaultCapacity = 4096;
+
+@interface CSUrnInternCache ()
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *entries;
+/// Keys in insertion order, oldest first (FIFO eviction)
+@property (nonatomic, strong) NSMutableArray<NSString *> *insertionOrder;
+@property (nonatomic, strong) NSLock *lock;
+@end
+
+@implementation CSUrnInternCache
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    if (self = [super init]) {
+        _capacity = MAX(capacity, (NSUInteger)1);
+        _entries = [NSMutableDictionary dictionaryWithCapacity:_capacity];
+        _insertionOrder = [NSMutableArray arrayWithCapacity:_capacity];
+        _lock = [[NSLock alloc] init];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    [self.lock lock];
+    NSUInteger count = self.entries.count;
+    [self.lock unlock];
+    return count;
+}
+
+- (nullable id)objectForString:(NSString *)string {
+    [self.lock lock];
+    id object = self.entries[string];
+    [self.lock unlock];
+    return object;
+}
+
+- (id)internObject:(id)object forString:(NSString *)string {
+    NSString *key = [string copy];
+
+    [self.lock lock];
+    id existing = self.entries[key];
+    if (existing) {
+        [self.lock unlock];
+        return existing;
+    }
+    if (self.entries.count >= self.capacity) {
+        NSString *oldest = self.insertionOrder.firstObject;
+        [self.insertionOrder removeObjectAtIndex:0];
+        [self.entries removeObjectForKey:oldest];
+    }
+    self.entries[key] = object;
+    [self.insertionOrder addObject:key];
+    [self.lock unlock];
+    return object;
+}
+
+- (void)removeAllObjects {
+    [self.lock lock];
+    [self.entries removeAllObjects];
+    [self.insertionOrder removeAllObjects];
+    [self.lock unlock];
+}
+
+@end
@@ -163,6 +163,9 @@ typedef NS_ENUM(NSInteger, CSArgumentSource) {
 /// Check if references previous node
 - (BOOL)referencesPrevious;
 
+/// The node a previous-output binding reads from, nil for other bindings
+- (nullable NSString *)previousOutputNodeId;
+
 @end
 
 // MARK: - ResolvedArgument
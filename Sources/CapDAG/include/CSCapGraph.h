@@ -140,6 +140,8 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * Check if a conversion path exists from one spec to another.
  * Uses BFS to find if there's any path (direct or through intermediates).
+ * The set of specs reachable from each source is computed once and reused
+ * until the next addCap:registryName:.
  * @param fromSpec The source MediaSpec ID
  * @param toSpec The target MediaSpec ID
  * @return YES if conversion is possible
@@ -169,7 +171,8 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * Find the best (highest specificity) conversion path from one spec to another.
  * Unlike findPath which finds the shortest path, this finds the path with
- * the highest total specificity score.
+ * the highest total specificity score. Ties go to the shorter path.
+ * Searches best-first without enumerating every path.
  * @param fromSpec The source MediaSpec ID
  * @param toSpec The target MediaSpec ID
  * @param maxDepth Maximum path length to search
@@ -179,6 +182,20 @@ NS_ASSUME_NONNULL_BEGIN
                                                toSpec:(NSString *)toSpec
                                              maxDepth:(NSInteger)maxDepth;
 
+/**
+ * Find the top `limit` conversion paths by total specificity (highest first,
+ * then fewest steps), over the same paths findAllPaths enumerates.
+ * @param fromSpec The source MediaSpec ID
+ * @param toSpec The target MediaSpec ID
+ * @param maxDepth Maximum path length to search
+ * @param limit Maximum number of paths to return
+ * @return Array of paths (each path is an array of edges), best first
+ */
+- (NSArray<NSArray<CSCapGraphEdge *> *> *)findBestPaths:(NSString *)fromSpec
+                                                 toSpec:(NSString *)toSpec
+                                               maxDepth:(NSInteger)maxDepth
+                                                  limit:(NSUInteger)limit;
+
 /**
  * Get all specs that have at least one outgoing edge.
  * @return Array of input spec IDs
@@ -40,6 +40,9 @@ NS_ASSUME_NONNULL_BEGIN
  * - cap:in="media:void";op=generate;out="media:binary";target=thumbnail
  * - cap:in="media:binary";op=extract;out="media:object";target=metadata
  * - cap:in="media:string";op=embed;out="media:number-array"
+ *
+ * Instances are immutable; specificity and hash are computed once at
+ * construction.
  */
 @interface CSCapUrn : NSObject <NSCopying, NSSecureCoding>
 
@@ -61,10 +64,19 @@ NS_ASSUME_NONNULL_BEGIN
  *
  * @param string The cap URN string (e.g., "cap:in=\"media:void\";op=generate;out=\"media:object\"")
  * @param error Error if the string format is invalid or in/out missing/invalid
- * @return A new CSCapUrn instance or nil if invalid
+ * Successful parses are interned (bounded, thread-safe): parsing the same
+ * string again returns the same instance without re-parsing. Failed parses
+ * are not cached.
+ *
+ * @return A CSCapUrn instance or nil if invalid
  */
 + (nullable instancetype)fromString:(NSString * _Nonnull)string error:(NSError * _Nullable * _Nullable)error;
 
+/**
+ * Drop every interned instance. Parsed URNs already handed out stay valid.
+ */
++ (void)clearInternCache;
+
 /**
  * Create a cap URN from tags
  * Extracts 'in' and 'out' from tags (required), stores rest as regular tags
@@ -22,6 +22,11 @@ NS_ASSUME_NONNULL_BEGIN
 /// Implemented by:
 /// - machfab: via CapService.execute_cap() through the relay
 /// - macino: by spawning plugin binaries
+///
+/// CSMachineExecutor runs independent nodes concurrently, so these methods
+/// may be called from several global queues at once (up to the executor's
+/// max parallelism) and must be thread-safe. Completions may be called on
+/// any queue.
 @protocol CSCapExecutorProtocol <NSObject>
 
 /// Execute a cap and return the raw output bytes
@@ -66,7 +71,25 @@ NS_ASSUME_NONNULL_BEGIN
 /// Set the settings provider for cap argument overrides
 - (instancetype)withSettingsProvider:(id<CSCapSettingsProviderProtocol>)provider;
 
-/// Execute the plan and return the result
+/// Run at most this many nodes at once (default 8), counting the nodes of
+/// every ForEach item body in flight. With 1, nodes run one at a time in
+/// topological order and the cap executor is never called concurrently;
+/// above 1 it must be thread-safe (see CSCapExecutorProtocol).
+- (instancetype)withMaxParallelism:(NSUInteger)maxParallelism;
+
+/// Bound concurrent invocations per cap, keyed by the node's cap URN string.
+/// Like withMaxParallelism:, the bound covers ForEach item bodies too.
+- (instancetype)withCapConcurrencyLimits:(NSDictionary<NSString *, NSNumber *> *)limits;
+
+/// Bound the ForEach items whose bodies run at once (default 8).
+/// A ForEach closed by a Collect runs its body once per item as results
+/// arrive; the Collect receives the per-item results in item order.
+- (instancetype)withForEachWindow:(NSUInteger)window;
+
+/// Execute the plan and return the result.
+/// Each node starts as soon as the nodes it depends on have finished, so
+/// independent branches run concurrently. After the first failure no new
+/// nodes start; the result is reported once running nodes have finished.
 - (void)execute:(void (^)(CSMachineResult * _Nullable result, NSError * _Nullable error))completion;
 
 @end
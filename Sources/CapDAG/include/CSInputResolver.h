@@ -204,6 +204,7 @@ BOOL CSInputResolverShouldExcludeDirectory(NSString *path);
 CSResolvedInputSet * _Nullable CSInputResolverResolvePath(NSString *path, NSError **error);
 
 /// Resolve multiple input paths to files
+/// Files are inspected concurrently; the result keeps the input order
 /// @param paths Array of paths (files, directories, or glob patterns)
 /// @param error Output: error if resolution fails
 /// @return Resolved input set, or nil on error
@@ -216,6 +217,11 @@ CSResolvedInputSet * _Nullable CSInputResolverResolvePaths(NSArray<NSString *> *
 /// @return Media URN string, or nil on error
 NSString * _Nullable CSInputResolverDetectFile(NSString *path, CSContentStructure *structure, NSError **error);
 
+/// Forget cached detection results
+/// CSInputResolverResolvePaths reuses a file's result while its size and
+/// modification date are unchanged; call this to force re-inspection
+void CSInputResolverClearDetectionCache(void);
+
 #pragma mark - Path Utilities
 
 /// Check if a path contains glob metacharacters
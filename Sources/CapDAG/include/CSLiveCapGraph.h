@@ -89,6 +89,10 @@ typedef NS_ENUM(NSInteger, CSLiveMachinePlanEdgeType) {
 
 /// Precomputed capability graph for path finding and reachability queries.
 /// Maintains a persistent graph structure updated when capabilities change.
+///
+/// Queries may run concurrently with each other; the lazily built topology
+/// and query caches are guarded internally. Mutations (sync, add, remove,
+/// clear) must not overlap any other call on the same graph.
 @interface CSLiveCapGraph : NSObject
 
 /// Create a new empty graph
@@ -97,17 +101,26 @@ typedef NS_ENUM(NSInteger, CSLiveMachinePlanEdgeType) {
 /// Clear the graph completely
 - (void)clear;
 
-/// Rebuild from a list of capabilities (replaces current contents).
-/// After adding all cap edges, inserts cardinality transitions (ForEach/Collect).
+/// Sync to a list of capabilities (replaces current contents).
+/// Diffs against the caps already in the graph and applies only the delta,
+/// so the result matches a full rebuild with cardinality transitions
+/// (ForEach/Collect) inserted. An unchanged cap set costs one diff.
 - (void)syncFromCaps:(NSArray<CSCap *> *)caps;
 
-/// Rebuild from cap URN strings using the registry.
+/// Sync from cap URN strings using the registry.
 /// Looks up Cap definitions from the registry; skips identity caps.
 - (void)syncFromCapUrns:(NSArray<NSString *> *)capUrns
                registry:(id<CSCapRegistryProtocol>)registry
              completion:(void (^)(void))completion;
 
+/// Apply a cap delta: remove caps by URN, add new caps, and recompute
+/// ForEach/Collect edges only for list types the change can affect.
+/// Caps already in the graph (and not removed) are ignored.
+- (void)updateWithAddedCaps:(NSArray<CSCap *> *)addedCaps
+             removedCapUrns:(NSArray<NSString *> *)removedCapUrns;
+
 /// Add a single capability as an edge. Skips empty specs and identity caps.
+/// Does not insert cardinality transitions; the next sync does.
 - (void)addCap:(CSCap *)cap;
 
 /// Number of unique media URN nodes
@@ -118,11 +131,13 @@ typedef NS_ENUM(NSInteger, CSLiveMachinePlanEdgeType) {
 
 /// BFS: find all reachable targets from source, up to maxDepth.
 /// Returns targets sorted by (min_path_length, display_name).
+/// Results are cached per (source, maxDepth) until the graph next changes.
 - (NSArray<CSReachableTargetInfo *> *)getReachableTargetsFromSource:(CSMediaUrn *)source
                                                           maxDepth:(NSUInteger)maxDepth;
 
-/// DFS: find all paths to exact target (uses isEquivalentTo: for matching).
+/// Find the best maxPaths paths to exact target (uses isEquivalentTo: for matching).
 /// Returns paths sorted by (cap_step_count, specificity desc, urn lex).
+/// Searches best-first with a bounded budget instead of enumerating every path.
 - (NSArray<CSStrand *> *)findPathsToExactTarget:(CSMediaUrn *)source
                                                    target:(CSMediaUrn *)target
                                                  maxDepth:(NSUInteger)maxDepth
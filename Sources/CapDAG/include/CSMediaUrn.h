@@ -21,7 +21,10 @@ typedef NS_ERROR_ENUM(CSMediaUrnErrorDomain, CSMediaUrnError) {
 
 /// Media URN - a TaggedUrn with required "media:" prefix
 /// Mirrors Rust: pub struct MediaUrn(TaggedUrn)
-@interface CSMediaUrn : NSObject
+///
+/// Instances are immutable. Equality and hash are by canonical string and are
+/// computed once at construction.
+@interface CSMediaUrn : NSObject <NSCopying>
 
 /// The required prefix for all media URNs
 @property (class, nonatomic, readonly) NSString *PREFIX;
@@ -37,8 +40,14 @@ typedef NS_ERROR_ENUM(CSMediaUrnErrorDomain, CSMediaUrnError) {
 /// Create a MediaUrn from a string representation
 /// The string must be a valid tagged URN with the "media" prefix
 /// Mirrors Rust: impl FromStr for MediaUrn
+///
+/// Successful parses are interned: parsing the same string again returns the
+/// same instance without re-parsing. Failed parses are not cached.
 + (nullable instancetype)fromString:(NSString *)string error:(NSError **)error;
 
+/// Drop every interned instance (parsed URNs already handed out stay valid)
++ (void)clearInternCache;
+
 /// Get a tag value
 /// Mirrors Rust: pub fn get_tag(&self, key: &str) -> Option<&str>
 - (nullable NSString *)getTag:(NSString *)key;
@@ -46,6 +55,11 @@ typedef NS_ERROR_ENUM(CSMediaUrnErrorDomain, CSMediaUrnError) {
 /// Get all tags as a dictionary
 - (NSDictionary<NSString *, NSString *> *)tags;
 
+/// Tag keys an instance must carry to conform to this URN used as a pattern:
+/// keys with an exact or `*` value (`?` places no constraint, `!` requires absence).
+/// Useful as a cheap presence prefilter before conformsTo:.
+- (NSSet<NSString *> *)requiredTagKeys;
+
 /// Convert to canonical string representation
 /// Mirrors Rust: impl Display for MediaUrn
 - (NSString *)toString;
@@ -52,7 +52,7 @@ typedef NS_ENUM(NSInteger, CSEdgeType) {
 
 /// An edge in the execution plan
 /// Mirrors Rust: pub struct MachinePlanEdge
-@interface CSMachinePlanEdge : NSObject
+@interface CSMachinePlanEdge : NSObject <NSCopying>
 
 /// Source node
 @property (nonatomic, copy) CSNodeId fromNode;
@@ -90,7 +90,7 @@ typedef NS_ENUM(NSInteger, CSEdgeType) {
 
 /// A node in the execution DAG
 /// Mirrors Rust: pub struct MachineNode and pub enum ExecutionNodeType
-@interface CSMachineNode : NSObject
+@interface CSMachineNode : NSObject <NSCopying>
 
 /// Unique identifier for this node
 @property (nonatomic, copy) CSNodeId nodeId;
@@ -177,7 +177,9 @@ typedef NS_ENUM(NSInteger, CSEdgeType) {
 
 /// The structured execution plan for a machine
 /// Mirrors Rust: pub struct MachinePlan
-@interface CSMachinePlan : NSObject
+/// Copies are deep: nodes, edges and the node lists can be changed without
+/// affecting the original.
+@interface CSMachinePlan : NSObject <NSCopying>
 
 /// Human-readable name for this execution plan
 @property (nonatomic, copy) NSString *name;
@@ -267,6 +269,9 @@ typedef NS_ENUM(NSInteger, CSEdgeType) {
 /// Execution duration in milliseconds
 @property (nonatomic, assign) uint64_t durationMs;
 
+/// When the node started, in milliseconds since the machine run started
+@property (nonatomic, assign) uint64_t startOffsetMs;
+
 @end
 
 // MARK: - MachineResult
@@ -32,6 +32,10 @@ typedef NS_ENUM(NSInteger, CSPlannerErrorCode) {
 /// Protocol for cap registry access
 @protocol CSCapRegistryProtocol <NSObject>
 - (void)getCachedCaps:(void (^)(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error))completion;
+@optional
+/// Changes whenever the cached caps change. Lets CSMachinePlanBuilder answer
+/// from its memo without fetching the caps at all.
+- (NSUInteger)capsGeneration;
 @end
 
 /// Protocol for media URN registry access
@@ -57,7 +61,7 @@ typedef NS_ENUM(NSInteger, CSStrandStepType) {
 // MARK: - Supporting Structures
 
 /// Information about a reachable target with metadata
-@interface CSReachableTargetInfo : NSObject
+@interface CSReachableTargetInfo : NSObject <NSCopying>
 @property (nonatomic, copy) NSString *mediaUrn;
 @property (nonatomic, copy) NSString *displayName;
 @property (nonatomic, assign) NSUInteger minDepth;
@@ -128,6 +132,11 @@ typedef NS_ENUM(NSInteger, CSStrandStepType) {
 // MARK: - MachinePlanBuilder
 
 /// Builder for creating cap execution plans
+///
+/// Paths, plans and reachable targets are memoized per (source, target) for
+/// the current caps. The memo is dropped when withAvailableCaps: is called,
+/// when the registry's capsGeneration changes, or, for registries without
+/// one, when getCachedCaps returns caps that differ from the last ones.
 @interface CSMachinePlanBuilder : NSObject
 
 /// Create a new plan builder with the given registries
@@ -137,12 +146,16 @@ typedef NS_ENUM(NSInteger, CSStrandStepType) {
 /// Set the filter for available cap URNs
 - (instancetype)withAvailableCaps:(NSSet<NSString *> *)availableCaps;
 
+/// Drop all memoized results, e.g. after the registry's caps were changed in place
+- (void)invalidateCaches;
+
 /// Find a path through the cap graph from source to target media type
 - (void)findPathFromSource:(NSString *)sourceMedia
                   toTarget:(NSString *)targetMedia
                 completion:(void (^)(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable error))completion;
 
-/// Build an execution plan for transforming from source to target media type
+/// Build an execution plan for transforming from source to target media type.
+/// Each call returns its own copy of the memoized plan.
 - (void)buildPlanFromSource:(NSString *)sourceMedia
                    toTarget:(NSString *)targetMedia
                  inputFiles:(NSArray<CSCapInputFile *> *)inputFiles
@@ -86,9 +86,15 @@ typedef NS_ENUM(NSInteger, CSSchemaValidationErrorType) {
 
 /**
  * JSON Schema Draft-7 validator for cap arguments and outputs
+ *
+ * Each media spec's schema is compiled on first use and kept, keyed by its
+ * media spec definition: `$ref`s are resolved (external ones via the
+ * resolver, once per ref), patterns are precompiled, and keywords are read
+ * into typed nodes. Validation then only walks the value.
  */
 @interface CSJSONSchemaValidator : NSObject
 
+/// Resolver for external `$ref`s. Setting it drops all compiled schemas.
 @property (nonatomic, strong, nullable) id<CSSchemaResolver> resolver;
 
 /**
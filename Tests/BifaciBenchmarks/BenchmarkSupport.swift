@@ -0,0 +1,86 @@
+//
+//  BenchmarkSupport.swift
+//  BifaciBenchmarks
+//
+//  Timing harness shared by the benchmark cases.
+//
+//  Benchmarks are skipped unless BIFACI_BENCHMARKS=1, so a plain
+//  `swift test` stays fast. Each result is printed as one line
+//
+//      BENCH <name> <value> <unit>
+//
+//  with a fixed name per case and the median of several rounds as the value,
+//  so runs can be diffed or scraped across releases:
+//
+//      BIFACI_BENCHMARKS=1 swift test -c release -Xswiftc -enable-testing \
+//          --filter BifaciBenchmarks | grep '^BENCH'
+
+import XCTest
+import Foundation
+
+enum Bench {
+
+    static var enabled: Bool {
+        ProcessInfo.processInfo.environment["BIFACI_BENCHMARKS"] == "1"
+    }
+
+    static func requireEnabled() throws {
+        guard enabled else {
+            throw XCTSkip("Set BIFACI_BENCHMARKS=1 to run benchmarks")
+        }
+    }
+
+    /// Keeps results observable so the optimizer can't drop the measured work
+    nonisolated(unsafe) static var sink: Int = 0
+
+    /// Median nanoseconds per operation over `rounds` rounds of `iterations` calls.
+    /// One untimed warm-up round runs first.
+    @discardableResult
+    static func nsPerOp(_ name: String, iterations: Int, rounds: Int = 5, _ body: (Int) throws -> Void) rethrows -> Double {
+        for i in 0..<min(iterations, 1_000) { try body(i) }
+        var samples: [Double] = []
+        for _ in 0..<rounds {
+            let start = DispatchTime.now().uptimeNanoseconds
+            for i in 0..<iterations { try body(i) }
+            let elapsed = DispatchTime.now().uptimeNanoseconds - start
+            samples.append(Double(elapsed) / Double(iterations))
+        }
+        let median = Self.median(samples)
+        report(name, value: median, unit: "ns/op")
+        return median
+    }
+
+    /// Median MB/s over `rounds` runs of `body`, which returns the bytes it moved.
+    @discardableResult
+    static func megabytesPerSecond(_ name: String, rounds: Int = 3, _ body: () throws -> Int) rethrows -> Double {
+        var samples: [Double] = []
+        for _ in 0..<rounds {
+            let start = DispatchTime.now().uptimeNanoseconds
+            let bytes = try body()
+            let elapsed = DispatchTime.now().uptimeNanoseconds - start
+            samples.append(Double(bytes) / 1_048_576 / (Double(max(elapsed, 1)) / 1e9))
+        }
+        let median = Self.median(samples)
+        report(name, value: median, unit: "MB/s")
+        return median
+    }
+
+    static func report(_ name: String, value: Double, unit: String) {
+        print("BENCH \(name) \(String(format: "%.1f", value)) \(unit)")
+    }
+
+    private static func median(_ samples: [Double]) -> Double {
+        let sorted = samples.sorted()
+        return sorted[sorted.count / 2]
+    }
+
+    /// Connected UNIX socket pair: bytes written to `.write` are read from `.read`
+    static func socketPair() -> (read: FileHandle, write: FileHandle) {
+        var fds: [Int32] = [0, 0]
+        socketpair(AF_UNIX, SOCK_STREAM, 0, &fds)
+        return (
+            read: FileHandle(fileDescriptor: fds[0], closeOnDealloc: true),
+            write: FileHandle(fileDescriptor: fds[1], closeOnDealloc: true)
+        )
+    }
+}
@@ -0,0 +1,49 @@
+//
+//  CodecBenchmarks.swift
+//  BifaciBenchmarks
+//
+//  encodeFrame / decodeFrame cost per frame across CHUNK payload sizes.
+
+import XCTest
+@testable import Bifaci
+
+final class CodecBenchmarks: XCTestCase {
+
+    private static let payloadSizes = [0, 1_024, 16_384, 262_144, 1_048_576]
+
+    private func chunk(size: Int) -> Frame {
+        let payload = Data((0..<size).map { UInt8(truncatingIfNeeded: $0) })
+        return Frame.chunk(reqId: MessageId.newUUID(), streamId: "bench", seq: 7, payload: payload, chunkIndex: 3, checksum: Frame.computeChecksum(payload))
+    }
+
+    // encodeFrame: header encode plus one payload copy
+    func testEncodeFrame() throws {
+        try Bench.requireEnabled()
+        for size in Self.payloadSizes {
+            let frame = chunk(size: size)
+            let iterations = size >= 262_144 ? 2_000 : 100_000
+            try Bench.nsPerOp("codec.encode.chunk_\(size)B", iterations: iterations) { _ in
+                Bench.sink &+= try encodeFrame(frame).count
+            }
+        }
+        let req = Frame.req(id: MessageId.newUUID(), capUrn: "cap:in=\"media:pdf\";op=extract;out=\"media:text\"", payload: Data(), contentType: "application/cbor")
+        try Bench.nsPerOp("codec.encode.req", iterations: 100_000) { _ in
+            Bench.sink &+= try encodeFrame(req).count
+        }
+    }
+
+    // decodeFrame: payload is sliced, not copied, so cost should be flat in size
+    func testDecodeFrame() throws {
+        try Bench.requireEnabled()
+        for size in Self.payloadSizes {
+            let bytes = try encodeFrame(chunk(size: size))
+            try Bench.nsPerOp("codec.decode.chunk_\(size)B", iterations: 100_000) { _ in
+                Bench.sink &+= try decodeFrame(bytes).payload?.count ?? 0
+            }
+        }
+        let req = try encodeFrame(Frame.req(id: MessageId.newUUID(), capUrn: "cap:in=\"media:pdf\";op=extract;out=\"media:text\"", payload: Data(), contentType: "application/cbor"))
+        try Bench.nsPerOp("codec.decode.req", iterations: 100_000) { _ in
+            Bench.sink &+= try decodeFrame(req).cap?.count ?? 0
+        }
+    }
+}
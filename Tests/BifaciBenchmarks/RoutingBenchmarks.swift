@@ -0,0 +1,74 @@
+//
+//  RoutingBenchmarks.swift
+//  BifaciBenchmarks
+//
+//  Cap resolution (the index behind RelaySwitch.findMasterForCap) at
+//  10/100/1000 registered caps, and ReorderBuffer.accept in and out of order.
+
+import XCTest
+@testable import Bifaci
+
+final class RoutingBenchmarks: XCTestCase {
+
+    private func capUrn(_ i: Int) -> String {
+        "cap:in=\"media:format\(i % 7)\";op=op\(i);out=\"media:result\(i % 5)\""
+    }
+
+    private func index(caps: Int, cacheCapacity: Int) -> CapDispatchIndex<Int> {
+        var index = CapDispatchIndex<Int>(cacheCapacity: cacheCapacity)
+        // A generic fallback plus `caps` distinct ops, as a switch with many masters sees
+        index.rebuild([(capUrn: "cap:in=media:;out=media:", target: 0)] + (0..<caps).map { (capUrn: capUrn($0), target: $0 + 1) })
+        return index
+    }
+
+    // Warm: repeated request URNs answered from the resolution cache.
+    // Cold: a one-entry cache and rotating requests, so every lookup matches against the table.
+    func testCapResolution() throws {
+        try Bench.requireEnabled()
+        for caps in [10, 100, 1_000] {
+            let requests = (0..<caps).map { capUrn($0) }
+
+            var warm = index(caps: caps, cacheCapacity: CAP_DISPATCH_CACHE_CAPACITY)
+            Bench.nsPerOp("routing.closest_match.warm_\(caps)caps", iterations: 200_000) { i in
+                Bench.sink &+= warm.closestMatch(for: requests[i % requests.count]) ?? 0
+            }
+
+            var cold = index(caps: caps, cacheCapacity: 1)
+            Bench.nsPerOp("routing.closest_match.cold_\(caps)caps", iterations: caps >= 1_000 ? 5_000 : 20_000) { i in
+                Bench.sink &+= cold.closestMatch(for: requests[i % requests.count]) ?? 0
+            }
+        }
+    }
+
+    // In order: every frame delivered at once. Out of order: frames arrive in
+    // swapped pairs (1, 0, 3, 2, ...) so half of them wait in the buffer.
+    func testReorderBufferAccept() throws {
+        try Bench.requireEnabled()
+        let framesPerFlow = 64
+        let flows = 64
+        let payload = Data(count: 16)
+        let checksum = Frame.computeChecksum(payload)
+
+        func frames(outOfOrder: Bool) -> [Frame] {
+            var all: [Frame] = []
+            for _ in 0..<flows {
+                let rid = MessageId.newUUID()
+                for n in 0..<framesPerFlow {
+                    let seq = outOfOrder ? UInt64(n ^ 1) : UInt64(n)
+                    all.append(Frame.chunk(reqId: rid, streamId: "s", seq: seq, payload: payload, chunkIndex: seq, checksum: checksum))
+                }
+            }
+            return all
+        }
+
+        for (label, outOfOrder) in [("in_order", false), ("out_of_order", true)] {
+            let batch = frames(outOfOrder: outOfOrder)
+            var reorderBuffer = ReorderBuffer(maxBufferPerFlow: DEFAULT_MAX_REORDER_BUFFER)
+            try Bench.nsPerOp("reorder.accept.\(label)", iterations: batch.count, rounds: 7) { i in
+                // Fresh buffer per batch: every round replays the same seq numbers
+                if i == 0 { reorderBuffer = ReorderBuffer(maxBufferPerFlow: DEFAULT_MAX_REORDER_BUFFER) }
+                Bench.sink &+= try reorderBuffer.accept(batch[i]).count
+            }
+        }
+    }
+}
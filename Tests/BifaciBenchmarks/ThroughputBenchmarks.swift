@@ -0,0 +1,149 @@
+//
+//  ThroughputBenchmarks.swift
+//  BifaciBenchmarks
+//
+//  End-to-end request throughput over real sockets: the engine streams one
+//  large argument through InProcessPluginHost, and through PluginHost to an
+//  attached plugin, and waits for the response. MB/s counts argument bytes.
+
+import XCTest
+@testable import Bifaci
+@testable import CapDAG
+
+@available(macOS 10.15.4, iOS 13.4, *)
+final class ThroughputBenchmarks: XCTestCase {
+
+    private static let sinkCap = "cap:in=\"media:bytes\";op=sink;out=\"media:text\""
+    private static let chunkSize = 65_536
+    private static let bytesPerRequest = 64 * 1_048_576
+
+    /// Counts incoming chunk bytes until END, then answers with the count
+    private final class SinkHandler: FrameHandler {
+        func handleRequest(capUrn: String, inputStream: AsyncStream<Frame>, output: ResponseWriter) {
+            Task {
+                var received = 0
+                for await frame in inputStream {
+                    if frame.frameType == .chunk { received += frame.payload?.count ?? 0 }
+                    if frame.frameType == .end { break }
+                }
+                output.emitResponse(mediaUrn: "media:text", data: "\(received)".data(using: .utf8)!)
+            }
+        }
+    }
+
+    /// Stream one request of `bytesPerRequest` and read frames until its END or ERR
+    private func streamRequest(writer: FrameWriter, reader: FrameReader, xid: MessageId) throws -> Int {
+        let rid = MessageId.newUUID()
+        let payload = Data(repeating: 0xAB, count: Self.chunkSize)
+        let checksum = Frame.computeChecksum(payload)
+        let chunks = Self.bytesPerRequest / Self.chunkSize
+
+        func send(_ frame: Frame) throws {
+            var f = frame
+            f.routingId = xid
+            try writer.write(f)
+        }
+
+        try send(Frame.req(id: rid, capUrn: Self.sinkCap, payload: Data(), contentType: "application/cbor"))
+        try send(Frame.streamStart(reqId: rid, streamId: "arg0", mediaUrn: "media:bytes"))
+        for i in 0..<chunks {
+            try send(Frame.chunk(reqId: rid, streamId: "arg0", seq: UInt64(i), payload: payload, chunkIndex: UInt64(i), checksum: checksum))
+        }
+        try send(Frame.streamEnd(reqId: rid, streamId: "arg0", chunkCount: UInt64(chunks)))
+        try send(Frame.end(id: rid))
+
+        while let frame = try reader.read() {
+            guard frame.id == rid else { continue }
+            if frame.frameType == .err {
+                throw PluginHostError.protocolError("Benchmark request failed: \(frame.errorMessage ?? "")")
+            }
+            if frame.frameType == .end { return Self.bytesPerRequest }
+        }
+        throw PluginHostError.receiveFailed("Connection closed before END")
+    }
+
+    func testInProcessHostThroughput() throws {
+        try Bench.requireEnabled()
+        let cap = CSCap(urn: try CSCapUrn.fromString(Self.sinkCap), title: "sink", command: "")
+        let host = InProcessPluginHost(handlers: [("sink", [cap], SinkHandler())])
+
+        let (hostRead, engineWrite) = Bench.socketPair()
+        let (engineRead, hostWrite) = Bench.socketPair()
+        let hostThread = Thread {
+            try? host.run(localRead: hostRead, localWrite: hostWrite)
+        }
+        hostThread.start()
+
+        let reader = FrameReader(handle: engineRead)
+        let writer = FrameWriter(handle: engineWrite)
+        XCTAssertEqual(try reader.read()?.frameType, .relayNotify)
+
+        try Bench.megabytesPerSecond("throughput.in_process_host") {
+            try streamRequest(writer: writer, reader: reader, xid: MessageId.uint(1))
+        }
+
+        engineWrite.closeFile()
+        engineRead.closeFile()
+    }
+
+    func testPluginHostThroughput() throws {
+        try Bench.requireEnabled()
+        let (pluginSide, hostToPluginSide) = Bench.socketPair()
+        let pluginReader = FrameReader(handle: pluginSide)
+        let pluginWriter = FrameWriter(handle: pluginSide)
+
+        let manifest = """
+        {"name":"Sink","version":"1.0","caps":[\
+        {"urn":"cap:in=media:;out=media:","title":"Identity","command":"identity"},\
+        {"urn":"\(Self.sinkCap.replacingOccurrences(of: "\"", with: "\\\""))","title":"Sink","command":"sink"}]}
+        """.data(using: .utf8)!
+
+        // Plugin: echo the identity probe, count every other request's bytes,
+        // answer heartbeats so the host keeps the plugin alive
+        let pluginThread = Thread {
+            guard (try? acceptHandshakeWithManifest(reader: pluginReader, writer: pluginWriter, manifest: manifest)) != nil else { return }
+            var caps: [MessageId: String] = [:]
+            var echoed: [MessageId: Data] = [:]
+            while let frame = try? pluginReader.read() {
+                switch frame.frameType {
+                case .heartbeat:
+                    try? pluginWriter.write(Frame.heartbeat(id: frame.id))
+                case .req:
+                    caps[frame.id] = frame.cap
+                case .chunk where caps[frame.id] == CSCapIdentity:
+                    echoed[frame.id, default: Data()].append(frame.payload ?? Data())
+                case .end:
+                    let data = caps.removeValue(forKey: frame.id) == CSCapIdentity ? echoed.removeValue(forKey: frame.id) ?? Data() : Data("ok".utf8)
+                    try? pluginWriter.write(Frame.streamStart(reqId: frame.id, streamId: "result", mediaUrn: "media:"))
+                    try? pluginWriter.write(Frame.chunk(reqId: frame.id, streamId: "result", seq: 0, payload: data, chunkIndex: 0, checksum: Frame.computeChecksum(data)))
+                    try? pluginWriter.write(Frame.streamEnd(reqId: frame.id, streamId: "result", chunkCount: 1))
+                    try? pluginWriter.write(Frame.end(id: frame.id))
+                default:
+                    break
+                }
+            }
+        }
+        pluginThread.start()
+
+        let host = PluginHost()
+        try host.attachPlugin(stdinHandle: hostToPluginSide, stdoutHandle: hostToPluginSide)
+
+        let (hostRead, engineWrite) = Bench.socketPair()
+        let (engineRead, hostWrite) = Bench.socketPair()
+        let hostThread = Thread {
+            try? host.run(relayRead: hostRead, relayWrite: hostWrite) { Data() }
+        }
+        hostThread.start()
+
+        let reader = FrameReader(handle: engineRead)
+        let writer = FrameWriter(handle: engineWrite)
+
+        try Bench.megabytesPerSecond("throughput.plugin_host") {
+            try streamRequest(writer: writer, reader: reader, xid: MessageId.newUUID())
+        }
+
+        engineWrite.closeFile()
+        host.close()
+        engineRead.closeFile()
+    }
+}
@@ -0,0 +1,282 @@
+import XCTest
+@testable import Bifaci
+@preconcurrency import SwiftCBOR
+import Ops
+
+// =============================================================================
+// Async Streaming Tests
+//
+// AsyncInputPackage/AsyncInputStream fed by AsyncInputDemux, async
+// OutputStream writes, dispatchOpAsync, task-suspending flow credits, and
+// AsyncHandlerGate admission.
+// =============================================================================
+
+/// Records every frame an OutputStream sends
+private final class RecordingSender: FrameSender, @unchecked Sendable {
+    private let lock = NSLock()
+    private var _frames: [Frame] = []
+
+    func send(_ frame: Frame) throws {
+        lock.lock()
+        _frames.append(frame)
+        lock.unlock()
+    }
+
+    var frames: [Frame] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _frames
+    }
+}
+
+/// Async Op: echoes every input chunk through writeAsync
+private struct AsyncEchoOp: Op, Sendable {
+    typealias Output = Void
+    func perform(dry: DryContext, wet: WetContext) async throws {
+        let req = try wet.getRequired(CborRequest.self, for: WET_KEY_REQUEST)
+        let input = try req.takeAsyncInput()
+        for await streamResult in input {
+            let stream = try streamResult.get()
+            for await chunkResult in stream {
+                guard case .byteString(let bytes) = try chunkResult.get() else { continue }
+                try await req.output().writeAsync(Data(bytes))
+            }
+        }
+    }
+    func metadata() -> OpMetadata { OpMetadata.builder("AsyncEchoOp").build() }
+}
+
+/// Async Op: calls a peer with "ping" and writes the peer's answer as its output
+private struct AsyncPeerOp: Op, Sendable {
+    typealias Output = Void
+    func perform(dry: DryContext, wet: WetContext) async throws {
+        let req = try wet.getRequired(CborRequest.self, for: WET_KEY_REQUEST)
+        let response = try await req.peer().callWithBytesAsync(capUrn: "cap:op=pong", args: [(mediaUrn: "media:", data: Data("ping".utf8))])
+        try await req.output().writeAsync(try await response.collectBytes())
+    }
+    func metadata() -> OpMetadata { OpMetadata.builder("AsyncPeerOp").build() }
+}
+
+/// Peer that answers no call until `expected` calls are waiting at once
+private final class BarrierPeer: PeerInvoker, @unchecked Sendable {
+    let sender = RecordingSender()
+    private let expected: Int
+    private let lock = NSLock()
+    private var waiting: [(MessageId, AsyncStream<Frame>.Continuation)] = []
+
+    init(expected: Int) {
+        self.expected = expected
+    }
+
+    func call(capUrn: String) throws -> PeerCall {
+        throw PluginRuntimeError.peerRequestError("Async Ops must not make blocking peer calls")
+    }
+
+    func callAsync(capUrn: String) async throws -> AsyncPeerCall {
+        let rid = MessageId.newUUID()
+        let (stream, continuation) = AsyncStream<Frame>.makeStream()
+        lock.lock()
+        waiting.append((rid, continuation))
+        let release = waiting.count == expected ? waiting : []
+        lock.unlock()
+
+        let payload = Data(CBOR.byteString(Array("pong".utf8)).encode())
+        for (id, pending) in release {
+            pending.yield(Frame.streamStart(reqId: id, streamId: "result", mediaUrn: "media:"))
+            pending.yield(Frame.log(id: id, level: "info", message: "working"))
+            pending.yield(Frame.chunk(reqId: id, streamId: "result", seq: 0, payload: payload, chunkIndex: 0, checksum: Frame.computeChecksum(payload)))
+            pending.yield(Frame.streamEnd(reqId: id, streamId: "result", chunkCount: 1))
+            pending.yield(Frame.end(id: id))
+            pending.finish()
+        }
+        return AsyncPeerCall(sender: sender, requestId: rid, maxChunk: 1024, responses: stream)
+    }
+}
+
+/// True once set; readable from the test while a task runs
+private final class Flag: @unchecked Sendable {
+    private let lock = NSLock()
+    private var _value = false
+    var value: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return _value
+    }
+    func set() {
+        lock.lock()
+        _value = true
+        lock.unlock()
+    }
+}
+
+final class AsyncStreamingTests: XCTestCase {
+
+    private func chunk(_ rid: MessageId, _ streamId: String, _ bytes: [UInt8], index: UInt64) -> Frame {
+        let payload = Data(CBOR.byteString(bytes).encode())
+        return Frame.chunk(reqId: rid, streamId: streamId, seq: 0, payload: payload, chunkIndex: index, checksum: Frame.computeChecksum(payload))
+    }
+
+    // TEST1290: Demux yields each stream at STREAM_START with its chunks, and the package ends at END
+    func test1290_demuxStreamsInArrivalOrder() async throws {
+        let rid = MessageId.newUUID()
+        let demux = AsyncInputDemux()
+        demux.push(Frame.streamStart(reqId: rid, streamId: "a", mediaUrn: "media:a"))
+        demux.push(Frame.streamStart(reqId: rid, streamId: "b", mediaUrn: "media:b"))
+        demux.push(chunk(rid, "b", [4, 5], index: 0))
+        demux.push(chunk(rid, "a", [1, 2], index: 0))
+        demux.push(chunk(rid, "a", [3], index: 1))
+        demux.push(Frame.streamEnd(reqId: rid, streamId: "a", chunkCount: 2))
+        demux.push(Frame.streamEnd(reqId: rid, streamId: "b", chunkCount: 1))
+        demux.push(Frame.end(id: rid))
+
+        let streams = try await demux.package.collectStreams()
+        XCTAssertEqual(streams.map { $0.mediaUrn }, ["media:a", "media:b"])
+        XCTAssertEqual([UInt8](streams[0].bytes), [1, 2, 3])
+        XCTAssertEqual([UInt8](streams[1].bytes), [4, 5])
+    }
+
+    // TEST1291: Checksum mismatches and ERR frames surface as failures in the stream
+    func test1291_streamFailures() async throws {
+        let rid = MessageId.newUUID()
+        let demux = AsyncInputDemux()
+        demux.push(Frame.streamStart(reqId: rid, streamId: "s", mediaUrn: "media:"))
+        var corrupt = chunk(rid, "s", [9], index: 0)
+        corrupt.checksum = (corrupt.checksum ?? 0) &+ 1
+        demux.push(corrupt)
+        demux.push(Frame.err(id: rid, code: "BOOM", message: "host failed"))
+
+        guard case .success(let stream)? = await demux.package.nextStream() else {
+            return XCTFail("Expected a stream")
+        }
+        var results: [Result<CBOR, StreamError>] = []
+        for await item in stream { results.append(item) }
+        XCTAssertEqual(results.count, 2)
+        guard case .failure(.protocolError) = results[0] else { return XCTFail("Expected checksum failure, got \(results[0])") }
+        guard case .failure(.remoteError(let code, _)) = results[1] else { return XCTFail("Expected remote error, got \(results[1])") }
+        XCTAssertEqual(code, "BOOM")
+        let next = await demux.package.nextStream()
+        XCTAssertNil(next, "ERR ends the package")
+    }
+
+    // TEST1292: dispatchOpAsync runs an async Op end to end; output is framed like the sync path
+    func test1292_dispatchOpAsyncEcho() async throws {
+        let rid = MessageId.newUUID()
+        let demux = AsyncInputDemux()
+        let sender = RecordingSender()
+        let output = Bifaci.OutputStream(sender: sender, streamId: "out", mediaUrn: "media:", requestId: rid, routingId: nil, maxChunk: 2)
+
+        // Feed input while the Op is already waiting for it
+        let feeder = Task {
+            demux.push(Frame.streamStart(reqId: rid, streamId: "in", mediaUrn: "media:"))
+            demux.push(chunk(rid, "in", [1, 2, 3], index: 0))
+            demux.push(Frame.streamEnd(reqId: rid, streamId: "in", chunkCount: 1))
+            demux.push(Frame.end(id: rid))
+        }
+        try await dispatchOpAsync(op: AnyOp(AsyncEchoOp()), input: demux.package, output: output, peer: NoPeerInvoker())
+        await feeder.value
+
+        let frames = sender.frames
+        XCTAssertEqual(frames.map { $0.frameType }, [.streamStart, .chunk, .chunk, .streamEnd])
+        XCTAssertEqual(frames.compactMap { $0.chunkIndex }, [0, 1])
+        XCTAssertEqual(frames.last?.chunkCount, 2)
+        let echoed = frames.filter { $0.frameType == .chunk }.flatMap { frame -> [UInt8] in
+            guard case .byteString(let bytes)? = try? CBOR.decode([UInt8](frame.payload ?? Data())) else { return [] }
+            return bytes
+        }
+        XCTAssertEqual(echoed, [1, 2, 3])
+    }
+
+    // TEST1293: acquireAsync suspends at zero credits until a grant; close releases with false
+    func test1293_acquireAsyncSuspendsUntilGrant() async throws {
+        let gate = FlowCreditGate(window: 1)
+        let key = FlowKey(rid: MessageId.newUUID(), xid: nil)
+        let first = await gate.acquireAsync(key)
+        XCTAssertTrue(first)
+
+        let acquired = Flag()
+        let waiter = Task { () -> Bool in
+            let ok = await gate.acquireAsync(key)
+            acquired.set()
+            return ok
+        }
+        try await Task.sleep(nanoseconds: 50_000_000)
+        XCTAssertFalse(acquired.value, "No credits left - must stay suspended")
+        gate.grant(key, 1)
+        let granted = await waiter.value
+        XCTAssertTrue(granted)
+
+        let closedWaiter = Task { await gate.acquireAsync(key) }
+        try await Task.sleep(nanoseconds: 20_000_000)
+        gate.close()
+        let afterClose = await closedWaiter.value
+        XCTAssertFalse(afterClose)
+    }
+
+    // TEST1294: AsyncHandlerGate queues a group at its limit while other groups still enter
+    func test1294_asyncGatePerGroupLimit() async throws {
+        let gate = AsyncHandlerGate(maxRunning: 4)
+        await gate.enter(group: "cap:op=slow", limit: 1)
+
+        let second = Task { () -> Bool in
+            await gate.enter(group: "cap:op=slow", limit: 1)
+            return true
+        }
+        while gate.stats().queued == 0 {
+            try await Task.sleep(nanoseconds: 1_000_000)
+        }
+        await gate.enter(group: "cap:op=fast")
+        XCTAssertEqual(gate.stats().running, 2)
+
+        gate.leave(group: "cap:op=slow")
+        let admitted = await second.value
+        XCTAssertTrue(admitted)
+        let stats = gate.stats()
+        XCTAssertEqual(stats.running, 2)
+        XCTAssertEqual(stats.queued, 0)
+    }
+
+    // TEST1295: A request carries one kind of input; taking the other kind fails clearly
+    func test1295_requestInputKindMismatch() throws {
+        let sender = RecordingSender()
+        let output = Bifaci.OutputStream(sender: sender, streamId: "out", mediaUrn: "media:", requestId: MessageId.newUUID(), routingId: nil, maxChunk: 16)
+        let req = CborRequest(asyncInput: AsyncInputDemux().package, output: output, peer: NoPeerInvoker())
+        XCTAssertThrowsError(try req.takeInput()) { error in
+            XCTAssertTrue("\(error)".contains("takeAsyncInput"))
+        }
+        XCTAssertNoThrow(try req.takeAsyncInput())
+        XCTAssertThrowsError(try req.takeAsyncInput())
+    }
+
+    // TEST1400: Async Ops awaiting peer responses suspend, so more of them than cooperative threads all get answered
+    func test1400_asyncOpPeerCalls() async throws {
+        let count = max(64, ProcessInfo.processInfo.activeProcessorCount * 4)
+        let peer = BarrierPeer(expected: count)
+
+        let outputs = try await withThrowingTaskGroup(of: RecordingSender.self) { group -> [RecordingSender] in
+            for _ in 0..<count {
+                group.addTask {
+                    let sender = RecordingSender()
+                    let output = Bifaci.OutputStream(sender: sender, streamId: "out", mediaUrn: "media:", requestId: MessageId.newUUID(), routingId: nil, maxChunk: 1024)
+                    try await dispatchOpAsync(op: AnyOp(AsyncPeerOp()), input: AsyncInputDemux().package, output: output, peer: peer)
+                    return sender
+                }
+            }
+            var senders: [RecordingSender] = []
+            for try await sender in group { senders.append(sender) }
+            return senders
+        }
+
+        XCTAssertEqual(outputs.count, count)
+        for sender in outputs {
+            let written = sender.frames.filter { $0.frameType == .chunk }.flatMap { frame -> [UInt8] in
+                guard case .byteString(let bytes)? = try? CBOR.decode([UInt8](frame.payload ?? Data())) else { return [] }
+                return bytes
+            }
+            XCTAssertEqual(Data(written), Data("pong".utf8), "LOG frames are skipped, data is collected")
+        }
+        // Each call streamed its arg and ended the request
+        let peerFrames = peer.sender.frames
+        XCTAssertEqual(peerFrames.filter { $0.frameType == .end }.count, count)
+        XCTAssertEqual(peerFrames.filter { $0.frameType == .chunk }.count, count)
+    }
+}
@@ -0,0 +1,84 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// BufferReader Chunk Assembly Tests
+//
+// In-memory assembly for small payloads, mapped temp-file assembly for
+// payloads larger than maxChunk, and bounds checks on chunk offsets.
+// =============================================================================
+
+final class BufferReaderTests: XCTestCase {
+
+    private func pattern(_ count: Int) -> Data {
+        Data((0..<count).map { UInt8(truncatingIfNeeded: $0 &* 31 &+ 7) })
+    }
+
+    // TEST1310: A payload larger than maxChunk reassembles from out-of-order chunks via the mapped file
+    func test1310_mappedAssemblyOutOfOrder() throws {
+        let reader = BufferReader(limits: Limits(maxFrame: DEFAULT_MAX_FRAME, maxChunk: 1024))
+        let payload = pattern(10_000)
+        try reader.startChunkedAssembly(totalLength: UInt64(payload.count))
+
+        let offsets = stride(from: 0, to: payload.count, by: 1000).reversed()
+        for offset in offsets {
+            let end = min(offset + 1000, payload.count)
+            XCTAssertFalse(reader.isChunkedAssemblyComplete)
+            try reader.addChunk(payload.subdata(in: offset..<end), offset: UInt64(offset))
+        }
+        XCTAssertTrue(reader.isChunkedAssemblyComplete)
+
+        let assembled = try reader.finalizeChunkedAssembly()
+        XCTAssertEqual(assembled, payload)
+        XCTAssertFalse(reader.isChunkedAssemblyComplete, "Finalize resets assembly state")
+    }
+
+    // TEST1311: The assembled Data stays valid after the reader is gone
+    func test1311_mappedDataOutlivesReader() throws {
+        let payload = pattern(5000)
+        let assembled: Data
+        do {
+            let reader = BufferReader(limits: Limits(maxFrame: DEFAULT_MAX_FRAME, maxChunk: 256))
+            try reader.startChunkedAssembly(totalLength: UInt64(payload.count))
+            try reader.addChunk(payload, offset: 0)
+            assembled = try reader.finalizeChunkedAssembly()
+        }
+        XCTAssertEqual(assembled.count, payload.count)
+        XCTAssertEqual(assembled, payload)
+    }
+
+    // TEST1312: A chunk past the declared length is rejected instead of writing out of bounds
+    func test1312_mappedAssemblyRejectsOverflow() throws {
+        let reader = BufferReader(limits: Limits(maxFrame: DEFAULT_MAX_FRAME, maxChunk: 64))
+        try reader.startChunkedAssembly(totalLength: 100)
+        XCTAssertThrowsError(try reader.addChunk(pattern(10), offset: 95))
+        XCTAssertThrowsError(try reader.addChunk(pattern(1), offset: 200))
+        XCTAssertNoThrow(try reader.addChunk(pattern(5), offset: 95))
+    }
+
+    // TEST1313: Payloads within maxChunk still assemble in memory
+    func test1313_smallAssemblyInMemory() throws {
+        let reader = BufferReader(limits: Limits(maxFrame: DEFAULT_MAX_FRAME, maxChunk: 1024))
+        let payload = pattern(600)
+        try reader.startChunkedAssembly(totalLength: UInt64(payload.count))
+        try reader.addChunk(payload.subdata(in: 300..<600), offset: 300)
+        try reader.addChunk(payload.subdata(in: 0..<300), offset: 0)
+        XCTAssertEqual(try reader.finalizeChunkedAssembly(), payload)
+    }
+
+    // TEST1401: File-backed assembly leaves unwritten gaps as zeros and ends at the furthest chunk
+    func test1401_fileBackedAssemblyGaps() throws {
+        let reader = BufferReader(limits: Limits(maxFrame: DEFAULT_MAX_FRAME, maxChunk: 64))
+        try reader.startChunkedAssembly(totalLength: 4096)
+        let head = pattern(100)
+        let tail = pattern(50)
+        try reader.addChunk(tail, offset: 1000)
+        try reader.addChunk(head, offset: 0)
+
+        let assembled = try reader.finalizeChunkedAssembly()
+        XCTAssertEqual(assembled.count, 1050)
+        XCTAssertEqual(assembled.prefix(100), head)
+        XCTAssertEqual(assembled.subdata(in: 100..<1000), Data(count: 900))
+        XCTAssertEqual(assembled.suffix(50), tail)
+    }
+}
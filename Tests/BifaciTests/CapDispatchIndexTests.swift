@@ -0,0 +1,144 @@
+import XCTest
+@testable import Bifaci
+import CapDAG
+
+// =============================================================================
+// CapDispatchIndex Tests
+//
+// The compiled routing index must resolve exactly like the linear
+// `request.accepts(registered)` + closest-specificity scan it replaces.
+// =============================================================================
+
+final class CapDispatchIndexTests: XCTestCase {
+
+    private let identity = "cap:in=media:;out=media:"
+    private let double = "cap:in=\"media:void\";op=double;out=\"media:void\""
+    private let triple = "cap:in=\"media:void\";op=triple;out=\"media:void\""
+    private let anyOp = "cap:in=\"media:void\";op=*;out=\"media:void\""
+
+    private func makeIndex(_ caps: [(String, Int)]) -> CapDispatchIndex<Int> {
+        var index = CapDispatchIndex<Int>()
+        index.rebuild(caps.map { (capUrn: $0.0, target: $0.1) })
+        return index
+    }
+
+    // TEST1200: Exact op request routes to the entry registered for that op
+    func test1200_exactOpRoutesToBucket() {
+        var index = makeIndex([(identity, 0), (double, 1), (triple, 2)])
+        XCTAssertEqual(index.closestMatch(for: double), 1)
+        XCTAssertEqual(index.closestMatch(for: triple), 2)
+        XCTAssertNil(index.closestMatch(for: "cap:in=\"media:void\";op=unknown;out=\"media:void\""))
+    }
+
+    // TEST1201: op=* registrations are candidates for any concrete op request
+    func test1201_wildcardOpRegistrationMatches() {
+        var index = makeIndex([(identity, 0), (anyOp, 3)])
+        XCTAssertEqual(index.closestMatch(for: double), 3)
+    }
+
+    // TEST1202: Request without op picks the closest-specificity entry (identity → identity)
+    func test1202_genericRequestPrefersGenericHandler() {
+        var index = makeIndex([(double, 1), (identity, 0)])
+        XCTAssertEqual(index.closestMatch(for: identity), 0)
+    }
+
+    // TEST1203: Specificity ties are broken by registration order
+    func test1203_tieBrokenByRegistrationOrder() {
+        var index = makeIndex([(double, 5), (double, 7)])
+        XCTAssertEqual(index.closestMatch(for: double), 5)
+    }
+
+    // TEST1204: Preferred cap wins over closest specificity among comparable matches
+    func test1204_preferredCapWins() {
+        let generic = "cap:in=media:;op=double;out=media:"
+        var index = makeIndex([(generic, 0), (double, 1)])
+        XCTAssertEqual(index.closestMatch(for: generic, preferredCap: double), 1)
+        XCTAssertEqual(index.closestMatch(for: generic), 0)
+    }
+
+    // TEST1205: Rebuild drops cached resolutions
+    func test1205_rebuildInvalidatesCache() {
+        var index = makeIndex([(double, 1)])
+        XCTAssertEqual(index.closestMatch(for: double), 1)
+        index.rebuild([(capUrn: double, target: 9)])
+        XCTAssertEqual(index.closestMatch(for: double), 9)
+        index.rebuild([(capUrn: String, target: Int)]())
+        XCTAssertNil(index.closestMatch(for: double))
+    }
+
+    // TEST1206: Unparseable registrations and requests are skipped, not fatal
+    func test1206_invalidUrnsSkipped() {
+        var index = makeIndex([("not-a-cap", 0), (double, 1)])
+        XCTAssertEqual(index.count, 1)
+        XCTAssertNil(index.closestMatch(for: "garbage"))
+        XCTAssertEqual(index.closestMatch(for: double), 1)
+    }
+
+    // TEST1207: Index agrees with a linear accepts scan across a mixed table
+    func test1207_matchesLinearScan() throws {
+        let caps = [identity, double, triple, anyOp,
+                    "cap:in=\"media:void\";op=double;out=\"media:void\";target=thumb"]
+        var index = makeIndex(caps.enumerated().map { ($0.element, $0.offset) })
+        let parsed = try caps.map { try CSCapUrn.fromString($0) }
+
+        let requests = caps + ["cap:op=double", "cap:op=*", "cap:in=\"media:void\";op=quad;out=\"media:void\""]
+        for request in requests {
+            let requestUrn = try CSCapUrn.fromString(request)
+            let reqSpec = Int(requestUrn.specificity())
+            var expected: (idx: Int, distance: Int)? = nil
+            for (i, reg) in parsed.enumerated() where requestUrn.accepts(reg) {
+                let distance = abs(Int(reg.specificity()) - reqSpec)
+                if expected == nil || distance < expected!.distance { expected = (i, distance) }
+            }
+            XCTAssertEqual(index.closestMatch(for: request), expected?.idx, "Mismatch for \(request)")
+        }
+    }
+
+    // TEST1208: firstMatch prefers an exact string registration over earlier accepting entries
+    func test1208_firstMatchExactStringFirst() {
+        var index = makeIndex([(anyOp, 0), (double, 1)])
+        XCTAssertEqual(index.firstMatch(for: double), 1, "Exact string registration wins")
+        XCTAssertEqual(index.firstMatch(for: triple), 0, "Otherwise first accepting entry in order")
+        XCTAssertNil(index.firstMatch(for: "cap:op=missing"))
+    }
+
+    // TEST1209: LRUCache evicts the least recently used key
+    func test1209_lruEvictsLeastRecentlyUsed() {
+        var cache = LRUCache<String, Int>(capacity: 2)
+        cache.set("a", 1)
+        cache.set("b", 2)
+        XCTAssertEqual(cache.get("a"), 1)  // a is now most recent
+        cache.set("c", 3)                  // evicts b
+        XCTAssertNil(cache.get("b"))
+        XCTAssertEqual(cache.get("a"), 1)
+        XCTAssertEqual(cache.get("c"), 3)
+        XCTAssertEqual(cache.count, 2)
+
+        cache.set("a", 10)
+        XCTAssertEqual(cache.get("a"), 10, "Updating an existing key replaces its value")
+        cache.removeAll()
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertNil(cache.get("a"))
+    }
+
+    // TEST1210: Cached negative resolutions stay correct under a small LRU
+    func test1210_smallCacheStaysCorrect() {
+        var index = CapDispatchIndex<Int>(cacheCapacity: 1)
+        index.rebuild([(capUrn: double, target: 1), (capUrn: triple, target: 2)])
+        for _ in 0..<3 {
+            XCTAssertEqual(index.closestMatch(for: double), 1)
+            XCTAssertEqual(index.closestMatch(for: triple), 2)
+            XCTAssertNil(index.closestMatch(for: "cap:op=none"))
+        }
+    }
+
+    // TEST1407: Matched cap is the registered URN, so distinct request strings share one metrics label
+    func test1407_matchedCapIsRegisteredUrn() {
+        var index = makeIndex([(identity, 0), (anyOp, 3)])
+        XCTAssertEqual(index.closestMatchedCap(for: double), anyOp)
+        XCTAssertEqual(index.closestMatchedCap(for: triple), anyOp)
+        XCTAssertEqual(index.firstMatchedCap(for: double), anyOp)
+        XCTAssertEqual(index.firstMatchedCap(for: identity), identity)
+        XCTAssertNil(index.closestMatchedCap(for: "cap:op=none"))
+    }
+}
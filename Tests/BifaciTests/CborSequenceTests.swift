@@ -630,4 +630,137 @@ final class CborSequenceTests: XCTestCase {
         let decoded = try CBOR.decode([UInt8](items[0]))
         XCTAssertEqual(decoded, page)
     }
+
+    // MARK: - Incremental decoding (CborSequenceDecoder)
+
+    // TEST1300: Feeding a sequence byte by byte yields the same items as splitting it whole
+    func test1300_decoderItemsAcrossArbitrarySplits() throws {
+        var seq = buildCborSequence([
+            .byteString(Array(repeating: 0xAB, count: 300)),
+            .utf8String("héllo"),
+            .map([.utf8String("k"): .array([.unsignedInt(1), .negativeInt(4), .null])]),
+            .unsignedInt(1 << 40),
+        ])
+        // Indefinite-length array, indefinite-length byte string, tagged uint
+        seq.append(contentsOf: [0x9F, 0x01, 0x02, 0xFF])
+        seq.append(contentsOf: [0x5F, 0x41, 0xAA, 0x41, 0xBB, 0xFF])
+        seq.append(contentsOf: [0xC1, 0x1A, 0x00, 0x01, 0x00, 0x00])
+
+        let whole = try splitCborSequence(seq)
+        XCTAssertEqual(whole.count, 7)
+        XCTAssertEqual(whole[4], Data([0x9F, 0x01, 0x02, 0xFF]))
+
+        var decoder = CborSequenceDecoder()
+        var incremental: [Data] = []
+        for byte in seq {
+            decoder.feed(Data([byte]))
+            while let item = try decoder.nextItem() {
+                incremental.append(item)
+            }
+        }
+        XCTAssertNoThrow(try decoder.finish())
+        XCTAssertEqual(incremental, whole)
+    }
+
+    // TEST1301: Only the unfinished trailing item stays buffered
+    func test1301_decoderBuffersOnlyPartialItem() throws {
+        let item = Data(CBOR.byteString(Array(repeating: 7, count: 100)).encode())
+        var decoder = CborSequenceDecoder()
+        var count = 0
+        for _ in 0..<10_000 {
+            // Each feed completes the previous item's tail and starts the next one
+            decoder.feed(item.prefix(60))
+            while try decoder.nextItem() != nil { count += 1 }
+            decoder.feed(item.suffix(from: 60))
+            while try decoder.nextItem() != nil { count += 1 }
+            XCTAssertEqual(decoder.bufferedByteCount, 0)
+        }
+        XCTAssertEqual(count, 10_000)
+
+        decoder.feed(item.prefix(10))
+        XCTAssertNil(try decoder.nextItem())
+        XCTAssertEqual(decoder.bufferedByteCount, 10)
+        XCTAssertThrowsError(try decoder.finish())
+    }
+
+    // TEST1302: Malformed headers fail immediately instead of waiting for more bytes
+    func test1302_decoderRejectsMalformed() {
+        var decoder = CborSequenceDecoder()
+        decoder.feed(Data([0x1C])) // reserved additional info 28
+        XCTAssertThrowsError(try decoder.nextItem())
+
+        var breakDecoder = CborSequenceDecoder()
+        breakDecoder.feed(Data([0xFF])) // break outside a container
+        XCTAssertThrowsError(try breakDecoder.nextItem())
+
+        XCTAssertThrowsError(try splitCborSequence(Data([0x5F, 0x61, 0x41, 0xFF]))) { error in
+            // Text chunk inside an indefinite byte string
+            guard case CborSequenceError.deserializationError = error else {
+                return XCTFail("Expected .deserializationError, got \(error)")
+            }
+        }
+    }
+
+    // TEST1303: demuxMultiStream reassembles list items that emitListItem split across chunks
+    func test1303_demuxReassemblesSplitListItems() throws {
+        let rid = MessageId.newUUID()
+        let sender = CapturingSender()
+        let output = Bifaci.OutputStream(sender: sender, streamId: "s", mediaUrn: "media:test;list", requestId: rid, routingId: nil, maxChunk: 7)
+        let items: [CBOR] = (0..<20).map { .utf8String(String(repeating: "x", count: $0 * 3)) }
+        for item in items {
+            try output.emitListItem(item)
+        }
+        try output.close()
+        var frames = sender.frames
+        frames.append(Frame.end(id: rid))
+
+        var index = 0
+        let package = demuxMultiStream(frameIterator: AnyIterator {
+            guard index < frames.count else { return nil }
+            defer { index += 1 }
+            return frames[index]
+        })
+        guard case .success(let stream)? = package.nextStream() else { return XCTFail("Expected a stream") }
+        let decoded = try stream.map { try $0.get() }
+        XCTAssertEqual(decoded, items)
+    }
+
+    // TEST1304: demuxMultiStream hands out a stream's items before the rest of the input is read
+    func test1304_demuxIsLazy() throws {
+        let rid = MessageId.newUUID()
+        var frames: [Frame] = [Frame.streamStart(reqId: rid, streamId: "s", mediaUrn: "media:test;list")]
+        for i in 0..<1000 {
+            let payload = Data(CBOR.unsignedInt(UInt64(i)).encode())
+            frames.append(Frame.chunk(reqId: rid, streamId: "s", seq: 0, payload: payload, chunkIndex: UInt64(i), checksum: Frame.computeChecksum(payload)))
+        }
+        frames.append(Frame.streamEnd(reqId: rid, streamId: "s", chunkCount: 1000))
+        frames.append(Frame.end(id: rid))
+
+        var pulled = 0
+        let package = demuxMultiStream(frameIterator: AnyIterator {
+            guard pulled < frames.count else { return nil }
+            defer { pulled += 1 }
+            return frames[pulled]
+        })
+        guard case .success(let stream)? = package.nextStream() else { return XCTFail("Expected a stream") }
+        var iterator = stream.makeIterator()
+        for expected in 0..<10 {
+            XCTAssertEqual(try iterator.next()?.get(), .unsignedInt(UInt64(expected)))
+        }
+        XCTAssertEqual(pulled, 11, "Only STREAM_START and the first ten chunks may be read")
+        var rest = 0
+        while let item = iterator.next() {
+            _ = try item.get()
+            rest += 1
+        }
+        XCTAssertEqual(rest, 990)
+    }
+}
+
+/// Records frames sent through an OutputStream
+private final class CapturingSender: FrameSender, @unchecked Sendable {
+    private(set) var frames: [Frame] = []
+    func send(_ frame: Frame) throws {
+        frames.append(frame)
+    }
 }
@@ -0,0 +1,197 @@
+import XCTest
+@preconcurrency import SwiftCBOR
+@testable import Bifaci
+
+// =============================================================================
+// Checksum Algorithm Tests
+//
+// FNV-1a stays the wire default; xxHash64 is used only when both HELLOs
+// offer it, and CHUNK frames name a non-default algorithm explicitly.
+// =============================================================================
+
+final class ChecksumTests: XCTestCase {
+
+    // TEST1240: FNV-1a fast path matches the reference byte loop
+    func test1240_fnv1aMatchesReference() {
+        XCTAssertEqual(Frame.computeChecksum(Data()), 0xcbf29ce484222325)
+        XCTAssertEqual(Frame.computeChecksum(Data("a".utf8)), 0xaf63dc4c8601ec8c)
+
+        let data = Data((0..<1000).map { UInt8(($0 * 7) & 0xFF) })
+        var reference: UInt64 = 0xcbf29ce484222325
+        for byte in data {
+            reference ^= UInt64(byte)
+            reference = reference &* 0x100000001b3
+        }
+        XCTAssertEqual(Frame.computeChecksum(data), reference)
+        XCTAssertEqual(Frame.computeChecksum(data.dropFirst(3)), Frame.computeChecksum(Data(data.dropFirst(3))),
+                       "Slices hash their own bytes")
+    }
+
+    // TEST1241: xxHash64 matches reference XXH64 (seed 0) vectors across all tail paths
+    func test1241_xxh64ReferenceVectors() {
+        XCTAssertEqual(ChecksumAlgorithm.xxh64.compute(Data()), 0xEF46DB3751D8E999)
+        XCTAssertEqual(ChecksumAlgorithm.xxh64.compute(Data("a".utf8)), 0xD24EC4F1A98C6E5B)
+        XCTAssertEqual(ChecksumAlgorithm.xxh64.compute(Data("abc".utf8)), 0x44BC2CF5AD770999)
+        XCTAssertEqual(ChecksumAlgorithm.xxh64.compute(Data("Nobody inspects the spammish repetition".utf8)), 0xFBCEA83C8A378BF1)
+        XCTAssertEqual(ChecksumAlgorithm.xxh64.compute(Data((0..<100).map { UInt8($0) })), 0x6AC1E58032166597)
+    }
+
+    // TEST1242: Negotiation picks our preference only when the peer offers it
+    func test1242_negotiation() {
+        XCTAssertEqual(ChecksumAlgorithm.negotiate(preferred: .xxh64, offered: [.xxh64, .fnv1a]), .xxh64)
+        XCTAssertEqual(ChecksumAlgorithm.negotiate(preferred: .xxh64, offered: [.fnv1a]), .fnv1a)
+        XCTAssertEqual(ChecksumAlgorithm.negotiate(preferred: .fnv1a, offered: [.xxh64, .fnv1a]), .fnv1a)
+    }
+
+    // TEST1243: Default HELLO carries no checksum_algorithms; a preferring HELLO offers its choice plus FNV-1a
+    func test1243_helloAdvertisement() throws {
+        let plain = try decodeFrame(encodeFrame(Frame.hello(limits: Limits())))
+        XCTAssertNil(plain.meta?["checksum_algorithms"])
+        XCTAssertEqual(plain.helloChecksumAlgorithms, [.fnv1a])
+
+        let offering = try decodeFrame(encodeFrame(Frame.helloWithManifest(limits: Limits(checksum: .xxh64), manifest: Data("{}".utf8))))
+        XCTAssertEqual(offering.helloChecksumAlgorithms, [.xxh64, .fnv1a])
+    }
+
+    // TEST1244: checksumAlgorithm survives encode/decode; FNV-1a frames omit the key
+    func test1244_frameKeyRoundtrip() throws {
+        let payload = Data("payload".utf8)
+        var frame = Frame.chunk(reqId: .uint(1), streamId: "s", seq: 0, payload: payload, chunkIndex: 0, checksum: 0)
+        frame.setChecksum(algorithm: .xxh64)
+
+        let decoded = try decodeFrame(encodeFrame(frame))
+        XCTAssertEqual(decoded.checksumAlgorithm, .xxh64)
+        XCTAssertTrue(decoded.hasValidChecksum())
+
+        frame.setChecksum(algorithm: .fnv1a)
+        let encoded = try encodeFrame(frame)
+        guard case .map(let map)? = try CBOR.decode([UInt8](encoded)) else { return XCTFail("Expected map") }
+        XCTAssertNil(map[.unsignedInt(FrameKey.checksumAlgorithm.rawValue)])
+        XCTAssertEqual(try decodeFrame(encoded).checksumAlgorithm, .fnv1a)
+    }
+
+    // TEST1245: Unknown checksum algorithm is a protocol error, not a silent mismatch
+    func test1245_unknownAlgorithmRejected() throws {
+        let map: [CBOR: CBOR] = [
+            .unsignedInt(FrameKey.version.rawValue): .unsignedInt(2),
+            .unsignedInt(FrameKey.frameType.rawValue): .unsignedInt(UInt64(FrameType.chunk.rawValue)),
+            .unsignedInt(FrameKey.id.rawValue): .unsignedInt(1),
+            .unsignedInt(FrameKey.chunkIndex.rawValue): .unsignedInt(0),
+            .unsignedInt(FrameKey.checksum.rawValue): .unsignedInt(0),
+            .unsignedInt(FrameKey.checksumAlgorithm.rawValue): .unsignedInt(200),
+        ]
+        XCTAssertThrowsError(try decodeFrame(Data(CBOR.map(map).encode()))) { error in
+            guard case FrameError.protocolError = error else { return XCTFail("Expected protocolError, got \(error)") }
+        }
+    }
+
+    // TEST1246: FrameWriter re-stamps a forwarded xxh64 CHUNK for a peer that only negotiated FNV-1a
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1246_writerRestampsUnsupportedAlgorithm() throws {
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let payload = Data(repeating: 7, count: 64)
+        var frame = Frame.chunk(reqId: .uint(1), streamId: "s", seq: 0, payload: payload, chunkIndex: 0, checksum: 0)
+        frame.setChecksum(algorithm: .xxh64)
+        try writer.write(frame)
+        pipe.fileHandleForWriting.closeFile()
+
+        let received = try FrameReader(handle: pipe.fileHandleForReading).read()
+        XCTAssertEqual(received?.checksumAlgorithm, .fnv1a)
+        XCTAssertEqual(received?.checksum, Frame.computeChecksum(payload))
+    }
+
+    // TEST1247: Handshake settles on xxh64 only when both sides prefer it
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1247_handshakeNegotiatesChecksum() throws {
+        for (hostPrefers, pluginPrefers, expected) in [
+            (ChecksumAlgorithm.xxh64, ChecksumAlgorithm.xxh64, ChecksumAlgorithm.xxh64),
+            (.xxh64, .fnv1a, .fnv1a),
+            (.fnv1a, .xxh64, .fnv1a),
+        ] {
+            let hostToPlugin = Pipe()
+            let pluginToHost = Pipe()
+
+            var pluginLimits: Limits?
+            let done = DispatchSemaphore(value: 0)
+            DispatchQueue.global().async {
+                let reader = FrameReader(handle: hostToPlugin.fileHandleForReading)
+                let writer = FrameWriter(handle: pluginToHost.fileHandleForWriting, limits: Limits(checksum: pluginPrefers))
+                pluginLimits = try? acceptHandshakeWithManifest(reader: reader, writer: writer, manifest: Data("{}".utf8))
+                done.signal()
+            }
+
+            let reader = FrameReader(handle: pluginToHost.fileHandleForReading)
+            let writer = FrameWriter(handle: hostToPlugin.fileHandleForWriting, limits: Limits(checksum: hostPrefers))
+            let result = try performHandshakeWithManifest(reader: reader, writer: writer)
+            done.wait()
+
+            XCTAssertEqual(result.limits.checksum, expected, "host=\(hostPrefers) plugin=\(pluginPrefers)")
+            XCTAssertEqual(pluginLimits?.checksum, expected, "host=\(hostPrefers) plugin=\(pluginPrefers)")
+        }
+    }
+
+    // TEST1398: A spawned plugin settles on xxh64 when the host prefers it, FNV-1a otherwise
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1398_spawnedPluginNegotiatesHostPreference() throws {
+        let sh = "/bin/sh"
+        guard FileManager.default.isExecutableFile(atPath: sh) else {
+            throw XCTSkip("\(sh) not available")
+        }
+        for (hostPrefers, expected) in [(ChecksumAlgorithm.xxh64, ChecksumAlgorithm.xxh64), (.fnv1a, .fnv1a)] {
+            XCTAssertEqual(try spawnBridgedPlugin(hostChecksum: hostPrefers), expected, "host=\(hostPrefers)")
+        }
+    }
+
+    /// Spawn a shell script that relays its stdin/stdout through two FIFOs to
+    /// a plugin running on a thread here, which prefers xxh64 like PluginRuntime.
+    /// Returns the checksum the plugin side negotiated.
+    @available(macOS 10.15.4, iOS 13.4, *)
+    private func spawnBridgedPlugin(hostChecksum: ChecksumAlgorithm) throws -> ChecksumAlgorithm? {
+        let dir = (NSTemporaryDirectory() as NSString).appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(atPath: dir, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(atPath: dir) }
+        let toPlugin = (dir as NSString).appendingPathComponent("in")
+        let fromPlugin = (dir as NSString).appendingPathComponent("out")
+        XCTAssertEqual(mkfifo(toPlugin, 0o600), 0)
+        XCTAssertEqual(mkfifo(fromPlugin, 0o600), 0)
+        let script = (dir as NSString).appendingPathComponent("plugin.sh")
+        try "#!/bin/sh\ncat > '\(toPlugin)' &\nexec cat '\(fromPlugin)'\n".write(toFile: script, atomically: true, encoding: .utf8)
+        try FileManager.default.setAttributes([.posixPermissions: 0o700], ofItemAtPath: script)
+
+        let manifest = Data("""
+        {"name":"Bridge","version":"1.0","caps":[{"urn":"cap:in=media:;out=media:","title":"Identity","command":"identity"}]}
+        """.utf8)
+        var negotiated: ChecksumAlgorithm?
+        let done = DispatchSemaphore(value: 0)
+        DispatchQueue.global().async {
+            defer { done.signal() }
+            guard let input = FileHandle(forReadingAtPath: toPlugin),
+                  let output = FileHandle(forWritingAtPath: fromPlugin) else { return }
+            let reader = FrameReader(handle: input)
+            let writer = FrameWriter(handle: output, limits: Limits(checksum: .xxh64))
+            guard let limits = try? acceptHandshakeWithManifest(reader: reader, writer: writer, manifest: manifest) else { return }
+            negotiated = limits.checksum
+            // Echo the identity probe so the host keeps the plugin
+            var echoed = Data()
+            while let frame = try? reader.read() {
+                if frame.frameType == .chunk { echoed.append(frame.payload ?? Data()) }
+                if frame.frameType == .end {
+                    try? writer.write(Frame.streamStart(reqId: frame.id, streamId: "result", mediaUrn: "media:"))
+                    try? writer.write(Frame.chunk(reqId: frame.id, streamId: "result", seq: 0, payload: echoed, chunkIndex: 0, checksum: Frame.computeChecksum(echoed)))
+                    try? writer.write(Frame.streamEnd(reqId: frame.id, streamId: "result", chunkCount: 1))
+                    try? writer.write(Frame.end(id: frame.id))
+                    break
+                }
+            }
+        }
+
+        let host = PluginHost(checksum: hostChecksum)
+        host.registerPlugin(path: script, knownCaps: ["cap:in=media:;out=media:"])
+        host.setPrewarm(path: script, instances: 1)
+        XCTAssertEqual(host.prewarmPlugins(), 1)
+        host.close()
+        XCTAssertEqual(done.wait(timeout: .now() + 10), .success)
+        return negotiated
+    }
+}
@@ -0,0 +1,65 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// DispatchPolicy Tests
+//
+// Scheduling among equivalent targets, and CapDispatchIndex returning every
+// target registered with a cap equivalent to the winner.
+// =============================================================================
+
+final class DispatchPolicyTests: XCTestCase {
+
+    private func candidates(_ loads: [Int], weights: [Double]? = nil) -> [DispatchCandidate] {
+        loads.enumerated().map { idx, load in
+            DispatchCandidate(target: idx, inFlight: load, weight: weights?[idx] ?? 1.0)
+        }
+    }
+
+    // TEST1330: leastInFlight picks the idlest target and breaks ties by registration order
+    func test1330_leastInFlight() {
+        XCTAssertEqual(DispatchPolicy.leastInFlight.choose(candidates([3, 1, 2])), 1)
+        XCTAssertEqual(DispatchPolicy.leastInFlight.choose(candidates([0, 0, 0])), 0)
+        XCTAssertEqual(DispatchPolicy.leastInFlight.choose(candidates([2, 1, 1])), 1)
+        XCTAssertEqual(DispatchPolicy.first.choose(candidates([9, 0])), 0)
+    }
+
+    // TEST1331: powerOfTwoChoices never picks the single most loaded of three or more targets
+    func test1331_powerOfTwoChoicesAvoidsHottest() {
+        let loads = candidates([4, 0, 9, 2])
+        var chosen = Set<Int>()
+        for _ in 0..<500 {
+            chosen.insert(DispatchPolicy.powerOfTwoChoices.choose(loads))
+        }
+        XCTAssertFalse(chosen.contains(2), "The hottest target loses every pairing")
+        XCTAssertTrue(chosen.contains(1))
+        XCTAssertEqual(DispatchPolicy.powerOfTwoChoices.choose(candidates([5, 3])), 1)
+    }
+
+    // TEST1332: weighted scales load by capacity and drains weight-0 targets
+    func test1332_weighted() {
+        // 3 in flight on weight 4 beats 1 in flight on weight 1: 4/4 < 2/1
+        XCTAssertEqual(DispatchPolicy.weighted.choose(candidates([1, 3], weights: [1, 4])), 1)
+        XCTAssertEqual(DispatchPolicy.weighted.choose(candidates([0, 5], weights: [0, 1])), 1)
+        XCTAssertEqual(DispatchPolicy.weighted.choose(candidates([2, 1], weights: [0, 0])), 1, "All drained: plain least-in-flight")
+    }
+
+    // TEST1333: closestMatches/firstMatches return every equivalent registration, winner first
+    func test1333_indexReturnsEquivalentTargets() {
+        let double = "cap:in=\"media:void\";op=double;out=\"media:void\""
+        let reordered = "cap:op=double;out=\"media:void\";in=\"media:void\""
+        let otherInput = "cap:in=\"media:png\";op=double;out=\"media:void\""
+        var index = CapDispatchIndex<Int>()
+        index.rebuild([
+            (capUrn: "cap:in=media:;out=media:", target: 0),
+            (capUrn: double, target: 1),
+            (capUrn: otherInput, target: 2),
+            (capUrn: reordered, target: 3),
+        ])
+
+        XCTAssertEqual(index.closestMatches(for: double), [1, 3])
+        XCTAssertEqual(index.firstMatches(for: reordered), [3, 1])
+        XCTAssertEqual(index.closestMatch(for: double), 1, "Single-target lookup is unchanged")
+        XCTAssertEqual(index.closestMatches(for: "cap:in=media:;op=missing;out=media:"), [])
+    }
+}
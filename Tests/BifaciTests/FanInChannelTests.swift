@@ -0,0 +1,107 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// FanInChannel Tests
+//
+// Per-lane FIFO, round-robin fairness across lanes, bounded lanes with
+// producer backpressure, and depth metrics.
+// =============================================================================
+
+final class FanInChannelTests: XCTestCase {
+
+    // TEST1250: Items from one lane come out in send order
+    func test1250_perLaneFifo() {
+        let channel = FanInChannel<Int>(capacity: 8)
+        for i in 0..<5 { channel.send(i, lane: 0) }
+        XCTAssertEqual((0..<5).compactMap { _ in channel.receive() }, [0, 1, 2, 3, 4])
+    }
+
+    // TEST1251: Consumer alternates between busy lanes instead of draining one first
+    func test1251_roundRobinAcrossLanes() {
+        let channel = FanInChannel<String>(capacity: 8)
+        for i in 0..<3 { channel.send("a\(i)", lane: 0) }
+        for i in 0..<3 { channel.send("b\(i)", lane: 1) }
+        let order = (0..<6).compactMap { _ in channel.receive() }
+        XCTAssertEqual(order, ["a0", "b0", "a1", "b1", "a2", "b2"])
+    }
+
+    // TEST1252: receive(deadline:) returns nil on timeout and ignores bare wake-ups
+    func test1252_receiveTimeout() {
+        let channel = FanInChannel<Int>(capacity: 4)
+        XCTAssertNil(channel.receive(deadline: .now() + 0.05))
+        channel.wake()
+        XCTAssertNil(channel.receive(deadline: .now() + 0.05))
+        channel.send(7, lane: 3)
+        XCTAssertEqual(channel.receive(deadline: .now() + 1), 7)
+    }
+
+    // TEST1253: A full lane blocks its producer until the consumer makes room; stats record it
+    func test1253_backpressureAndStats() {
+        let channel = FanInChannel<Int>(capacity: 2)
+        channel.send(1, lane: 0)
+        channel.send(2, lane: 0)
+
+        let sent = expectation(description: "third send completes")
+        DispatchQueue.global().async {
+            channel.send(3, lane: 0)
+            sent.fulfill()
+        }
+
+        // Give the producer time to block on the full lane
+        Thread.sleep(forTimeInterval: 0.1)
+        var stats = channel.stats()
+        XCTAssertEqual(stats.depth, 2)
+        XCTAssertEqual(stats.producerWaits, 1)
+
+        XCTAssertEqual(channel.receive(), 1)
+        wait(for: [sent], timeout: 2.0)
+
+        stats = channel.stats()
+        XCTAssertEqual(stats.depthByLane, [2])
+        XCTAssertEqual(stats.highWaterMark, 2)
+        XCTAssertEqual(stats.enqueued, 3)
+        XCTAssertEqual(channel.receive(), 2)
+        XCTAssertEqual(channel.receive(), 3)
+    }
+
+    // TEST1254: close() releases a producer blocked on a full lane and rejects new items
+    func test1254_closeReleasesProducers() {
+        let channel = FanInChannel<Int>(capacity: 1)
+        channel.send(1, lane: 0)
+
+        let released = expectation(description: "blocked send returns")
+        var accepted = true
+        DispatchQueue.global().async {
+            accepted = channel.send(2, lane: 0)
+            released.fulfill()
+        }
+        Thread.sleep(forTimeInterval: 0.05)
+        channel.close()
+        wait(for: [released], timeout: 2.0)
+
+        XCTAssertFalse(accepted)
+        XCTAssertFalse(channel.send(3, lane: 1))
+        XCTAssertEqual(channel.receive(deadline: .now() + 1), 1, "Queued items survive close")
+    }
+
+    // TEST1255: Many producers, one consumer: every item is delivered exactly once
+    func test1255_manyProducersDeliverAll() {
+        let channel = FanInChannel<Int>(capacity: 16)
+        let producers = 8
+        let perProducer = 500
+        for p in 0..<producers {
+            Thread.detachNewThread {
+                for i in 0..<perProducer { channel.send(p * perProducer + i, lane: p) }
+            }
+        }
+
+        var seen = Set<Int>()
+        for _ in 0..<(producers * perProducer) {
+            guard let item = channel.receive(deadline: .now() + 5) else { return XCTFail("Timed out after \(seen.count)") }
+            XCTAssertTrue(seen.insert(item).inserted)
+        }
+        XCTAssertEqual(seen.count, producers * perProducer)
+        XCTAssertEqual(channel.stats().depth, 0)
+    }
+}
@@ -833,4 +833,103 @@ final class FlowOrderingTests: XCTestCase {
             XCTAssertEqual(frame.seq, UInt64(i))
         }
     }
+
+    // MARK: - Flow Credit Tests (TEST1270-1274)
+
+    // TEST1270: Sender blocks once its window is spent and resumes on CREDIT
+    func test1270_creditGateBlocksUntilGrant() {
+        let gate = FlowCreditGate(window: 2)
+        let key = FlowKey(rid: .uint(1), xid: .uint(9))
+        XCTAssertTrue(gate.acquire(key))
+        XCTAssertTrue(gate.acquire(key))
+
+        let acquired = DispatchSemaphore(value: 0)
+        DispatchQueue.global().async {
+            gate.acquire(key)
+            acquired.signal()
+        }
+        XCTAssertEqual(acquired.wait(timeout: .now() + 0.1), .timedOut, "Third CHUNK must wait for credit")
+        gate.grant(key, 1)
+        XCTAssertEqual(acquired.wait(timeout: .now() + 2), .success)
+    }
+
+    // TEST1271: An exhausted flow does not block other flows; close releases waiters
+    func test1271_creditGateFlowsIndependent() {
+        let gate = FlowCreditGate(window: 1)
+        let bulk = FlowKey(rid: .uint(1), xid: nil)
+        let interactive = FlowKey(rid: .uint(2), xid: nil)
+        gate.acquire(bulk)
+
+        let released = DispatchSemaphore(value: 0)
+        var result = true
+        DispatchQueue.global().async {
+            result = gate.acquire(bulk)
+            released.signal()
+        }
+        XCTAssertTrue(gate.acquire(interactive), "Other flows keep their own window")
+
+        gate.close()
+        XCTAssertEqual(released.wait(timeout: .now() + 2), .success)
+        XCTAssertFalse(result, "acquire reports the gate was closed")
+    }
+
+    // TEST1272: Grants for finished or unknown flows are dropped; removed flows start a fresh window
+    func test1272_creditGateIgnoresStaleGrants() {
+        let gate = FlowCreditGate(window: 1)
+        let key = FlowKey(rid: .uint(3), xid: nil)
+        gate.grant(key, 100)  // unknown flow: dropped
+        gate.acquire(key)
+        gate.remove(key)
+        gate.grant(key, 100)  // finished flow: dropped
+
+        XCTAssertTrue(gate.acquire(key), "Reused key starts with a full window")
+        let blocked = DispatchSemaphore(value: 0)
+        DispatchQueue.global().async {
+            gate.acquire(key)
+            blocked.signal()
+        }
+        XCTAssertEqual(blocked.wait(timeout: .now() + 0.1), .timedOut, "Stale grants must not inflate the window")
+        gate.close()
+        _ = blocked.wait(timeout: .now() + 2)
+    }
+
+    // TEST1273: Returner hands back credits in half-window batches per flow
+    func test1273_creditReturnerBatches() {
+        let returner = FlowCreditReturner(window: 8)
+        let a = FlowKey(rid: .uint(1), xid: nil)
+        let b = FlowKey(rid: .uint(2), xid: nil)
+        XCTAssertEqual((0..<3).compactMap { _ in returner.consumed(a) }, [])
+        XCTAssertEqual(returner.consumed(a), 4)
+        XCTAssertNil(returner.consumed(b), "Counts are per flow")
+        XCTAssertNil(returner.consumed(a))
+        returner.remove(a)
+        XCTAssertEqual((0..<4).compactMap { _ in returner.consumed(a) }, [4])
+        XCTAssertEqual(FlowCreditReturner(window: 1).consumed(a), 1)
+    }
+
+    // TEST1274: flow_window is negotiated only when both HELLOs offer one; CREDIT bypasses seq ordering
+    func test1274_flowWindowNegotiationAndCreditFrame() throws {
+        let plain = try decodeFrame(encodeFrame(Frame.hello(limits: Limits())))
+        XCTAssertNil(plain.meta?["flow_window"], "Default HELLO is unchanged")
+        XCTAssertEqual(plain.helloFlowWindow, 0)
+
+        let offering = try decodeFrame(encodeFrame(Frame.hello(limits: Limits(flowWindow: 16))))
+        XCTAssertEqual(offering.helloFlowWindow, 16)
+
+        XCTAssertEqual(Limits.negotiateFlowWindow(32, 16), 16)
+        XCTAssertEqual(Limits.negotiateFlowWindow(32, 0), 0)
+        XCTAssertEqual(Limits(flowWindow: 8).negotiate(with: Limits()).flowWindow, 0)
+
+        let credit = try decodeFrame(encodeFrame(Frame.credit(id: .uint(5), routingId: .uint(7), credits: 16)))
+        XCTAssertEqual(credit.frameType, .credit)
+        XCTAssertEqual(credit.creditGrant, 16)
+        XCTAssertEqual(FlowKey.fromFrame(credit), FlowKey(rid: .uint(5), xid: .uint(7)))
+        XCTAssertFalse(credit.isFlowFrame())
+
+        var assigner = SeqAssigner()
+        var stamped = credit
+        assigner.assign(&stamped)
+        XCTAssertEqual(stamped.seq, 0)
+        XCTAssertEqual(try ReorderBuffer(maxBufferPerFlow: 1).accept(credit).count, 1)
+    }
 }
@@ -33,7 +33,8 @@ final class CborFrameTests: XCTestCase {
         XCTAssertNil(FrameType(rawValue: 2), "rawValue 2 (res) removed - must be invalid")
         XCTAssertEqual(FrameType(rawValue: 10), .relayNotify)
         XCTAssertEqual(FrameType(rawValue: 11), .relayState)
-        XCTAssertNil(FrameType(rawValue: 12), "rawValue 12 must be invalid")
+        XCTAssertEqual(FrameType(rawValue: 12), .credit)
+        XCTAssertNil(FrameType(rawValue: 13), "rawValue 13 must be invalid")
         XCTAssertNil(FrameType(rawValue: 99), "rawValue 99 must be invalid")
         XCTAssertNil(FrameType(rawValue: 255), "rawValue 255 must be invalid")
     }
@@ -1166,9 +1167,10 @@ final class CborFrameTests: XCTestCase {
         XCTAssertEqual(frame.payload, resources)
     }
 
-    // TEST403: FrameType from value 12 is nil (one past RelayState)
+    // TEST403: FrameType value 12 is Credit (right after RelayState); 13 is nil
     func test403_frameTypeOnePastRelayState() {
-        XCTAssertNil(FrameType(rawValue: 12), "rawValue 12 must be nil (one past RelayState)")
+        XCTAssertEqual(FrameType(rawValue: 12), .credit, "rawValue 12 is Credit (one past RelayState)")
+        XCTAssertNil(FrameType(rawValue: 13), "rawValue 13 must be nil (one past Credit)")
     }
 
     // TEST521: RelayNotify CBOR roundtrip preserves manifest and limits
@@ -1761,4 +1763,282 @@ final class CborFrameTests: XCTestCase {
             }
         }
     }
+
+    // MARK: - Direct Codec Wire Compatibility (TEST1220-1224)
+
+    // TEST1220: Frames encoded by the direct codec parse as the same CBOR map SwiftCBOR would build
+    func test1220_directEncodeMatchesCborTree() throws {
+        let payload = Data((0..<300).map { UInt8($0 & 0xFF) })
+        var frame = Frame.chunk(reqId: .uint(70_000), streamId: "s1", seq: 5, payload: payload,
+                                chunkIndex: 2, checksum: UInt64.max)
+        frame.routingId = .uint(9)
+        frame.eof = true
+        frame.meta = ["k": .utf8String("v")]
+
+        let encoded = try encodeFrame(frame)
+        guard case .map(let map)? = try CBOR.decode([UInt8](encoded)) else {
+            return XCTFail("Direct encoding must be a CBOR map")
+        }
+        XCTAssertEqual(map[.unsignedInt(FrameKey.id.rawValue)], .unsignedInt(70_000))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.seq.rawValue)], .unsignedInt(5))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.streamId.rawValue)], .utf8String("s1"))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.payload.rawValue)], .byteString([UInt8](payload)))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.eof.rawValue)], .boolean(true))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.routingId.rawValue)], .unsignedInt(9))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.chunkIndex.rawValue)], .unsignedInt(2))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.checksum.rawValue)], .unsignedInt(UInt64.max))
+        XCTAssertEqual(map[.unsignedInt(FrameKey.meta.rawValue)], .map([.utf8String("k"): .utf8String("v")]))
+    }
+
+    // TEST1221: A SwiftCBOR-built frame map (with unknown keys) decodes through the direct decoder
+    func test1221_decodeCborTreeWithUnknownKeys() throws {
+        let uuid = MessageId.newUUID()
+        let map: [CBOR: CBOR] = [
+            .unsignedInt(FrameKey.version.rawValue): .unsignedInt(2),
+            .unsignedInt(FrameKey.frameType.rawValue): .unsignedInt(UInt64(FrameType.req.rawValue)),
+            .unsignedInt(FrameKey.id.rawValue): .byteString([UInt8](uuid.asBytes())),
+            .unsignedInt(FrameKey.cap.rawValue): .utf8String("cap:op=test"),
+            .unsignedInt(FrameKey.payload.rawValue): .byteString([1, 2, 3]),
+            .unsignedInt(99): .array([.unsignedInt(1), .map([.utf8String("x"): .null])]),
+            .utf8String("extra"): .tagged(.init(rawValue: 1), .double(1.5)),
+        ]
+        let decoded = try decodeFrame(Data(CBOR.map(map).encode()))
+        XCTAssertEqual(decoded.frameType, .req)
+        XCTAssertEqual(decoded.id, uuid)
+        XCTAssertEqual(decoded.cap, "cap:op=test")
+        XCTAssertEqual(decoded.payload, Data([1, 2, 3]))
+    }
+
+    // TEST1222: Negative-int checksum (Rust i64 encoding) decodes to the same bit pattern
+    func test1222_negativeChecksumDecodes() throws {
+        let checksum: UInt64 = 0xF000_0000_0000_0001
+        let map: [CBOR: CBOR] = [
+            .unsignedInt(FrameKey.version.rawValue): .unsignedInt(2),
+            .unsignedInt(FrameKey.frameType.rawValue): .unsignedInt(UInt64(FrameType.chunk.rawValue)),
+            .unsignedInt(FrameKey.id.rawValue): .unsignedInt(1),
+            .unsignedInt(FrameKey.chunkIndex.rawValue): .unsignedInt(0),
+            // -(n+1) == Int64(bitPattern: checksum)
+            .unsignedInt(FrameKey.checksum.rawValue): .negativeInt(~checksum),
+        ]
+        let decoded = try decodeFrame(Data(CBOR.map(map).encode()))
+        XCTAssertEqual(decoded.checksum, checksum)
+    }
+
+    // TEST1223: Decoding works on a Data slice and the payload slice compares equal to the original bytes
+    func test1223_decodeFromSliceKeepsPayload() throws {
+        let payload = Data(repeating: 0xAB, count: 4096)
+        let frame = Frame.req(id: .uint(3), capUrn: "cap:op=test", payload: payload, contentType: "application/cbor")
+        let prefixed = Data([0, 0, 0, 0]) + (try encodeFrame(frame))
+        let decoded = try decodeFrame(prefixed.dropFirst(4))
+        XCTAssertEqual(decoded.payload, payload)
+        XCTAssertEqual(decoded.payload.map { [UInt8]($0) }, [UInt8](payload))
+        XCTAssertEqual(decoded.contentType, "application/cbor")
+    }
+
+    // TEST1224: Truncated or non-map input is rejected instead of crashing
+    func test1224_truncatedInputRejected() throws {
+        let encoded = try encodeFrame(Frame.req(id: .uint(1), capUrn: "cap:op=test", payload: Data([1, 2, 3]), contentType: "x"))
+        for cut in [1, encoded.count / 2, encoded.count - 1] {
+            XCTAssertThrowsError(try decodeFrame(encoded.prefix(cut)), "cut at \(cut)")
+        }
+        XCTAssertThrowsError(try decodeFrame(Data()))
+        XCTAssertThrowsError(try decodeFrame(Data(CBOR.array([.unsignedInt(1)]).encode()))) { error in
+            guard case FrameError.invalidFrame = error else { return XCTFail("Expected invalidFrame, got \(error)") }
+        }
+    }
+
+    // MARK: - Buffered FrameReader (TEST1225-1227)
+
+    // TEST1225: Read-ahead FrameReader returns every frame of a multi-frame burst in order, then EOF
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1225_bufferedReaderExtractsBurst() throws {
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let frameCount = 500
+
+        let writerThread = Thread {
+            for i in 0..<frameCount {
+                let payload = Data(repeating: UInt8(i & 0xFF), count: i * 7)
+                try? writer.write(Frame.req(id: .uint(UInt64(i)), capUrn: "cap:op=test", payload: payload, contentType: "x"))
+            }
+            try? writer.flush()
+            pipe.fileHandleForWriting.closeFile()
+        }
+        writerThread.start()
+
+        let reader = FrameReader(handle: pipe.fileHandleForReading, bufferSize: 4096)
+        for i in 0..<frameCount {
+            guard let frame = try reader.read() else {
+                return XCTFail("Unexpected EOF at frame \(i)")
+            }
+            XCTAssertEqual(frame.id, .uint(UInt64(i)))
+            XCTAssertEqual(frame.payload, Data(repeating: UInt8(i & 0xFF), count: i * 7))
+        }
+        XCTAssertNil(try reader.read())
+    }
+
+    // TEST1226: Stream ending mid-frame reports unexpectedEof from the buffered reader
+    func test1226_bufferedReaderTruncatedFrame() throws {
+        let pipe = Pipe()
+        let encoded = try encodeFrame(Frame.end(id: .uint(1), finalPayload: Data([1, 2, 3])))
+        var prefixed = Data([0, 0, 0, UInt8(encoded.count)])
+        prefixed.append(encoded.prefix(encoded.count - 2))
+        pipe.fileHandleForWriting.write(prefixed)
+        pipe.fileHandleForWriting.closeFile()
+
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        XCTAssertThrowsError(try reader.read()) { error in
+            guard case FrameError.unexpectedEof = error else { return XCTFail("Expected unexpectedEof, got \(error)") }
+        }
+    }
+
+    // TEST1227: bufferSize 0 reads exactly one frame, leaving the rest on the handle
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1227_unbufferedReaderLeavesTrailingBytes() throws {
+        let pipe = Pipe()
+        var buffer = Data()
+        try writeFrame(Frame.end(id: .uint(1), finalPayload: nil), to: pipe.fileHandleForWriting, limits: Limits(), buffer: &buffer)
+        try writeFrame(Frame.end(id: .uint(2), finalPayload: nil), to: pipe.fileHandleForWriting, limits: Limits(), buffer: &buffer)
+        pipe.fileHandleForWriting.closeFile()
+
+        let first = FrameReader(handle: pipe.fileHandleForReading, bufferSize: 0)
+        XCTAssertEqual(try first.read()?.id, .uint(1))
+        // A second reader on the same handle still sees the next frame
+        let second = FrameReader(handle: pipe.fileHandleForReading, bufferSize: 0)
+        XCTAssertEqual(try second.read()?.id, .uint(2))
+        XCTAssertNil(try second.read())
+    }
+
+    // MARK: - FrameWriter Coalescing (TEST1228-1230)
+
+    // TEST1228: Header + out-of-line payload written by appendFrame is byte-identical to the length-prefixed encodeFrame
+    func test1228_appendFrameMatchesEncodeFrame() throws {
+        for size in [0, 10, FRAME_WRITEV_MIN_PAYLOAD, FRAME_WRITEV_MIN_PAYLOAD * 3] {
+            let payload = Data((0..<size).map { UInt8($0 % 251) })
+            var frame = Frame.chunk(reqId: .uint(1), streamId: "s", seq: 0, payload: payload,
+                                    chunkIndex: 0, checksum: Frame.computeChecksum(payload))
+            frame.routingId = .uint(4)
+
+            var buffer = Data()
+            let tail = try appendFrame(frame, limits: Limits(maxFrame: 1_000_000, maxChunk: 1_000_000), to: &buffer)
+            XCTAssertEqual(tail != nil, size >= FRAME_WRITEV_MIN_PAYLOAD)
+
+            let encoded = try encodeFrame(frame)
+            var expected = Data([UInt8((encoded.count >> 24) & 0xFF), UInt8((encoded.count >> 16) & 0xFF),
+                                 UInt8((encoded.count >> 8) & 0xFF), UInt8(encoded.count & 0xFF)])
+            expected.append(encoded)
+            XCTAssertEqual(buffer + (tail ?? Data()), expected, "size \(size)")
+        }
+    }
+
+    // TEST1229: Coalescing writer delivers a CHUNK burst and its END in order, including writev'd large chunks
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1229_coalescedBurstRoundtrip() throws {
+        let pipe = Pipe()
+        let limits = Limits(maxFrame: 1_000_000, maxChunk: 100_000)
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting, limits: limits, coalesceBytes: 4096)
+        let sizes = [100, 200, 50_000, 10, 3000, 70_000, 1]
+
+        let writerThread = Thread {
+            for (i, size) in sizes.enumerated() {
+                let payload = Data(repeating: UInt8(i), count: size)
+                try? writer.write(Frame.chunk(reqId: .uint(1), streamId: "s", seq: UInt64(i), payload: payload,
+                                              chunkIndex: UInt64(i), checksum: Frame.computeChecksum(payload)))
+            }
+            try? writer.write(Frame.end(id: .uint(1)))
+        }
+        writerThread.start()
+
+        let reader = FrameReader(handle: pipe.fileHandleForReading, limits: limits)
+        for (i, size) in sizes.enumerated() {
+            let frame = try reader.read()
+            XCTAssertEqual(frame?.frameType, .chunk)
+            XCTAssertEqual(frame?.chunkIndex, UInt64(i))
+            XCTAssertEqual(frame?.payload?.count, size)
+        }
+        XCTAssertEqual(try reader.read()?.frameType, .end, "END flushes the batch")
+    }
+
+    // TEST1230: A lone coalesced CHUNK is flushed by the delay timer without further writes
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1230_coalesceDelayFlushesIdleBatch() throws {
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting, coalesceBytes: 1_000_000, coalesceDelay: 0.01)
+        let payload = Data([1, 2, 3])
+        try writer.write(Frame.chunk(reqId: .uint(1), streamId: "s", seq: 0, payload: payload,
+                                     chunkIndex: 0, checksum: Frame.computeChecksum(payload)))
+
+        let received = expectation(description: "chunk delivered")
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        Thread.detachNewThread {
+            if let frame = try? reader.read(), frame.payload == payload {
+                received.fulfill()
+            }
+        }
+        wait(for: [received], timeout: 2.0)
+        withExtendedLifetime(writer) {}
+    }
+
+    // MARK: - Zero-Copy Chunking (TEST1231-1233)
+
+    /// Read CHUNK frames until eof and return the reassembled bytes (verifies checksums and offsets).
+    private func collectChunks(_ reader: FrameReader) throws -> Data {
+        var assembled = Data()
+        while let frame = try reader.read() {
+            XCTAssertEqual(frame.frameType, .chunk)
+            let payload = frame.payload ?? Data()
+            XCTAssertEqual(frame.checksum, Frame.computeChecksum(payload))
+            XCTAssertEqual(frame.offset, UInt64(assembled.count))
+            assembled.append(payload)
+            if frame.eof == true { break }
+        }
+        return assembled
+    }
+
+    // TEST1231: writeChunked on a Data slice (non-zero startIndex) chunks the slice contents, not the parent
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1231_writeChunkedFromSlice() throws {
+        let pipe = Pipe()
+        let limits = Limits(maxFrame: 1_000_000, maxChunk: 7_000)
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting, limits: limits)
+        let parent = Data((0..<50_000).map { UInt8($0 % 253) })
+        let slice = parent[1_234..<41_234]
+
+        let writerThread = Thread {
+            try? writer.writeChunked(id: .uint(1), streamId: "s", contentType: "application/octet-stream", data: slice)
+        }
+        writerThread.start()
+
+        let assembled = try collectChunks(FrameReader(handle: pipe.fileHandleForReading, limits: limits))
+        XCTAssertEqual(assembled, Data(slice))
+    }
+
+    // TEST1232: writeChunked(fileURL:) streams a mapped file identical to its contents
+    @available(macOS 10.15.4, iOS 13.4, *)
+    func test1232_writeChunkedFromMappedFile() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("bifaci-chunk-\(UUID().uuidString)")
+        let contents = Data((0..<100_000).map { UInt8(($0 * 31) & 0xFF) })
+        try contents.write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        let pipe = Pipe()
+        let limits = Limits(maxFrame: 1_000_000, maxChunk: 32_768)
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting, limits: limits)
+        let writerThread = Thread {
+            try? writer.writeChunked(id: .uint(2), streamId: "f", contentType: "application/octet-stream", fileURL: url)
+        }
+        writerThread.start()
+
+        let assembled = try collectChunks(FrameReader(handle: pipe.fileHandleForReading, limits: limits))
+        XCTAssertEqual(assembled, contents)
+    }
+
+    // TEST1233: encodeCborByteString matches SwiftCBOR's byteString encoding for every head width
+    func test1233_encodeCborByteStringMatchesSwiftCbor() {
+        for size in [0, 23, 24, 255, 256, 65_535, 65_536] {
+            let bytes = Data(repeating: 0x5A, count: size)
+            XCTAssertEqual(encodeCborByteString(bytes), Data(CBOR.byteString([UInt8](bytes)).encode()), "size \(size)")
+            XCTAssertEqual(encodeCborByteString(bytes.dropFirst(0)), encodeCborByteString(bytes))
+        }
+    }
 }
@@ -0,0 +1,138 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// HandlerPool Tests
+//
+// Bounded worker threads for request handlers, thread reuse across bursts,
+// and per-cap concurrency limits that don't hold back other caps.
+// =============================================================================
+
+final class HandlerPoolTests: XCTestCase {
+
+    /// Tracks the peak number of jobs inside a section at once
+    private final class Peak: @unchecked Sendable {
+        private let lock = NSLock()
+        private var current = 0
+        private(set) var peak = 0
+
+        func enter() {
+            lock.lock()
+            current += 1
+            peak = max(peak, current)
+            lock.unlock()
+        }
+
+        func leave() {
+            lock.lock()
+            current -= 1
+            lock.unlock()
+        }
+    }
+
+    // TEST1280: A burst larger than the pool runs every job on at most maxWorkers threads
+    func test1280_burstBoundedByMaxWorkers() {
+        let pool = HandlerPool(maxWorkers: 4)
+        let peak = Peak()
+        let done = DispatchGroup()
+        for _ in 0..<200 {
+            done.enter()
+            pool.submit(group: "cap:op=small") {
+                peak.enter()
+                Thread.sleep(forTimeInterval: 0.001)
+                peak.leave()
+                done.leave()
+            }
+        }
+        XCTAssertEqual(done.wait(timeout: .now() + 10), .success)
+        XCTAssertLessThanOrEqual(peak.peak, 4)
+        XCTAssertLessThanOrEqual(pool.stats().workers, 4)
+        pool.close()
+    }
+
+    // TEST1281: A per-cap limit queues that cap's jobs while other caps keep running
+    func test1281_perGroupLimit() {
+        let pool = HandlerPool(maxWorkers: 8)
+        let limited = Peak()
+        let release = DispatchSemaphore(value: 0)
+        let slowDone = DispatchGroup()
+        for _ in 0..<4 {
+            slowDone.enter()
+            pool.submit(group: "cap:op=slow", limit: 1) {
+                limited.enter()
+                release.wait()
+                limited.leave()
+                slowDone.leave()
+            }
+        }
+
+        let fast = expectation(description: "other cap runs while slow cap is saturated")
+        pool.submit(group: "cap:op=fast") { fast.fulfill() }
+        wait(for: [fast], timeout: 2.0)
+
+        var stats = pool.stats()
+        XCTAssertEqual(stats.running, 1, "Only one slow job may run")
+        XCTAssertEqual(stats.queued, 3)
+
+        for _ in 0..<4 { release.signal() }
+        XCTAssertEqual(slowDone.wait(timeout: .now() + 5), .success)
+        XCTAssertEqual(limited.peak, 1)
+        stats = pool.stats()
+        XCTAssertEqual(stats.queued, 0)
+        pool.close()
+    }
+
+    // TEST1282: Sequential requests reuse the same worker instead of starting new threads
+    func test1282_workersReused() {
+        let pool = HandlerPool(maxWorkers: 16)
+        for _ in 0..<50 {
+            let ran = DispatchSemaphore(value: 0)
+            pool.submit(group: "cap:op=echo") { ran.signal() }
+            XCTAssertEqual(ran.wait(timeout: .now() + 2), .success)
+            // Let the worker go idle before the next submit
+            while pool.stats().idle == 0 { Thread.sleep(forTimeInterval: 0.001) }
+        }
+        XCTAssertEqual(pool.stats().workers, 1)
+        pool.close()
+    }
+
+    // TEST1399: Handlers blocked on nested peer calls into their own cap, at both limits, don't deadlock
+    func test1399_nestedPeerCallsAtLimit() {
+        // One worker and a per-cap limit of 1: every level of the chain needs
+        // the slot its caller holds while it waits for the response
+        let pool = HandlerPool(maxWorkers: 1)
+        let depth = 4
+
+        /// Stand-in for a peer call the host routes back into the same cap
+        func peerCall(level: Int, reply: @escaping (Int) -> Void) {
+            pool.submit(group: "cap:op=recurse", limit: 1) {
+                guard level < depth else { return reply(level) }
+                let response = DispatchSemaphore(value: 0)
+                var deepest = 0
+                peerCall(level: level + 1) { value in
+                    deepest = value
+                    response.signal()
+                }
+                HandlerPool.blocking { response.wait() }
+                reply(deepest)
+            }
+        }
+
+        let done = DispatchSemaphore(value: 0)
+        var reached = 0
+        peerCall(level: 1) { value in
+            reached = value
+            done.signal()
+        }
+        XCTAssertEqual(done.wait(timeout: .now() + 5), .success, "Nested peer calls deadlocked the pool")
+        XCTAssertEqual(reached, depth)
+
+        // Extra workers retire once nothing is blocked
+        let deadline = Date().addingTimeInterval(5)
+        while pool.stats().workers > 1 && Date() < deadline { Thread.sleep(forTimeInterval: 0.001) }
+        let stats = pool.stats()
+        XCTAssertEqual(stats.blocked, 0)
+        XCTAssertLessThanOrEqual(stats.workers, 1)
+        pool.close()
+    }
+}
@@ -0,0 +1,110 @@
+import XCTest
+@preconcurrency import SwiftCBOR
+@testable import Bifaci
+
+// =============================================================================
+// Metrics Tests
+//
+// Counter/gauge/histogram semantics, snapshot export (JSON and CBOR), the
+// ReorderBuffer occupancy gauge, and metrics carried in RelayState meta.
+// =============================================================================
+
+@available(macOS 10.15.4, iOS 13.4, *)
+final class MetricsTests: XCTestCase {
+
+    // TEST1350: Metrics accumulate per name+label; reset zeroes history but keeps gauge levels
+    func test1350_registryBasics() throws {
+        let registry = MetricsRegistry()
+        registry.counter("reqs", label: "a").increment()
+        registry.counter("reqs", label: "a").increment(by: 4)
+        registry.counter("reqs", label: "b").increment()
+        let gauge = registry.gauge("depth")
+        gauge.add(3)
+        gauge.add(-2)
+        let histogram = registry.histogram("latency_us")
+        for value: UInt64 in [0, 1, 3, 100, 1000] { histogram.record(value) }
+
+        let snap = registry.snapshot()
+        XCTAssertEqual(snap.counter("reqs", label: "a"), 5)
+        XCTAssertEqual(snap.counter("reqs", label: "b"), 1)
+        XCTAssertEqual(snap.gauge("depth"), GaugeSnapshot(value: 1, highWaterMark: 3))
+        let h = try XCTUnwrap(snap.histogram("latency_us"))
+        XCTAssertEqual(h.count, 5)
+        XCTAssertEqual(h.sum, 1104)
+        XCTAssertEqual(h.min, 0)
+        XCTAssertEqual(h.max, 1000)
+        XCTAssertEqual(h.percentile(0.5), 3, "Median sits in the [2, 4) bucket")
+        XCTAssertEqual(h.percentile(1.0), 1000, "Top bucket bound is capped at max")
+
+        registry.reset()
+        let after = registry.snapshot()
+        XCTAssertEqual(after.counter("reqs", label: "a"), 0)
+        XCTAssertEqual(after.histogram("latency_us")?.count, 0)
+        XCTAssertEqual(after.gauge("depth"), GaugeSnapshot(value: 1, highWaterMark: 1))
+        histogram.record(7)
+        XCTAssertEqual(registry.snapshot().histogram("latency_us")?.count, 1, "Handles survive reset")
+    }
+
+    // TEST1351: Snapshots round-trip through CBOR and export keyed JSON
+    func test1351_snapshotExport() throws {
+        let registry = MetricsRegistry()
+        registry.counter("bytes", label: "cap:op=x").increment(by: 42)
+        registry.gauge("level").add(-5)
+        registry.histogram("size").record(4096)
+
+        let snap = registry.snapshot()
+        let decoded = try XCTUnwrap(MetricsSnapshot(cbor: snap.cbor()))
+        XCTAssertEqual(decoded.counters, snap.counters)
+        XCTAssertEqual(decoded.gauges, snap.gauges)
+        XCTAssertEqual(decoded.histograms, snap.histograms)
+
+        let json = try XCTUnwrap(JSONSerialization.jsonObject(with: snap.jsonData()) as? [String: Any])
+        let counters = try XCTUnwrap(json["counters"] as? [String: Any])
+        XCTAssertEqual(counters["bytes{cap:op=x}"] as? Int, 42)
+        XCTAssertNil(MetricsSnapshot(cbor: .utf8String("nope")))
+    }
+
+    // TEST1352: ReorderBuffer reports frames held for a gap and releases them on drain and cleanup
+    func test1352_reorderBufferOccupancy() throws {
+        let occupancy = MetricsRegistry.shared.gauge("reorder_buffer.buffered_frames")
+        let base = occupancy.value
+        let buffer = ReorderBuffer(maxBufferPerFlow: 8)
+        let rid = MessageId.newUUID()
+        func chunk(_ seq: UInt64) -> Frame {
+            var frame = Frame.chunk(reqId: rid, streamId: "s", seq: seq, payload: Data([1]), chunkIndex: seq, checksum: Frame.computeChecksum(Data([1])))
+            frame.seq = seq
+            return frame
+        }
+
+        XCTAssertTrue(try buffer.accept(chunk(2)).isEmpty)
+        XCTAssertTrue(try buffer.accept(chunk(1)).isEmpty)
+        XCTAssertEqual(occupancy.value - base, 2)
+        XCTAssertEqual(try buffer.accept(chunk(0)).count, 3)
+        XCTAssertEqual(occupancy.value - base, 0)
+
+        XCTAssertTrue(try buffer.accept(chunk(5)).isEmpty)
+        XCTAssertEqual(occupancy.value - base, 1)
+        buffer.cleanupFlow(FlowKey(rid: rid, xid: nil))
+        XCTAssertEqual(occupancy.value - base, 0)
+    }
+
+    // TEST1353: A metrics snapshot attached to RelayState survives the wire
+    func test1353_relayStateCarriesMetrics() throws {
+        let registry = MetricsRegistry()
+        registry.counter("relay_switch.requests_routed").increment(by: 9)
+        registry.histogram("relay_switch.request_latency_us", label: "cap:op=y").record(250)
+
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        try RelayMaster.sendState(socketWriter: writer, resources: Data("{}".utf8), metrics: registry.snapshot())
+
+        let frame = try XCTUnwrap(try reader.read())
+        XCTAssertEqual(frame.frameType, .relayState)
+        XCTAssertEqual(frame.payload, Data("{}".utf8))
+        let metrics = try XCTUnwrap(frame.relayStateMetrics)
+        XCTAssertEqual(metrics.counter("relay_switch.requests_routed"), 9)
+        XCTAssertEqual(metrics.histogram("relay_switch.request_latency_us", label: "cap:op=y")?.max, 250)
+        XCTAssertNil(Frame.relayState(resources: Data()).relayStateMetrics)
+    }
+}
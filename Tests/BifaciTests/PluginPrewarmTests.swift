@@ -0,0 +1,66 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// PluginHost Pre-warm Tests
+//
+// Spare instances per binary path, pre-warm spawning, and how a broken
+// binary takes every instance of it out of routing.
+// =============================================================================
+
+@available(macOS 10.15.4, iOS 13.4, *)
+final class PluginPrewarmTests: XCTestCase {
+
+    private func advertisedCaps(_ host: PluginHost) -> [String] {
+        (try? JSONSerialization.jsonObject(with: host.capabilities) as? [String]) ?? []
+    }
+
+    // TEST1320: Spare instances route like the registered plugin and don't duplicate advertised caps
+    func test1320_spareInstancesNotAdvertisedTwice() {
+        let host = PluginHost()
+        host.registerPlugin(path: "/nonexistent/hot", knownCaps: ["cap:op=hot"])
+        let primary = host.findPluginForCap("cap:op=hot")
+        host.setPrewarm(path: "/nonexistent/hot", instances: 3)
+
+        XCTAssertEqual(host.findPluginForCap("cap:op=hot"), primary, "Lookup still resolves to the registered plugin")
+        XCTAssertEqual(advertisedCaps(host).filter { $0 == "cap:op=hot" }.count, 1)
+    }
+
+    // TEST1321: Pre-warming an unregistered path does nothing
+    func test1321_prewarmUnregisteredPathIsNoop() {
+        let host = PluginHost()
+        host.setPrewarm(path: "/nonexistent/unknown", instances: 2)
+        XCTAssertEqual(host.prewarmPlugins(), 0)
+        XCTAssertNil(host.findPluginForCap("cap:op=anything"))
+        XCTAssertTrue(host.runningPlugins().isEmpty)
+    }
+
+    // TEST1322: A binary that can't be spawned starts nothing but stays advertised for a later attempt
+    func test1322_prewarmSpawnFailureKeepsCaps() {
+        let host = PluginHost()
+        host.registerPlugin(path: "/nonexistent/plugin/binary", knownCaps: ["cap:op=cold"])
+        host.setPrewarm(path: "/nonexistent/plugin/binary", instances: 2)
+
+        XCTAssertEqual(host.prewarmPlugins(), 0)
+        XCTAssertTrue(host.runningPlugins().isEmpty)
+        XCTAssertTrue(advertisedCaps(host).contains("cap:op=cold"))
+        XCTAssertNotNil(host.findPluginForCap("cap:op=cold"))
+    }
+
+    // TEST1323: A binary that fails HELLO takes every pre-warm instance out of routing
+    func test1323_helloFailureRemovesAllInstances() throws {
+        // cat echoes the host's HELLO back, which has no manifest
+        let cat = "/bin/cat"
+        guard FileManager.default.isExecutableFile(atPath: cat) else {
+            throw XCTSkip("\(cat) not available")
+        }
+        let host = PluginHost()
+        host.registerPlugin(path: cat, knownCaps: ["cap:op=echo"])
+        host.setPrewarm(path: cat, instances: 2)
+
+        XCTAssertEqual(host.prewarmPlugins(), 0)
+        XCTAssertNil(host.findPluginForCap("cap:op=echo"))
+        XCTAssertFalse(advertisedCaps(host).contains("cap:op=echo"))
+        XCTAssertTrue(host.runningPlugins().isEmpty)
+    }
+}
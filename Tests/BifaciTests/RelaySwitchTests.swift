@@ -847,6 +847,127 @@ final class CborRelaySwitchTests: XCTestCase {
         // Shutdown switch - file handles closed by ARC
         switch_.shutdown()
     }
+
+    // MARK: - Sharded Routing Tests (TEST1260-1261)
+
+    // TEST1260: A master that stops reading stalls only writers to that master
+    func test1260_blockedMasterDoesNotStallOtherRoutes() throws {
+        let slowCap = "cap:in=\"media:void\";op=slow;out=\"media:void\""
+        let fastCap = "cap:in=\"media:void\";op=fast;out=\"media:void\""
+        let slow1 = FileHandle.socketPair()
+        let slow2 = FileHandle.socketPair()
+        let fast1 = FileHandle.socketPair()
+        let fast2 = FileHandle.socketPair()
+
+        let ready = DispatchSemaphore(value: 0)
+        let releaseSlow = DispatchSemaphore(value: 0)
+
+        // Slow master: verifies identity, then stops reading until released, then drains
+        DispatchQueue.global().async {
+            let reader = FrameReader(handle: slow2.read)
+            let writer = FrameWriter(handle: slow1.write)
+            try! self.sendNotify(writer: writer, capabilities: ["cap:in=media:;out=media:", slowCap], limits: Limits())
+            ready.signal()
+            try! self.handleIdentityVerification(reader: reader, writer: writer)
+            releaseSlow.wait()
+            while let frame = try? reader.read(), frame.frameType != .end {}
+        }
+
+        // Fast master: answers one REQ
+        DispatchQueue.global().async {
+            let reader = FrameReader(handle: fast2.read)
+            let writer = FrameWriter(handle: fast1.write)
+            try! self.sendNotify(writer: writer, capabilities: ["cap:in=media:;out=media:", fastCap], limits: Limits())
+            ready.signal()
+            try! self.handleIdentityVerification(reader: reader, writer: writer)
+            if let frame = try? reader.read(), frame.frameType == .req {
+                var response = Frame.end(id: frame.id, finalPayload: Data("fast".utf8))
+                response.routingId = frame.routingId
+                try! writer.write(response)
+            }
+        }
+
+        XCTAssertEqual(ready.wait(timeout: .now() + 2), .success)
+        XCTAssertEqual(ready.wait(timeout: .now() + 2), .success)
+
+        let switch_ = try RelaySwitch(sockets: [
+            SocketPair(read: slow1.read, write: slow2.write),
+            SocketPair(read: fast1.read, write: fast2.write),
+        ])
+
+        // Stream into the slow master until its socket buffer fills and the write blocks
+        let slowId = MessageId.uint(1)
+        try switch_.sendToMaster(Frame.req(id: slowId, capUrn: slowCap, payload: Data(), contentType: ""))
+        let slowDone = DispatchSemaphore(value: 0)
+        DispatchQueue.global().async {
+            let payload = Data(repeating: 0xAB, count: 64 * 1024)
+            for i in 0..<64 {
+                let chunk = Frame.chunk(reqId: slowId, streamId: "s", seq: 0, payload: payload,
+                                        chunkIndex: UInt64(i), checksum: Frame.computeChecksum(payload))
+                try? switch_.sendToMaster(chunk)
+            }
+            try? switch_.sendToMaster(Frame.end(id: slowId))
+            slowDone.signal()
+        }
+        XCTAssertEqual(slowDone.wait(timeout: .now() + 0.2), .timedOut, "Slow master should be applying backpressure")
+
+        // Routing to the fast master proceeds while the slow write is blocked
+        try switch_.sendToMaster(Frame.req(id: MessageId.uint(2), capUrn: fastCap, payload: Data(), contentType: ""))
+        let response = try switch_.readFromMasters(timeout: 2)
+        XCTAssertEqual(response?.payload, Data("fast".utf8))
+
+        releaseSlow.signal()
+        XCTAssertEqual(slowDone.wait(timeout: .now() + 5), .success)
+        switch_.shutdown()
+    }
+
+    // TEST1261: Concurrent flows from many threads land in the right shards and route back correctly
+    func test1261_concurrentFlowsRouteIndependently() throws {
+        let pair1 = FileHandle.socketPair()
+        let pair2 = FileHandle.socketPair()
+        let flows = 64
+
+        let ready = DispatchSemaphore(value: 0)
+        // Echo master: answers every REQ with its own payload
+        DispatchQueue.global().async {
+            let reader = FrameReader(handle: pair2.read)
+            let writer = FrameWriter(handle: pair1.write)
+            try! self.sendNotify(writer: writer, capabilities: ["cap:in=media:;out=media:"], limits: Limits())
+            ready.signal()
+            try! self.handleIdentityVerification(reader: reader, writer: writer)
+            for _ in 0..<flows {
+                guard let frame = try? reader.read(), frame.frameType == .req else { return }
+                var response = Frame.end(id: frame.id, finalPayload: frame.payload)
+                response.routingId = frame.routingId
+                try! writer.write(response)
+            }
+        }
+        XCTAssertEqual(ready.wait(timeout: .now() + 2), .success)
+
+        let switch_ = try RelaySwitch(sockets: [SocketPair(read: pair1.read, write: pair2.write)])
+
+        DispatchQueue.concurrentPerform(iterations: flows) { i in
+            let req = Frame.req(id: MessageId.uint(UInt64(100 + i)), capUrn: "cap:in=media:;out=media:",
+                                payload: Data("flow-\(i)".utf8), contentType: "")
+            XCTAssertNoThrow(try switch_.sendToMaster(req))
+        }
+
+        var seen = Set<String>()
+        for _ in 0..<flows {
+            guard let response = try switch_.readFromMasters(timeout: 5) else { return XCTFail("Timed out after \(seen.count)") }
+            guard case .uint(let id) = response.id else { return XCTFail("Unexpected id") }
+            XCTAssertEqual(response.payload, Data("flow-\(id - 100)".utf8))
+            XCTAssertNil(response.routingId, "XID is stripped for the engine")
+            seen.insert(response.id.toString())
+        }
+        XCTAssertEqual(seen.count, flows)
+
+        // Terminal responses cleared every flow: continuations are now unknown
+        XCTAssertThrowsError(try switch_.sendToMaster(Frame.end(id: MessageId.uint(100)))) { error in
+            guard case RelaySwitchError.unknownRequest = error else { return XCTFail("Expected unknownRequest, got \(error)") }
+        }
+        switch_.shutdown()
+    }
 }
 
 // Helper extension for creating socket pairs
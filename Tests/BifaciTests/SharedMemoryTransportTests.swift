@@ -0,0 +1,135 @@
+import XCTest
+@testable import Bifaci
+
+// =============================================================================
+// Shared Memory Transport Tests
+//
+// Ring put/take with wrap-around and back-pressure, CHUNK payloads staged in
+// the ring by FrameWriter and restored by FrameReader, and HELLO negotiation.
+// =============================================================================
+
+@available(macOS 10.15.4, iOS 13.4, *)
+final class SharedMemoryTransportTests: XCTestCase {
+
+    private func pattern(_ count: Int, seed: UInt8) -> Data {
+        Data((0..<count).map { UInt8(truncatingIfNeeded: $0 &* 13) &+ seed })
+    }
+
+    private func bigChunk(_ payload: Data) -> Frame {
+        Frame.chunk(reqId: MessageId.newUUID(), streamId: "s", seq: 0, payload: payload, chunkIndex: 0, checksum: Frame.computeChecksum(payload))
+    }
+
+    // TEST1340: Payloads wrap around the ring end and space returns as the receiver takes them
+    func test1340_ringWrapAndRelease() throws {
+        let sender = try SharedMemoryRing.create(capacity: 1000)
+        let receiver = try SharedMemoryRing.open(path: sender.path, capacity: 1000)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: sender.path), "Receiver unlinks the ring file")
+
+        let a = pattern(600, seed: 1)
+        let b = pattern(300, seed: 2)
+        let c = pattern(500, seed: 3)
+        let offA = try XCTUnwrap(sender.put(a))
+        let offB = try XCTUnwrap(sender.put(b))
+        XCTAssertNil(sender.put(c), "No room until the receiver takes something")
+
+        XCTAssertEqual(try receiver.take(offset: offA, length: a.count), a)
+        let offC = try XCTUnwrap(sender.put(c), "Space released by take is reusable")
+        XCTAssertEqual(offC, 1000, "Payload that would straddle the end starts at the next lap")
+        XCTAssertEqual(try receiver.take(offset: offB, length: b.count), b)
+        XCTAssertEqual(try receiver.take(offset: offC, length: c.count), c)
+        XCTAssertThrowsError(try receiver.take(offset: offA, length: a.count), "Offsets behind the cursor are rejected")
+    }
+
+    // TEST1341: Large CHUNKs travel through the ring, small ones inline, and both arrive intact
+    func test1341_writerStagesReaderRestores() throws {
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        let ring = try SharedMemoryRing.create(capacity: 1 << 20)
+        writer.attachSharedMemoryRing(ring)
+        reader.attachSharedMemoryRing(try SharedMemoryRing.open(path: ring.path, capacity: ring.capacity))
+
+        let large = pattern(200_000, seed: 7)
+        let small = pattern(100, seed: 9)
+        for payload in [large, small, large] {
+            try writer.write(bigChunk(payload))
+            let frame = try XCTUnwrap(try reader.read())
+            XCTAssertEqual(frame.payload, payload)
+            XCTAssertNil(frame.meta, "Ring bookkeeping is stripped on restore")
+            XCTAssertTrue(frame.hasValidChecksum())
+        }
+    }
+
+    // TEST1342: A ring CHUNK on a link that never negotiated a ring is a protocol error
+    func test1342_ringChunkWithoutRingRejected() throws {
+        let pipe = Pipe()
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        let ring = try SharedMemoryRing.create(capacity: 1 << 20)
+        writer.attachSharedMemoryRing(ring)
+        // Mapped elsewhere, so the writer stages into it, but never attached to this reader
+        let elsewhere = try SharedMemoryRing.open(path: ring.path, capacity: ring.capacity)
+
+        try writer.write(bigChunk(pattern(SHARED_MEMORY_MIN_PAYLOAD, seed: 4)))
+        XCTAssertThrowsError(try reader.read())
+        withExtendedLifetime(elsewhere) {}
+    }
+
+    // TEST1343: Both directions switch over only when both HELLOs offer a ring
+    func test1343_handshakeNegotiatesRing() throws {
+        for pluginOffers in [true, false] {
+            let hostToPlugin = Pipe()
+            let pluginToHost = Pipe()
+            let hostReader = FrameReader(handle: pluginToHost.fileHandleForReading)
+            let hostWriter = FrameWriter(handle: hostToPlugin.fileHandleForWriting, limits: Limits(sharedMemoryRing: 1 << 20))
+            let pluginReader = FrameReader(handle: hostToPlugin.fileHandleForReading)
+            let pluginWriter = FrameWriter(handle: pluginToHost.fileHandleForWriting, limits: Limits(sharedMemoryRing: pluginOffers ? 1 << 20 : 0))
+
+            let manifest = Data("{\"name\":\"Shm\",\"version\":\"1.0\",\"caps\":[]}".utf8)
+            var pluginLimits: Limits?
+            let done = DispatchSemaphore(value: 0)
+            DispatchQueue.global().async {
+                pluginLimits = try? acceptHandshakeWithManifest(reader: pluginReader, writer: pluginWriter, manifest: manifest)
+                done.signal()
+            }
+            let result = try performHandshakeWithManifest(reader: hostReader, writer: hostWriter)
+            XCTAssertEqual(done.wait(timeout: .now() + 5), .success)
+
+            XCTAssertEqual(result.limits.sharedMemoryRing > 0, pluginOffers)
+            XCTAssertEqual((pluginLimits?.sharedMemoryRing ?? 0) > 0, pluginOffers)
+
+            // Payload arrives either way (small enough to sit in the pipe buffer when inline)
+            let payload = pattern(SHARED_MEMORY_MIN_PAYLOAD + 1000, seed: 5)
+            try hostWriter.write(bigChunk(payload))
+            XCTAssertEqual(try pluginReader.read()?.payload, payload)
+            try pluginWriter.write(bigChunk(payload))
+            XCTAssertEqual(try hostReader.read()?.payload, payload)
+        }
+    }
+
+    // TEST1406: A peer ring the host can't map leaves both directions inline instead of failing the handshake
+    func test1406_unmappablePeerRingFallsBackInline() throws {
+        let pipe = Pipe()
+        let reader = FrameReader(handle: pipe.fileHandleForReading)
+        let writer = FrameWriter(handle: pipe.fileHandleForWriting)
+        let ours = try SharedMemoryRing.create(capacity: 1 << 20)
+
+        // The plugin's ring, already attached on its side, whose file is gone
+        let theirs = try SharedMemoryRing.create(capacity: 1 << 20)
+        theirs.unlinkFile()
+        var theirHello = Frame.hello(limits: Limits())
+        theirHello.advertiseSharedMemoryRing(theirs)
+
+        XCTAssertEqual(completeSharedMemoryOffer(ours, theirHello: theirHello, reader: reader, writer: writer), 0)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: ours.path), "Our unused offer is unlinked")
+
+        // The plugin side keeps its CHUNKs inline: the host never flagged its ring as mapped
+        let pluginPipe = Pipe()
+        let pluginWriter = FrameWriter(handle: pluginPipe.fileHandleForWriting)
+        pluginWriter.attachSharedMemoryRing(theirs)
+        let payload = pattern(SHARED_MEMORY_MIN_PAYLOAD + 1000, seed: 6)
+        try pluginWriter.write(bigChunk(payload))
+        XCTAssertEqual(try FrameReader(handle: pluginPipe.fileHandleForReading).read()?.payload, payload)
+        XCTAssertNil(theirs.put(payload))
+    }
+}
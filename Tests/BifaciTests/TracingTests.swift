@@ -0,0 +1,113 @@
+import XCTest
+@testable import Bifaci
+@testable import CapDAG
+
+// =============================================================================
+// Tracing Tests
+//
+// Trace context in frame meta: span recording and latency segments, wire
+// round trip, the span cap, and a trace coming back on an in-process handler's
+// terminal frame.
+// =============================================================================
+
+@available(macOS 10.15.4, iOS 13.4, *)
+final class TracingTests: XCTestCase {
+
+    /// Drains its input, then fails (terminal frame is an ERR carrying meta of its own)
+    private final class DrainThenFailHandler: FrameHandler {
+        func handleRequest(capUrn: String, inputStream: AsyncStream<Frame>, output: ResponseWriter) {
+            Task {
+                for await frame in inputStream where frame.frameType == .end { break }
+                output.emitError(code: "TRACED_FAILURE", message: "expected")
+            }
+        }
+    }
+
+    // TEST1360: Spans are appended only to traced frames and pair up into segments
+    func test1360_spansAndSegments() throws {
+        var untraced = Frame.req(id: MessageId.newUUID(), capUrn: "cap:op=t", payload: Data(), contentType: "application/cbor")
+        untraced.recordTraceSpan(hop: TraceHop.relaySwitch, event: "route")
+        XCTAssertNil(untraced.traceContext)
+        XCTAssertNil(untraced.meta?[TRACE_META_KEY])
+
+        var req = untraced
+        req.startTrace(traceId: "t-1")
+        req.recordTraceSpan(hop: TraceHop.relaySwitch, event: "route")
+        req.recordTraceSpan(hop: TraceHop.pluginHost, event: "dispatch")
+
+        let trace = try XCTUnwrap(req.traceContext)
+        XCTAssertEqual(trace.traceId, "t-1")
+        XCTAssertEqual(trace.spans.map { "\($0.hop).\($0.event)" }, ["engine.send", "relay_switch.route", "plugin_host.dispatch"])
+        XCTAssertEqual(trace.segments.count, 2)
+        XCTAssertEqual(trace.segments[0].label, "engine.send → relay_switch.route")
+        XCTAssertGreaterThanOrEqual(trace.totalMicros, 0)
+
+        let fixed = TraceContext(traceId: "x", spans: [
+            TraceSpan(hop: "a", event: "in", timestampMicros: 100),
+            TraceSpan(hop: "b", event: "out", timestampMicros: 350),
+        ])
+        XCTAssertEqual(fixed.segments.first?.micros, 250)
+
+        req.traceContext = nil
+        XCTAssertNil(req.meta, "Clearing the only meta entry drops meta")
+    }
+
+    // TEST1361: A trace survives the wire next to other meta on an ERR
+    func test1361_traceWireRoundTrip() throws {
+        var err = Frame.err(id: MessageId.newUUID(), code: "SOME_CODE", message: "boom")
+        err.traceContext = TraceContext(traceId: "wire", spans: [TraceSpan(hop: TraceHop.plugin, event: "handler_end", timestampMicros: 42)])
+
+        let pipe = Pipe()
+        try FrameWriter(handle: pipe.fileHandleForWriting).write(err)
+        let decoded = try XCTUnwrap(try FrameReader(handle: pipe.fileHandleForReading).read())
+
+        XCTAssertEqual(decoded.errorCode, "SOME_CODE")
+        XCTAssertEqual(decoded.traceContext, err.traceContext)
+    }
+
+    // TEST1362: A trace stops growing at MAX_TRACE_SPANS
+    func test1362_spanCap() throws {
+        var req = Frame.req(id: MessageId.newUUID(), capUrn: "cap:op=loop", payload: Data(), contentType: "application/cbor")
+        req.startTrace()
+        for _ in 0..<(MAX_TRACE_SPANS + 10) {
+            req.recordTraceSpan(hop: TraceHop.relaySwitch, event: "route")
+        }
+        XCTAssertEqual(req.traceContext?.spans.count, MAX_TRACE_SPANS)
+    }
+
+    // TEST1363: InProcessPluginHost returns the REQ's trace on the handler's terminal frame
+    func test1363_inProcessHostReturnsTrace() throws {
+        let capUrn = "cap:in=\"media:text\";op=traced;out=\"media:text\""
+        let cap = CSCap(urn: try CSCapUrn.fromString(capUrn), title: "traced", command: "")
+        let host = InProcessPluginHost(handlers: [("traced", [cap], DrainThenFailHandler())])
+
+        let (hostRead, testWrite) = Pipe.socketPair()
+        let (testRead, hostWrite) = Pipe.socketPair()
+        let hostThread = Thread {
+            try? host.run(localRead: hostRead, localWrite: hostWrite)
+        }
+        hostThread.start()
+
+        let reader = FrameReader(handle: testRead)
+        let writer = FrameWriter(handle: testWrite)
+        XCTAssertEqual(try reader.read()?.frameType, .relayNotify)
+
+        let rid = MessageId.newUUID()
+        var req = Frame.req(id: rid, capUrn: capUrn, payload: Data(), contentType: "application/cbor")
+        req.routingId = MessageId.uint(1)
+        req.startTrace(traceId: "in-process")
+        try writer.write(req)
+        try writer.write(Frame.end(id: rid))
+
+        let response = try XCTUnwrap(try reader.read())
+        XCTAssertEqual(response.frameType, .err)
+        XCTAssertEqual(response.errorCode, "TRACED_FAILURE")
+        let trace = try XCTUnwrap(response.traceContext)
+        XCTAssertEqual(trace.traceId, "in-process")
+        XCTAssertEqual(trace.spans.map { $0.event }, ["send", "req_received", "handler_end"])
+
+        testWrite.closeFile()
+        testRead.closeFile()
+        Thread.sleep(forTimeInterval: 0.1)
+    }
+}
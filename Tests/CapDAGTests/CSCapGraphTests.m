@@ -319,4 +319,65 @@
     XCTAssertEqualObjects(path[1].registryName, @"plugins", @"Second edge from plugins");
 }
 
+// Helper: a cap from inSpec to outSpec with extra tags raising its specificity
+- (CSCap *)makeGraphCapWithInSpec:(NSString *)inSpec outSpec:(NSString *)outSpec extraTags:(NSString *)extraTags {
+    NSString *urnString = [NSString stringWithFormat:@"cap:%@in=\"%@\";op=convert;out=\"%@\"", extraTags, inSpec, outSpec];
+    CSCapUrn *capUrn = [CSCapUrn fromString:urnString error:nil];
+    return [CSCap capWithUrn:capUrn title:urnString command:@"convert"];
+}
+
+- (CSCapGraph *)makeScoredGraph {
+    CSCapGraph *graph = [CSCapGraph graph];
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:a" outSpec:@"media:b" extraTags:@""] registryName:@"r"];
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:b" outSpec:@"media:d" extraTags:@""] registryName:@"r"];
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:a" outSpec:@"media:c" extraTags:@"quality=high;variant=x;"] registryName:@"r"];
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:c" outSpec:@"media:d" extraTags:@"quality=high;"] registryName:@"r"];
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:a" outSpec:@"media:d" extraTags:@""] registryName:@"r"];
+    return graph;
+}
+
+// TEST1382: findBestPath returns the highest-specificity path without enumerating all paths
+- (void)test1382FindBestPathMatchesExhaustiveScoring {
+    CSCapGraph *graph = [self makeScoredGraph];
+
+    NSInteger bestScore = -1;
+    for (NSArray<CSCapGraphEdge *> *path in [graph findAllPaths:@"media:a" toSpec:@"media:d" maxDepth:4]) {
+        NSInteger score = 0;
+        for (CSCapGraphEdge *edge in path) score += edge.specificity;
+        bestScore = MAX(bestScore, score);
+    }
+
+    NSArray<CSCapGraphEdge *> *best = [graph findBestPath:@"media:a" toSpec:@"media:d" maxDepth:4];
+    XCTAssertEqual(best.count, 2u);
+    XCTAssertEqualObjects(best[0].toSpec, @"media:c");
+    NSInteger score = 0;
+    for (CSCapGraphEdge *edge in best) score += edge.specificity;
+    XCTAssertEqual(score, bestScore);
+
+    // Depth 1 leaves only the direct edge
+    NSArray<CSCapGraphEdge *> *shallow = [graph findBestPath:@"media:a" toSpec:@"media:d" maxDepth:1];
+    XCTAssertEqual(shallow.count, 1u);
+    XCTAssertNil([graph findBestPath:@"media:d" toSpec:@"media:a" maxDepth:4]);
+}
+
+// TEST1383: Top-k paths come back best first; canConvert sees caps added after a query
+- (void)test1383FindBestPathsAndCanConvertCache {
+    CSCapGraph *graph = [self makeScoredGraph];
+
+    NSArray<NSArray<CSCapGraphEdge *> *> *top = [graph findBestPaths:@"media:a" toSpec:@"media:d" maxDepth:4 limit:2];
+    XCTAssertEqual(top.count, 2u);
+    NSInteger first = 0, second = 0;
+    for (CSCapGraphEdge *edge in top[0]) first += edge.specificity;
+    for (CSCapGraphEdge *edge in top[1]) second += edge.specificity;
+    XCTAssertGreaterThanOrEqual(first, second);
+
+    NSArray *all = [graph findBestPaths:@"media:a" toSpec:@"media:d" maxDepth:4 limit:10];
+    XCTAssertEqual(all.count, [graph findAllPaths:@"media:a" toSpec:@"media:d" maxDepth:4].count);
+
+    XCTAssertFalse([graph canConvert:@"media:a" toSpec:@"media:e"]);
+    [graph addCap:[self makeGraphCapWithInSpec:@"media:d" outSpec:@"media:e" extraTags:@""] registryName:@"r"];
+    XCTAssertTrue([graph canConvert:@"media:a" toSpec:@"media:e"]);
+    XCTAssertTrue([graph canConvert:@"media:c" toSpec:@"media:e"]);
+}
+
 @end
@@ -267,6 +267,95 @@ static NSString* testMatrixUrn(NSString *tags) {
     XCTAssertEqual(all.count, 3);
 }
 
+// TEST1374: Indexed lookup agrees with a full accepts: scan across op, in and out variants
+- (void)test1374_indexed_lookup_matches_full_scan {
+    NSDictionary<NSString *, NSArray<NSString *> *> *setCaps = @{
+        @"exact-op": @[@"cap:in=\"media:pdf\";op=extract;out=\"media:record;textable\""],
+        @"wildcard-op": @[@"cap:in=\"media:pdf\";op=*;out=\"media:record;textable\""],
+        @"no-op": @[@"cap:in=\"media:pdf\";out=\"media:textable\""],
+        @"any-in": @[@"cap:in=media:;op=extract;out=media:"],
+        @"image": @[@"cap:in=\"media:image;png\";op=extract;out=\"media:record;textable\"",
+                    @"cap:in=\"media:image;jpeg\";op=resize;out=\"media:image;jpeg\""],
+    };
+    NSMutableDictionary<NSString *, MockCapSet *> *hosts = [NSMutableDictionary dictionary];
+    for (NSString *name in setCaps) {
+        NSMutableArray<CSCap *> *caps = [NSMutableArray array];
+        for (NSString *urn in setCaps[name]) {
+            [caps addObject:makeCap(urn, name)];
+        }
+        hosts[name] = [[MockCapSet alloc] initWithName:name];
+        XCTAssertTrue([self.registry registerCapSet:name host:hosts[name] capabilities:caps error:nil]);
+    }
+
+    NSArray<NSString *> *requests = @[
+        @"cap:in=\"media:pdf\";op=extract;out=\"media:record;textable\"",
+        @"cap:in=\"media:pdf\";op=*;out=\"media:textable\"",
+        @"cap:in=\"media:pdf\";out=media:",
+        @"cap:in=\"media:image;png\";op=extract;out=\"media:record\"",
+        @"cap:in=\"media:image;jpeg\";op=resize;out=\"media:image\"",
+        @"cap:in=media:;op=extract;out=media:",
+        @"cap:in=\"media:void\";op=summarize;out=media:",
+    ];
+    for (NSString *requestString in requests) {
+        CSCapUrn *request = [CSCapUrn fromString:requestString error:nil];
+        XCTAssertNotNil(request);
+
+        NSMutableSet<NSString *> *expected = [NSMutableSet set];
+        for (NSString *name in setCaps) {
+            for (NSString *urn in setCaps[name]) {
+                if ([[CSCapUrn fromString:urn error:nil] accepts:request]) {
+                    [expected addObject:name];
+                    break;
+                }
+            }
+        }
+
+        NSMutableSet<NSString *> *found = [NSMutableSet set];
+        for (MockCapSet *host in [self.registry findCapSets:requestString error:nil]) {
+            [found addObject:host.name];
+        }
+        XCTAssertEqualObjects(found, expected, @"findCapSets mismatch for %@", requestString);
+        XCTAssertEqual([self.registry acceptsRequest:requestString], expected.count > 0, @"acceptsRequest mismatch for %@", requestString);
+    }
+}
+
+// TEST1375: Unregistering a set removes only its caps from the index
+- (void)test1375_unregister_updates_index {
+    MockCapSet *first = [[MockCapSet alloc] initWithName:@"first"];
+    MockCapSet *second = [[MockCapSet alloc] initWithName:@"second"];
+    [self.registry registerCapSet:@"first" host:first capabilities:@[makeCap(testMatrixUrn(@"op=shared"), @"A"), makeCap(testMatrixUrn(@"op=only_first"), @"B")] error:nil];
+    [self.registry registerCapSet:@"second" host:second capabilities:@[makeCap(testMatrixUrn(@"op=shared"), @"C")] error:nil];
+
+    XCTAssertEqual([self.registry findCapSets:testMatrixUrn(@"op=shared") error:nil].count, 2u);
+    XCTAssertTrue([self.registry unregisterCapSet:@"first"]);
+
+    NSArray *remaining = [self.registry findCapSets:testMatrixUrn(@"op=shared") error:nil];
+    XCTAssertEqual(remaining.count, 1u);
+    XCTAssertEqual(remaining.firstObject, second);
+    XCTAssertFalse([self.registry acceptsRequest:testMatrixUrn(@"op=only_first")]);
+
+    // The name can be registered again and is indexed afresh
+    XCTAssertTrue([self.registry registerCapSet:@"first" host:first capabilities:@[makeCap(testMatrixUrn(@"op=only_first"), @"B")] error:nil]);
+    XCTAssertTrue([self.registry acceptsRequest:testMatrixUrn(@"op=only_first")]);
+}
+
+// TEST1376: findBestCapSet ranks each set by its first matching cap; ties keep the earlier set
+- (void)test1376_best_cap_set_ranking {
+    MockCapSet *generic = [[MockCapSet alloc] initWithName:@"generic"];
+    MockCapSet *specific = [[MockCapSet alloc] initWithName:@"specific"];
+    MockCapSet *tied = [[MockCapSet alloc] initWithName:@"tied"];
+    CSCap *genericCap = makeCap(testMatrixUrn(@"op=generate"), @"generic");
+    CSCap *specificCap = makeCap(testMatrixUrn(@"ext=pdf;op=generate"), @"specific");
+    [self.registry registerCapSet:@"generic" host:generic capabilities:@[genericCap, makeCap(testMatrixUrn(@"ext=pdf;format=x;op=generate"), @"hidden")] error:nil];
+    [self.registry registerCapSet:@"specific" host:specific capabilities:@[specificCap] error:nil];
+    [self.registry registerCapSet:@"tied" host:tied capabilities:@[makeCap(testMatrixUrn(@"ext=pdf;op=generate"), @"tied")] error:nil];
+
+    CSCap *definition = nil;
+    id<CSCapSet> best = [self.registry findBestCapSet:testMatrixUrn(@"ext=pdf;format=x;op=generate") error:nil capDefinition:&definition];
+    XCTAssertEqual(best, specific, @"generic competes with its first matching cap only; specific registered before tied");
+    XCTAssertEqual(definition, specificCap);
+}
+
 // TEST127: CapGraph basic construction
 - (void)test127_cap_graph_basic_construction {
     CSCapGraph *graph = [CSCapGraph graph];
@@ -1399,4 +1399,83 @@ static NSString* testUrn(NSString *tags) {
                   @"Thumbnail fallback with void input should match");
 }
 
+#pragma mark - Interning Tests
+
+// TEST1370: Repeated parses of the same string return the interned instance
+- (void)test1370_fromStringInternsInstances {
+    NSError *error = nil;
+    NSString *urn = testUrn(@"op=intern_probe");
+    CSCapUrn *first = [CSCapUrn fromString:urn error:&error];
+    XCTAssertNotNil(first);
+    CSCapUrn *second = [CSCapUrn fromString:[urn mutableCopy] error:&error];
+    XCTAssertTrue(first == second, @"Same string must yield the same instance");
+
+    // Failed parses are not cached: the error is reported every time
+    NSString *bad = @"cap:in=\"media:void\";op=;out=\"media:void\"";
+    error = nil;
+    XCTAssertNil([CSCapUrn fromString:bad error:&error]);
+    XCTAssertNotNil(error);
+    error = nil;
+    XCTAssertNil([CSCapUrn fromString:bad error:&error]);
+    XCTAssertNotNil(error);
+
+    [CSCapUrn clearInternCache];
+    CSCapUrn *reparsed = [CSCapUrn fromString:urn error:&error];
+    XCTAssertFalse(first == reparsed, @"Clearing the cache forces a fresh parse");
+    XCTAssertEqualObjects(first, reparsed);
+    XCTAssertEqual(first.hash, reparsed.hash);
+}
+
+// TEST1371: Precomputed specificity and hash agree with values built another way
+- (void)test1371_precomputedSpecificityAndHash {
+    NSError *error = nil;
+    CSCapUrn *parsed = [CSCapUrn fromString:@"cap:in=\"media:pdf\";op=extract;out=\"media:record;textable\";target=*" error:&error];
+    XCTAssertNotNil(parsed);
+    // in: 1 tag, out: 2 tags, op: exact, target: wildcard (not counted)
+    XCTAssertEqual([parsed specificity], 4);
+
+    CSCapUrn *built = [[[[[[CSCapUrnBuilder builder] inSpec:@"media:pdf"] outSpec:@"media:record;textable"]
+                         tag:@"target" value:@"*"] tag:@"op" value:@"extract"] build:&error];
+    XCTAssertNotNil(built);
+    XCTAssertFalse(parsed == built);
+    XCTAssertEqualObjects(parsed, built);
+    XCTAssertEqual(parsed.hash, built.hash);
+    XCTAssertEqual([built specificity], [parsed specificity]);
+
+    CSCapUrn *other = [parsed withTag:@"op" value:@"summarize"];
+    XCTAssertNotEqualObjects(parsed, other);
+    XCTAssertEqual([other specificity], [parsed specificity]);
+
+    NSSet *set = [NSSet setWithObjects:parsed, built, other, nil];
+    XCTAssertEqual(set.count, 2u);
+}
+
+// TEST1372: Concurrent parses of the same strings all resolve to one instance per string
+- (void)test1372_concurrentInterning {
+    [CSCapUrn clearInternCache];
+    NSUInteger distinct = 16;
+    NSMutableArray<NSString *> *urns = [NSMutableArray array];
+    for (NSUInteger i = 0; i < distinct; i++) {
+        [urns addObject:testUrn([NSString stringWithFormat:@"op=concurrent%lu", (unsigned long)i])];
+    }
+
+    NSMutableArray *results = [NSMutableArray array];
+    for (NSUInteger i = 0; i < distinct; i++) {
+        [results addObject:[NSMutableSet set]];
+    }
+    NSLock *resultsLock = [[NSLock alloc] init];
+
+    dispatch_apply(256, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        NSUInteger index = iteration % distinct;
+        CSCapUrn *urn = [CSCapUrn fromString:urns[index] error:nil];
+        [resultsLock lock];
+        [results[index] addObject:[NSValue valueWithNonretainedObject:urn]];
+        [resultsLock unlock];
+    });
+
+    for (NSUInteger i = 0; i < distinct; i++) {
+        XCTAssertEqual([results[i] count], 1u, @"Every thread must get the interned instance for %@", urns[i]);
+    }
+}
+
 @end
@@ -0,0 +1,326 @@
+//
+//  CSExecutorTests.m
+//  CapDAGTests
+//
+//  Tests for CSMachineExecutor scheduling: independent nodes run
+//  concurrently within the parallelism and per-cap limits, a failure
+//  stops the run, and ForEach bodies stream through a bounded window.
+//
+
+#import <XCTest/XCTest.h>
+#import "CapDAG.h"
+
+// Mock backend: every cap takes `delay` seconds and records peak concurrency
+@interface MockTimedCapExecutor : NSObject <CSCapExecutorProtocol>
+@property (nonatomic, assign) NSTimeInterval delay;
+@property (nonatomic, copy, nullable) NSString *failingCapUrn;
+/// First argument value -> delay overriding `delay`; the response echoes that value
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSNumber *> *delaysByArgument;
+/// First argument value whose invocation fails
+@property (nonatomic, copy, nullable) NSString *failingArgument;
+@property (nonatomic, assign) NSUInteger running;
+@property (nonatomic, assign) NSUInteger peakRunning;
+@property (nonatomic, assign) NSUInteger completed;
+/// Invocations that started before any invocation had finished
+@property (nonatomic, assign) NSUInteger startedBeforeFirstCompletion;
+@end
+
+@implementation MockTimedCapExecutor
+
+- (void)executeCapWithUrn:(NSString *)capUrn
+                arguments:(NSArray<NSDictionary *> *)arguments
+            preferredCap:(nullable NSString *)preferredCap
+              completion:(void (^)(NSData * _Nullable output, NSError * _Nullable error))completion {
+    @synchronized (self) {
+        self.running += 1;
+        self.peakRunning = MAX(self.peakRunning, self.running);
+        if (self.completed == 0) self.startedBeforeFirstCompletion += 1;
+    }
+    NSData *argumentData = arguments.firstObject[@"value"];
+    NSString *argument = argumentData ? [[NSString alloc] initWithData:argumentData encoding:NSUTF8StringEncoding] : nil;
+    NSTimeInterval delay = argument && self.delaysByArgument[argument] ? self.delaysByArgument[argument].doubleValue : self.delay;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
+                   dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        @synchronized (self) {
+            self.running -= 1;
+            self.completed += 1;
+        }
+        if ([capUrn isEqualToString:self.failingCapUrn] || (argument && [argument isEqualToString:self.failingArgument])) {
+            completion(nil, [NSError errorWithDomain:@"MockTimedCapExecutor" code:1
+                                            userInfo:@{NSLocalizedDescriptionKey: @"cap failed"}]);
+            return;
+        }
+        if (argument) {
+            completion([NSJSONSerialization dataWithJSONObject:@{@"value": argument} options:0 error:nil], nil);
+            return;
+        }
+        completion([@"{\"ok\":true}" dataUsingEncoding:NSUTF8StringEncoding], nil);
+    });
+}
+
+- (void)hasCap:(NSString *)capUrn completion:(void (^)(BOOL has))completion {
+    completion(YES);
+}
+
+- (void)getCap:(NSString *)capUrn completion:(void (^)(CSCap * _Nullable cap, NSError * _Nullable error))completion {
+    completion([CSCap capWithUrn:[CSCapUrn fromString:capUrn error:nil] title:capUrn command:@"test"], nil);
+}
+
+@end
+
+@interface CSExecutorTests : XCTestCase
+@end
+
+// Helper: input slot fanned out to `width` independent cap nodes, each with its own output
+static CSMachinePlan *buildFanOutPlan(NSArray<NSString *> *capUrns) {
+    CSMachinePlan *plan = [CSMachinePlan planWithName:@"Fan-out test plan"];
+    [plan addNode:[CSMachineNode inputSlotNode:@"input_slot" slotName:@"input" mediaUrn:@"media:pdf" cardinality:CSInputCardinalitySingle]];
+    for (NSUInteger i = 0; i < capUrns.count; i++) {
+        NSString *capId = [NSString stringWithFormat:@"cap_%lu", (unsigned long)i];
+        NSString *outputId = [NSString stringWithFormat:@"output_%lu", (unsigned long)i];
+        [plan addNode:[CSMachineNode capNode:capId capUrn:capUrns[i]]];
+        [plan addNode:[CSMachineNode outputNode:outputId outputName:outputId sourceNode:capId]];
+        [plan addEdge:[CSMachinePlanEdge directFrom:@"input_slot" to:capId]];
+        [plan addEdge:[CSMachinePlanEdge directFrom:capId to:outputId]];
+    }
+    return plan;
+}
+
+// Helper: list input -> ForEach over a cap reading each item's file path -> Collect -> output
+static CSMachinePlan *buildForEachPlan(NSString *capUrn) {
+    CSMachinePlan *plan = [CSMachinePlan planWithName:@"ForEach test plan"];
+    [plan addNode:[CSMachineNode inputSlotNode:@"input_slot" slotName:@"input" mediaUrn:@"media:pdf;list" cardinality:CSInputCardinalitySequence]];
+    [plan addNode:[CSMachineNode forEachNode:@"foreach" inputNode:@"input_slot" bodyEntry:@"body_cap" bodyExit:@"body_cap"]];
+    [plan addNode:[CSMachineNode capNode:@"body_cap" capUrn:capUrn bindings:@{@"media:file-path": [CSArgumentBinding inputFilePath]}]];
+    [plan addNode:[CSMachineNode collectNode:@"collect" inputNodes:@[@"body_cap"]]];
+    [plan addNode:[CSMachineNode outputNode:@"output" outputName:@"results" sourceNode:@"collect"]];
+    [plan addEdge:[CSMachinePlanEdge directFrom:@"input_slot" to:@"foreach"]];
+    [plan addEdge:[CSMachinePlanEdge iterationFrom:@"foreach" to:@"body_cap"]];
+    [plan addEdge:[CSMachinePlanEdge collectionFrom:@"body_cap" to:@"collect"]];
+    [plan addEdge:[CSMachinePlanEdge directFrom:@"collect" to:@"output"]];
+    return plan;
+}
+
+static NSArray<CSCapInputFile *> *buildItemFiles(NSUInteger count) {
+    NSMutableArray<CSCapInputFile *> *files = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [files addObject:[CSCapInputFile withFilePath:[NSString stringWithFormat:@"/tmp/item%lu.pdf", (unsigned long)i] mediaUrn:@"media:pdf"]];
+    }
+    return files;
+}
+
+@implementation CSExecutorTests
+
+- (CSMachineResult *)runPlan:(CSMachinePlan *)plan configure:(void (^)(CSMachineExecutor *executor))configure backend:(MockTimedCapExecutor *)backend {
+    CSCapInputFile *input = [CSCapInputFile withFilePath:@"/tmp/input.pdf" mediaUrn:@"media:pdf"];
+    return [self runPlan:plan inputFiles:@[input] configure:configure backend:backend];
+}
+
+- (CSMachineResult *)runPlan:(CSMachinePlan *)plan inputFiles:(NSArray<CSCapInputFile *> *)inputFiles configure:(void (^)(CSMachineExecutor *executor))configure backend:(MockTimedCapExecutor *)backend {
+    CSMachineExecutor *executor = [[CSMachineExecutor alloc] initWithExecutor:backend plan:plan inputFiles:inputFiles];
+    if (configure) configure(executor);
+
+    XCTestExpectation *done = [self expectationWithDescription:@"execute"];
+    __block CSMachineResult *result = nil;
+    [executor execute:^(CSMachineResult * _Nullable machineResult, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        result = machineResult;
+        [done fulfill];
+    }];
+    [self waitForExpectations:@[done] timeout:10];
+    return result;
+}
+
+// TEST1384: Independent branches run concurrently; parallelism 1 serializes them
+- (void)test1384FanOutRunsConcurrently {
+    NSArray *caps = @[@"cap:in=media:pdf;op=a;out=media:text", @"cap:in=media:pdf;op=b;out=media:text", @"cap:in=media:pdf;op=c;out=media:text"];
+
+    MockTimedCapExecutor *parallel = [[MockTimedCapExecutor alloc] init];
+    parallel.delay = 0.2;
+    CSMachineResult *result = [self runPlan:buildFanOutPlan(caps) configure:nil backend:parallel];
+    XCTAssertTrue(result.success, @"%@", result.error);
+    XCTAssertEqual(parallel.peakRunning, 3u);
+    XCTAssertEqual(result.nodeResults.count, 7u);
+    XCTAssertEqualObjects(result.nodeResults.firstObject.nodeId, @"input_slot", @"Results come back in topological order");
+    // Every branch starts before each sibling finishes
+    for (CSNodeExecutionResult *a in result.nodeResults) {
+        if (![a.nodeId hasPrefix:@"cap_"]) continue;
+        for (CSNodeExecutionResult *b in result.nodeResults) {
+            if (![b.nodeId hasPrefix:@"cap_"] || a == b) continue;
+            XCTAssertLessThan(a.startOffsetMs, b.startOffsetMs + b.durationMs, @"%@ starts after %@ finished", a.nodeId, b.nodeId);
+        }
+    }
+
+    MockTimedCapExecutor *serial = [[MockTimedCapExecutor alloc] init];
+    serial.delay = 0.05;
+    result = [self runPlan:buildFanOutPlan(caps) configure:^(CSMachineExecutor *executor) {
+        [executor withMaxParallelism:1];
+    } backend:serial];
+    XCTAssertTrue(result.success);
+    XCTAssertEqual(serial.peakRunning, 1u);
+}
+
+// TEST1385: A per-cap limit bounds concurrent invocations of that cap only
+- (void)test1385PerCapConcurrencyLimit {
+    NSString *limited = @"cap:in=media:pdf;op=limited;out=media:text";
+    NSArray *caps = @[limited, limited, limited, @"cap:in=media:pdf;op=free;out=media:text"];
+
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.1;
+    CSMachineResult *result = [self runPlan:buildFanOutPlan(caps) configure:^(CSMachineExecutor *executor) {
+        [executor withCapConcurrencyLimits:@{limited: @1}];
+    } backend:backend];
+
+    XCTAssertTrue(result.success, @"%@", result.error);
+    XCTAssertEqual(backend.peakRunning, 2u, @"One limited invocation alongside the free cap");
+    for (CSNodeExecutionResult *nodeResult in result.nodeResults) {
+        XCTAssertLessThanOrEqual(nodeResult.startOffsetMs, result.totalDurationMs);
+    }
+}
+
+// TEST1386: A failing node fails the run and its dependents never start
+- (void)test1386FailureStopsDependents {
+    NSString *failing = @"cap:in=media:pdf;op=broken;out=media:text";
+    NSArray *caps = @[failing, @"cap:in=media:pdf;op=fine;out=media:text"];
+
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.01;
+    backend.failingCapUrn = failing;
+    CSMachineResult *result = [self runPlan:buildFanOutPlan(caps) configure:nil backend:backend];
+
+    XCTAssertFalse(result.success);
+    XCTAssertTrue([result.error containsString:@"cap_0"], @"%@", result.error);
+    for (CSNodeExecutionResult *nodeResult in result.nodeResults) {
+        XCTAssertNotEqualObjects(nodeResult.nodeId, @"output_0");
+    }
+}
+
+// TEST1387: ForEach item bodies run concurrently, bounded by the window
+- (void)test1387ForEachRunsItemsWithinWindow {
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.1;
+    CSMachineResult *result = [self runPlan:buildForEachPlan(@"cap:in=media:pdf;op=extract;out=media:text")
+                                 inputFiles:buildItemFiles(8)
+                                  configure:^(CSMachineExecutor *executor) {
+        [executor withForEachWindow:3];
+    } backend:backend];
+
+    XCTAssertTrue(result.success, @"%@", result.error);
+    XCTAssertEqual(backend.peakRunning, 3u);
+    XCTAssertEqual(backend.startedBeforeFirstCompletion, 3u, @"A full window starts before any item finishes, and no more");
+    NSArray<NSString *> *nodeIds = [result.nodeResults valueForKey:@"nodeId"];
+    XCTAssertEqualObjects(nodeIds, (@[@"input_slot", @"foreach", @"collect", @"output"]), @"Per-item body runs are not top-level results");
+}
+
+// TEST1388: Collect receives every item's body output in item order, whatever order they finish in
+- (void)test1388ForEachCollectPreservesItemOrder {
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.01;
+    backend.delaysByArgument = @{@"/tmp/item0.pdf": @0.2, @"/tmp/item1.pdf": @0.1};
+    CSMachineResult *result = [self runPlan:buildForEachPlan(@"cap:in=media:pdf;op=extract;out=media:text")
+                                 inputFiles:buildItemFiles(4)
+                                  configure:nil
+                                    backend:backend];
+
+    XCTAssertTrue(result.success, @"%@", result.error);
+    CSNodeExecutionResult *collect = nil;
+    for (CSNodeExecutionResult *nodeResult in result.nodeResults) {
+        if ([nodeResult.nodeId isEqualToString:@"collect"]) collect = nodeResult;
+    }
+    id collected = [NSJSONSerialization JSONObjectWithData:[collect.textOutput dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil];
+    NSArray *values = [collected valueForKey:@"value"];
+    XCTAssertEqualObjects(values, (@[@"/tmp/item0.pdf", @"/tmp/item1.pdf", @"/tmp/item2.pdf", @"/tmp/item3.pdf"]));
+}
+
+// TEST1389: A failing item fails the ForEach, no later items start, and Collect never runs
+- (void)test1389ForEachItemFailureFailsRun {
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.01;
+    backend.failingArgument = @"/tmp/item1.pdf";
+    CSMachineResult *result = [self runPlan:buildForEachPlan(@"cap:in=media:pdf;op=extract;out=media:text")
+                                 inputFiles:buildItemFiles(20)
+                                  configure:^(CSMachineExecutor *executor) {
+        [executor withForEachWindow:2];
+    } backend:backend];
+
+    XCTAssertFalse(result.success);
+    XCTAssertTrue([result.error containsString:@"foreach"], @"%@", result.error);
+    XCTAssertTrue([result.error containsString:@"Item 1"], @"%@", result.error);
+    for (CSNodeExecutionResult *nodeResult in result.nodeResults) {
+        XCTAssertNotEqualObjects(nodeResult.nodeId, @"collect");
+    }
+}
+
+// TEST1404: A ForEach body reading an outer node waits for it and sees its output in every item run
+- (void)test1404ForEachBodyReadsOuterNode {
+    CSMachinePlan *plan = [CSMachinePlan planWithName:@"ForEach with outer input"];
+    [plan addNode:[CSMachineNode inputSlotNode:@"input_slot" slotName:@"input" mediaUrn:@"media:pdf;list" cardinality:CSInputCardinalitySequence]];
+    [plan addNode:[CSMachineNode capNode:@"prep" capUrn:@"cap:in=media:pdf;op=prep;out=media:text"
+                                bindings:@{@"media:text": [CSArgumentBinding literalString:@"prepared"]}]];
+    [plan addNode:[CSMachineNode forEachNode:@"foreach" inputNode:@"input_slot" bodyEntry:@"body_cap" bodyExit:@"body_cap"]];
+    [plan addNode:[CSMachineNode capNode:@"body_cap" capUrn:@"cap:in=media:pdf;op=extract;out=media:text"
+                                bindings:@{@"media:text": [CSArgumentBinding previousOutputFromNode:@"prep" outputField:@"value"]}]];
+    [plan addNode:[CSMachineNode collectNode:@"collect" inputNodes:@[@"body_cap"]]];
+    [plan addNode:[CSMachineNode outputNode:@"output" outputName:@"results" sourceNode:@"collect"]];
+    [plan addEdge:[CSMachinePlanEdge directFrom:@"input_slot" to:@"foreach"]];
+    [plan addEdge:[CSMachinePlanEdge directFrom:@"prep" to:@"body_cap"]];
+    [plan addEdge:[CSMachinePlanEdge iterationFrom:@"foreach" to:@"body_cap"]];
+    [plan addEdge:[CSMachinePlanEdge collectionFrom:@"body_cap" to:@"collect"]];
+    [plan addEdge:[CSMachinePlanEdge directFrom:@"collect" to:@"output"]];
+
+    MockTimedCapExecutor *backend = [[MockTimedCapExecutor alloc] init];
+    backend.delay = 0.1;
+    CSMachineResult *result = [self runPlan:plan inputFiles:buildItemFiles(3) configure:nil backend:backend];
+
+    XCTAssertTrue(result.success, @"%@", result.error);
+    CSNodeExecutionResult *prep = nil;
+    CSNodeExecutionResult *foreach = nil;
+    CSNodeExecutionResult *collect = nil;
+    for (CSNodeExecutionResult *nodeResult in result.nodeResults) {
+        if ([nodeResult.nodeId isEqualToString:@"prep"]) prep = nodeResult;
+        if ([nodeResult.nodeId isEqualToString:@"foreach"]) foreach = nodeResult;
+        if ([nodeResult.nodeId isEqualToString:@"collect"]) collect = nodeResult;
+    }
+    XCTAssertNotNil(prep);
+    XCTAssertGreaterThanOrEqual(foreach.startOffsetMs, prep.startOffsetMs + prep.durationMs, @"The ForEach waits for the node its body reads");
+    XCTAssertFalse([[result.nodeResults valueForKey:@"nodeId"] containsObject:@"body_cap"]);
+
+    id collected = [NSJSONSerialization JSONObjectWithData:[collect.textOutput dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil];
+    NSArray *values = [collected valueForKey:@"value"];
+    XCTAssertEqual(values.count, 3u, @"One result per item");
+    XCTAssertEqual([NSSet setWithArray:values].count, 1u, @"Every item run read the same outer output");
+    XCTAssertTrue([values.firstObject containsString:@"prepared"], @"%@", values);
+}
+
+// TEST1411: Parallelism and per-cap limits bound ForEach item runs together, not each item run
+- (void)test1411ForEachItemsShareRunLimits {
+    NSString *capUrn = @"cap:in=media:pdf;op=extract;out=media:text";
+
+    MockTimedCapExecutor *parallel = [[MockTimedCapExecutor alloc] init];
+    parallel.delay = 0.05;
+    CSMachineResult *result = [self runPlan:buildForEachPlan(capUrn) inputFiles:buildItemFiles(8) configure:^(CSMachineExecutor *executor) {
+        [[executor withForEachWindow:8] withMaxParallelism:2];
+    } backend:parallel];
+    XCTAssertTrue(result.success, @"%@", result.error);
+    XCTAssertEqual(parallel.completed, 8u);
+    XCTAssertEqual(parallel.peakRunning, 2u);
+
+    MockTimedCapExecutor *limited = [[MockTimedCapExecutor alloc] init];
+    limited.delay = 0.05;
+    result = [self runPlan:buildForEachPlan(capUrn) inputFiles:buildItemFiles(4) configure:^(CSMachineExecutor *executor) {
+        [[executor withForEachWindow:4] withCapConcurrencyLimits:@{capUrn: @1}];
+    } backend:limited];
+    XCTAssertTrue(result.success, @"%@", result.error);
+    XCTAssertEqual(limited.completed, 4u);
+    XCTAssertEqual(limited.peakRunning, 1u);
+
+    MockTimedCapExecutor *serial = [[MockTimedCapExecutor alloc] init];
+    serial.delay = 0.01;
+    result = [self runPlan:buildForEachPlan(capUrn) inputFiles:buildItemFiles(3) configure:^(CSMachineExecutor *executor) {
+        [executor withMaxParallelism:1];
+    } backend:serial];
+    XCTAssertTrue(result.success, @"The ForEach itself doesn't hold the only slot: %@", result.error);
+    XCTAssertEqual(serial.peakRunning, 1u);
+}
+
+@end
@@ -717,4 +717,113 @@
     XCTAssertTrue([set isHomogeneous]);
 }
 
+#pragma mark - Indexed Lookup and Detection Cache Tests
+
+/// First adapter in priority order matching the extension, as the registry
+/// answered before it indexed its adapters
+- (nullable id<CSMediaAdapter>)linearAdapterForExtension:(NSString *)ext {
+    for (id<CSMediaAdapter> adapter in [CSMediaAdapterRegistry shared].adapters) {
+        if ([adapter matchesExtension:ext]) {
+            return adapter;
+        }
+    }
+    return nil;
+}
+
+- (nullable id<CSMediaAdapter>)linearAdapterForMagicBytes:(NSData *)bytes {
+    for (id<CSMediaAdapter> adapter in [CSMediaAdapterRegistry shared].adapters) {
+        if ([adapter matchesMagicBytes:bytes]) {
+            return adapter;
+        }
+    }
+    return nil;
+}
+
+- (NSData *)dataWithBytes:(const uint8_t *)bytes length:(NSUInteger)length paddedTo:(NSUInteger)padded {
+    NSMutableData *data = [NSMutableData dataWithBytes:bytes length:length];
+    [data setLength:MAX(padded, length)];
+    return data;
+}
+
+- (void)test1395_indexed_lookup_matches_linear_scan {
+    // TEST1395: Indexed extension and magic-byte lookups pick the same adapter as a linear scan
+    CSMediaAdapterRegistry *registry = [CSMediaAdapterRegistry shared];
+
+    NSArray<NSString *> *extensions = @[@"pdf", @"PDF", @"epub", @"docx", @"png", @"jpg", @"jpeg",
+                                        @"gif", @"svg", @"wav", @"mp3", @"mp4", @"mov", @"json",
+                                        @"ndjson", @"csv", @"tsv", @"yaml", @"txt", @"md", @"rs",
+                                        @"swift", @"mk", @"makefile", @"zip", @"tar", @"gz", @"jar",
+                                        @"ttf", @"ipynb", @"wasm", @"dot", @"unknownext", @""];
+    for (NSString *ext in extensions) {
+        XCTAssertEqual([registry adapterForExtension:ext], [self linearAdapterForExtension:[ext lowercaseString]], @"extension %@", ext);
+    }
+
+    const uint8_t png[] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    const uint8_t pdf[] = {0x25, 0x50, 0x44, 0x46, 0x2D};
+    const uint8_t zip[] = {0x50, 0x4B, 0x03, 0x04};
+    const uint8_t gzip[] = {0x1F, 0x8B, 0x08};
+    const uint8_t wave[] = {0x52, 0x49, 0x46, 0x46, 0, 0, 0, 0, 0x57, 0x41, 0x56, 0x45};
+    const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF};
+    const uint8_t junk[] = {0x00, 0x01, 0x02, 0x03};
+    NSArray<NSData *> *samples = @[
+        [self dataWithBytes:png length:sizeof(png) paddedTo:32],
+        [self dataWithBytes:pdf length:sizeof(pdf) paddedTo:32],
+        [self dataWithBytes:zip length:sizeof(zip) paddedTo:32],
+        [self dataWithBytes:gzip length:sizeof(gzip) paddedTo:32],
+        [self dataWithBytes:wave length:sizeof(wave) paddedTo:32],
+        [self dataWithBytes:jpeg length:sizeof(jpeg) paddedTo:32],
+        [self dataWithBytes:junk length:sizeof(junk) paddedTo:32],
+        [self dataWithBytes:png length:2 paddedTo:2],
+        [@"<?xml version=\"1.0\"?><svg></svg>" dataUsingEncoding:NSUTF8StringEncoding],
+    ];
+    for (NSData *sample in samples) {
+        XCTAssertEqual([registry adapterForMagicBytes:sample], [self linearAdapterForMagicBytes:sample], @"bytes %@", sample);
+    }
+}
+
+- (void)test1396_concurrent_detection_keeps_input_order {
+    // TEST1396: Files inspected concurrently come back in input order with their own media types
+    NSMutableArray<NSString *> *paths = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 64; i++) {
+        NSString *name = [NSString stringWithFormat:@"file%02lu.%@", (unsigned long)(63 - i), i % 2 ? @"json" : @"csv"];
+        NSString *content = i % 2 ? @"{\"a\": 1}" : @"a,b\n1,2\n";
+        [paths addObject:[self createTestFile:name content:content]];
+    }
+    NSError *error;
+
+    CSResolvedInputSet *result = CSInputResolverResolvePaths(paths, &error);
+
+    XCTAssertNil(error);
+    XCTAssertEqual(result.files.count, paths.count);
+    for (NSUInteger i = 0; i < paths.count; i++) {
+        CSResolvedFile *file = result.files[i];
+        XCTAssertEqualObjects(file.path.lastPathComponent, paths[i].lastPathComponent);
+        XCTAssertTrue([file.mediaUrn hasPrefix:i % 2 ? @"media:json" : @"media:csv"], @"%@", file.mediaUrn);
+    }
+}
+
+- (void)test1397_detection_cache_invalidates_on_change {
+    // TEST1397: A cached detection is reused while size and mtime hold, and redone once the file changes
+    CSInputResolverClearDetectionCache();
+    NSString *path = [self createTestFile:@"data.json" content:@"{\"a\": 1}"];
+    NSError *error;
+
+    CSResolvedInputSet *first = CSInputResolverResolvePath(path, &error);
+    XCTAssertNil(error);
+    XCTAssertFalse([first.files[0] isList]);
+
+    CSResolvedInputSet *again = CSInputResolverResolvePath(path, &error);
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(again.files[0].mediaUrn, first.files[0].mediaUrn);
+    XCTAssertEqual(again.files[0].contentStructure, first.files[0].contentStructure);
+
+    [@"[{\"a\": 1}, {\"a\": 2}]" writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [self.fm setAttributes:@{NSFileModificationDate: [NSDate dateWithTimeIntervalSinceNow:60]} ofItemAtPath:path error:nil];
+
+    CSResolvedInputSet *changed = CSInputResolverResolvePath(path, &error);
+    XCTAssertNil(error);
+    XCTAssertTrue([changed.files[0] isList]);
+    XCTAssertEqual(changed.files[0].sizeBytes, (uint64_t)[[self.fm attributesOfItemAtPath:path error:nil] fileSize]);
+}
+
 @end
@@ -359,4 +359,198 @@ static CSCap *makeTestCap(NSString *inSpec, NSString *outSpec, NSString *op, NSS
                    @"A specific disbind cap should NOT be equivalent to identity");
 }
 
+// TEST1377: Cached reachability is dropped when a cap is added
+- (void)test1377ReachabilityCacheInvalidatedByAddCap {
+    CSLiveCapGraph *graph = [CSLiveCapGraph graph];
+    [graph addCap:makeTestCap(@"media:a", @"media:b", @"step1", @"A to B")];
+
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:a" error:&error];
+    XCTAssertEqual([graph getReachableTargetsFromSource:source maxDepth:5].count, 1u);
+
+    [graph addCap:makeTestCap(@"media:b", @"media:c", @"step2", @"B to C")];
+    NSArray<CSReachableTargetInfo *> *targets = [graph getReachableTargetsFromSource:source maxDepth:5];
+    XCTAssertEqual(targets.count, 2u, @"New cap must be visible after a cached query");
+    XCTAssertEqualObjects(targets[1].mediaUrn, @"media:c");
+    XCTAssertEqual(targets[1].minDepth, 2u);
+
+    // Callers get their own info objects
+    targets[0].pathCount = 99;
+    XCTAssertEqual([graph getReachableTargetsFromSource:source maxDepth:5][0].pathCount, 1u);
+}
+
+// TEST1378: maxPaths keeps the best paths, not the first ones found
+- (void)test1378FindPathsKeepsBestWhenTruncated {
+    CSLiveCapGraph *graph = [CSLiveCapGraph graph];
+    // Long route registered first, so a depth-first walk would find it first
+    [graph addCap:makeTestCap(@"media:a", @"media:m1", @"long1", @"A to M1")];
+    [graph addCap:makeTestCap(@"media:m1", @"media:m2", @"long2", @"M1 to M2")];
+    [graph addCap:makeTestCap(@"media:m2", @"media:c", @"long3", @"M2 to C")];
+    [graph addCap:makeTestCap(@"media:a", @"media:b", @"short1", @"A to B")];
+    [graph addCap:makeTestCap(@"media:b", @"media:c", @"short2", @"B to C")];
+    CSCap *direct = makeTestCap(@"media:a", @"media:c", @"direct", @"A to C");
+    [graph addCap:direct];
+
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:a" error:&error];
+    CSMediaUrn *target = [CSMediaUrn fromString:@"media:c" error:&error];
+
+    NSArray<CSStrand *> *best = [graph findPathsToExactTarget:source target:target maxDepth:5 maxPaths:1];
+    XCTAssertEqual(best.count, 1u);
+    XCTAssertEqualObjects(best[0].steps[0].capUrn, [direct.capUrn toString]);
+
+    NSArray<CSStrand *> *two = [graph findPathsToExactTarget:source target:target maxDepth:5 maxPaths:2];
+    XCTAssertEqual(two.count, 2u);
+    XCTAssertEqual(two[1].capStepCount, 2);
+
+    NSArray<CSStrand *> *all = [graph findPathsToExactTarget:source target:target maxDepth:5 maxPaths:10];
+    XCTAssertEqual(all.count, 3u);
+    XCTAssertEqual(all[2].capStepCount, 3);
+
+    NSArray<CSStrand *> *shallow = [graph findPathsToExactTarget:source target:target maxDepth:2 maxPaths:10];
+    XCTAssertEqual(shallow.count, 2u, @"maxDepth still bounds path length");
+}
+
+// TEST1379: Queries from a source that is not a graph node still match by conformance
+- (void)test1379QueriesFromNonNodeSource {
+    CSLiveCapGraph *graph = [CSLiveCapGraph graph];
+    [graph addCap:makeTestCap(@"media:pdf", @"media:extracted-text", @"extract", @"Extract")];
+
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:pdf;textable" error:&error];
+    CSMediaUrn *target = [CSMediaUrn fromString:@"media:extracted-text" error:&error];
+    XCTAssertNotNil(source);
+
+    XCTAssertEqual([graph getReachableTargetsFromSource:source maxDepth:3].count, 1u);
+    XCTAssertEqual([graph findPathsToExactTarget:source target:target maxDepth:3 maxPaths:5].count, 1u);
+}
+
+// TEST1380: Incremental sync ends in the same graph as a full rebuild
+- (void)test1380IncrementalSyncMatchesFullRebuild {
+    CSCap *disbind = makeTestCap(@"media:pdf", @"media:page;textable;list", @"disbind", @"Disbind PDF");
+    CSCap *choose = makeTestCap(@"media:textable", @"media:decision;bool;textable", @"choose", @"Make a Decision");
+    CSCap *ocr = makeTestCap(@"media:image", @"media:page;textable", @"ocr", @"OCR");
+    CSCap *summarize = makeTestCap(@"media:page;textable;list", @"media:summary-text", @"summarize", @"Summarize");
+
+    NSArray<NSArray<CSCap *> *> *manifests = @[
+        @[disbind, choose],
+        @[disbind, choose, ocr],
+        @[disbind, ocr, summarize],
+        @[choose],
+        @[disbind, choose, ocr, summarize],
+    ];
+
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:pdf" error:&error];
+    CSMediaUrn *target = [CSMediaUrn fromString:@"media:decision;bool;textable" error:&error];
+
+    CSLiveCapGraph *incremental = [CSLiveCapGraph graph];
+    for (NSArray<CSCap *> *caps in manifests) {
+        [incremental syncFromCaps:caps];
+        // addCap: leaves transitions stale, which forces sync to rebuild in full
+        CSLiveCapGraph *rebuilt = [CSLiveCapGraph graph];
+        for (CSCap *cap in caps) {
+            [rebuilt addCap:cap];
+        }
+        [rebuilt syncFromCaps:caps];
+
+        XCTAssertEqual([incremental edgeCount], [rebuilt edgeCount]);
+        XCTAssertEqual([incremental nodeCount], [rebuilt nodeCount]);
+
+        NSArray *incrementalTargets = [[incremental getReachableTargetsFromSource:source maxDepth:5] valueForKey:@"mediaUrn"];
+        NSArray *rebuiltTargets = [[rebuilt getReachableTargetsFromSource:source maxDepth:5] valueForKey:@"mediaUrn"];
+        XCTAssertEqualObjects(incrementalTargets, rebuiltTargets);
+
+        NSArray *incrementalPaths = [[incremental findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+        NSArray *rebuiltPaths = [[rebuilt findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+        XCTAssertEqualObjects(incrementalPaths, rebuiltPaths);
+    }
+}
+
+// TEST1381: Removing the only item consumer drops the list's ForEach edge
+- (void)test1381RemovingConsumerDropsForEach {
+    CSCap *disbind = makeTestCap(@"media:pdf", @"media:page;textable;list", @"disbind", @"Disbind PDF");
+    CSCap *choose = makeTestCap(@"media:textable", @"media:decision;bool;textable", @"choose", @"Make a Decision");
+
+    CSLiveCapGraph *graph = [CSLiveCapGraph graph];
+    [graph syncFromCaps:@[disbind, choose]];
+    NSUInteger withConsumer = [graph edgeCount];
+    XCTAssertGreaterThan(withConsumer, 2u, @"ForEach/Collect edges inserted");
+
+    [graph updateWithAddedCaps:@[] removedCapUrns:@[[choose.capUrn toString]]];
+    XCTAssertEqual([graph edgeCount], 1u, @"Only the disbind cap edge remains");
+
+    // Unchanged manifest is a no-op
+    [graph syncFromCaps:@[disbind]];
+    XCTAssertEqual([graph edgeCount], 1u);
+
+    [graph updateWithAddedCaps:@[choose] removedCapUrns:@[]];
+    XCTAssertEqual([graph edgeCount], withConsumer);
+}
+
+// TEST1402: Concurrent first queries share one lazily built topology and agree with a serial query
+- (void)test1402ConcurrentQueriesOnFreshGraph {
+    NSArray<CSCap *> *caps = @[
+        makeTestCap(@"media:pdf", @"media:page;textable;list", @"disbind", @"Disbind PDF"),
+        makeTestCap(@"media:textable", @"media:decision;bool;textable", @"choose", @"Make a Decision"),
+        makeTestCap(@"media:image", @"media:page;textable", @"ocr", @"OCR"),
+    ];
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:pdf" error:&error];
+    CSMediaUrn *target = [CSMediaUrn fromString:@"media:decision;bool;textable" error:&error];
+
+    CSLiveCapGraph *serial = [CSLiveCapGraph graph];
+    [serial syncFromCaps:caps];
+    NSArray *expectedTargets = [[serial getReachableTargetsFromSource:source maxDepth:5] valueForKey:@"mediaUrn"];
+    NSArray *expectedPaths = [[serial findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+
+    CSLiveCapGraph *graph = [CSLiveCapGraph graph];
+    [graph syncFromCaps:caps];
+    NSLock *lock = [[NSLock alloc] init];
+    NSMutableArray *mismatches = [NSMutableArray array];
+    dispatch_apply(32, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        NSArray *targets = [[graph getReachableTargetsFromSource:source maxDepth:5] valueForKey:@"mediaUrn"];
+        NSArray *paths = [[graph findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+        if (![targets isEqualToArray:expectedTargets] || ![paths isEqualToArray:expectedPaths]) {
+            [lock lock];
+            [mismatches addObject:@(i)];
+            [lock unlock];
+        }
+    });
+    XCTAssertEqual(mismatches.count, 0u);
+    XCTAssertGreaterThan(expectedPaths.count, 0u);
+}
+
+// TEST1403: A manifest listing the same cap URN twice builds the same graph through full and incremental sync
+- (void)test1403DuplicateCapsDedupedOnBothSyncPaths {
+    CSCap *disbind = makeTestCap(@"media:pdf", @"media:page;textable;list", @"disbind", @"Disbind PDF");
+    CSCap *choose = makeTestCap(@"media:textable", @"media:decision;bool;textable", @"choose", @"Make a Decision");
+    CSCap *chooseAgain = makeTestCap(@"media:textable", @"media:decision;bool;textable", @"choose", @"Decide Again");
+    NSArray<CSCap *> *caps = @[disbind, choose, chooseAgain, disbind];
+
+    // Fresh graph: incremental diff path
+    CSLiveCapGraph *incremental = [CSLiveCapGraph graph];
+    [incremental syncFromCaps:caps];
+
+    // addCap: leaves transitions stale, which forces the full rebuild path
+    CSLiveCapGraph *rebuilt = [CSLiveCapGraph graph];
+    [rebuilt addCap:disbind];
+    [rebuilt syncFromCaps:caps];
+
+    CSLiveCapGraph *unique = [CSLiveCapGraph graph];
+    [unique syncFromCaps:@[disbind, choose]];
+
+    XCTAssertEqual([incremental edgeCount], [unique edgeCount]);
+    XCTAssertEqual([rebuilt edgeCount], [unique edgeCount]);
+    XCTAssertEqual([rebuilt nodeCount], [incremental nodeCount]);
+
+    NSError *error = nil;
+    CSMediaUrn *source = [CSMediaUrn fromString:@"media:pdf" error:&error];
+    CSMediaUrn *target = [CSMediaUrn fromString:@"media:decision;bool;textable" error:&error];
+    NSArray *incrementalPaths = [[incremental findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+    NSArray *rebuiltPaths = [[rebuilt findPathsToExactTarget:source target:target maxDepth:6 maxPaths:10] valueForKey:@"pathDescription"];
+    XCTAssertEqualObjects(incrementalPaths, rebuiltPaths);
+    XCTAssertGreaterThan(rebuiltPaths.count, 0u);
+}
+
 @end
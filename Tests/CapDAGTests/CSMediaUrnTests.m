@@ -520,4 +520,29 @@
         @"availability must not conform to path");
 }
 
+#pragma mark - Interning
+
+// TEST1373: MediaUrn parses are interned and compare by canonical form
+- (void)test1373_media_urn_interning_and_equality {
+    NSError *error = nil;
+    CSMediaUrn *first = [CSMediaUrn fromString:@"media:textable;record" error:&error];
+    XCTAssertNotNil(first);
+    XCTAssertTrue(first == [CSMediaUrn fromString:@"media:textable;record" error:&error]);
+    XCTAssertEqual([first specificity], 2);
+
+    // A different spelling of the same URN is a separate cache entry but an equal value
+    CSMediaUrn *reordered = [CSMediaUrn fromString:@"media:record;textable" error:&error];
+    XCTAssertNotNil(reordered);
+    XCTAssertEqualObjects([first toString], [reordered toString]);
+    XCTAssertEqualObjects(first, reordered);
+    XCTAssertEqual(first.hash, reordered.hash);
+    XCTAssertNotEqualObjects(first, [first withList]);
+
+    NSDictionary *byUrn = @{first: @"value"};
+    XCTAssertEqualObjects(byUrn[reordered], @"value");
+
+    XCTAssertNil([CSMediaUrn fromString:@"cap:op=x" error:&error]);
+    XCTAssertEqual(error.code, CSMediaUrnErrorInvalidPrefix);
+}
+
 @end
@@ -0,0 +1,127 @@
+//
+//  CSPlanBuilderTests.m
+//  CapDAGTests
+//
+//  Tests for CSMachinePlanBuilder memoization: repeated queries are answered
+//  from the memo, callers get independent plans, and changing the available
+//  caps or the registry's caps drops stale answers.
+//
+
+#import <XCTest/XCTest.h>
+#import "CapDAG.h"
+
+// Mock registry: counts fetches and bumps its generation on every change
+@interface MockGenerationCapRegistry : NSObject <CSCapRegistryProtocol>
+@property (nonatomic, strong) NSArray<CSCap *> *caps;
+@property (nonatomic, assign) NSUInteger fetchCount;
+@property (nonatomic, assign) NSUInteger generation;
+@end
+
+@implementation MockGenerationCapRegistry
+
+- (void)setCaps:(NSArray<CSCap *> *)caps {
+    _caps = caps;
+    _generation += 1;
+}
+
+- (void)getCachedCaps:(void (^)(NSArray<CSCap *> * _Nullable caps, NSError * _Nullable error))completion {
+    self.fetchCount += 1;
+    completion(self.caps, nil);
+}
+
+- (NSUInteger)capsGeneration {
+    return self.generation;
+}
+
+@end
+
+@interface MockMediaRegistry : NSObject <CSMediaUrnRegistryProtocol>
+@end
+
+@implementation MockMediaRegistry
+
+- (void)getMediaSpec:(NSString *)urn completion:(void (^)(NSDictionary * _Nullable spec, NSError * _Nullable error))completion {
+    completion(nil, nil);
+}
+
+@end
+
+static CSCap *makeBuilderCap(NSString *urn) {
+    return [CSCap capWithUrn:[CSCapUrn fromString:urn error:nil] title:urn command:@"test"];
+}
+
+@interface CSPlanBuilderTests : XCTestCase
+@end
+
+@implementation CSPlanBuilderTests
+
+- (CSMachinePlan *)buildPlan:(CSMachinePlanBuilder *)builder error:(NSError **)outError {
+    __block CSMachinePlan *result = nil;
+    __block NSError *resultError = nil;
+    CSCapInputFile *input = [CSCapInputFile withFilePath:@"/tmp/input.pdf" mediaUrn:@"media:pdf"];
+    [builder buildPlanFromSource:@"media:pdf" toTarget:@"media:text" inputFiles:@[input] completion:^(CSMachinePlan * _Nullable plan, NSError * _Nullable error) {
+        result = plan;
+        resultError = error;
+    }];
+    if (outError) *outError = resultError;
+    return result;
+}
+
+// TEST1390: Repeated plan requests are served from the memo as independent copies
+- (void)test1390PlanMemoReturnsIndependentCopies {
+    MockGenerationCapRegistry *registry = [[MockGenerationCapRegistry alloc] init];
+    registry.caps = @[makeBuilderCap(@"cap:in=media:pdf;op=extract;out=media:text")];
+    CSMachinePlanBuilder *builder = [[CSMachinePlanBuilder alloc] initWithCapRegistry:registry mediaRegistry:[[MockMediaRegistry alloc] init]];
+
+    CSMachinePlan *first = [self buildPlan:builder error:nil];
+    XCTAssertNotNil(first);
+    NSUInteger fetchesAfterFirst = registry.fetchCount;
+
+    [first addNode:[CSMachineNode capNode:@"extra" capUrn:@"cap:in=media:text;op=extra;out=media:text"]];
+    [first getNode:@"cap_0"].capUrn = @"cap:in=media:pdf;op=changed;out=media:text";
+
+    CSMachinePlan *second = [self buildPlan:builder error:nil];
+    XCTAssertEqual(registry.fetchCount, fetchesAfterFirst, @"A hit with an unchanged generation does not fetch caps");
+    XCTAssertNotEqual(first, second);
+    XCTAssertNil([second getNode:@"extra"]);
+    XCTAssertEqualObjects([second getNode:@"cap_0"].capUrn, @"cap:in=media:pdf;op=extract;out=media:text");
+    XCTAssertEqual(second.nodes.count, first.nodes.count - 1);
+}
+
+// TEST1391: withAvailableCaps: and registry changes invalidate memoized paths
+- (void)test1391PathMemoInvalidation {
+    NSString *extract = @"cap:in=media:pdf;op=extract;out=media:text";
+    MockGenerationCapRegistry *registry = [[MockGenerationCapRegistry alloc] init];
+    registry.caps = @[makeBuilderCap(extract)];
+    CSMachinePlanBuilder *builder = [[CSMachinePlanBuilder alloc] initWithCapRegistry:registry mediaRegistry:[[MockMediaRegistry alloc] init]];
+
+    __block NSArray<NSString *> *path = nil;
+    __block NSError *pathError = nil;
+    void (^findPath)(void) = ^{
+        [builder findPathFromSource:@"media:pdf" toTarget:@"media:text" completion:^(NSArray<NSString *> * _Nullable capUrns, NSError * _Nullable error) {
+            path = capUrns;
+            pathError = error;
+        }];
+    };
+
+    findPath();
+    XCTAssertEqual(path.count, 1u);
+    NSString *extractCanonical = path.firstObject;
+
+    [builder withAvailableCaps:[NSSet set]];
+    findPath();
+    XCTAssertNil(path);
+    XCTAssertEqual(pathError.code, CSPlannerErrorCodeNotFound);
+
+    [builder withAvailableCaps:[NSSet setWithObject:extractCanonical]];
+    findPath();
+    XCTAssertEqualObjects(path, @[extractCanonical]);
+
+    // New registry contents: the memoized path for the old caps is dropped
+    registry.caps = @[];
+    findPath();
+    XCTAssertNil(path);
+    XCTAssertEqual(pathError.code, CSPlannerErrorCodeNotFound);
+}
+
+@end
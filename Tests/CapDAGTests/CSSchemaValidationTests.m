@@ -11,6 +11,21 @@
 #import <XCTest/XCTest.h>
 #import "CapDAG.h"
 
+// Resolver serving in-memory schemas that runs `onResolve` before answering
+@interface CSCallbackSchemaResolver : NSObject <CSSchemaResolver>
+@property (nonatomic, copy) NSDictionary<NSString *, NSDictionary *> *schemas;
+@property (nonatomic, copy, nullable) void (^onResolve)(NSString *schemaRef);
+@end
+
+@implementation CSCallbackSchemaResolver
+
+- (nullable NSDictionary *)resolveSchema:(NSString *)schemaRef error:(NSError **)error {
+    if (self.onResolve) self.onResolve(schemaRef);
+    return self.schemas[schemaRef];
+}
+
+@end
+
 @interface CSSchemaValidationTests : XCTestCase
 @property (nonatomic, strong) CSJSONSchemaValidator *validator;
 @property (nonatomic, strong) CSFileSchemaResolver *resolver;
@@ -842,4 +857,176 @@
     XCTAssertTrue(result.valid, @"Should pass when registry lookup not available (graceful degradation)");
 }
 
+#pragma mark - Compiled Schema Tests
+
+- (CSCapArg *)argumentForMediaUrn:(NSString *)mediaUrn {
+    return [CSCapArg argWithMediaUrn:mediaUrn
+                            required:YES
+                             sources:@[[CSArgSource cliFlagSource:@"--data"]]
+                      argDescription:@"Structured data"
+                        defaultValue:nil];
+}
+
+- (NSArray<NSDictionary *> *)mediaSpecsForUrn:(NSString *)mediaUrn schema:(NSDictionary *)schema {
+    return @[@{
+        @"urn": mediaUrn,
+        @"media_type": @"application/json",
+        @"schema": schema
+    }];
+}
+
+// TEST1392: An external $ref is resolved through the resolver once and reused
+- (void)test1392ExternalRefResolvedOnce {
+    NSString *path = [self.tempDir stringByAppendingPathComponent:@"user-name.json"];
+    NSData *refSchema = [NSJSONSerialization dataWithJSONObject:@{@"type": @"string", @"minLength": @2} options:0 error:nil];
+    XCTAssertTrue([refSchema writeToFile:path atomically:YES]);
+
+    NSString *urn = @"my:user.v1;textable;record";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{
+        @"type": @"object",
+        @"properties": @{@"name": @{@"$ref": @"user-name"}},
+        @"required": @[@"name"]
+    }];
+    CSCapArg *argument = [self argumentForMediaUrn:urn];
+
+    NSError *error = nil;
+    XCTAssertTrue([self.validator validateArgument:argument withValue:@{@"name": @"Ada"} mediaSpecs:mediaSpecs error:&error], @"%@", error);
+
+    // The compiled ref is reused; the file is not read again
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    XCTAssertTrue([self.validator validateArgument:argument withValue:@{@"name": @"Grace"} mediaSpecs:mediaSpecs error:&error], @"%@", error);
+    XCTAssertFalse([self.validator validateArgument:argument withValue:@{@"name": @"A"} mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqualObjects(((CSSchemaValidationError *)error).validationErrors, @[@"Property 'name' validation failed"]);
+}
+
+// TEST1393: Recursive local $refs validate nested structures to any depth
+- (void)test1393RecursiveLocalRef {
+    NSString *urn = @"my:tree.v1;textable;record";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{
+        @"$ref": @"#/definitions/node",
+        @"definitions": @{
+            @"node": @{
+                @"type": @"object",
+                @"required": @[@"label"],
+                @"properties": @{
+                    @"label": @{@"type": @"string"},
+                    @"children": @{@"type": @"array", @"items": @{@"$ref": @"#/definitions/node"}}
+                }
+            }
+        }
+    }];
+    CSCapArg *argument = [self argumentForMediaUrn:urn];
+
+    NSDictionary *valid = @{@"label": @"root", @"children": @[@{@"label": @"a", @"children": @[@{@"label": @"b"}]}]};
+    NSError *error = nil;
+    XCTAssertTrue([self.validator validateArgument:argument withValue:valid mediaSpecs:mediaSpecs error:&error], @"%@", error);
+
+    NSDictionary *invalid = @{@"label": @"root", @"children": @[@{@"label": @"a", @"children": @[@{@"label": @3}]}]};
+    XCTAssertFalse([self.validator validateArgument:argument withValue:invalid mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqualObjects(((CSSchemaValidationError *)error).validationErrors, @[@"Property 'children' validation failed"]);
+
+    NSDictionary *missingLabel = @{@"children": @[]};
+    XCTAssertFalse([self.validator validateArgument:argument withValue:missingLabel mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqualObjects(((CSSchemaValidationError *)error).validationErrors, @[@"Missing required property 'label'"]);
+}
+
+// TEST1394: Precompiled patterns match per value, bad patterns and dangling refs are reported
+- (void)test1394PatternsAndDanglingRefs {
+    NSString *urn = @"my:slug.v1;textable";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{@"type": @"string", @"pattern": @"^[a-z]+$"}];
+    CSCapArg *argument = [self argumentForMediaUrn:urn];
+    NSError *error = nil;
+    for (NSUInteger round = 0; round < 2; round++) {
+        XCTAssertTrue([self.validator validateArgument:argument withValue:@"slug" mediaSpecs:mediaSpecs error:&error], @"%@", error);
+        XCTAssertFalse([self.validator validateArgument:argument withValue:@"Not A Slug" mediaSpecs:mediaSpecs error:&error]);
+        XCTAssertEqualObjects(((CSSchemaValidationError *)error).validationErrors, @[@"String does not match pattern '^[a-z]+$'"]);
+    }
+
+    NSArray<NSDictionary *> *badPatternSpecs = [self mediaSpecsForUrn:urn schema:@{@"type": @"string", @"pattern": @"(["}];
+    XCTAssertFalse([self.validator validateArgument:argument withValue:@"slug" mediaSpecs:badPatternSpecs error:&error]);
+    XCTAssertTrue([((CSSchemaValidationError *)error).validationErrors.firstObject hasPrefix:@"Invalid regex pattern '(['"]);
+
+    NSArray<NSDictionary *> *danglingSpecs = [self mediaSpecsForUrn:urn schema:@{@"$ref": @"#/definitions/missing"}];
+    XCTAssertFalse([self.validator validateArgument:argument withValue:@"slug" mediaSpecs:danglingSpecs error:&error]);
+    XCTAssertEqual(error.code, CSSchemaValidationErrorTypeSchemaRefNotResolved);
+}
+
+// TEST1405: The resolver runs outside the cache lock, and a compiled $ref survives the resolver being replaced
+- (void)test1405ResolverReentryAndReplacement {
+    CSCallbackSchemaResolver *resolver = [[CSCallbackSchemaResolver alloc] init];
+    resolver.schemas = @{@"user-name": @{@"type": @"string", @"minLength": @2}};
+    CSJSONSchemaValidator *validator = [CSJSONSchemaValidator validatorWithResolver:resolver];
+
+    NSString *urn = @"my:user.v1;textable;record";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{
+        @"type": @"object",
+        @"properties": @{@"name": @{@"$ref": @"user-name"}},
+        @"required": @[@"name"]
+    }];
+    CSCapArg *argument = [self argumentForMediaUrn:urn];
+
+    // Re-entrant: the resolver validates through the same validator
+    NSString *slugUrn = @"my:slug.v1;textable";
+    NSArray<NSDictionary *> *slugSpecs = [self mediaSpecsForUrn:slugUrn schema:@{@"type": @"string", @"pattern": @"^[a-z]+$"}];
+    CSCapArg *slugArgument = [self argumentForMediaUrn:slugUrn];
+    __block BOOL nestedValid = NO;
+    __weak CSJSONSchemaValidator *weakValidator = validator;
+    resolver.onResolve = ^(NSString *schemaRef) {
+        nestedValid = [weakValidator validateArgument:slugArgument withValue:@"slug" mediaSpecs:slugSpecs error:nil];
+    };
+    NSError *error = nil;
+    XCTAssertTrue([validator validateArgument:argument withValue:@{@"name": @"Ada"} mediaSpecs:mediaSpecs error:&error], @"%@", error);
+    XCTAssertTrue(nestedValid);
+
+    // Replaced mid-compilation: the schema compiled against the old resolver still checks its $ref
+    NSString *otherUrn = @"my:member.v1;textable;record";
+    NSArray<NSDictionary *> *otherSpecs = [self mediaSpecsForUrn:otherUrn schema:@{
+        @"type": @"object",
+        @"properties": @{@"name": @{@"$ref": @"member-name"}}
+    }];
+    resolver.schemas = @{@"member-name": @{@"type": @"string", @"minLength": @2}};
+    resolver.onResolve = ^(NSString *schemaRef) {
+        weakValidator.resolver = [[CSCallbackSchemaResolver alloc] init];
+    };
+    XCTAssertFalse([validator validateArgument:[self argumentForMediaUrn:otherUrn] withValue:@{@"name": @"A"} mediaSpecs:otherSpecs error:&error]);
+    XCTAssertEqualObjects(((CSSchemaValidationError *)error).validationErrors, @[@"Property 'name' validation failed"]);
+}
+
+// TEST1408: A local $ref to the schema itself is a cycle and fails compilation instead of looping
+- (void)test1408SelfRefCycleFails {
+    NSString *urn = @"my:loop.v1;textable";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{@"$ref": @"#"}];
+    NSError *error = nil;
+    XCTAssertFalse([self.validator validateArgument:[self argumentForMediaUrn:urn] withValue:@"x" mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqual(error.code, CSSchemaValidationErrorTypeSchemaRefNotResolved);
+}
+
+// TEST1409: A definition whose only keyword is a $ref back to itself fails compilation
+- (void)test1409DefinitionRefCycleFails {
+    NSString *urn = @"my:loop.v1;textable";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{
+        @"$ref": @"#/definitions/a",
+        @"definitions": @{@"a": @{@"$ref": @"#/definitions/a"}}
+    }];
+    NSError *error = nil;
+    XCTAssertFalse([self.validator validateArgument:[self argumentForMediaUrn:urn] withValue:@"x" mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqual(error.code, CSSchemaValidationErrorTypeSchemaRefNotResolved);
+}
+
+// TEST1410: External documents that only $ref each other (A -> B -> A) fail compilation
+- (void)test1410ExternalRefCycleFails {
+    CSCallbackSchemaResolver *resolver = [[CSCallbackSchemaResolver alloc] init];
+    resolver.schemas = @{
+        @"A.json": @{@"$ref": @"B.json"},
+        @"B.json": @{@"$ref": @"A.json"}
+    };
+    CSJSONSchemaValidator *validator = [CSJSONSchemaValidator validatorWithResolver:resolver];
+
+    NSString *urn = @"my:loop.v1;textable";
+    NSArray<NSDictionary *> *mediaSpecs = [self mediaSpecsForUrn:urn schema:@{@"$ref": @"A.json"}];
+    NSError *error = nil;
+    XCTAssertFalse([validator validateArgument:[self argumentForMediaUrn:urn] withValue:@"x" mediaSpecs:mediaSpecs error:&error]);
+    XCTAssertEqual(error.code, CSSchemaValidationErrorTypeSchemaRefNotResolved);
+}
+
 @end